@@ -5,6 +5,8 @@
 
 #ifndef ROCKSDB_LITE
 #include "db/compacted_db_impl.h"
+
+#include <algorithm>
 #include "db/db_impl.h"
 #include "db/version_set.h"
 #include "table/get_context.h"
@@ -59,32 +61,59 @@ Status CompactedDBImpl::Get(const ReadOptions& options,
 std::vector<Status> CompactedDBImpl::MultiGet(const ReadOptions& options,
     const std::vector<ColumnFamilyHandle*>&,
     const std::vector<Slice>& keys, std::vector<std::string>* values) {
-  autovector<TableReader*, 16> reader_list;
-  for (const auto& key : keys) {
-    const FdWithKeyRange& f = files_.files[FindFile(key)];
-    if (user_comparator_->Compare(key, ExtractUserKey(f.smallest_key)) < 0) {
-      reader_list.push_back(nullptr);
-    } else {
-      LookupKey lkey(key, kMaxSequenceNumber);
-      f.fd.table_reader->Prepare(lkey.internal_key());
-      reader_list.push_back(f.fd.table_reader);
-    }
-  }
   std::vector<Status> statuses(keys.size(), Status::NotFound());
   values->resize(keys.size());
-  int idx = 0;
-  for (auto* r : reader_list) {
-    if (r != nullptr) {
-      GetContext get_context(user_comparator_, nullptr, nullptr, nullptr,
-                             GetContext::kNotFound, keys[idx], &(*values)[idx],
-                             nullptr, nullptr, nullptr, nullptr);
-      LookupKey lkey(keys[idx], kMaxSequenceNumber);
-      r->Get(options, lkey.internal_key(), &get_context);
-      if (get_context.State() == GetContext::kFound) {
-        statuses[idx] = Status::OK();
-      }
+  // The file of each key that may be in one, and the keys in file order, so
+  // that each table looks up all its keys at once
+  std::vector<size_t> key_files(keys.size());
+  std::vector<size_t> order;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    key_files[i] = FindFile(keys[i]);
+    const FdWithKeyRange& f = files_.files[key_files[i]];
+    if (user_comparator_->Compare(keys[i], ExtractUserKey(f.smallest_key)) >=
+        0) {
+      order.push_back(i);
+    }
+  }
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return key_files[a] < key_files[b];
+  });
+
+  std::vector<std::string> internal_keys(order.size());
+  std::vector<Slice> batch_keys(order.size());
+  std::vector<GetContext> get_contexts;
+  std::vector<GetContext*> batch_contexts(order.size());
+  std::vector<Status> batch_statuses(order.size());
+  get_contexts.reserve(order.size());
+  for (size_t j = 0; j < order.size(); ++j) {
+    size_t idx = order[j];
+    AppendInternalKey(&internal_keys[j],
+                      ParsedInternalKey(keys[idx], kMaxSequenceNumber,
+                                        kValueTypeForSeek));
+    batch_keys[j] = internal_keys[j];
+    get_contexts.emplace_back(user_comparator_, nullptr, nullptr, nullptr,
+                              GetContext::kNotFound, keys[idx],
+                              &(*values)[idx], nullptr, nullptr, nullptr,
+                              nullptr);
+    batch_contexts[j] = &get_contexts[j];
+  }
+  for (size_t begin = 0; begin < order.size();) {
+    size_t end = begin + 1;
+    while (end < order.size() &&
+           key_files[order[end]] == key_files[order[begin]]) {
+      ++end;
+    }
+    files_.files[key_files[order[begin]]].fd.table_reader->MultiGet(
+        options, end - begin, &batch_keys[begin], &batch_contexts[begin],
+        &batch_statuses[begin]);
+    begin = end;
+  }
+  for (size_t j = 0; j < order.size(); ++j) {
+    if (!batch_statuses[j].ok()) {
+      statuses[order[j]] = batch_statuses[j];
+    } else if (get_contexts[j].State() == GetContext::kFound) {
+      statuses[order[j]] = Status::OK();
     }
-    ++idx;
   }
   return statuses;
 }
@@ -48,7 +48,9 @@
 #include "table/merging_iterator.h"
 #include "table/table_builder.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/file_reader_writer.h"
+#include "util/io_tracer.h"
 #include "util/iostats_context_imp.h"
 #include "util/log_buffer.h"
 #include "util/logging.h"
@@ -513,6 +515,7 @@ void CompactionJob::GenSubcompactionBoundaries() {
 Status CompactionJob::Run() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_RUN);
+  IOCallerGuard io_caller_guard(IOCaller::kCompaction);
   TEST_SYNC_POINT("CompactionJob::Run():Start");
   log_buffer_->FlushBufferToLog();
   LogCompaction();
@@ -578,6 +581,7 @@ Status CompactionJob::Run() {
 Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_INSTALL);
+  IOCallerGuard io_caller_guard(IOCaller::kCompaction);
   db_mutex_->AssertHeld();
   Status status = compact_->status;
   ColumnFamilyData* cfd = compact_->compaction->column_family_data();
@@ -661,6 +665,8 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options) {
 
 void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   assert(sub_compact != nullptr);
+  // Subcompactions other than the first run in threads of their own
+  IOCallerGuard io_caller_guard(IOCaller::kCompaction);
   ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
   std::unique_ptr<RangeDelAggregator> range_del_agg(
       new RangeDelAggregator(cfd->internal_comparator(), existing_snapshots_));
@@ -692,13 +698,24 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   // To build compression dictionary, we sample the first output file, assuming
   // it'll reach the maximum length, and then use the dictionary for compressing
   // subsequent output files. The dictionary may be less than max_dict_bytes if
-  // the first output file's length is less than the maximum.
+  // the first output file's length is less than the maximum. With
+  // zstd_max_train_bytes, up to that many bytes are sampled and the
+  // dictionary is trained from them instead.
   const int kSampleLenShift = 6;  // 2^6 = 64-byte samples
+  const CompressionOptions& compression_opts =
+      cfd->ioptions()->compression_opts;
+  const CompressionType output_compression =
+      sub_compact->compaction->output_compression();
+  const bool train_dict = compression_opts.zstd_max_train_bytes > 0 &&
+                          (output_compression == kZSTD ||
+                           output_compression == kZSTDNotFinalCompression) &&
+                          ZSTD_TrainDictionarySupported();
+  const size_t max_sample_bytes = train_dict
+                                      ? compression_opts.zstd_max_train_bytes
+                                      : compression_opts.max_dict_bytes;
   std::set<size_t> sample_begin_offsets;
-  if (bottommost_level_ &&
-      cfd->ioptions()->compression_opts.max_dict_bytes > 0) {
-    const size_t kMaxSamples =
-        cfd->ioptions()->compression_opts.max_dict_bytes >> kSampleLenShift;
+  if (bottommost_level_ && compression_opts.max_dict_bytes > 0) {
+    const size_t kMaxSamples = max_sample_bytes >> kSampleLenShift;
     const size_t kOutFileLen = mutable_cf_options->MaxFileSizeForLevel(
         compact_->compaction->output_level());
     if (kOutFileLen != port::kMaxSizet) {
@@ -757,11 +774,13 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   }
   const auto& c_iter_stats = c_iter->iter_stats();
   auto sample_begin_offset_iter = sample_begin_offsets.cbegin();
-  // data_begin_offset and compression_dict are only valid while generating
+  // data_begin_offset and dict_samples are only valid while generating
   // dictionary from the first output file.
   size_t data_begin_offset = 0;
-  std::string compression_dict;
-  compression_dict.reserve(cfd->ioptions()->compression_opts.max_dict_bytes);
+  std::string dict_samples;
+  if (!sample_begin_offsets.empty()) {
+    dict_samples.reserve(max_sample_bytes);
+  }
 
   while (status.ok() && !cfd->IsDropped() && c_iter->Valid()) {
     // Invariant: c_iter.status() is guaranteed to be OK if c_iter->Valid()
@@ -833,8 +852,8 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
             data_elmt_copy_len =
                 data_end_offset - (data_begin_offset + data_elmt_copy_offset);
           }
-          compression_dict.append(&data_elmt.data()[data_elmt_copy_offset],
-                                  data_elmt_copy_len);
+          dict_samples.append(&data_elmt.data()[data_elmt_copy_offset],
+                              data_elmt_copy_len);
           if (sample_end_offset > data_end_offset) {
             // Didn't finish sample. Try to finish it with the next data_elmt.
             break;
@@ -890,7 +909,12 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
       if (sub_compact->outputs.size() == 1) {
         // Use dictionary from first output file for compression of subsequent
         // files.
-        sub_compact->compression_dict = std::move(compression_dict);
+        if (train_dict) {
+          sub_compact->compression_dict = ZSTD_TrainDictionary(
+              dict_samples, kSampleLenShift, compression_opts.max_dict_bytes);
+        } else {
+          sub_compact->compression_dict = std::move(dict_samples);
+        }
       }
     }
   }
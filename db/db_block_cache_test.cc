@@ -163,6 +163,79 @@ TEST_F(DBBlockCacheTest, TestWithoutCompressedBlockCache) {
   }
 }
 
+TEST_F(DBBlockCacheTest, WarmUpFromHotBlocks) {
+  BlockBasedTableOptions table_options = GetTableOptions();
+  table_options.block_cache = NewLRUCache(1 << 20, 0);
+  Options options = GetOptions(table_options);
+  options.hot_blocks_persist_period_sec = 3600;
+  DestroyAndReopen(options);
+  InitTable(options);
+  ASSERT_OK(Flush());
+  const size_t kNumHot = kNumBlocks / 2;
+  for (size_t i = 0; i < kNumHot; i++) {
+    ASSERT_EQ(std::string(kValueSize, 'a'), Get(ToString(i)));
+  }
+  // Closing the DB writes the hot block list
+  Close();
+  ASSERT_OK(env_->FileExists(HotBlocksFileName(dbname_)));
+
+  // The hot blocks are loaded into a new cache when the DB is reopened
+  table_options.block_cache = NewLRUCache(1 << 20, 0);
+  options = GetOptions(table_options);
+  options.hot_blocks_persist_period_sec = 3600;
+  Reopen(options);
+  dbfull()->TEST_WaitForWarmUp();
+  RecordCacheCounters(options);
+  for (size_t i = 0; i < kNumHot; i++) {
+    Get(ToString(i));
+    CheckCacheCounters(options, 0, 1, 0, 0);
+  }
+  Get(ToString(kNumBlocks - 1));
+  CheckCacheCounters(options, 1, 0, 1, 0);
+
+  // Rewrite the table without updating the list
+  options.hot_blocks_persist_period_sec = 0;
+  Reopen(options);
+  // A second table, so that compacting cannot just move the first one
+  ASSERT_OK(Put(ToString(kNumBlocks), "a"));
+  ASSERT_OK(Flush());
+  CompactRangeOptions cro;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  Close();
+
+  // Blocks of the deleted table are skipped
+  table_options.block_cache = NewLRUCache(1 << 20, 0);
+  options = GetOptions(table_options);
+  options.hot_blocks_persist_period_sec = 3600;
+  Reopen(options);
+  dbfull()->TEST_WaitForWarmUp();
+  RecordCacheCounters(options);
+  Get(ToString(0));
+  CheckCacheCounters(options, 1, 0, 1, 0);
+}
+
+TEST_F(DBBlockCacheTest, PersistHotBlocksPeriodically) {
+  BlockBasedTableOptions table_options = GetTableOptions();
+  table_options.block_cache = NewLRUCache(1 << 20, 0);
+  Options options = GetOptions(table_options);
+  options.hot_blocks_persist_period_sec = 1;
+  DestroyAndReopen(options);
+  dbfull()->TEST_WaitForWarmUp();
+  InitTable(options);
+  ASSERT_OK(Flush());
+  ASSERT_EQ(std::string(kValueSize, 'a'), Get(ToString(0)));
+
+  // The list is written while the DB stays open
+  for (int i = 0; i < 100 && !env_->FileExists(HotBlocksFileName(dbname_)).ok();
+       i++) {
+    env_->SleepForMicroseconds(100000);
+  }
+  ASSERT_OK(env_->FileExists(HotBlocksFileName(dbname_)));
+  ASSERT_TRUE(
+      env_->FileExists(HotBlocksFileName(dbname_) + ".tmp").IsNotFound());
+}
+
 #ifdef SNAPPY
 TEST_F(DBBlockCacheTest, TestWithCompressedBlockCache) {
   ReadOptions read_options;
@@ -335,12 +408,26 @@ class MockCache : public LRUCache {
   virtual Status Insert(const Slice& key, void* value, size_t charge,
                         void (*deleter)(const Slice& key, void* value),
                         Handle** handle, Priority priority) override {
+    CountInsert(priority);
+    return LRUCache::Insert(key, value, charge, deleter, handle, priority);
+  }
+
+  virtual Status InsertWithHelper(const Slice& key, void* value, size_t charge,
+                                  const CacheTierHelper* helper,
+                                  Handle** handle,
+                                  Priority priority) override {
+    CountInsert(priority);
+    return LRUCache::InsertWithHelper(key, value, charge, helper, handle,
+                                      priority);
+  }
+
+ private:
+  static void CountInsert(Priority priority) {
     if (priority == Priority::LOW) {
       low_pri_insert_count++;
     } else {
       high_pri_insert_count++;
     }
-    return LRUCache::Insert(key, value, charge, deleter, handle, priority);
   }
 };
 
@@ -27,6 +27,7 @@
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
@@ -43,6 +44,8 @@
 #include "db/filename.h"
 #include "db/flush_job.h"
 #include "db/forward_iterator.h"
+#include "db/hot_blocks.h"
+#include "db/in_memory_stats_history.h"
 #include "db/job_context.h"
 #include "db/log_reader.h"
 #include "db/log_writer.h"
@@ -68,6 +71,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/merge_operator.h"
+#include "rocksdb/rate_limiter.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
@@ -76,6 +80,7 @@
 #include "rocksdb/write_buffer_manager.h"
 #include "table/block.h"
 #include "table/block_based_table_factory.h"
+#include "table/format.h"
 #include "table/merging_iterator.h"
 #include "table/table_builder.h"
 #include "table/two_level_iterator.h"
@@ -87,6 +92,7 @@
 #include "util/crc32c.h"
 #include "util/file_reader_writer.h"
 #include "util/file_util.h"
+#include "util/io_tracer.h"
 #include "util/iostats_context_imp.h"
 #include "util/log_buffer.h"
 #include "util/logging.h"
@@ -341,9 +347,14 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname)
       bg_flush_scheduled_(0),
       num_running_flushes_(0),
       bg_purge_scheduled_(0),
+      bg_warm_up_scheduled_(0),
+      hot_blocks_loaded_(false),
       disable_delete_obsolete_files_(0),
       delete_obsolete_files_last_run_(env_->NowMicros()),
       last_stats_dump_time_microsec_(0),
+      stats_history_size_(0),
+      tracer_(nullptr),
+      tracer_users_(0),
       next_job_id_(1),
       has_unpersisted_data_(false),
       unable_to_flush_oldest_log_(false),
@@ -414,6 +425,15 @@ void DBImpl::CancelAllBackgroundWork(bool wait) {
 }
 
 DBImpl::~DBImpl() {
+  // Stop taking statistics snapshots, which read DB properties
+  if (thread_persist_stats_ != nullptr) {
+    thread_persist_stats_->cancel();
+  }
+  if (thread_persist_hot_blocks_ != nullptr) {
+    thread_persist_hot_blocks_->cancel();
+  }
+  // End a trace left running, writing the queries it still holds
+  EndTrace();
   // CancelAllBackgroundWork called with false means we just set the shutdown
   // marker. After this we do a variant of the waiting and unschedule work
   // (to consider: moving all the waiting into CancelAllBackgroundWork(true))
@@ -426,13 +446,26 @@ DBImpl::~DBImpl() {
 
   // Wait for background work to finish
   while (bg_compaction_scheduled_ || bg_flush_scheduled_ ||
-         bg_purge_scheduled_) {
+         bg_purge_scheduled_ || bg_warm_up_scheduled_) {
     TEST_SYNC_POINT("DBImpl::~DBImpl:WaitJob");
     bg_cv_.Wait();
   }
   EraseThreadStatusDbInfo();
   flush_scheduler_.Clear();
 
+  // Remember what is hot in the block cache for the next time the DB is
+  // opened
+  if (opened_successfully_ && hot_blocks_loaded_ &&
+      immutable_db_options_.hot_blocks_persist_period_sec > 0) {
+    mutex_.Unlock();
+    Status s = PersistHotBlocks();
+    if (!s.ok()) {
+      Log(InfoLogLevel::WARN_LEVEL, immutable_db_options_.info_log,
+          "Failed to write the hot block list: %s", s.ToString().c_str());
+    }
+    mutex_.Lock();
+  }
+
   while (!flush_queue_.empty()) {
     auto cfd = PopFirstFromFlushQueue();
     if (cfd->Unref()) {
@@ -667,6 +700,332 @@ void DBImpl::MaybeDumpStats() {
   }
 }
 
+namespace {
+#ifndef ROCKSDB_LITE
+// The DB properties recorded in each statistics snapshot, and whether they
+// are summed over the column families or are DB-wide
+const struct {
+  const std::string& name;
+  bool aggregated;
+} kStatsHistoryProperties[] = {
+    {DB::Properties::kCurSizeAllMemTables, true},
+    {DB::Properties::kNumImmutableMemTable, true},
+    {DB::Properties::kEstimateNumKeys, true},
+    {DB::Properties::kEstimateLiveDataSize, true},
+    {DB::Properties::kTotalSstFilesSize, true},
+    {DB::Properties::kEstimatePendingCompactionBytes, true},
+    {DB::Properties::kNumRunningFlushes, false},
+    {DB::Properties::kNumRunningCompactions, false},
+    {DB::Properties::kNumSnapshots, false},
+};
+#endif  // !ROCKSDB_LITE
+
+size_t EstimateStatsSnapshotSize(
+    const std::map<std::string, uint64_t>& stats_map) {
+  size_t size = sizeof(uint64_t);
+  for (const auto& stat : stats_map) {
+    size += stat.first.size() + sizeof(stat.second);
+  }
+  return size;
+}
+}  // namespace
+
+void DBImpl::PersistStats() {
+  TEST_SYNC_POINT("DBImpl::PersistStats:Entry");
+  const uint64_t now_seconds = env_->NowMicros() / 1000000;
+  std::map<std::string, uint64_t> stats_map;
+#ifndef ROCKSDB_LITE
+  // Read the properties before taking stats_history_mutex_, as they take
+  // mutex_
+  for (const auto& property : kStatsHistoryProperties) {
+    uint64_t value;
+    bool found = property.aggregated
+                     ? GetAggregatedIntProperty(property.name, &value)
+                     : GetIntProperty(DefaultColumnFamily(), property.name,
+                                      &value);
+    if (found) {
+      stats_map[property.name] = value;
+    }
+  }
+#endif  // !ROCKSDB_LITE
+
+  InstrumentedMutexLock l(&stats_history_mutex_);
+  UpdateStatsSliceLocked(&stats_map);
+  auto existing = stats_history_.find(now_seconds);
+  if (existing != stats_history_.end()) {
+    // Two snapshots in the same second; keep the later one
+    stats_history_size_ -= EstimateStatsSnapshotSize(existing->second);
+  }
+  stats_history_size_ += EstimateStatsSnapshotSize(stats_map);
+  stats_history_[now_seconds] = std::move(stats_map);
+  const size_t buffer_size = immutable_db_options_.stats_history_buffer_size;
+  while (stats_history_size_ > buffer_size && !stats_history_.empty()) {
+    stats_history_size_ -=
+        EstimateStatsSnapshotSize(stats_history_.begin()->second);
+    stats_history_.erase(stats_history_.begin());
+  }
+}
+
+void DBImpl::UpdateStatsSliceLocked(
+    std::map<std::string, uint64_t>* stats_delta) {
+  stats_history_mutex_.AssertHeld();
+  Statistics* statistics = immutable_db_options_.statistics.get();
+  if (statistics == nullptr) {
+    return;
+  }
+  for (const auto& ticker : TickersNameMap) {
+    const uint64_t value = statistics->getTickerCount(ticker.first);
+    uint64_t& last_value = stats_slice_[ticker.second];
+    if (stats_delta != nullptr) {
+      // A ticker that went down was reset; count from zero
+      (*stats_delta)[ticker.second] =
+          value >= last_value ? value - last_value : value;
+    }
+    last_value = value;
+  }
+}
+
+Status DBImpl::GetStatsHistory(
+    uint64_t start_time, uint64_t end_time,
+    std::unique_ptr<StatsHistoryIterator>* stats_iterator) {
+  if (stats_iterator == nullptr) {
+    return Status::InvalidArgument("stats_iterator not preallocated.");
+  }
+  stats_iterator->reset(
+      new InMemoryStatsHistoryIterator(start_time, end_time, this));
+  return (*stats_iterator)->status();
+}
+
+bool DBImpl::FindStatsByTime(uint64_t start_time, uint64_t end_time,
+                             uint64_t* new_time,
+                             std::map<std::string, uint64_t>* stats_map) {
+  assert(new_time != nullptr && stats_map != nullptr);
+  InstrumentedMutexLock l(&stats_history_mutex_);
+  auto it = stats_history_.lower_bound(start_time);
+  if (it == stats_history_.end() || it->first >= end_time) {
+    return false;
+  }
+  *new_time = it->first;
+  *stats_map = it->second;
+  return true;
+}
+
+void DBImpl::MaybePersistHotBlocks() {
+  {
+    InstrumentedMutexLock l(&mutex_);
+    // Do not overwrite the list before its blocks have been loaded
+    if (!hot_blocks_loaded_) {
+      return;
+    }
+  }
+  Status s = PersistHotBlocks();
+  if (!s.ok()) {
+    Log(InfoLogLevel::WARN_LEVEL, immutable_db_options_.info_log,
+        "Failed to write the hot block list: %s", s.ToString().c_str());
+  }
+}
+
+Status DBImpl::PersistHotBlocks() {
+  // Hold the current versions so that their tables stay open while the
+  // hot blocks are looked up
+  autovector<Version*> versions;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (cfd->IsDropped()) {
+        continue;
+      }
+      cfd->Ref();
+      cfd->current()->Ref();
+      versions.push_back(cfd->current());
+    }
+  }
+
+  // Keys found in each block cache, which is usually shared by all the
+  // column families
+  std::unordered_map<Cache*, std::map<std::string, Cache::Priority>> hot_keys;
+  std::vector<HotFileBlocks> files;
+  for (auto version : versions) {
+    ColumnFamilyData* cfd = version->cfd();
+    const auto* vstorage = version->storage_info();
+    for (int level = 0; level < vstorage->num_levels(); level++) {
+      for (auto f : vstorage->LevelFiles(level)) {
+        TableReader* table_reader = f->fd.table_reader;
+        Cache::Handle* handle = nullptr;
+        if (table_reader == nullptr) {
+          // Tables that are not open have no blocks cached, or few
+          if (!cfd->table_cache()
+                   ->FindTable(env_options_, cfd->internal_comparator(),
+                               f->fd, &handle, true /* no_io */)
+                   .ok()) {
+            continue;
+          }
+          table_reader = cfd->table_cache()->GetTableReaderFromHandle(handle);
+        }
+        Cache* block_cache = table_reader->GetBlockCache();
+        if (block_cache != nullptr) {
+          auto iter = hot_keys.find(block_cache);
+          if (iter == hot_keys.end()) {
+            std::vector<std::pair<std::string, Cache::Priority>> keys;
+            block_cache->GetHotKeys(
+                immutable_db_options_.max_persisted_hot_blocks, &keys);
+            iter = hot_keys
+                       .emplace(block_cache,
+                                std::map<std::string, Cache::Priority>(
+                                    keys.begin(), keys.end()))
+                       .first;
+          }
+          HotFileBlocks file;
+          file.column_family_id = cfd->GetID();
+          file.file_number = f->fd.GetNumber();
+          table_reader->GetHotBlocks(iter->second, &file.blocks);
+          if (!file.blocks.empty()) {
+            files.push_back(std::move(file));
+          }
+        }
+        if (handle != nullptr) {
+          cfd->table_cache()->ReleaseHandle(handle);
+        }
+      }
+    }
+  }
+
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto version : versions) {
+      ColumnFamilyData* cfd = version->cfd();
+      version->Unref();
+      if (cfd->Unref()) {
+        delete cfd;
+      }
+    }
+  }
+
+  size_t num_blocks = 0;
+  for (const auto& file : files) {
+    num_blocks += file.blocks.size();
+  }
+  Status s = WriteHotBlocksFile(env_, dbname_, files);
+  if (s.ok()) {
+    Log(InfoLogLevel::INFO_LEVEL, immutable_db_options_.info_log,
+        "Wrote %" ROCKSDB_PRIszt " hot blocks of %" ROCKSDB_PRIszt
+        " files to the hot block list",
+        num_blocks, files.size());
+  }
+  return s;
+}
+
+Status DBImpl::WarmUpBlockCache() {
+  std::vector<HotFileBlocks> files;
+  Status s = ReadHotBlocksFile(env_, dbname_, &files);
+  if (s.IsNotFound()) {
+    return Status::OK();
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  std::unique_ptr<RateLimiter> rate_limiter;
+  if (immutable_db_options_.hot_blocks_warm_up_bytes_per_sec > 0) {
+    rate_limiter.reset(NewGenericRateLimiter(static_cast<int64_t>(
+        immutable_db_options_.hot_blocks_warm_up_bytes_per_sec)));
+  }
+  // Blocks read at once; shutdown is checked between batches
+  const size_t kBatchSize = 32;
+  size_t num_loaded = 0;
+  size_t num_skipped_files = 0;
+  for (const auto& file : files) {
+    if (shutting_down_.load(std::memory_order_acquire)) {
+      return Status::Incomplete("Shutdown in progress");
+    }
+    ColumnFamilyData* cfd = nullptr;
+    Version* version = nullptr;
+    FileDescriptor fd;
+    {
+      InstrumentedMutexLock l(&mutex_);
+      auto c = versions_->GetColumnFamilySet()->GetColumnFamily(
+          file.column_family_id);
+      if (c != nullptr && !c->IsDropped()) {
+        const auto* vstorage = c->current()->storage_info();
+        for (int level = 0; level < vstorage->num_levels() && !version;
+             level++) {
+          for (auto f : vstorage->LevelFiles(level)) {
+            if (f->fd.GetNumber() == file.file_number) {
+              cfd = c;
+              version = c->current();
+              fd = f->fd;
+              break;
+            }
+          }
+        }
+      }
+      if (version != nullptr) {
+        cfd->Ref();
+        version->Ref();
+      }
+    }
+    if (version == nullptr) {
+      // Deleted by a compaction since the list was written
+      num_skipped_files++;
+      continue;
+    }
+
+    Cache::Handle* handle = nullptr;
+    s = cfd->table_cache()->FindTable(env_options_, cfd->internal_comparator(),
+                                      fd, &handle);
+    if (s.ok()) {
+      TableReader* table_reader =
+          cfd->table_cache()->GetTableReaderFromHandle(handle);
+      for (size_t i = 0; s.ok() && i < file.blocks.size(); i += kBatchSize) {
+        if (shutting_down_.load(std::memory_order_acquire)) {
+          s = Status::Incomplete("Shutdown in progress");
+          break;
+        }
+        std::vector<HotBlock> batch(
+            file.blocks.begin() + i,
+            file.blocks.begin() + std::min(i + kBatchSize, file.blocks.size()));
+        if (rate_limiter != nullptr) {
+          int64_t bytes = 0;
+          for (const auto& block : batch) {
+            bytes += static_cast<int64_t>(block.size + kBlockTrailerSize);
+          }
+          while (bytes > 0) {
+            int64_t request =
+                std::min(bytes, rate_limiter->GetSingleBurstBytes());
+            rate_limiter->Request(request, Env::IO_LOW);
+            bytes -= request;
+          }
+        }
+        s = table_reader->WarmUp(batch);
+        if (s.ok()) {
+          num_loaded += batch.size();
+        }
+      }
+      cfd->table_cache()->ReleaseHandle(handle);
+    }
+    {
+      InstrumentedMutexLock l(&mutex_);
+      version->Unref();
+      if (cfd->Unref()) {
+        delete cfd;
+      }
+    }
+    if (s.IsIncomplete()) {
+      return s;
+    }
+    if (!s.ok()) {
+      Log(InfoLogLevel::WARN_LEVEL, immutable_db_options_.info_log,
+          "Failed to load hot blocks of file %" PRIu64 ": %s",
+          file.file_number, s.ToString().c_str());
+    }
+  }
+  Log(InfoLogLevel::INFO_LEVEL, immutable_db_options_.info_log,
+      "Loaded %" ROCKSDB_PRIszt " hot blocks into the block cache, skipped %"
+      ROCKSDB_PRIszt " deleted files",
+      num_loaded, num_skipped_files);
+  return Status::OK();
+}
+
 uint64_t DBImpl::FindMinPrepLogReferencedByMemTable() {
   if (!allow_2pc()) {
     return 0;
@@ -1099,6 +1458,7 @@ void DBImpl::PurgeObsoleteFiles(const JobContext& state, bool schedule_only) {
       case kIdentityFile:
       case kMetaDatabase:
       case kOptionsFile:
+      case kHotBlocksFile:
         keep = true;
         break;
     }
@@ -1773,6 +2133,7 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& log_numbers,
 Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
                                            MemTable* mem, VersionEdit* edit) {
   mutex_.AssertHeld();
+  IOCallerGuard io_caller_guard(IOCaller::kFlush);
   const uint64_t start_micros = env_->NowMicros();
   FileMetaData meta;
   auto pending_outputs_inserted_elem =
@@ -3154,6 +3515,12 @@ void DBImpl::BGWorkPurge(void* db) {
   TEST_SYNC_POINT("DBImpl::BGWorkPurge:end");
 }
 
+void DBImpl::BGWorkWarmUp(void* db) {
+  IOSTATS_SET_THREAD_POOL_ID(Env::Priority::LOW);
+  TEST_SYNC_POINT("DBImpl::BGWorkWarmUp:start");
+  reinterpret_cast<DBImpl*>(db)->BackgroundCallWarmUp();
+}
+
 void DBImpl::UnscheduleCallback(void* arg) {
   CompactionArg ca = *(reinterpret_cast<CompactionArg*>(arg));
   delete reinterpret_cast<CompactionArg*>(arg);
@@ -3163,6 +3530,23 @@ void DBImpl::UnscheduleCallback(void* arg) {
   TEST_SYNC_POINT("DBImpl::UnscheduleCallback");
 }
 
+void DBImpl::BackgroundCallWarmUp() {
+  Status s = WarmUpBlockCache();
+  if (!s.ok() && !s.IsIncomplete()) {
+    Log(InfoLogLevel::WARN_LEVEL, immutable_db_options_.info_log,
+        "Failed to load the hot block list: %s", s.ToString().c_str());
+  }
+
+  mutex_.Lock();
+  // A damaged list is replaced the next time it is written
+  hot_blocks_loaded_ = !s.IsIncomplete();
+  bg_warm_up_scheduled_--;
+  bg_cv_.SignalAll();
+  // IMPORTANT: there should be no code after calling SignalAll. This call may
+  // signal the DB destructor that it's OK to proceed with destruction.
+  mutex_.Unlock();
+}
+
 void DBImpl::BackgroundCallPurge() {
   mutex_.Lock();
 
@@ -3995,11 +4379,16 @@ Status DBImpl::GetImpl(const ReadOptions& read_options,
                        ColumnFamilyHandle* column_family, const Slice& key,
                        std::string* value, bool* value_found) {
   StopWatch sw(env_, stats_, DB_GET);
+  IOCallerGuard io_caller_guard(IOCaller::kUserGet);
   PERF_TIMER_GUARD(get_snapshot_time);
 
   auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
   auto cfd = cfh->cfd();
 
+  if (Tracer* tracer = PinTracer()) {
+    UnpinTracer(tracer->Get(cfd->GetID(), key));
+  }
+
   // Acquire SuperVersion
   SuperVersion* sv = GetAndRefSuperVersion(cfd);
 
@@ -4080,6 +4469,7 @@ std::vector<Status> DBImpl::MultiGet(
     const std::vector<Slice>& keys, std::vector<std::string>* values) {
 
   StopWatch sw(env_, stats_, DB_MULTIGET);
+  IOCallerGuard io_caller_guard(IOCaller::kUserGet);
   PERF_TIMER_GUARD(get_snapshot_time);
 
   SequenceNumber snapshot;
@@ -4391,8 +4781,19 @@ Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
     return NewErrorIterator(Status::NotSupported(
         "ReadTier::kPersistedData is not yet supported in iterators."));
   }
+  IOCallerGuard io_caller_guard(IOCaller::kUserIterator);
   auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
   auto cfd = cfh->cfd();
+  if (read_options.keys_only && cfd->ioptions()->merge_operator != nullptr) {
+    return NewErrorIterator(Status::NotSupported(
+        "ReadOptions::keys_only is not supported with a merge operator."));
+  }
+  if (read_options.projected_value_columns != nullptr &&
+      cfd->ioptions()->merge_operator != nullptr) {
+    return NewErrorIterator(Status::NotSupported(
+        "ReadOptions::projected_value_columns is not supported with a merge "
+        "operator."));
+  }
 
   XFUNC_TEST("", "managed_new", managed_new1, xf_manage_new,
              reinterpret_cast<DBImpl*>(this),
@@ -4423,7 +4824,8 @@ Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
         kMaxSequenceNumber,
         sv->mutable_cf_options.max_sequential_skip_in_iterations,
         sv->version_number, read_options.iterate_upper_bound,
-        read_options.prefix_same_as_start, read_options.pin_data);
+        read_options.prefix_same_as_start, read_options.pin_data,
+        false /* total_order_seek */, this, cfd);
 #endif
   } else {
     SequenceNumber latest_snapshot = versions_->LastSequence();
@@ -4482,7 +4884,7 @@ Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
         sv->mutable_cf_options.max_sequential_skip_in_iterations,
         sv->version_number, read_options.iterate_upper_bound,
         read_options.prefix_same_as_start, read_options.pin_data,
-        read_options.total_order_seek);
+        read_options.total_order_seek, this, cfd);
 
     InternalIterator* internal_iter =
         NewInternalIterator(read_options, cfd, sv, db_iter->GetArena(),
@@ -4503,6 +4905,26 @@ Status DBImpl::NewIterators(
     return Status::NotSupported(
         "ReadTier::kPersistedData is not yet supported in iterators.");
   }
+  if (read_options.keys_only) {
+    for (auto cfh : column_families) {
+      auto cfd = reinterpret_cast<ColumnFamilyHandleImpl*>(cfh)->cfd();
+      if (cfd->ioptions()->merge_operator != nullptr) {
+        return Status::NotSupported(
+            "ReadOptions::keys_only is not supported with a merge operator.");
+      }
+    }
+  }
+  if (read_options.projected_value_columns != nullptr) {
+    for (auto cfh : column_families) {
+      auto cfd = reinterpret_cast<ColumnFamilyHandleImpl*>(cfh)->cfd();
+      if (cfd->ioptions()->merge_operator != nullptr) {
+        return Status::NotSupported(
+            "ReadOptions::projected_value_columns is not supported with a "
+            "merge operator.");
+      }
+    }
+  }
+  IOCallerGuard io_caller_guard(IOCaller::kUserIterator);
   iterators->clear();
   iterators->reserve(column_families.size());
   XFUNC_TEST("", "managed_new", managed_new1, xf_manage_new,
@@ -4537,7 +4959,8 @@ Status DBImpl::NewIterators(
           env_, *cfd->ioptions(), cfd->user_comparator(), iter,
           kMaxSequenceNumber,
           sv->mutable_cf_options.max_sequential_skip_in_iterations,
-          sv->version_number, nullptr, false, read_options.pin_data));
+          sv->version_number, nullptr, false, read_options.pin_data,
+          false /* total_order_seek */, this, cfd));
     }
 #endif
   } else {
@@ -4557,7 +4980,8 @@ Status DBImpl::NewIterators(
       ArenaWrappedDBIter* db_iter = NewArenaWrappedDbIterator(
           env_, *cfd->ioptions(), cfd->user_comparator(), snapshot,
           sv->mutable_cf_options.max_sequential_skip_in_iterations,
-          sv->version_number, nullptr, false, read_options.pin_data);
+          sv->version_number, nullptr, false, read_options.pin_data,
+          false /* total_order_seek */, this, cfd);
       InternalIterator* internal_iter =
           NewInternalIterator(read_options, cfd, sv, db_iter->GetArena(),
                               db_iter->GetRangeDelAggregator());
@@ -4650,6 +5074,10 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   if (write_options.timeout_hint_us != 0) {
     return Status::InvalidArgument("timeout_hint_us is deprecated");
   }
+  IOCallerGuard io_caller_guard(IOCaller::kUserWrite);
+  if (Tracer* tracer = PinTracer()) {
+    UnpinTracer(tracer->Write(my_batch));
+  }
 
   Status status;
 
@@ -5897,6 +6325,73 @@ Status DBImpl::GetDbIdentity(std::string& identity) const {
   return s;
 }
 
+Status DBImpl::StartTrace(const TraceOptions& trace_options,
+                          std::unique_ptr<TraceWriter>&& trace_writer) {
+  InstrumentedMutexLock lock(&trace_mutex_);
+  if (tracer_.load() != nullptr) {
+    return Status::Busy("Query trace already running");
+  }
+  std::unique_ptr<Tracer> tracer(
+      new Tracer(env_, trace_options, std::move(trace_writer)));
+  Status s = tracer->WriteHeader();
+  if (!s.ok()) {
+    return s;
+  }
+  tracer_.store(tracer.release());
+  return s;
+}
+
+Status DBImpl::EndTrace() {
+  InstrumentedMutexLock lock(&trace_mutex_);
+  std::unique_ptr<Tracer> tracer(tracer_.exchange(nullptr));
+  if (tracer == nullptr) {
+    return Status::OK();
+  }
+  // Queries that found the tracer before it was cleared may still be
+  // tracing to it
+  while (tracer_users_.load() != 0) {
+    std::this_thread::yield();
+  }
+  return tracer->Close();
+}
+
+Tracer* DBImpl::PinTracer() {
+  // Untraced queries only pay for this load
+  if (tracer_.load(std::memory_order_relaxed) == nullptr) {
+    return nullptr;
+  }
+  // Announce the use before looking at the tracer again, so that EndTrace()
+  // either waits for it or is seen to have cleared the tracer
+  tracer_users_.fetch_add(1);
+  Tracer* tracer = tracer_.load();
+  if (tracer == nullptr) {
+    tracer_users_.fetch_sub(1);
+  }
+  return tracer;
+}
+
+void DBImpl::UnpinTracer(const Status& trace_status) {
+  tracer_users_.fetch_sub(1);
+  // A trace that cannot be written any more is of no use; the tracer drops
+  // the queries that follow rather than fail them.
+  if (!trace_status.ok()) {
+    Log(InfoLogLevel::WARN_LEVEL, immutable_db_options_.info_log,
+        "Query trace ended: %s", trace_status.ToString().c_str());
+  }
+}
+
+void DBImpl::TraceIteratorSeek(uint32_t cf_id, const Slice& key) {
+  if (Tracer* tracer = PinTracer()) {
+    UnpinTracer(tracer->IteratorSeek(cf_id, key));
+  }
+}
+
+void DBImpl::TraceIteratorSeekForPrev(uint32_t cf_id, const Slice& key) {
+  if (Tracer* tracer = PinTracer()) {
+    UnpinTracer(tracer->IteratorSeekForPrev(cf_id, key));
+  }
+}
+
 // Default implementations of convenience methods that subclasses of DB
 // can call if they wish
 Status DB::Put(const WriteOptions& opt, ColumnFamilyHandle* column_family,
@@ -6118,6 +6613,26 @@ Status DB::Open(const DBOptions& db_options, const std::string& dbname,
     *dbptr = impl;
     impl->opened_successfully_ = true;
     impl->MaybeScheduleFlushOrCompaction();
+    if (impl->immutable_db_options_.hot_blocks_persist_period_sec > 0) {
+      // Load the blocks that were hot before the DB was closed
+      impl->bg_warm_up_scheduled_++;
+      impl->env_->Schedule(&DBImpl::BGWorkWarmUp, impl, Env::Priority::LOW,
+                           nullptr);
+      impl->thread_persist_hot_blocks_.reset(new RepeatableThread(
+          [impl]() { impl->MaybePersistHotBlocks(); }, impl->env_,
+          impl->immutable_db_options_.hot_blocks_persist_period_sec *
+              1000000ULL));
+    }
+    if (impl->immutable_db_options_.stats_persist_period_sec > 0) {
+      {
+        // Tickers of the first snapshot count from now
+        InstrumentedMutexLock l(&impl->stats_history_mutex_);
+        impl->UpdateStatsSliceLocked(nullptr);
+      }
+      impl->thread_persist_stats_.reset(new RepeatableThread(
+          [impl]() { impl->PersistStats(); }, impl->env_,
+          impl->immutable_db_options_.stats_persist_period_sec * 1000000ULL));
+    }
   }
   impl->mutex_.Unlock();
 
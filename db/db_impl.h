@@ -46,8 +46,10 @@
 #include "util/event_logger.h"
 #include "util/hash.h"
 #include "util/instrumented_mutex.h"
+#include "util/repeatable_thread.h"
 #include "util/stop_watch.h"
 #include "util/thread_local.h"
+#include "util/trace_replay.h"
 
 namespace rocksdb {
 
@@ -292,6 +294,30 @@ class DBImpl : public DB {
 
   virtual Status GetDbIdentity(std::string& identity) const override;
 
+  using DB::StartTrace;
+  virtual Status StartTrace(
+      const TraceOptions& options,
+      std::unique_ptr<TraceWriter>&& trace_writer) override;
+
+  using DB::EndTrace;
+  virtual Status EndTrace() override;
+
+  using DB::GetStatsHistory;
+  virtual Status GetStatsHistory(
+      uint64_t start_time, uint64_t end_time,
+      std::unique_ptr<StatsHistoryIterator>* stats_iterator) override;
+
+  // Copies to *stats_map the first statistics snapshot taken in
+  // [start_time, end_time), and its time to *new_time. Returns false if there
+  // is none.
+  bool FindStatsByTime(uint64_t start_time, uint64_t end_time,
+                       uint64_t* new_time,
+                       std::map<std::string, uint64_t>* stats_map);
+
+  // Called by the DB iterators to trace their seeks
+  void TraceIteratorSeek(uint32_t cf_id, const Slice& key);
+  void TraceIteratorSeekForPrev(uint32_t cf_id, const Slice& key);
+
   Status RunManualCompaction(ColumnFamilyData* cfd, int input_level,
                              int output_level, uint32_t output_path_id,
                              const Slice* begin, const Slice* end,
@@ -386,6 +412,17 @@ class DBImpl : public DB {
 
   int TEST_BGCompactionsAllowed() const;
 
+  // Write the HOT_BLOCKS file now
+  Status TEST_PersistHotBlocks() { return PersistHotBlocks(); }
+
+  // Wait for the blocks listed in the HOT_BLOCKS file to be loaded
+  void TEST_WaitForWarmUp();
+
+  // Take a statistics snapshot now
+  void TEST_PersistStats() { PersistStats(); }
+
+  size_t TEST_EstimateInMemoryStatsHistorySize() const;
+
 #endif  // NDEBUG
 
   // Return maximum background compaction allowed to be scheduled based on
@@ -701,10 +738,12 @@ class DBImpl : public DB {
   static void BGWorkCompaction(void* arg);
   static void BGWorkFlush(void* db);
   static void BGWorkPurge(void* arg);
+  static void BGWorkWarmUp(void* db);
   static void UnscheduleCallback(void* arg);
   void BackgroundCallCompaction(void* arg);
   void BackgroundCallFlush();
   void BackgroundCallPurge();
+  void BackgroundCallWarmUp();
   Status BackgroundCompaction(bool* madeProgress, JobContext* job_context,
                               LogBuffer* log_buffer, void* m = 0);
   Status BackgroundFlush(bool* madeProgress, JobContext* job_context,
@@ -715,6 +754,26 @@ class DBImpl : public DB {
   // dump rocksdb.stats to LOG
   void MaybeDumpStats();
 
+  // Append a snapshot of the tickers and of a few DB properties to
+  // stats_history_, dropping the oldest snapshots that no longer fit in
+  // stats_history_buffer_size
+  void PersistStats();
+
+  // Add to *stats_delta how much each ticker grew since the last call, which
+  // also becomes the base of the next one. stats_delta can be nullptr to
+  // only record the base. REQUIRES: stats_history_mutex_ held
+  void UpdateStatsSliceLocked(std::map<std::string, uint64_t>* stats_delta);
+
+  // Write the data blocks of this DB that are hot in the block cache to the
+  // HOT_BLOCKS file, unless the blocks listed there have not been loaded yet.
+  // Called every hot_blocks_persist_period_sec.
+  void MaybePersistHotBlocks();
+  Status PersistHotBlocks();
+
+  // Load the blocks listed in the HOT_BLOCKS file into the block cache.
+  // Returns Incomplete if interrupted by shutdown.
+  Status WarmUpBlockCache();
+
   // Return the minimum empty level that could hold the total data in the
   // input level. Return the input level, if such level could not be found.
   int FindMinimumEmptyLevelFitting(ColumnFamilyData* cfd,
@@ -947,6 +1006,15 @@ class DBImpl : public DB {
   // number of background obsolete file purge jobs, submitted to the HIGH pool
   int bg_purge_scheduled_;
 
+  // number of background jobs loading the blocks listed in the HOT_BLOCKS
+  // file, submitted to the LOW pool
+  int bg_warm_up_scheduled_;
+
+  // Set once the blocks listed in the HOT_BLOCKS file have been loaded. The
+  // file is not rewritten before then, so that it is not replaced with the
+  // hot set of a cache that is still cold.
+  bool hot_blocks_loaded_;
+
   // Information for a manual compaction
   struct ManualCompaction {
     ColumnFamilyData* cfd;
@@ -991,6 +1059,29 @@ class DBImpl : public DB {
   // last time stats were dumped to LOG
   std::atomic<uint64_t> last_stats_dump_time_microsec_;
 
+  // Calls PersistStats() every stats_persist_period_sec, if not zero
+  std::unique_ptr<RepeatableThread> thread_persist_stats_;
+  // Calls MaybePersistHotBlocks() every hot_blocks_persist_period_sec, if not
+  // zero
+  std::unique_ptr<RepeatableThread> thread_persist_hot_blocks_;
+  // Protects stats_history_, stats_history_size_ and stats_slice_
+  mutable InstrumentedMutex stats_history_mutex_;
+  // Statistics snapshots, keyed by the time they were taken in seconds since
+  // the epoch
+  std::map<uint64_t, std::map<std::string, uint64_t>> stats_history_;
+  // Approximate memory used by stats_history_
+  size_t stats_history_size_;
+  // Ticker values at the last snapshot, from which the next one is computed
+  std::map<std::string, uint64_t> stats_slice_;
+
+  // Serializes StartTrace() and EndTrace()
+  InstrumentedMutex trace_mutex_;
+  // The running query trace, if any. Queries use it without taking
+  // trace_mutex_, counting themselves in tracer_users_ so that EndTrace()
+  // can wait for them before deleting it.
+  std::atomic<Tracer*> tracer_;
+  std::atomic<uint32_t> tracer_users_;
+
   // Each flush or compaction gets its own job id. this counter makes sure
   // they're unique
   std::atomic<int> next_job_id_;
@@ -1106,6 +1197,11 @@ class DBImpl : public DB {
                  const Slice& key, std::string* value,
                  bool* value_found = nullptr);
 
+  // Returns the running query tracer, or nullptr. A tracer returned must be
+  // given back to UnpinTracer(), along with the status of the tracing.
+  Tracer* PinTracer();
+  void UnpinTracer(const Status& trace_status);
+
   bool GetIntPropertyInternal(ColumnFamilyData* cfd,
                               const DBPropertyInfo& property_info,
                               bool is_locked, uint64_t* value);
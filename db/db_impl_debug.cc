@@ -188,5 +188,17 @@ int DBImpl::TEST_BGCompactionsAllowed() const {
   return BGCompactionsAllowed();
 }
 
+void DBImpl::TEST_WaitForWarmUp() {
+  InstrumentedMutexLock l(&mutex_);
+  while (bg_warm_up_scheduled_) {
+    bg_cv_.Wait();
+  }
+}
+
+size_t DBImpl::TEST_EstimateInMemoryStatsHistorySize() const {
+  InstrumentedMutexLock l(&stats_history_mutex_);
+  return stats_history_size_;
+}
+
 }  // namespace rocksdb
 #endif  // NDEBUG
@@ -13,6 +13,8 @@
 #include <string>
 #include <limits>
 
+#include "db/column_family.h"
+#include "db/db_impl.h"
 #include "db/dbformat.h"
 #include "db/filename.h"
 #include "db/merge_context.h"
@@ -25,6 +27,7 @@
 #include "rocksdb/options.h"
 #include "table/internal_iterator.h"
 #include "util/arena.h"
+#include "util/io_tracer.h"
 #include "util/logging.h"
 #include "util/mutexlock.h"
 #include "util/perf_context_imp.h"
@@ -106,7 +109,8 @@ class DBIter: public Iterator {
          uint64_t max_sequential_skip_in_iterations, uint64_t version_number,
          const Slice* iterate_upper_bound = nullptr,
          bool prefix_same_as_start = false, bool pin_data = false,
-         bool total_order_seek = false)
+         bool total_order_seek = false, DBImpl* db_impl = nullptr,
+         ColumnFamilyData* cfd = nullptr)
       : arena_mode_(arena_mode),
         env_(env),
         logger_(ioptions.info_log),
@@ -124,7 +128,9 @@ class DBIter: public Iterator {
         pin_thru_lifetime_(pin_data),
         total_order_seek_(total_order_seek),
         range_del_agg_(ioptions.internal_comparator, s,
-                       true /* collapse_deletions */) {
+                       true /* collapse_deletions */),
+        db_impl_(db_impl),
+        cfd_(cfd) {
     RecordTick(statistics_, NO_ITERATORS);
     prefix_extractor_ = ioptions.prefix_extractor;
     max_skip_ = max_sequential_skip_in_iterations;
@@ -282,6 +288,9 @@ class DBIter: public Iterator {
   RangeDelAggregator range_del_agg_;
   LocalStatistics local_stats_;
   PinnedIteratorsManager pinned_iters_mgr_;
+  // Set if the seeks are to be traced
+  DBImpl* db_impl_;
+  ColumnFamilyData* cfd_;
 
   // No copying allowed
   DBIter(const DBIter&);
@@ -302,6 +311,7 @@ inline bool DBIter::ParseKey(ParsedInternalKey* ikey) {
 
 void DBIter::Next() {
   assert(valid_);
+  IOCallerGuard io_caller_guard(IOCaller::kUserIterator);
 
   // Release temporarily pinned blocks from last operation
   ReleaseTempPinnedData();
@@ -580,6 +590,7 @@ void DBIter::MergeValuesNewToOld() {
 
 void DBIter::Prev() {
   assert(valid_);
+  IOCallerGuard io_caller_guard(IOCaller::kUserIterator);
   ReleaseTempPinnedData();
   if (direction_ == kForward) {
     ReverseToBackward();
@@ -944,6 +955,10 @@ void DBIter::FindParseableKey(ParsedInternalKey* ikey, Direction direction) {
 
 void DBIter::Seek(const Slice& target) {
   StopWatch sw(env_, statistics_, DB_SEEK);
+  IOCallerGuard io_caller_guard(IOCaller::kUserIterator);
+  if (db_impl_ != nullptr && cfd_ != nullptr) {
+    db_impl_->TraceIteratorSeek(cfd_->GetID(), target);
+  }
   ReleaseTempPinnedData();
   saved_key_.Clear();
   // now saved_key is used to store internal key.
@@ -983,6 +998,10 @@ void DBIter::Seek(const Slice& target) {
 
 void DBIter::SeekForPrev(const Slice& target) {
   StopWatch sw(env_, statistics_, DB_SEEK);
+  IOCallerGuard io_caller_guard(IOCaller::kUserIterator);
+  if (db_impl_ != nullptr && cfd_ != nullptr) {
+    db_impl_->TraceIteratorSeekForPrev(cfd_->GetID(), target);
+  }
   ReleaseTempPinnedData();
   saved_key_.Clear();
   // now saved_key is used to store internal key.
@@ -1022,6 +1041,7 @@ void DBIter::SeekForPrev(const Slice& target) {
 }
 
 void DBIter::SeekToFirst() {
+  IOCallerGuard io_caller_guard(IOCaller::kUserIterator);
   // Don't use iter_::Seek() if we set a prefix extractor
   // because prefix seek will be used.
   if (prefix_extractor_ != nullptr) {
@@ -1056,6 +1076,7 @@ void DBIter::SeekToFirst() {
 }
 
 void DBIter::SeekToLast() {
+  IOCallerGuard io_caller_guard(IOCaller::kUserIterator);
   // Don't use iter_::Seek() if we set a prefix extractor
   // because prefix seek will be used.
   if (prefix_extractor_ != nullptr) {
@@ -1102,11 +1123,12 @@ Iterator* NewDBIterator(
     const Comparator* user_key_comparator, InternalIterator* internal_iter,
     const SequenceNumber& sequence, uint64_t max_sequential_skip_in_iterations,
     uint64_t version_number, const Slice* iterate_upper_bound,
-    bool prefix_same_as_start, bool pin_data, bool total_order_seek) {
+    bool prefix_same_as_start, bool pin_data, bool total_order_seek,
+    DBImpl* db_impl, ColumnFamilyData* cfd) {
   DBIter* db_iter = new DBIter(
       env, ioptions, user_key_comparator, internal_iter, sequence, false,
       max_sequential_skip_in_iterations, version_number, iterate_upper_bound,
-      prefix_same_as_start, pin_data, total_order_seek);
+      prefix_same_as_start, pin_data, total_order_seek, db_impl, cfd);
   return db_iter;
 }
 
@@ -1150,14 +1172,14 @@ ArenaWrappedDBIter* NewArenaWrappedDbIterator(
     const Comparator* user_key_comparator, const SequenceNumber& sequence,
     uint64_t max_sequential_skip_in_iterations, uint64_t version_number,
     const Slice* iterate_upper_bound, bool prefix_same_as_start, bool pin_data,
-    bool total_order_seek) {
+    bool total_order_seek, DBImpl* db_impl, ColumnFamilyData* cfd) {
   ArenaWrappedDBIter* iter = new ArenaWrappedDBIter();
   Arena* arena = iter->GetArena();
   auto mem = arena->AllocateAligned(sizeof(DBIter));
   DBIter* db_iter = new (mem) DBIter(
       env, ioptions, user_key_comparator, nullptr, sequence, true,
       max_sequential_skip_in_iterations, version_number, iterate_upper_bound,
-      prefix_same_as_start, pin_data, total_order_seek);
+      prefix_same_as_start, pin_data, total_order_seek, db_impl, cfd);
 
   iter->SetDBIter(db_iter);
 
@@ -21,19 +21,24 @@
 namespace rocksdb {
 
 class Arena;
+class ColumnFamilyData;
+class DBImpl;
 class DBIter;
 class InternalIterator;
 
 // Return a new iterator that converts internal keys (yielded by
 // "*internal_iter") that were live at the specified "sequence" number
 // into appropriate user keys.
+// If db_impl and cfd are given, the seeks are reported to db_impl's query
+// trace.
 extern Iterator* NewDBIterator(
     Env* env, const ImmutableCFOptions& options,
     const Comparator* user_key_comparator, InternalIterator* internal_iter,
     const SequenceNumber& sequence, uint64_t max_sequential_skip_in_iterations,
     uint64_t version_number, const Slice* iterate_upper_bound = nullptr,
     bool prefix_same_as_start = false, bool pin_data = false,
-    bool total_order_seek = false);
+    bool total_order_seek = false, DBImpl* db_impl = nullptr,
+    ColumnFamilyData* cfd = nullptr);
 
 // A wrapper iterator which wraps DB Iterator and the arena, with which the DB
 // iterator is supposed be allocated. This class is used as an entry point of
@@ -82,6 +87,7 @@ extern ArenaWrappedDBIter* NewArenaWrappedDbIterator(
     uint64_t max_sequential_skip_in_iterations, uint64_t version_number,
     const Slice* iterate_upper_bound = nullptr,
     bool prefix_same_as_start = false, bool pin_data = false,
-    bool total_order_seek = false);
+    bool total_order_seek = false, DBImpl* db_impl = nullptr,
+    ColumnFamilyData* cfd = nullptr);
 
 }  // namespace rocksdb
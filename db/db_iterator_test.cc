@@ -1780,6 +1780,69 @@ TEST_F(DBIteratorTest, ReadAhead) {
   delete iter;
 }
 
+#ifdef OS_LINUX
+TEST_F(DBIteratorTest, AutoReadahead) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.disable_auto_compactions = true;
+  options.statistics = rocksdb::CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.max_auto_readahead_size = 64 * 1024;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  std::string value(1024, 'a');
+  for (int i = 0; i < 200; i++) {
+    Put(Key(i), value);
+  }
+  ASSERT_OK(Flush());
+
+  // Point lookups never read ahead
+  for (int i = 0; i < 200; i += 20) {
+    ASSERT_EQ(value, Get(Key(i)));
+  }
+  ASSERT_EQ(0U, TestGetTickerCount(options, AUTO_READAHEAD_BYTES));
+
+  // A full scan reads ahead once it has seen a few adjacent blocks
+  auto* iter = db_->NewIterator(ReadOptions());
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(value, iter->value());
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  delete iter;
+  ASSERT_EQ(200, count);
+  uint64_t readahead_bytes = TestGetTickerCount(options, AUTO_READAHEAD_BYTES);
+  ASSERT_GT(readahead_bytes, 0U);
+  ASSERT_GT(TestGetTickerCount(options, AUTO_READAHEAD_USEFUL_BYTES), 0U);
+  ASSERT_LE(TestGetTickerCount(options, AUTO_READAHEAD_USEFUL_BYTES) +
+                TestGetTickerCount(options, AUTO_READAHEAD_WASTED_BYTES),
+            readahead_bytes);
+
+  // Nor does a scan over blocks that are all in the block cache
+  iter = db_->NewIterator(ReadOptions());
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+  }
+  ASSERT_OK(iter->status());
+  delete iter;
+  ASSERT_EQ(readahead_bytes, TestGetTickerCount(options, AUTO_READAHEAD_BYTES));
+
+  // Disabled with max_auto_readahead_size = 0
+  table_options.max_auto_readahead_size = 0;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  options.statistics = rocksdb::CreateDBStatistics();
+  Reopen(options);
+  iter = db_->NewIterator(ReadOptions());
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+  }
+  ASSERT_OK(iter->status());
+  delete iter;
+  ASSERT_EQ(0U, TestGetTickerCount(options, AUTO_READAHEAD_BYTES));
+}
+#endif  // OS_LINUX
+
 // Insert a key, create a snapshot iterator, overwrite key lots of times,
 // seek to a smaller key. Expect DBIter to fall back to a seek instead of
 // going through all the overwrites linearly.
@@ -1836,6 +1899,76 @@ TEST_F(DBIteratorTest, DBIteratorSkipRecentDuplicatesTest) {
                  NUMBER_OF_RESEEKS_IN_ITERATION));
 }
 
+TEST_F(DBIteratorTest, SeparatedValuesKeysOnly) {
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.separate_data_block_values = true;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  std::map<std::string, std::string> true_data;
+  Random rnd(301);
+  for (int i = 0; i < 2000; i++) {
+    std::string k = Key(i * 3);
+    std::string v = RandomString(&rnd, i % 10 == 0 ? 0 : 300);
+    ASSERT_OK(Put(k, v));
+    true_data[k] = v;
+    if (i % 700 == 0) {
+      ASSERT_OK(Flush());
+    }
+  }
+  for (int i = 0; i < 2000; i += 11) {
+    ASSERT_OK(Delete(Key(i * 3)));
+    true_data.erase(Key(i * 3));
+  }
+  ASSERT_OK(Flush());
+
+  for (const auto& kv : true_data) {
+    ASSERT_EQ(kv.second, Get(kv.first));
+  }
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  auto it = true_data.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+    ASSERT_TRUE(it != true_data.end());
+    ASSERT_EQ(it->first, iter->key().ToString());
+    ASSERT_EQ(it->second, iter->value().ToString());
+  }
+  ASSERT_TRUE(it == true_data.end());
+  auto rit = true_data.rbegin();
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++rit) {
+    ASSERT_TRUE(rit != true_data.rend());
+    ASSERT_EQ(rit->first, iter->key().ToString());
+    ASSERT_EQ(rit->second, iter->value().ToString());
+  }
+  ASSERT_TRUE(rit == true_data.rend());
+
+  ReadOptions keys_only;
+  keys_only.keys_only = true;
+  iter.reset(db_->NewIterator(keys_only));
+  size_t count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(true_data.size(), count);
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    count--;
+  }
+  ASSERT_EQ(0U, count);
+  iter->Seek(Key(301));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(true_data.lower_bound(Key(301))->first, iter->key().ToString());
+  iter.reset();
+
+  // Merge operands cannot be resolved without their values
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  Reopen(options);
+  iter.reset(db_->NewIterator(keys_only));
+  ASSERT_TRUE(iter->status().IsNotSupported());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
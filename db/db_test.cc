@@ -3303,6 +3303,13 @@ TEST_F(DBTest, ChecksumTest) {
   ASSERT_OK(Put("g", "h"));
   ASSERT_OK(Flush());  // table with xxhash checksum
 
+  table_options.checksum = kxxHash64;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  ASSERT_OK(Put("i", "j"));
+  ASSERT_OK(Put("k", "l"));
+  ASSERT_OK(Flush());  // table with xxhash64 checksum
+
   table_options.checksum = kCRC32c;
   options.table_factory.reset(NewBlockBasedTableFactory(table_options));
   Reopen(options);
@@ -3310,6 +3317,8 @@ TEST_F(DBTest, ChecksumTest) {
   ASSERT_EQ("d", Get("c"));
   ASSERT_EQ("f", Get("e"));
   ASSERT_EQ("h", Get("g"));
+  ASSERT_EQ("j", Get("i"));
+  ASSERT_EQ("l", Get("k"));
 
   table_options.checksum = kCRC32c;
   options.table_factory.reset(NewBlockBasedTableFactory(table_options));
@@ -3318,6 +3327,8 @@ TEST_F(DBTest, ChecksumTest) {
   ASSERT_EQ("d", Get("c"));
   ASSERT_EQ("f", Get("e"));
   ASSERT_EQ("h", Get("g"));
+  ASSERT_EQ("j", Get("i"));
+  ASSERT_EQ("l", Get("k"));
 }
 
 #ifndef ROCKSDB_LITE
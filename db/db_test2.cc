@@ -15,6 +15,7 @@
 #include "port/stack_trace.h"
 #include "rocksdb/persistent_cache.h"
 #include "rocksdb/wal_filter.h"
+#include "util/trace_replay.h"
 
 namespace rocksdb {
 
@@ -1042,6 +1043,83 @@ TEST_F(DBTest2, PresetCompressionDict) {
   }
 }
 
+TEST_F(DBTest2, ZSTDTrainedCompressionDict) {
+  if (!ZSTD_Supported() || !ZSTD_TrainDictionarySupported()) {
+    fprintf(stderr, "skipping zstd dictionary training test\n");
+    return;
+  }
+  const int kNumKeys = 4000;
+  const char* kWords[] = {"alpha", "bravo",  "charlie", "delta",
+                          "echo",  "foxtrot", "golf",   "hotel"};
+  Random rnd(301);
+  // Small JSON-like values that share their field names and vocabulary
+  std::vector<std::string> values;
+  for (int i = 0; i < kNumKeys; i++) {
+    values.push_back("{\"id\":" + ToString(rnd.Next()) + ",\"name\":\"" +
+                     kWords[rnd.Uniform(8)] + "\",\"tags\":[\"" +
+                     kWords[rnd.Uniform(8)] + "\",\"" + kWords[rnd.Uniform(8)] +
+                     "\"],\"active\":" + (rnd.OneIn(2) ? "true" : "false") +
+                     "}");
+  }
+
+  Options options = CurrentOptions();
+  options.compression = kZSTD;
+  options.write_buffer_size = 4 << 20;
+  options.target_file_size_base = 32 << 10;
+  options.num_levels = 2;
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1 << 10;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  // SST bytes without a dictionary, with the raw samples as the dictionary
+  // and with a dictionary trained from them
+  uint64_t flushed_bytes[3];
+  uint64_t compacted_bytes[3];
+  for (int mode = 0; mode < 3; mode++) {
+    options.compression_opts.max_dict_bytes = mode > 0 ? 4 << 10 : 0;
+    options.compression_opts.zstd_max_train_bytes = mode == 2 ? 16 << 10 : 0;
+    DestroyAndReopen(options);
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(Key(i), values[i]));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_EQ(1, NumTableFilesAtLevel(0));
+
+    std::vector<std::string> files;
+    GetSstFiles(dbname_, &files);
+    ASSERT_EQ(1, files.size());
+    ASSERT_OK(
+        env_->GetFileSize(dbname_ + "/" + files[0], &flushed_bytes[mode]));
+
+    // The flushed file is moved to L1 as is. Compacting it again there, the
+    // bottommost compaction samples its first output file and compresses
+    // the following ones with the dictionary.
+    ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    ASSERT_EQ(0, NumTableFilesAtLevel(0));
+    CompactRangeOptions cro;
+    cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+    ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+    ASSERT_GT(NumTableFilesAtLevel(1), 2);
+    files.clear();
+    GetSstFiles(dbname_, &files);
+    compacted_bytes[mode] = 0;
+    for (const auto& file : files) {
+      uint64_t file_bytes;
+      ASSERT_OK(env_->GetFileSize(dbname_ + "/" + file, &file_bytes));
+      compacted_bytes[mode] += file_bytes;
+    }
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(values[i], Get(Key(i)));
+    }
+  }
+
+  // Flushes only use a trained dictionary, never the raw samples
+  ASSERT_LT(flushed_bytes[2], flushed_bytes[1]);
+  ASSERT_LT(compacted_bytes[1], compacted_bytes[0]);
+  ASSERT_LE(compacted_bytes[2], compacted_bytes[1]);
+}
+
 class CompactionCompressionListener : public EventListener {
  public:
   explicit CompactionCompressionListener(Options* db_options)
@@ -1581,6 +1659,45 @@ TEST_F(DBTest2, PersistentCache) {
   }
 }
 
+TEST_F(DBTest2, PersistentCacheChecksums) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  auto cache = std::make_shared<MockPersistentCache>(true /* is_compressed */,
+                                                     1024 * 1024);
+  BlockBasedTableOptions table_options;
+  table_options.persistent_cache = cache;
+  table_options.no_block_cache = true;
+  table_options.verify_persistent_cache_checksums = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 100; i++) {
+    values.push_back(RandomString(&rnd, 1000));
+    ASSERT_OK(Put(Key(i), values[i]));
+  }
+  ASSERT_OK(Flush());
+  // Fills the cache
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+
+  // Pages that fail verification are read again from the file
+  {
+    MutexLock l(&cache->lock_);
+    ASSERT_GT(cache->data_.size(), 0);
+    for (auto& page : cache->data_) {
+      page.second[0] ^= 0x55;
+    }
+  }
+  const uint64_t hits = TestGetTickerCount(options, PERSISTENT_CACHE_HIT);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+  ASSERT_GT(TestGetTickerCount(options, PERSISTENT_CACHE_HIT), hits);
+}
+
 namespace {
 void CountSyncPoint() {
   TEST_SYNC_POINT_CALLBACK("DBTest2::MarkedPoint", nullptr /* arg */);
@@ -2277,6 +2394,295 @@ TEST_F(DBTest2, GetRaceFlush2) {
   t1.join();
   rocksdb::SyncPoint::GetInstance()->DisableProcessing();
 }
+
+TEST_F(DBTest2, TraceAndReplay) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreatePutOperator();
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  const std::string trace_filename = dbname_ + "/rocksdb.trace";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(NewFileTraceWriter(env_, EnvOptions(), trace_filename,
+                               &trace_writer));
+  ASSERT_OK(db_->StartTrace(TraceOptions(), std::move(trace_writer)));
+  ASSERT_TRUE(db_->StartTrace(TraceOptions(), std::unique_ptr<TraceWriter>())
+                  .IsBusy());
+
+  ASSERT_OK(Put(0, "a", "1"));
+  ASSERT_OK(Merge(0, "b", "2"));
+  ASSERT_OK(Delete(0, "c"));
+  ASSERT_OK(Put(1, "d", "3"));
+  WriteBatch batch;
+  batch.Put(handles_[1], "e", "4");
+  batch.Delete(handles_[1], "d");
+  ASSERT_OK(db_->Write(WriteOptions(), &batch));
+  ASSERT_EQ("1", Get(0, "a"));
+  ASSERT_EQ("NOT_FOUND", Get(1, "d"));
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions(), handles_[1]));
+  iter->Seek("e");
+  ASSERT_TRUE(iter->Valid());
+  iter->SeekForPrev("z");
+  ASSERT_TRUE(iter->Valid());
+  iter.reset();
+  ASSERT_OK(db_->EndTrace());
+  // Not traced
+  ASSERT_OK(Put(0, "f", "5"));
+
+  // Replay the trace against an empty DB with the same column families
+  const std::string replay_dbname = test::TmpDir(env_) + "/db_replay";
+  ASSERT_OK(DestroyDB(replay_dbname, options));
+  DB* replay_db = nullptr;
+  std::vector<ColumnFamilyHandle*> replay_handles;
+  {
+    options.create_if_missing = true;
+    DB* tmp_db;
+    ASSERT_OK(DB::Open(options, replay_dbname, &tmp_db));
+    ColumnFamilyHandle* cfh;
+    ASSERT_OK(tmp_db->CreateColumnFamily(options, "pikachu", &cfh));
+    delete cfh;
+    delete tmp_db;
+    std::vector<ColumnFamilyDescriptor> column_families;
+    column_families.emplace_back(kDefaultColumnFamilyName, options);
+    column_families.emplace_back("pikachu", options);
+    ASSERT_OK(DB::Open(DBOptions(options), replay_dbname, column_families,
+                       &replay_handles, &replay_db));
+  }
+
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(NewFileTraceReader(env_, EnvOptions(), trace_filename,
+                               &trace_reader));
+  Replayer replayer(replay_db, replay_handles, std::move(trace_reader));
+  ASSERT_TRUE(replayer.SetFastForward(0.0).IsInvalidArgument());
+  ASSERT_OK(replayer.SetFastForward(100.0));
+  ASSERT_OK(replayer.Replay());
+  // Five writes, two gets and two seeks
+  ASSERT_EQ(9U, replayer.num_queries());
+
+  std::string value;
+  ASSERT_OK(replay_db->Get(ReadOptions(), replay_handles[0], "a", &value));
+  ASSERT_EQ("1", value);
+  ASSERT_OK(replay_db->Get(ReadOptions(), replay_handles[0], "b", &value));
+  ASSERT_EQ("2", value);
+  ASSERT_TRUE(
+      replay_db->Get(ReadOptions(), replay_handles[1], "d", &value)
+          .IsNotFound());
+  ASSERT_OK(replay_db->Get(ReadOptions(), replay_handles[1], "e", &value));
+  ASSERT_EQ("4", value);
+  ASSERT_TRUE(
+      replay_db->Get(ReadOptions(), replay_handles[0], "f", &value)
+          .IsNotFound());
+
+  for (auto handle : replay_handles) {
+    delete handle;
+  }
+  delete replay_db;
+
+  // The first failed query is reported
+  std::vector<ColumnFamilyDescriptor> column_families;
+  column_families.emplace_back(kDefaultColumnFamilyName, options);
+  column_families.emplace_back("pikachu", options);
+  ASSERT_OK(DB::OpenForReadOnly(DBOptions(options), replay_dbname,
+                                column_families, &replay_handles,
+                                &replay_db));
+  ASSERT_OK(NewFileTraceReader(env_, EnvOptions(), trace_filename,
+                               &trace_reader));
+  Replayer read_only_replayer(replay_db, replay_handles,
+                              std::move(trace_reader));
+  ASSERT_OK(read_only_replayer.SetFastForward(100.0));
+  ASSERT_TRUE(read_only_replayer.Replay().IsNotSupported());
+  ASSERT_EQ(9U, read_only_replayer.num_queries());
+  for (auto handle : replay_handles) {
+    delete handle;
+  }
+  delete replay_db;
+  ASSERT_OK(DestroyDB(replay_dbname, options));
+}
+
+TEST_F(DBTest2, TraceFromManyThreads) {
+  const std::string trace_filename = dbname_ + "/rocksdb.trace";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(NewFileTraceWriter(env_, EnvOptions(), trace_filename,
+                               &trace_writer));
+  ASSERT_OK(db_->StartTrace(TraceOptions(), std::move(trace_writer)));
+  const int kNumThreads = 4;
+  const int kNumWrites = 1000;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumWrites; i++) {
+        ASSERT_OK(Put(Key(t * kNumWrites + i), "v"));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_OK(db_->EndTrace());
+
+  // Every write is in the trace
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(NewFileTraceReader(env_, EnvOptions(), trace_filename,
+                               &trace_reader));
+  std::string encoded_trace;
+  int num_writes = 0;
+  bool ended = false;
+  Trace trace;
+  while (trace_reader->Read(&encoded_trace).ok()) {
+    ASSERT_OK(DecodeTrace(encoded_trace, &trace));
+    if (trace.type == kTraceWrite) {
+      num_writes++;
+    } else if (trace.type == kTraceEnd) {
+      ended = true;
+    }
+  }
+  ASSERT_EQ(kNumThreads * kNumWrites, num_writes);
+  ASSERT_TRUE(ended);
+}
+
+TEST_F(DBTest2, TraceSampling) {
+  const std::string trace_filename = dbname_ + "/rocksdb.trace";
+  std::unique_ptr<TraceWriter> trace_writer;
+  ASSERT_OK(NewFileTraceWriter(env_, EnvOptions(), trace_filename,
+                               &trace_writer));
+  TraceOptions trace_options;
+  trace_options.sampling_frequency = 10;
+  ASSERT_OK(db_->StartTrace(trace_options, std::move(trace_writer)));
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "v"));
+  }
+  ASSERT_OK(db_->EndTrace());
+
+  std::unique_ptr<TraceReader> trace_reader;
+  ASSERT_OK(NewFileTraceReader(env_, EnvOptions(), trace_filename,
+                               &trace_reader));
+  std::string encoded_trace;
+  int num_writes = 0;
+  Trace trace;
+  while (trace_reader->Read(&encoded_trace).ok()) {
+    ASSERT_OK(DecodeTrace(encoded_trace, &trace));
+    if (trace.type == kTraceWrite) {
+      num_writes++;
+    }
+  }
+  ASSERT_EQ(10, num_writes);
+}
+
+namespace {
+std::vector<std::pair<uint64_t, std::map<std::string, uint64_t>>>
+ReadStatsHistory(DB* db, uint64_t start_time, uint64_t end_time) {
+  std::vector<std::pair<uint64_t, std::map<std::string, uint64_t>>> history;
+  std::unique_ptr<StatsHistoryIterator> stats_iter;
+  EXPECT_OK(db->GetStatsHistory(start_time, end_time, &stats_iter));
+  for (; stats_iter->Valid(); stats_iter->Next()) {
+    history.emplace_back(stats_iter->GetStatsTime(), stats_iter->GetStatsMap());
+  }
+  EXPECT_OK(stats_iter->status());
+  return history;
+}
+}  // namespace
+
+TEST_F(DBTest2, StatsHistoryRecordsDeltas) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = CreateDBStatistics();
+  // Snapshots are taken by the test
+  options.stats_persist_period_sec = 3600;
+  options.env = env_;
+  // Counted before the DB is opened, so left out of the first snapshot
+  options.statistics->recordTick(NUMBER_KEYS_WRITTEN, 100);
+  Reopen(options);
+  ASSERT_EQ(0U, ReadStatsHistory(db_, 0, port::kMaxUint64).size());
+
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "value"));
+  }
+  dbfull()->TEST_PersistStats();
+  env_->addon_time_.fetch_add(10 * 1000000);
+  for (int i = 10; i < 15; i++) {
+    ASSERT_OK(Put(Key(i), "value"));
+  }
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ("value", Get(Key(i)));
+  }
+  dbfull()->TEST_PersistStats();
+
+  auto history = ReadStatsHistory(db_, 0, port::kMaxUint64);
+  ASSERT_EQ(2U, history.size());
+  ASSERT_LE(history[0].first + 10, history[1].first);
+  ASSERT_EQ(10U, history[0].second["rocksdb.number.keys.written"]);
+  ASSERT_EQ(0U, history[0].second["rocksdb.number.keys.read"]);
+  ASSERT_EQ(5U, history[1].second["rocksdb.number.keys.written"]);
+  ASSERT_EQ(3U, history[1].second["rocksdb.number.keys.read"]);
+#ifndef ROCKSDB_LITE
+  // Properties are recorded as they are
+  ASSERT_EQ(10U, history[0].second[DB::Properties::kEstimateNumKeys]);
+  ASSERT_EQ(15U, history[1].second[DB::Properties::kEstimateNumKeys]);
+  ASSERT_EQ(1U, history[1].second.count(DB::Properties::kNumRunningFlushes));
+#endif  // !ROCKSDB_LITE
+
+  // The time range selects snapshots
+  auto second_only = ReadStatsHistory(db_, history[0].first + 1,
+                                      port::kMaxUint64);
+  ASSERT_EQ(1U, second_only.size());
+  ASSERT_EQ(history[1].first, second_only[0].first);
+  ASSERT_EQ(0U, ReadStatsHistory(db_, 0, history[0].first).size());
+  ASSERT_EQ(1U, ReadStatsHistory(db_, 0, history[0].first + 1).size());
+}
+
+TEST_F(DBTest2, StatsHistoryFitsInBuffer) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = CreateDBStatistics();
+  options.stats_persist_period_sec = 3600;
+  options.env = env_;
+  Reopen(options);
+  dbfull()->TEST_PersistStats();
+  const size_t snapshot_size =
+      dbfull()->TEST_EstimateInMemoryStatsHistorySize();
+  ASSERT_GT(snapshot_size, 0U);
+
+  // Room for three snapshots and a half
+  options.stats_history_buffer_size = snapshot_size * 7 / 2;
+  Reopen(options);
+  uint64_t last_time = 0;
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "value"));
+    env_->addon_time_.fetch_add(1000000);
+    dbfull()->TEST_PersistStats();
+    last_time = env_->NowMicros() / 1000000;
+  }
+  ASSERT_LE(dbfull()->TEST_EstimateInMemoryStatsHistorySize(),
+            options.stats_history_buffer_size);
+  auto history = ReadStatsHistory(db_, 0, port::kMaxUint64);
+  ASSERT_EQ(3U, history.size());
+  ASSERT_EQ(last_time, history.back().first);
+  for (const auto& snapshot : history) {
+    ASSERT_EQ(1U, snapshot.second.at("rocksdb.number.keys.written"));
+  }
+}
+
+TEST_F(DBTest2, StatsHistoryTakenPeriodically) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = CreateDBStatistics();
+  options.stats_persist_period_sec = 1;
+  Reopen(options);
+  ASSERT_OK(Put("foo", "bar"));
+  // Up to 10 seconds for the first snapshot
+  size_t num_snapshots = 0;
+  for (int i = 0; i < 100 && num_snapshots == 0; i++) {
+    env_->SleepForMicroseconds(100000);
+    num_snapshots = ReadStatsHistory(db_, 0, port::kMaxUint64).size();
+  }
+  ASSERT_GT(num_snapshots, 0U);
+
+  // Without stats_persist_period_sec, no snapshot is taken
+  options.stats_persist_period_sec = 0;
+  Reopen(options);
+  env_->SleepForMicroseconds(1500000);
+  ASSERT_EQ(0U, ReadStatsHistory(db_, 0, port::kMaxUint64).size());
+  ASSERT_TRUE(db_->GetStatsHistory(0, 1, nullptr).IsInvalidArgument());
+}
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
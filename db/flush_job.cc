@@ -42,8 +42,10 @@
 #include "table/table_builder.h"
 #include "table/two_level_iterator.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/event_logger.h"
 #include "util/file_util.h"
+#include "util/io_tracer.h"
 #include "util/iostats_context_imp.h"
 #include "util/log_buffer.h"
 #include "util/logging.h"
@@ -157,6 +159,7 @@ Status FlushJob::Run(FileMetaData* file_meta) {
   assert(pick_memtable_called);
   AutoThreadOperationStageUpdater stage_run(
       ThreadStatus::STAGE_FLUSH_RUN);
+  IOCallerGuard io_caller_guard(IOCaller::kFlush);
   if (mems_.empty()) {
     LogToBuffer(log_buffer_, "[%s] Nothing in memtable to flush",
                 cfd_->GetName().c_str());
@@ -236,6 +239,31 @@ void FlushJob::Cancel() {
   base_->Unref();
 }
 
+std::string FlushJob::TrainCompressionDict(InternalIterator* iter,
+                                           uint64_t data_size) {
+  const CompressionOptions& compression_opts =
+      cfd_->ioptions()->compression_opts;
+  // Take every stride-th entry so that the samples spread over the whole
+  // flush rather than cover its first keys
+  const uint64_t stride = data_size / compression_opts.zstd_max_train_bytes + 1;
+  std::string samples;
+  std::vector<size_t> sample_lens;
+  uint64_t entry = 0;
+  for (iter->SeekToFirst();
+       iter->Valid() && samples.size() < compression_opts.zstd_max_train_bytes;
+       iter->Next(), entry++) {
+    if (entry % stride != 0) {
+      continue;
+    }
+    const Slice user_key = ExtractUserKey(iter->key());
+    samples.append(user_key.data(), user_key.size());
+    samples.append(iter->value().data(), iter->value().size());
+    sample_lens.push_back(user_key.size() + iter->value().size());
+  }
+  return ZSTD_TrainDictionary(samples, sample_lens,
+                              compression_opts.max_dict_bytes);
+}
+
 Status FlushJob::WriteLevel0Table() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_FLUSH_WRITE_L0);
@@ -256,6 +284,7 @@ Status FlushJob::WriteLevel0Table() {
     ro.total_order_seek = true;
     Arena arena;
     uint64_t total_num_entries = 0, total_num_deletes = 0;
+    uint64_t total_data_size = 0;
     size_t total_memory_usage = 0;
     for (MemTable* m : mems_) {
       Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
@@ -268,6 +297,7 @@ Status FlushJob::WriteLevel0Table() {
       }
       total_num_entries += m->num_entries();
       total_num_deletes += m->num_deletes();
+      total_data_size += m->data_size();
       total_memory_usage += m->ApproximateMemoryUsage();
     }
 
@@ -292,6 +322,16 @@ Status FlushJob::WriteLevel0Table() {
 
       TEST_SYNC_POINT_CALLBACK("FlushJob::WriteLevel0Table:output_compression",
                                &output_compression_);
+      const CompressionOptions& compression_opts =
+          cfd_->ioptions()->compression_opts;
+      std::string compression_dict;
+      if (compression_opts.max_dict_bytes > 0 &&
+          compression_opts.zstd_max_train_bytes > 0 &&
+          (output_compression_ == kZSTD ||
+           output_compression_ == kZSTDNotFinalCompression) &&
+          ZSTD_TrainDictionarySupported()) {
+        compression_dict = TrainCompressionDict(iter.get(), total_data_size);
+      }
       s = BuildTable(
           dbname_, db_options_.env, *cfd_->ioptions(), mutable_cf_options_,
           env_options_, cfd_->table_cache(), iter.get(),
@@ -302,7 +342,7 @@ Status FlushJob::WriteLevel0Table() {
           cfd_->ioptions()->compression_opts,
           mutable_cf_options_.paranoid_file_checks, cfd_->internal_stats(),
           TableFileCreationReason::kFlush, event_logger_, job_context_->job_id,
-          Env::IO_HIGH, &table_properties_, 0 /* level */);
+          Env::IO_HIGH, &table_properties_, 0 /* level */, &compression_dict);
       LogFlush(db_options_.info_log);
     }
     Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
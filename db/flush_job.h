@@ -79,6 +79,10 @@ class FlushJob {
   void ReportFlushInputSize(const autovector<MemTable*>& mems);
   void RecordFlushIOStats();
   Status WriteLevel0Table();
+  // Trains a ZSTD dictionary for the flush output from a sample of the
+  // entries of iter, which hold about data_size bytes
+  std::string TrainCompressionDict(InternalIterator* iter,
+                                   uint64_t data_size);
   const std::string& dbname_;
   ColumnFamilyData* cfd_;
   const ImmutableDBOptions& db_options_;
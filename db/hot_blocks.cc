@@ -0,0 +1,120 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "db/hot_blocks.h"
+
+#include <assert.h>
+#include "db/filename.h"
+#include "rocksdb/env.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+
+namespace rocksdb {
+
+// HOT_BLOCKS file format:
+//   magic number: fixed32
+//   number of files: varint32
+//   for each file:
+//     column family id: varint32
+//     file number: varint64
+//     number of blocks: varint32
+//     for each block:
+//       offset minus the offset of the previous block of the file: varint64
+//       size: varint64
+//       priority, 1 for high: char
+//   masked crc32c of everything above: fixed32
+namespace {
+const uint32_t kHotBlocksFileMagic = 0x486f7442;  // "HotB"
+}  // namespace
+
+Status WriteHotBlocksFile(Env* env, const std::string& dbname,
+                          const std::vector<HotFileBlocks>& files) {
+  std::string data;
+  PutFixed32(&data, kHotBlocksFileMagic);
+  PutVarint32(&data, static_cast<uint32_t>(files.size()));
+  for (const auto& file : files) {
+    PutVarint32(&data, file.column_family_id);
+    PutVarint64(&data, file.file_number);
+    PutVarint32(&data, static_cast<uint32_t>(file.blocks.size()));
+    uint64_t prev_offset = 0;
+    for (const auto& block : file.blocks) {
+      assert(block.offset >= prev_offset);
+      PutVarint64(&data, block.offset - prev_offset);
+      PutVarint64(&data, block.size);
+      data.push_back(block.priority == Cache::Priority::HIGH ? 1 : 0);
+      prev_offset = block.offset;
+    }
+  }
+  PutFixed32(&data, crc32c::Mask(crc32c::Value(data.data(), data.size())));
+
+  // Not a name ParseFileName() knows, so that PurgeObsoleteFiles() leaves
+  // the file alone while it is being written
+  std::string tmp = HotBlocksFileName(dbname) + ".tmp";
+  Status s = WriteStringToFile(env, data, tmp, true /* should_sync */);
+  if (s.ok()) {
+    s = env->RenameFile(tmp, HotBlocksFileName(dbname));
+  }
+  if (!s.ok()) {
+    env->DeleteFile(tmp);
+  }
+  return s;
+}
+
+Status ReadHotBlocksFile(Env* env, const std::string& dbname,
+                         std::vector<HotFileBlocks>* files) {
+  const std::string fname = HotBlocksFileName(dbname);
+  std::string data;
+  Status s = ReadFileToString(env, fname, &data);
+  if (!s.ok()) {
+    return s;
+  }
+  if (data.size() < 2 * sizeof(uint32_t) ||
+      DecodeFixed32(data.data()) != kHotBlocksFileMagic) {
+    return Status::Corruption(fname, "bad magic number");
+  }
+  const size_t body_size = data.size() - sizeof(uint32_t);
+  if (crc32c::Unmask(DecodeFixed32(data.data() + body_size)) !=
+      crc32c::Value(data.data(), body_size)) {
+    return Status::Corruption(fname, "checksum mismatch");
+  }
+
+  Slice input(data.data() + sizeof(uint32_t), body_size - sizeof(uint32_t));
+  uint32_t num_files;
+  if (!GetVarint32(&input, &num_files)) {
+    return Status::Corruption(fname, "bad file count");
+  }
+  files->clear();
+  for (uint32_t i = 0; i < num_files; i++) {
+    HotFileBlocks file;
+    uint32_t num_blocks;
+    if (!GetVarint32(&input, &file.column_family_id) ||
+        !GetVarint64(&input, &file.file_number) ||
+        !GetVarint32(&input, &num_blocks)) {
+      return Status::Corruption(fname, "bad file entry");
+    }
+    uint64_t offset = 0;
+    for (uint32_t j = 0; j < num_blocks; j++) {
+      uint64_t delta;
+      HotBlock block;
+      if (!GetVarint64(&input, &delta) || !GetVarint64(&input, &block.size) ||
+          input.empty()) {
+        return Status::Corruption(fname, "bad block entry");
+      }
+      offset += delta;
+      block.offset = offset;
+      block.priority =
+          input[0] == 1 ? Cache::Priority::HIGH : Cache::Priority::LOW;
+      input.remove_prefix(1);
+      file.blocks.push_back(block);
+    }
+    files->push_back(std::move(file));
+  }
+  if (!input.empty()) {
+    return Status::Corruption(fname, "trailing data");
+  }
+  return Status::OK();
+}
+
+}  // namespace rocksdb
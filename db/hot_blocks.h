@@ -0,0 +1,41 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// The HOT_BLOCKS file of a DB lists the data blocks that were hottest in the
+// block cache, so that they can be loaded back into it when the DB is
+// reopened.
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "rocksdb/status.h"
+#include "table/table_reader.h"
+
+namespace rocksdb {
+
+class Env;
+
+// The hot data blocks of one table file
+struct HotFileBlocks {
+  uint32_t column_family_id;
+  uint64_t file_number;
+  // In file offset order
+  std::vector<HotBlock> blocks;
+};
+
+// Replace the HOT_BLOCKS file of the DB with one listing `files`. The list is
+// written to a temporary file that is then renamed, so that a crash leaves
+// either the old or the new list behind.
+extern Status WriteHotBlocksFile(Env* env, const std::string& dbname,
+                                 const std::vector<HotFileBlocks>& files);
+
+// Read the list written by WriteHotBlocksFile(). Returns NotFound if the DB
+// has no HOT_BLOCKS file and Corruption if the file is damaged.
+extern Status ReadHotBlocksFile(Env* env, const std::string& dbname,
+                                std::vector<HotFileBlocks>* files);
+
+}  // namespace rocksdb
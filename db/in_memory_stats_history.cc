@@ -0,0 +1,25 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "db/in_memory_stats_history.h"
+
+#include "db/db_impl.h"
+
+namespace rocksdb {
+
+void InMemoryStatsHistoryIterator::Next() {
+  assert(valid_);
+  // Snapshots are keyed by second, so the next one is at least a second
+  // after the current one
+  AdvanceIteratorByTime(time_ + 1, end_time_);
+}
+
+void InMemoryStatsHistoryIterator::AdvanceIteratorByTime(uint64_t start_time,
+                                                         uint64_t end_time) {
+  assert(db_impl_ != nullptr);
+  valid_ = db_impl_->FindStatsByTime(start_time, end_time, &time_, &stats_map_);
+}
+
+}  // namespace rocksdb
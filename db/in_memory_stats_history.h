@@ -0,0 +1,55 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include "rocksdb/stats_history.h"
+
+namespace rocksdb {
+
+class DBImpl;
+
+// Iterates over the snapshots that DBImpl keeps in memory. It copies one
+// snapshot at a time, so it does not hold any lock of the DB between calls.
+class InMemoryStatsHistoryIterator : public StatsHistoryIterator {
+ public:
+  // Positions the iterator at the first snapshot taken in
+  // [start_time, end_time)
+  InMemoryStatsHistoryIterator(uint64_t start_time, uint64_t end_time,
+                               DBImpl* db_impl)
+      : time_(0), end_time_(end_time), valid_(true), db_impl_(db_impl) {
+    AdvanceIteratorByTime(start_time, end_time_);
+  }
+
+  virtual ~InMemoryStatsHistoryIterator() {}
+
+  virtual bool Valid() const override { return valid_; }
+  virtual Status status() const override { return status_; }
+  virtual void Next() override;
+  virtual uint64_t GetStatsTime() const override { return time_; }
+  virtual const std::map<std::string, uint64_t>& GetStatsMap() const override {
+    return stats_map_;
+  }
+
+ private:
+  // Loads the first snapshot taken in [start_time, end_time), or marks the
+  // iterator invalid if there is none
+  void AdvanceIteratorByTime(uint64_t start_time, uint64_t end_time);
+
+  uint64_t time_;
+  const uint64_t end_time_;
+  std::map<std::string, uint64_t> stats_map_;
+  Status status_;
+  bool valid_;
+  DBImpl* db_impl_;
+
+  // No copying allowed
+  InMemoryStatsHistoryIterator(const InMemoryStatsHistoryIterator&) = delete;
+  void operator=(const InMemoryStatsHistoryIterator&) = delete;
+};
+
+}  // namespace rocksdb
@@ -252,6 +252,13 @@ class MemTable {
     return num_entries_.load(std::memory_order_relaxed);
   }
 
+  // Get total size of the encoded entries in the mem table.
+  // REQUIRES: external synchronization to prevent simultaneous
+  // operations on the same MemTable (unless this Memtable is immutable).
+  uint64_t data_size() const {
+    return data_size_.load(std::memory_order_relaxed);
+  }
+
   // Get total number of deletes in the mem table.
   // REQUIRES: external synchronization to prevent simultaneous
   // operations on the same MemTable (unless this Memtable is immutable).
@@ -9,9 +9,11 @@
 #include <vector>
 
 #include "rocksdb/db.h"
+#include "rocksdb/filter_policy.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/perf_context.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/table.h"
 #include "port/port.h"
 #include "util/histogram.h"
 #include "util/instrumented_mutex.h"
@@ -649,6 +651,76 @@ TEST_F(PerfContextTest, MergeOperatorTime) {
 
   delete db;
 }
+
+TEST_F(PerfContextTest, PerLevelPerfContext) {
+  DestroyDB(kDbName, Options());
+  DB* db;
+  Options options;
+  options.create_if_missing = true;
+  BlockBasedTableOptions table_options;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  ASSERT_OK(DB::Open(options, kDbName, &db));
+
+  // k1 in level 1, and a level 0 file whose key range covers it
+  ASSERT_OK(db->Put(WriteOptions(), "k1", "v1"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  ASSERT_OK(db->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_OK(db->Put(WriteOptions(), "k0", "v0"));
+  ASSERT_OK(db->Put(WriteOptions(), "k2", "v2"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  std::string files_per_level;
+  ASSERT_TRUE(db->GetProperty("rocksdb.num-files-at-level0", &files_per_level));
+  ASSERT_EQ("1", files_per_level);
+  ASSERT_TRUE(db->GetProperty("rocksdb.num-files-at-level1", &files_per_level));
+  ASSERT_EQ("1", files_per_level);
+
+  SetPerfLevel(kEnableTime);
+  perf_context.EnablePerLevelPerfContext();
+  perf_context.Reset();
+  std::string val;
+  ASSERT_OK(db->Get(ReadOptions(), "k1", &val));
+  const PerfContextByLevel& level0 = perf_context.level_perf_context[0];
+  const PerfContextByLevel& level1 = perf_context.level_perf_context[1];
+  EXPECT_EQ(1, level0.bloom_filter_useful);
+  EXPECT_EQ(0, level0.bloom_filter_full_positive);
+  EXPECT_EQ(0, level0.data_block_read_count);
+  EXPECT_EQ(0, level1.bloom_filter_useful);
+  EXPECT_EQ(1, level1.bloom_filter_full_positive);
+  EXPECT_EQ(1, level1.bloom_filter_full_true_positive);
+  EXPECT_EQ(1, level1.data_block_read_count);
+  EXPECT_EQ(1, perf_context.data_block_read_count);
+  EXPECT_GT(level1.block_read_byte, 0);
+  EXPECT_GT(level1.get_from_table_nanos, 0);
+  EXPECT_NE(std::string::npos,
+            perf_context.ToString().find("data_block_read_count = 1@level1"));
+
+  // The data block is now in the block cache
+  perf_context.Reset();
+  ASSERT_OK(db->Get(ReadOptions(), "k1", &val));
+  EXPECT_EQ(0, level1.data_block_read_count);
+  EXPECT_EQ(1, level1.block_cache_hit_count);
+
+  // Misses inside the level 0 key range are checked against its filter, and
+  // a filter false positive is not a true positive
+  perf_context.Reset();
+  for (int i = 0; i < 1000; i++) {
+    db->Get(ReadOptions(), "k1" + ToString(i), &val);
+  }
+  EXPECT_EQ(1000, level0.bloom_filter_useful +
+                      level0.bloom_filter_full_positive);
+  EXPECT_EQ(0, level0.bloom_filter_full_true_positive);
+
+  // Nothing is broken down by level once disabled
+  perf_context.DisablePerLevelPerfContext();
+  perf_context.ClearPerLevelPerfContext();
+  ASSERT_OK(db->Get(ReadOptions(), "k1", &val));
+  EXPECT_EQ(0, level1.bloom_filter_full_positive);
+  EXPECT_EQ(0, level1.block_cache_hit_count);
+  SetPerfLevel(kDisable);
+
+  delete db;
+}
 }
 
 int main(int argc, char** argv) {
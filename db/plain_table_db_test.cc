@@ -12,6 +12,7 @@
 #ifndef ROCKSDB_LITE
 
 #include <algorithm>
+#include <map>
 #include <set>
 
 #include "db/db_impl.h"
@@ -31,6 +32,7 @@
 #include "table/plain_table_factory.h"
 #include "table/plain_table_key_coding.h"
 #include "table/plain_table_reader.h"
+#include "util/compression.h"
 #include "util/hash.h"
 #include "util/logging.h"
 #include "util/mutexlock.h"
@@ -1160,6 +1162,94 @@ TEST_P(PlainTableDBTest, AdaptiveTable) {
   ASSERT_NE("v5", Get("3000000000000bar"));
 }
 
+TEST_P(PlainTableDBTest, CompressedChunks) {
+  CompressionType compression = kNoCompression;
+  if (Snappy_Supported()) {
+    compression = kSnappyCompression;
+  } else if (Zlib_Supported()) {
+    compression = kZlibCompression;
+  } else if (LZ4_Supported()) {
+    compression = kLZ4Compression;
+  }
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 2000; i++) {
+    char key[20];
+    // 100 prefixes of 8 bytes
+    snprintf(key, sizeof(key), "%08d%08d", i % 100, i);
+    expected[key] = std::string(50 + i % 50, 'a' + i % 26) + ToString(i);
+  }
+
+  for (EncodingType encoding_type : {kPlain, kPrefix}) {
+    for (bool store_index_in_file : {false, true}) {
+      for (bool with_cache : {false, true}) {
+        Options options = CurrentOptions();
+        options.create_if_missing = true;
+        options.compression = compression;
+        options.statistics = rocksdb::CreateDBStatistics();
+        PlainTableOptions plain_table_options;
+        plain_table_options.user_key_len = 16;
+        plain_table_options.bloom_bits_per_key = 10;
+        plain_table_options.hash_table_ratio = 0.75;
+        plain_table_options.index_sparseness = 4;
+        plain_table_options.encoding_type = encoding_type;
+        plain_table_options.store_index_in_file = store_index_in_file;
+        plain_table_options.chunk_size = 1024;
+        if (with_cache) {
+          plain_table_options.block_cache = NewLRUCache(1 << 20);
+        }
+        options.table_factory.reset(NewPlainTableFactory(plain_table_options));
+        DestroyAndReopen(&options);
+
+        for (const auto& kv : expected) {
+          ASSERT_OK(Put(kv.first, kv.second));
+        }
+        dbfull()->TEST_FlushMemTable();
+
+        TablePropertiesCollection props;
+        ASSERT_OK(
+            reinterpret_cast<DB*>(dbfull())->GetPropertiesOfAllTables(&props));
+        ASSERT_EQ(1U, props.size());
+        auto table_props = props.begin()->second;
+        ASSERT_GT(table_props->num_data_blocks, 10U);
+        if (compression != kNoCompression) {
+          ASSERT_LT(table_props->data_size * 2,
+                    table_props->raw_key_size + table_props->raw_value_size);
+        }
+
+        // Read the chunks from the file, then from the cache if there is one
+        for (int pass = 0; pass < 2; pass++) {
+          for (const auto& kv : expected) {
+            ASSERT_EQ(kv.second, Get(kv.first));
+          }
+          ASSERT_EQ("NOT_FOUND", Get("0000001200000000"));
+          ASSERT_EQ("NOT_FOUND", Get("0000012300000000"));
+        }
+        if (with_cache) {
+          ASSERT_GT(options.statistics->getTickerCount(BLOCK_CACHE_DATA_HIT),
+                    0U);
+          ASSERT_EQ(table_props->num_data_blocks,
+                    options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD));
+        }
+
+        std::unique_ptr<Iterator> iter(dbfull()->NewIterator(ReadOptions()));
+        for (int prefix : {0, 37, 99}) {
+          char key[20];
+          snprintf(key, sizeof(key), "%08d", prefix);
+          auto it = expected.lower_bound(key);
+          int count = 0;
+          for (iter->Seek(key); iter->Valid() && iter->key().starts_with(key);
+               iter->Next(), ++it, ++count) {
+            ASSERT_EQ(it->first, iter->key().ToString());
+            ASSERT_EQ(it->second, iter->value().ToString());
+          }
+          ASSERT_OK(iter->status());
+          ASSERT_EQ(20, count);
+        }
+      }
+    }
+  }
+}
+
 INSTANTIATE_TEST_CASE_P(PlainTableDBTest, PlainTableDBTest, ::testing::Bool());
 
 }  // namespace rocksdb
@@ -960,12 +960,16 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
       user_comparator(), internal_comparator());
   FdWithKeyRange* f = fp.GetNextFile();
   while (f != nullptr) {
+    PerfContextByLevelRecorder perf_by_level(
+        static_cast<int>(fp.GetHitFileLevel()));
+    const uint64_t key_matches = get_context.num_key_matches();
     *status = table_cache_->Get(
         read_options, *internal_comparator(), f->fd, ikey, &get_context,
         cfd_->internal_stats()->GetFileReadHist(fp.GetHitFileLevel()),
         IsFilterSkipped(static_cast<int>(fp.GetHitFileLevel()),
                         fp.IsHitFileLastInLevel()),
         fp.GetCurrentLevel());
+    perf_by_level.Finish(get_context.num_key_matches() != key_matches);
     // TODO: examine the behavior for corrupted key
     if (!status->ok()) {
       return;
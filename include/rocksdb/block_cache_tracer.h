@@ -0,0 +1,93 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include "rocksdb/status.h"
+#include "rocksdb/trace_reader_writer.h"
+
+namespace rocksdb {
+
+// Kind of block looked up in the block cache
+enum class TraceBlockType : char {
+  kDataBlock = 0,
+  kFilterBlock = 1,
+  kIndexBlock = 2,
+  kRangeDeletionBlock = 3,
+  kNumBlockTypes = 4,
+};
+
+// What a block cache lookup was done for
+enum class TableReaderCaller : char {
+  kUserGet = 0,
+  kUserIterator = 1,
+  kCompaction = 2,
+  // Opening a table, TableReader::Prefetch() and block cache warm-up
+  kPrefetch = 3,
+  // Everything else, like approximating sizes or dumping a table
+  kOther = 4,
+  kNumCallers = 5,
+};
+
+// One lookup of a block in the block cache
+struct BlockCacheTraceRecord {
+  // Env::NowMicros() of the table's Env at the time of the lookup
+  uint64_t access_timestamp = 0;
+  // Key of the block in the block cache
+  std::string block_key;
+  TraceBlockType block_type = TraceBlockType::kDataBlock;
+  // Memory charged to the cache for the block
+  uint64_t block_size = 0;
+  uint32_t cf_id = 0;
+  // Level of the table, -1 if unknown
+  int level = -1;
+  TableReaderCaller caller = TableReaderCaller::kOther;
+  bool is_cache_hit = false;
+  // On a miss, the block was not added to the cache, because
+  // ReadOptions::fill_cache was false or I/O was not allowed.
+  bool no_insert = false;
+};
+
+struct BlockCacheTraceOptions {
+  // Only 1 out of sampling_frequency blocks is traced. Blocks are picked by
+  // their key, so all lookups of a picked block are traced and a replay of
+  // the trace sees the same hits and misses for it.
+  uint64_t sampling_frequency = 1;
+  // Tracing stops once the trace reaches this size
+  uint64_t max_trace_file_size = uint64_t{64} * 1024 * 1024 * 1024;
+};
+
+// BlockCacheTracer records the block cache lookups of block-based tables
+// that have it set as BlockBasedTableOptions::block_cache_tracer. When not
+// tracing, a lookup only pays for a check of IsTracing().
+//
+// tools/block_cache_trace_analyzer replays a trace against simulated caches
+// of several sizes and policies.
+class BlockCacheTracer {
+ public:
+  virtual ~BlockCacheTracer() {}
+
+  // Start writing lookups to trace_writer. Returns Busy if a trace is
+  // already running.
+  virtual Status StartTrace(const BlockCacheTraceOptions& options,
+                            std::unique_ptr<TraceWriter>&& trace_writer) = 0;
+
+  // Stop tracing and close the trace writer
+  virtual Status EndTrace() = 0;
+
+  virtual bool IsTracing() const = 0;
+
+  // Called by the table readers for every lookup while IsTracing()
+  virtual void WriteBlockAccess(const BlockCacheTraceRecord& record) = 0;
+};
+
+// Create a tracer that writes the trace in the format read by
+// tools/block_cache_trace_analyzer.
+extern std::shared_ptr<BlockCacheTracer> NewBlockCacheTracer();
+
+}  // namespace rocksdb
@@ -25,6 +25,8 @@
 #include <stdint.h>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include "rocksdb/slice.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
@@ -32,6 +34,7 @@
 namespace rocksdb {
 
 class Cache;
+enum CompressionType : unsigned char;
 
 // Create a new cache with a fixed size capacity. The cache is sharded
 // to 2^num_shard_bits shards, by hash of the key. The total capacity
@@ -41,10 +44,31 @@ class Cache;
 // high_pri_pool_pct.
 // num_shard_bits = -1 means it is automatically determined: every shard
 // will be at least 512KB and number of shard bits will not exceed 6.
+// If use_admission_filter is set, a full cache only accepts a new low
+// priority entry if its key was looked up more often recently than the key
+// it would evict (TinyLFU), so that blocks read once by a scan do not push
+// out the hot set.
 extern std::shared_ptr<Cache> NewLRUCache(size_t capacity,
                                           int num_shard_bits = -1,
                                           bool strict_capacity_limit = false,
-                                          double high_pri_pool_ratio = 0.0);
+                                          double high_pri_pool_ratio = 0.0,
+                                          bool use_admission_filter = false);
+
+// Similar to NewLRUCache, but the cache has two tiers sharing one capacity.
+// compressed_tier_ratio of the capacity holds entries evicted from the
+// uncompressed tier, compressed with compression_type. A lookup that finds
+// an entry in the compressed tier moves it back to the uncompressed tier.
+// Only entries inserted with Cache::InsertWithHelper() are moved to the
+// compressed tier; the others are dropped on eviction as usual.
+// If compression_type is not supported on this platform, entries are kept
+// uncompressed in the second tier.
+//
+// Return nullptr if compressed_tier_ratio is not within [0, 1).
+extern std::shared_ptr<Cache> NewTieredLRUCache(
+    size_t capacity, double compressed_tier_ratio,
+    CompressionType compression_type, int num_shard_bits = -1,
+    bool strict_capacity_limit = false, double high_pri_pool_ratio = 0.0,
+    bool use_admission_filter = false);
 
 // Similar to NewLRUCache, but create a cache based on CLOCK algorithm with
 // better concurrent performance in some cases. See util/clock_cache.cc for
@@ -55,6 +79,18 @@ extern std::shared_ptr<Cache> NewClockCache(size_t capacity,
                                             int num_shard_bits = -1,
                                             bool strict_capacity_limit = false);
 
+// Tells a cache with a compressed tier (see NewTieredLRUCache) how to keep
+// an entry in serialized form after it is evicted from memory, and how to
+// rebuild it when it is looked up again. All functions must be thread-safe.
+struct CacheTierHelper {
+  // Append the serialized form of value to *output.
+  void (*save)(void* value, std::string* output);
+  // Rebuild a value from its serialized form and return its charge.
+  Status (*create)(const Slice& data, void** value, size_t* charge);
+  // Release a value, like the deleter passed to Cache::Insert().
+  void (*deleter)(const Slice& key, void* value);
+};
+
 class Cache {
  public:
   // Depending on implementation, cache entries with high priority could be less
@@ -95,6 +131,18 @@ class Cache {
                         Handle** handle = nullptr,
                         Priority priority = Priority::LOW) = 0;
 
+  // Same as Insert(), but when the entry is evicted from a cache that has
+  // a compressed tier it is saved there with helper->save() instead of
+  // being deleted. helper->deleter is used as the deleter and helper must
+  // outlive the cache. Caches without a compressed tier treat this as a
+  // plain Insert().
+  virtual Status InsertWithHelper(const Slice& key, void* value, size_t charge,
+                                  const CacheTierHelper* helper,
+                                  Handle** handle = nullptr,
+                                  Priority priority = Priority::LOW) {
+    return Insert(key, value, charge, helper->deleter, handle, priority);
+  }
+
   // If the cache has no mapping for "key", returns nullptr.
   //
   // Else return a handle that corresponds to the mapping.  The caller
@@ -176,6 +224,15 @@ class Cache {
   // Prerequisit: no entry is referenced.
   virtual void EraseUnRefEntries() = 0;
 
+  // Append to *keys the keys of up to max_entries entries of the cache, the
+  // most recently used first, along with the priority each was inserted
+  // with. Entries that are referenced count as the most recently used.
+  // Used to remember what the cache holds across a restart; the default
+  // implementation appends nothing.
+  virtual void GetHotKeys(
+      size_t max_entries,
+      std::vector<std::pair<std::string, Priority>>* keys) {}
+
   virtual std::string GetPrintableOptions() const { return ""; }
 
  private:
@@ -22,7 +22,9 @@
 #include "rocksdb/options.h"
 #include "rocksdb/snapshot.h"
 #include "rocksdb/sst_file_writer.h"
+#include "rocksdb/stats_history.h"
 #include "rocksdb/thread_status.h"
+#include "rocksdb/trace_reader_writer.h"
 #include "rocksdb/transaction_log.h"
 #include "rocksdb/types.h"
 #include "rocksdb/version.h"
@@ -1022,6 +1024,32 @@ class DB {
       TablePropertiesCollection* props) = 0;
 #endif  // ROCKSDB_LITE
 
+  // Starts recording the queries made to the DB (writes, gets and iterator
+  // seeks) to trace_writer, until EndTrace() is called or the trace reaches
+  // options.max_trace_file_size. Iterator Next() and Prev() calls are not
+  // recorded. The trace can be replayed against a copy of the DB with
+  // db_bench's replay benchmark. Returns Busy if a trace is already running.
+  virtual Status StartTrace(const TraceOptions& options,
+                            std::unique_ptr<TraceWriter>&& trace_writer) {
+    return Status::NotSupported("StartTrace() is not implemented.");
+  }
+
+  // Stops the trace started by StartTrace() and closes its TraceWriter
+  virtual Status EndTrace() {
+    return Status::NotSupported("EndTrace() is not implemented.");
+  }
+
+  // Returns an iterator over the statistics snapshots taken from start_time
+  // (inclusive) to end_time (exclusive), both in seconds since the epoch.
+  // Snapshots are only taken when DBOptions::stats_persist_period_sec is not
+  // zero, and only the most recent ones that fit in
+  // DBOptions::stats_history_buffer_size are kept.
+  virtual Status GetStatsHistory(
+      uint64_t start_time, uint64_t end_time,
+      std::unique_ptr<StatsHistoryIterator>* stats_iterator) {
+    return Status::NotSupported("GetStatsHistory() is not implemented.");
+  }
+
   // Needed for StackableDB
   virtual DB* GetRootDB() { return this; }
 
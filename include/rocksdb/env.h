@@ -453,6 +453,26 @@ class SequentialFile {
   }
 };
 
+// A request for one of the reads issued through RandomAccessFile::MultiRead.
+// offset, len and scratch are filled in by the caller; result and status are
+// filled in by MultiRead().
+struct ReadRequest {
+  // File offset in bytes
+  uint64_t offset = 0;
+
+  // Length to read in bytes
+  size_t len = 0;
+
+  // A buffer of at least len bytes that MultiRead() may read into
+  char* scratch = nullptr;
+
+  // Output parameter set by MultiRead() to point to the data read
+  Slice result;
+
+  // Status of the read, set by MultiRead()
+  Status status;
+};
+
 // A file abstraction for randomly reading the contents of a file.
 class RandomAccessFile {
  public:
@@ -472,6 +492,24 @@ class RandomAccessFile {
   virtual Status Read(uint64_t offset, size_t n, Slice* result,
                       char* scratch) const = 0;
 
+  // Read a batch of independent, possibly non-contiguous ranges of the file.
+  // The implementation may issue the reads in parallel (e.g. through io_uring)
+  // so that a single thread can keep the device queue full. Each request's
+  // result and status are set as if by Read(). The return value is a status
+  // for the batch as a whole; it is OK unless the batch could not be issued
+  // at all, so callers must also check each request's status.
+  //
+  // Safe for concurrent use by multiple threads.
+  // If Direct I/O enabled, offset, len, and scratch of every request should
+  // be aligned properly.
+  virtual Status MultiRead(ReadRequest* reqs, size_t num_reqs) const {
+    for (size_t i = 0; i < num_reqs; ++i) {
+      ReadRequest& req = reqs[i];
+      req.status = Read(req.offset, req.len, &req.result, req.scratch);
+    }
+    return Status::OK();
+  }
+
   // Used by the file_reader_writer to decide if the ReadAhead wrapper
   // should simply forward the call and do not enact buffering or locking.
   virtual bool ShouldForwardRawRequest() const {
@@ -482,6 +520,13 @@ class RandomAccessFile {
   // layer
   virtual void EnableReadAhead() {}
 
+  // Tells the file system that [offset, offset + n) is going to be read soon
+  // so that it can start loading it, e.g. into the OS page cache. It does not
+  // wait for the data to be read.
+  virtual Status Prefetch(uint64_t offset, size_t n) {
+    return Status::NotSupported("Prefetch not supported.");
+  }
+
   // Tries to get an unique ID for this file that will be the same each time
   // the file is opened (and will stay the same while the file is open).
   // Furthermore, it tries to make this ID at most "max_size" bytes. If such an
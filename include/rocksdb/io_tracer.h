@@ -0,0 +1,101 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include "rocksdb/env.h"
+#include "rocksdb/status.h"
+#include "rocksdb/trace_reader_writer.h"
+
+namespace rocksdb {
+
+// File operation recorded in an I/O trace
+enum class IOTraceOp : char {
+  kRead = 0,
+  // One request of a RandomAccessFile::MultiRead() batch. Its latency is the
+  // latency of the whole batch.
+  kMultiRead = 1,
+  kPrefetch = 2,
+  kAppend = 3,
+  kPositionedAppend = 4,
+  kTruncate = 5,
+  kFlush = 6,
+  kSync = 7,
+  kFsync = 8,
+  kRangeSync = 9,
+  kClose = 10,
+  kNumOps = 11,
+};
+
+// What the thread issuing an I/O was doing
+enum class IOCaller : char {
+  // Everything else, like opening the DB or writing the MANIFEST outside of
+  // flushes and compactions
+  kOther = 0,
+  kFlush = 1,
+  kCompaction = 2,
+  kUserGet = 3,
+  kUserIterator = 4,
+  // Writing the WAL
+  kUserWrite = 5,
+  kNumCallers = 6,
+};
+
+// One file operation
+struct IOTraceRecord {
+  // Env::NowMicros() when the operation started
+  uint64_t access_timestamp = 0;
+  uint64_t latency_nanos = 0;
+  std::string file_name;
+  IOTraceOp op = IOTraceOp::kRead;
+  IOCaller caller = IOCaller::kOther;
+  // Offset of a read, range sync or append, and the new size of a truncated
+  // file. Sequential reads and appends get the position in the file.
+  uint64_t offset = 0;
+  // Bytes requested by a read, written by an append or synced by a range
+  // sync
+  uint64_t length = 0;
+  // Bytes actually read
+  uint64_t io_size = 0;
+  bool ok = true;
+};
+
+struct IOTraceOptions {
+  // Only 1 out of sampling_frequency operations is traced
+  uint64_t sampling_frequency = 1;
+  // Tracing stops once the trace reaches this size
+  uint64_t max_trace_file_size = uint64_t{64} * 1024 * 1024 * 1024;
+};
+
+// An Env that times the file reads, writes and syncs of the files it opens
+// and, while tracing, records each of them with the IOCaller of the thread
+// that issued it. When not tracing, an operation only pays for a check of
+// IsTracing().
+//
+// tools/io_trace_analyzer reports the access patterns, bytes read per file
+// type and latency outliers of a trace.
+class IOTracingEnv : public EnvWrapper {
+ public:
+  explicit IOTracingEnv(Env* base_env) : EnvWrapper(base_env) {}
+
+  // Start writing operations to trace_writer. Returns Busy if a trace is
+  // already running. trace_writer must not write through this env.
+  virtual Status StartTrace(const IOTraceOptions& options,
+                            std::unique_ptr<TraceWriter>&& trace_writer) = 0;
+
+  // Stop tracing and close the trace writer
+  virtual Status EndTrace() = 0;
+
+  virtual bool IsTracing() const = 0;
+};
+
+// Returns an IOTracingEnv on top of base_env. The caller owns it and must
+// delete it after the DBs that use it are closed.
+extern IOTracingEnv* NewIOTracingEnv(Env* base_env);
+
+}  // namespace rocksdb
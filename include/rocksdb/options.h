@@ -159,14 +159,29 @@ struct CompressionOptions {
   // A value of 0 indicates the feature is disabled.
   // Default: 0.
   uint32_t max_dict_bytes;
+  // Maximum size of the training data passed to ZSTD's dictionary trainer.
+  // When set with max_dict_bytes, the data sampled for the dictionary, up to
+  // this many bytes, is used to train a dictionary of up to max_dict_bytes
+  // instead of being used as the dictionary itself. Flushes then also train
+  // a dictionary from the memtables they write, so that L0 files are
+  // compressed with one too. Only applies to kZSTD and
+  // kZSTDNotFinalCompression; other compression types keep using the raw
+  // samples. A value of about 100x max_dict_bytes is a good start.
+  // Default: 0.
+  uint32_t zstd_max_train_bytes;
 
   CompressionOptions()
-      : window_bits(-14), level(-1), strategy(0), max_dict_bytes(0) {}
+      : window_bits(-14),
+        level(-1),
+        strategy(0),
+        max_dict_bytes(0),
+        zstd_max_train_bytes(0) {}
   CompressionOptions(int wbits, int _lev, int _strategy, int _max_dict_bytes)
       : window_bits(wbits),
         level(_lev),
         strategy(_strategy),
-        max_dict_bytes(_max_dict_bytes) {}
+        max_dict_bytes(_max_dict_bytes),
+        zstd_max_train_bytes(0) {}
 };
 
 enum UpdateStatus {    // Return status For inplace update callback
@@ -1148,6 +1163,37 @@ struct DBOptions {
   // Default: 600 (10 min)
   unsigned int stats_dump_period_sec = 600;
 
+  // If not zero, a snapshot of the tickers of statistics and of a few integer
+  // DB properties is taken every stats_persist_period_sec and kept in memory,
+  // where DB::GetStatsHistory() can read it. Tickers are recorded as how much
+  // they grew since the previous snapshot.
+  // Default: 0 (disabled)
+  unsigned int stats_persist_period_sec = 0;
+
+  // Memory budget of the snapshots taken every stats_persist_period_sec. The
+  // oldest snapshots are dropped to stay within it.
+  // Default: 1MB
+  size_t stats_history_buffer_size = 1024 * 1024;
+
+  // If not zero, the data blocks of this DB that are hottest in the block
+  // cache are recorded in a HOT_BLOCKS file in the DB directory, by a
+  // background thread every hot_blocks_persist_period_sec and when the DB is
+  // closed. When the DB is opened, the blocks listed in that file are loaded
+  // back into the block cache in the background, so that reads do not start
+  // from a cold cache after a restart. Blocks of files deleted in the
+  // meantime are skipped.
+  // Default: 0 (disabled)
+  unsigned int hot_blocks_persist_period_sec = 0;
+
+  // Maximum number of blocks recorded in the HOT_BLOCKS file.
+  // Default: 65536
+  size_t max_persisted_hot_blocks = 65536;
+
+  // Rate limit, in bytes per second, of the reads that load the blocks listed
+  // in the HOT_BLOCKS file when the DB is opened. 0 means no limit.
+  // Default: 0
+  uint64_t hot_blocks_warm_up_bytes_per_sec = 0;
+
   // If set true, will hint the underlying file system that the file
   // access pattern is random, when a sst file is opened.
   // Default: true
@@ -1557,6 +1603,28 @@ struct ReadOptions {
   // Default: false
   bool ignore_range_deletions;
 
+  // If non-nullptr, iterators over tables of the column-aware table format
+  // only decode and return these value columns, in declaration order. The
+  // index after the last value column selects the value checksum. Values that
+  // do not fit the schema, values from the memtables and values from tables
+  // of the other formats are returned whole. Must outlive the iterators
+  // created with it. Merge operands cannot be merged from some of their
+  // columns, so NewIterator() returns an iterator with a NotSupported status
+  // on column families with a merge operator. Does not apply to Get().
+  // Default: nullptr
+  const std::vector<uint32_t>* projected_value_columns;
+
+  // If true, the iterators created with these options are only used for their
+  // keys, for example to count entries or check that they exist, and
+  // Iterator::value() returns unspecified values. Data blocks of block-based
+  // tables are then read without touching their values, which is cheaper when
+  // BlockBasedTableOptions::separate_data_block_values is set. Merge operands
+  // cannot be resolved without their values, so NewIterator() returns an
+  // iterator with a NotSupported status on column families with a merge
+  // operator. Does not apply to Get().
+  // Default: false
+  bool keys_only;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
@@ -1681,6 +1749,15 @@ struct IngestExternalFileOptions {
   bool allow_blocking_flush = true;
 };
 
+// TraceOptions is used by DB::StartTrace()
+struct TraceOptions {
+  // Tracing stops once the trace file reaches this size. Default: 64GB
+  uint64_t max_trace_file_size = uint64_t{64} * 1024 * 1024 * 1024;
+  // Only one in every sampling_frequency queries is traced. Default: 1,
+  // every query
+  uint64_t sampling_frequency = 1;
+};
+
 }  // namespace rocksdb
 
 #endif  // STORAGE_ROCKSDB_INCLUDE_OPTIONS_H_
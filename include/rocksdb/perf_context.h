@@ -13,6 +13,27 @@
 
 namespace rocksdb {
 
+// Counters of the files of one level that Get() looked up
+struct PerfContextByLevel {
+  void Reset();  // reset all performance counters to zero
+
+  // number of files whose bloom filter ruled the key out
+  uint64_t bloom_filter_useful;
+  // number of files whose bloom filter could not rule the key out
+  uint64_t bloom_filter_full_positive;
+  // number of files whose bloom filter could not rule the key out, and that
+  // did hold the key
+  uint64_t bloom_filter_full_true_positive;
+  uint64_t block_cache_hit_count;   // number of block cache hits
+  uint64_t index_block_read_count;  // number of index block reads (with IO)
+  uint64_t data_block_read_count;   // number of data block reads (with IO)
+  uint64_t block_read_byte;         // number of bytes from block reads
+  uint64_t get_from_table_nanos;    // total nanos looking up the files
+};
+
+// Levels from kPerfContextMaxLevels - 1 on share the last PerfContextByLevel
+const int kPerfContextMaxLevels = 16;
+
 // A thread local context for gathering performance counter efficiently
 // and transparently.
 // Use SetPerfLevel(PerfLevel::kEnableTime) to enable time stats.
@@ -125,6 +146,23 @@ struct PerfContext {
   uint64_t bloom_sst_hit_count;
   // total number of SST table bloom misses
   uint64_t bloom_sst_miss_count;
+
+  // total number of index blocks read from SST files (with IO)
+  uint64_t index_block_read_count;
+  // total number of data blocks read from SST files (with IO)
+  uint64_t data_block_read_count;
+
+  // Once enabled, the lookups that Get() makes in SST files are also
+  // counted by the level of the file, in level_perf_context. Reset() clears
+  // them while enabled. Only block-based tables report their block reads and
+  // block cache hits.
+  void EnablePerLevelPerfContext() { per_level_perf_context_enabled = true; }
+  void DisablePerLevelPerfContext() { per_level_perf_context_enabled = false; }
+  void ClearPerLevelPerfContext();
+
+  bool per_level_perf_context_enabled;
+  // Indexed by level
+  PerfContextByLevel level_perf_context[kPerfContextMaxLevels];
 };
 
 #if defined(NPERF_CONTEXT) || defined(IOS_CROSS_COMPILE)
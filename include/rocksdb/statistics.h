@@ -216,6 +216,16 @@ enum Tickers : uint32_t {
   READ_AMP_ESTIMATE_USEFUL_BYTES,  // Estimate of total bytes actually used.
   READ_AMP_TOTAL_READ_BYTES,       // Total size of loaded data blocks.
 
+  // Automatic readahead of sequential table iterator scans, see
+  // BlockBasedTableOptions::max_auto_readahead_size.
+  // Bytes requested to be read ahead.
+  AUTO_READAHEAD_BYTES,
+  // Bytes of blocks the iterators then read from within a readahead window.
+  AUTO_READAHEAD_USEFUL_BYTES,
+  // Bytes of readahead windows that were never read, because the scan moved
+  // elsewhere or stopped.
+  AUTO_READAHEAD_WASTED_BYTES,
+
   TICKER_ENUM_MAX
 };
 
@@ -318,6 +328,9 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {ROW_CACHE_MISS, "rocksdb.row.cache.miss"},
     {READ_AMP_ESTIMATE_USEFUL_BYTES, "rocksdb.read.amp.estimate.useful.bytes"},
     {READ_AMP_TOTAL_READ_BYTES, "rocksdb.read.amp.total.read.bytes"},
+    {AUTO_READAHEAD_BYTES, "rocksdb.auto.readahead.bytes"},
+    {AUTO_READAHEAD_USEFUL_BYTES, "rocksdb.auto.readahead.useful.bytes"},
+    {AUTO_READAHEAD_WASTED_BYTES, "rocksdb.auto.readahead.wasted.bytes"},
 };
 
 /**
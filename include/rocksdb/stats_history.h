@@ -0,0 +1,44 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+// StatsHistoryIterator walks the statistics snapshots that a DB took every
+// DBOptions::stats_persist_period_sec, oldest first. Each snapshot maps
+// names to values:
+//  - for each ticker of DBOptions::statistics, by its name in TickersNameMap,
+//    how much it grew since the previous snapshot
+//  - for a few integer DB properties, such as "rocksdb.estimate-num-keys",
+//    their value when the snapshot was taken
+//
+// An iterator must not outlive the DB it was obtained from.
+class StatsHistoryIterator {
+ public:
+  StatsHistoryIterator() {}
+  virtual ~StatsHistoryIterator() {}
+
+  virtual bool Valid() const = 0;
+
+  // Moves to the next snapshot. REQUIRES: Valid()
+  virtual void Next() = 0;
+
+  virtual Status status() const = 0;
+
+  // Time the current snapshot was taken, in seconds since the epoch.
+  // REQUIRES: Valid()
+  virtual uint64_t GetStatsTime() const = 0;
+
+  // REQUIRES: Valid()
+  virtual const std::map<std::string, uint64_t>& GetStatsMap() const = 0;
+};
+
+}  // namespace rocksdb
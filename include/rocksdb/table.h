@@ -19,6 +19,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/cache.h"
 #include "rocksdb/env.h"
@@ -29,6 +30,7 @@
 namespace rocksdb {
 
 // -- Block-based Table
+class BlockCacheTracer;
 class FlushBlockPolicyFactory;
 class PersistentCache;
 class RandomAccessFile;
@@ -46,6 +48,10 @@ enum ChecksumType : char {
   kNoChecksum = 0x0,  // not yet supported. Will fail
   kCRC32c = 0x1,
   kxxHash = 0x2,
+  // The lower 32 bits of the 64-bit xxHash, which reads 8 bytes at a time
+  // and is the cheapest to compute on 64-bit platforms without the SSE4.2
+  // crc32 instruction. Can only be read by RocksDB versions that know it.
+  kxxHash64 = 0x3,
 };
 
 // For advanced user only
@@ -122,6 +128,10 @@ struct BlockBasedTableOptions {
   // If NULL, rocksdb will not use a compressed block cache.
   std::shared_ptr<Cache> block_cache_compressed = nullptr;
 
+  // If non-NULL, lookups of the table's blocks in block_cache are recorded
+  // while the tracer is tracing. See NewBlockCacheTracer().
+  std::shared_ptr<BlockCacheTracer> block_cache_tracer = nullptr;
+
   // Approximate size of user data packed per block.  Note that the
   // block size specified here corresponds to uncompressed data.  The
   // actual size of the unit read from disk may be smaller if
@@ -154,6 +164,18 @@ struct BlockBasedTableOptions {
   // Default: true
   bool use_delta_encoding = true;
 
+  // Store the values of each data block after all its keys, instead of each
+  // value right after its key. Seeks and scans that only look at keys then
+  // walk over densely packed keys and never bring the values into the CPU
+  // cache, which helps tables with large values. See also
+  // ReadOptions::keys_only. Index and meta blocks are not affected.
+  //
+  // Tables written with this option cannot be read by older versions of
+  // RocksDB.
+  //
+  // Default: false
+  bool separate_data_block_values = false;
+
   // If non-nullptr, use the specified filter policy to reduce disk reads.
   // Many applications will benefit from passing the result of
   // NewBloomFilterPolicy() here.
@@ -182,6 +204,16 @@ struct BlockBasedTableOptions {
   // algorithms.
   bool verify_compression = false;
 
+  // Blocks found in the block caches were verified when they were read from
+  // the file and have no checksum, so cache hits never pay for checksums.
+  // The pages of a persistent_cache that stores compressed pages are the
+  // only cached blocks that keep their checksums. If this is set, the
+  // checksums of those pages are verified when ReadOptions::verify_checksums
+  // is, and a page that fails verification is read again from the file.
+  //
+  // Default: false
+  bool verify_persistent_cache_checksums = false;
+
   // If used, For every data block we load into memory, we will create a bitmap
   // of size ((block_size / `read_amp_bytes_per_bit`) / 8) bytes. This bitmap
   // will be used to figure out the percentage we actually read of the blocks.
@@ -205,7 +237,51 @@ struct BlockBasedTableOptions {
   // Default: 0 (disabled)
   uint32_t read_amp_bytes_per_bit = 0;
 
-  // We currently have three versions:
+  // When a table iterator reads data blocks that are next to each other in
+  // the file, it asks the file system to read ahead of it. The readahead
+  // starts at 8KB on the third sequential block read and doubles on every
+  // new readahead up to this size. It goes back to the start when the
+  // iterator jumps elsewhere in the file. Not used with direct I/O reads or
+  // when ReadOptions::readahead_size is set.
+  //
+  // Tickers::AUTO_READAHEAD_USEFUL_BYTES and
+  // Tickers::AUTO_READAHEAD_WASTED_BYTES tell how much of what was read
+  // ahead actually got used.
+  //
+  // Default: 256KB, 0 disables it
+  size_t max_auto_readahead_size = 256 * 1024;
+
+  // If not empty, the data blocks of a compressed table (one whose level
+  // compression is not kNoCompression) each get the best of these
+  // compression types instead of the level compression. The first data block
+  // and then one out of adaptive_compression_sampling_interval are
+  // compressed with every candidate to measure the ratio it achieves and the
+  // CPU time it costs, and are written with the one that compressed them
+  // best. The other blocks use the candidate with the best recent ratio, or
+  // stay uncompressed when no candidate has recently compressed well enough,
+  // which saves the CPU of compressing incompressible data.
+  //
+  // Each block records its compression type, so readers do not need this
+  // option. The number of data blocks written with each type is reported in
+  // the BlockBasedTablePropertyNames::kDataBlockCompressionTypes property.
+  //
+  // Default: empty (all blocks use the level compression)
+  std::vector<CompressionType> adaptive_compression_candidates;
+
+  // One out of adaptive_compression_sampling_interval data blocks is
+  // compressed with every adaptive compression candidate. Must not be 0.
+  //
+  // Default: 16
+  uint32_t adaptive_compression_sampling_interval = 16;
+
+  // CPU budget of adaptive compression: a candidate that costs more than
+  // this many nanoseconds per KB of raw data on average is only used when
+  // no other candidate compresses well enough within the budget.
+  //
+  // Default: 0 (no limit)
+  uint64_t adaptive_compression_max_nanos_per_kb = 0;
+
+  // We currently have five versions:
   // 0 -- This version is currently written out by all RocksDB's versions by
   // default.  Can be read by really old RocksDB's. Doesn't support changing
   // checksum (default is CRC32).
@@ -217,6 +293,16 @@ struct BlockBasedTableOptions {
   // encode compressed blocks with LZ4, BZip2 and Zlib compression. If you
   // don't plan to run RocksDB before version 3.10, you should probably use
   // this.
+  // 3 -- Can be read by RocksDB's versions since 5.3. Makes binary search
+  // indexes smaller: past the restart points of the index block, an index
+  // entry only stores the size of its data block, whose offset follows the
+  // previous one, and the index keys are separators of the user keys rather
+  // than of the internal keys, unless a user key spans two data blocks. Set
+  // index_block_restart_interval above 1 to shrink the handles too.
+  // 4 -- Can be read by RocksDB's versions since 5.3. With the bytewise
+  // comparator, data and binary search index blocks also store the first 8
+  // bytes of the user key of each restart point, which narrow down the
+  // binary searches of the blocks before any key is decoded.
   // This option only affects newly written tables. When reading exising tables,
   // the information about version is read from the footer.
   uint32_t format_version = 2;
@@ -230,6 +316,13 @@ struct BlockBasedTablePropertyNames {
   static const std::string kWholeKeyFiltering;
   // value is "1" for true and "0" for false.
   static const std::string kPrefixFiltering;
+  // Number of data blocks written with each compression type when
+  // BlockBasedTableOptions::adaptive_compression_candidates is set, as
+  // "<type>=<blocks>" pairs separated by ';', like "Snappy=10;ZSTD=3".
+  static const std::string kDataBlockCompressionTypes;
+  // "1" if the keys of the index are user keys rather than internal keys.
+  // Only set with format_version 3 and above.
+  static const std::string kIndexKeyIsUserKey;
 };
 
 // Create default block based table factory.
@@ -260,6 +353,7 @@ struct PlainTablePropertyNames {
   static const std::string kEncodingType;
   static const std::string kBloomVersion;
   static const std::string kNumBloomBlocks;
+  static const std::string kChunkSize;
 };
 
 const uint32_t kPlainTableVariableLength = 0;
@@ -314,6 +408,20 @@ struct PlainTableOptions {
   //                       file building and store it in file. When reading
   //                       file, index will be mmaped instead of recomputation.
   bool store_index_in_file = false;
+
+  // @chunk_size: if > 0, the records are grouped into chunks of about this
+  //              many bytes, which are compressed with the compression type
+  //              of the column family and read through the regular file
+  //              read path instead of mmap. The prefix hash index keeps
+  //              pointing to offsets in the uncompressed records, which are
+  //              mapped to a chunk when reading. Files with chunks cannot be
+  //              read by older versions of RocksDB.
+  size_t chunk_size = 0;
+
+  // @block_cache: if non-null, the uncompressed chunks are cached in it.
+  //               Otherwise each reader decompresses the chunks it reads.
+  //               Only used for files with chunks.
+  std::shared_ptr<Cache> block_cache = nullptr;
 };
 
 // -- Plain Table with prefix-only seek
@@ -384,6 +492,9 @@ struct CuckooTableOptions {
   // power of two, and bit and is used to calculate hash, which is faster in
   // general.
   bool use_module_hash = true;
+  // The number of threads the builder computes the hashes of the keys with.
+  // The table built does not depend on it.
+  uint32_t num_build_threads = 1;
 };
 
 // Cuckoo Table Factory for SST table format using Cache Friendly Cuckoo Hashing
@@ -0,0 +1,54 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include "rocksdb/env.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+// TraceWriter is where tracers send the records they produce. Each call to
+// Write() hands over one whole record, which the matching TraceReader
+// returns from one call to Read().
+//
+// Tracers serialize their calls to Write(), so implementations do not need
+// to be thread-safe.
+class TraceWriter {
+ public:
+  virtual ~TraceWriter() {}
+
+  virtual Status Write(const Slice& data) = 0;
+  virtual Status Close() = 0;
+  // Number of bytes written so far
+  virtual uint64_t GetFileSize() = 0;
+};
+
+// TraceReader returns the records written by a TraceWriter, in order.
+// Read() returns Status::Incomplete() once all records have been read.
+class TraceReader {
+ public:
+  virtual ~TraceReader() {}
+
+  virtual Status Read(std::string* data) = 0;
+  virtual Status Close() = 0;
+};
+
+// A TraceWriter that writes the records to a file, each prefixed with its
+// length.
+extern Status NewFileTraceWriter(Env* env, const EnvOptions& env_options,
+                                 const std::string& trace_filename,
+                                 std::unique_ptr<TraceWriter>* trace_writer);
+
+// A TraceReader for files written by NewFileTraceWriter().
+extern Status NewFileTraceReader(Env* env, const EnvOptions& env_options,
+                                 const std::string& trace_filename,
+                                 std::unique_ptr<TraceReader>* trace_reader);
+
+}  // namespace rocksdb
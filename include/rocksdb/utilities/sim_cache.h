@@ -35,6 +35,14 @@ extern std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> cache,
                                              size_t sim_capacity,
                                              int num_shard_bits);
 
+// Same as above, but the simulated cache is sim_cache, which only ever
+// holds keys. This lets the simulation use a different cache
+// configuration than `cache`, for example an LRU cache with an admission
+// filter. To compare several configurations on the same traffic, wrap a
+// SimCache in another SimCache.
+extern std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> cache,
+                                             std::shared_ptr<Cache> sim_cache);
+
 class SimCache : public Cache {
  public:
   SimCache() {}
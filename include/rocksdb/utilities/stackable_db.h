@@ -331,6 +331,20 @@ class StackableDB : public DB {
     return db_->DefaultColumnFamily();
   }
 
+  virtual Status StartTrace(
+      const TraceOptions& options,
+      std::unique_ptr<TraceWriter>&& trace_writer) override {
+    return db_->StartTrace(options, std::move(trace_writer));
+  }
+
+  virtual Status EndTrace() override { return db_->EndTrace(); }
+
+  virtual Status GetStatsHistory(
+      uint64_t start_time, uint64_t end_time,
+      std::unique_ptr<StatsHistoryIterator>* stats_iterator) override {
+    return db_->GetStatsHistory(start_time, end_time, stats_iterator);
+  }
+
  protected:
   DB* db_;
 };
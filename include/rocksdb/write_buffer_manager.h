@@ -14,6 +14,8 @@
 
 #include <atomic>
 #include <cstddef>
+#include <memory>
+#include "rocksdb/cache.h"
 
 namespace rocksdb {
 
@@ -21,39 +23,68 @@ class WriteBufferManager {
  public:
   // _buffer_size = 0 indicates no limit. Memory won't be tracked,
   // memory_usage() won't be valid and ShouldFlush() will always return true.
-  explicit WriteBufferManager(size_t _buffer_size)
-      : buffer_size_(_buffer_size), memory_used_(0) {}
+  //
+  // If cache is provided, the memory used by memtables is also charged to
+  // it, in units of dummy entries of kSizeDummyEntry bytes, so that memtables
+  // and cached blocks share one memory budget: memtable growth evicts cold
+  // blocks. When the cache is full of memory that cannot be evicted,
+  // ShouldFlush() returns true. Memory is then tracked even if _buffer_size
+  // is 0.
+  explicit WriteBufferManager(size_t _buffer_size,
+                              std::shared_ptr<Cache> cache = {});
 
-  ~WriteBufferManager() {}
+  ~WriteBufferManager();
 
   bool enabled() const { return buffer_size_ != 0; }
 
-  // Only valid if enabled()
+  // Whether memtable memory is charged to a cache
+  bool cost_to_cache() const { return cache_rep_ != nullptr; }
+
+  // Only valid if enabled() or cost_to_cache()
   size_t memory_usage() const {
     return memory_used_.load(std::memory_order_relaxed);
   }
+  // Memory charged to the cache; only valid if cost_to_cache()
+  size_t dummy_entries_in_cache_usage() const;
   size_t buffer_size() const { return buffer_size_; }
 
   // Should only be called from write thread
   bool ShouldFlush() const {
-    return enabled() && memory_usage() >= buffer_size();
+    if (enabled() && memory_usage() >= buffer_size()) {
+      return true;
+    }
+    return cache_full_.load(std::memory_order_relaxed) && memory_usage() > 0;
   }
 
-  // Should only be called from write thread
   void ReserveMem(size_t mem) {
-    if (enabled()) {
+    if (cache_rep_ != nullptr) {
+      ReserveMemWithCache(mem);
+    } else if (enabled()) {
       memory_used_.fetch_add(mem, std::memory_order_relaxed);
     }
   }
   void FreeMem(size_t mem) {
-    if (enabled()) {
+    if (cache_rep_ != nullptr) {
+      FreeMemWithCache(mem);
+    } else if (enabled()) {
       memory_used_.fetch_sub(mem, std::memory_order_relaxed);
     }
   }
 
+  // Charge of each dummy entry inserted into the cache
+  static const size_t kSizeDummyEntry = 1024 * 1024;
+
  private:
+  struct CacheRep;
+
+  void ReserveMemWithCache(size_t mem);
+  void FreeMemWithCache(size_t mem);
+
   const size_t buffer_size_;
   std::atomic<size_t> memory_used_;
+  std::unique_ptr<CacheRep> cache_rep_;
+  // Set when the cache has no evictable room left
+  std::atomic<bool> cache_full_;
 
   // No copying allowed
   WriteBufferManager(const WriteBufferManager&) = delete;
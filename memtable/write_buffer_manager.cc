@@ -0,0 +1,127 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "rocksdb/write_buffer_manager.h"
+
+#include <assert.h>
+#include <vector>
+#include "port/port.h"
+#include "util/coding.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+// MSVC complains that it is already defined since it is static in the header.
+#ifndef OS_WIN
+const size_t WriteBufferManager::kSizeDummyEntry;
+#endif
+
+struct WriteBufferManager::CacheRep {
+  std::shared_ptr<Cache> cache;
+  port::Mutex mutex;
+  // Memory charged to the cache by the dummy entries
+  std::atomic<size_t> allocated_size;
+  // Dummy entries are keyed by a prefix unique to this manager followed by
+  // the entry's number
+  std::string key_prefix;
+  uint64_t next_key_id;
+  // Dummy entries currently held, with the key each was inserted under
+  std::vector<std::pair<Cache::Handle*, uint64_t>> dummy_handles;
+
+  explicit CacheRep(std::shared_ptr<Cache> _cache)
+      : cache(_cache), allocated_size(0), next_key_id(0) {
+    PutVarint64(&key_prefix, cache->NewId());
+  }
+
+  std::string GetKey(uint64_t id) const {
+    std::string key = key_prefix;
+    PutVarint64(&key, id);
+    return key;
+  }
+};
+
+WriteBufferManager::WriteBufferManager(size_t _buffer_size,
+                                       std::shared_ptr<Cache> cache)
+    : buffer_size_(_buffer_size), memory_used_(0), cache_full_(false) {
+  if (cache != nullptr) {
+    cache_rep_.reset(new CacheRep(cache));
+  }
+}
+
+WriteBufferManager::~WriteBufferManager() {
+  if (cache_rep_ != nullptr) {
+    for (const auto& dummy : cache_rep_->dummy_handles) {
+      cache_rep_->cache->Erase(cache_rep_->GetKey(dummy.second));
+      cache_rep_->cache->Release(dummy.first);
+    }
+  }
+}
+
+size_t WriteBufferManager::dummy_entries_in_cache_usage() const {
+  if (cache_rep_ == nullptr) {
+    return 0;
+  }
+  return cache_rep_->allocated_size.load(std::memory_order_relaxed);
+}
+
+void WriteBufferManager::ReserveMemWithCache(size_t mem) {
+  assert(cache_rep_ != nullptr);
+  // Memtables may be written to concurrently, so this needs a lock to keep
+  // the dummy entries in sync with memory_used_
+  MutexLock l(&cache_rep_->mutex);
+  size_t new_mem_used = memory_used_.load(std::memory_order_relaxed) + mem;
+  memory_used_.store(new_mem_used, std::memory_order_relaxed);
+  bool inserted = false;
+  while (new_mem_used > cache_rep_->allocated_size) {
+    // Pinning a dummy entry makes the cache evict other entries to make
+    // room for it
+    uint64_t id = cache_rep_->next_key_id++;
+    Cache::Handle* handle = nullptr;
+    Status s = cache_rep_->cache->Insert(
+        cache_rep_->GetKey(id), nullptr /* value */, kSizeDummyEntry,
+        nullptr /* deleter */, &handle, Cache::Priority::HIGH);
+    if (!s.ok() || handle == nullptr) {
+      // The cache has a strict capacity limit and is full
+      cache_full_.store(true, std::memory_order_relaxed);
+      return;
+    }
+    cache_rep_->dummy_handles.emplace_back(handle, id);
+    cache_rep_->allocated_size += kSizeDummyEntry;
+    inserted = true;
+  }
+  if (inserted) {
+    cache_full_.store(cache_rep_->cache->GetPinnedUsage() >=
+                          cache_rep_->cache->GetCapacity(),
+                      std::memory_order_relaxed);
+  }
+}
+
+void WriteBufferManager::FreeMemWithCache(size_t mem) {
+  assert(cache_rep_ != nullptr);
+  MutexLock l(&cache_rep_->mutex);
+  size_t new_mem_used = memory_used_.load(std::memory_order_relaxed) - mem;
+  memory_used_.store(new_mem_used, std::memory_order_relaxed);
+  // Give memory back to the cache once usage drops below 3/4 of what is
+  // reserved, so that a memtable growing and shrinking around an entry
+  // boundary does not insert and erase dummy entries over and over.
+  bool released = false;
+  while (!cache_rep_->dummy_handles.empty() &&
+         new_mem_used < cache_rep_->allocated_size / 4 * 3 &&
+         cache_rep_->allocated_size - kSizeDummyEntry >= new_mem_used) {
+    const auto& dummy = cache_rep_->dummy_handles.back();
+    cache_rep_->cache->Erase(cache_rep_->GetKey(dummy.second));
+    cache_rep_->cache->Release(dummy.first);
+    cache_rep_->dummy_handles.pop_back();
+    cache_rep_->allocated_size -= kSizeDummyEntry;
+    released = true;
+  }
+  if (released || cache_full_.load(std::memory_order_relaxed)) {
+    cache_full_.store(cache_rep_->cache->GetPinnedUsage() >=
+                          cache_rep_->cache->GetCapacity(),
+                      std::memory_order_relaxed);
+  }
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,108 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "rocksdb/write_buffer_manager.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class WriteBufferManagerTest : public testing::Test {};
+
+TEST_F(WriteBufferManagerTest, ShouldFlush) {
+  WriteBufferManager wbf(10 * 1024 * 1024);
+  ASSERT_FALSE(wbf.cost_to_cache());
+
+  wbf.ReserveMem(8 * 1024 * 1024);
+  ASSERT_FALSE(wbf.ShouldFlush());
+  wbf.ReserveMem(3 * 1024 * 1024);
+  ASSERT_TRUE(wbf.ShouldFlush());
+  wbf.FreeMem(2 * 1024 * 1024);
+  ASSERT_FALSE(wbf.ShouldFlush());
+  ASSERT_EQ(9 * 1024 * 1024U, wbf.memory_usage());
+}
+
+TEST_F(WriteBufferManagerTest, CacheCost) {
+  const size_t kMB = 1024 * 1024;
+  std::shared_ptr<Cache> cache = NewLRUCache(50 * kMB, 4);
+  std::unique_ptr<WriteBufferManager> wbf(new WriteBufferManager(0, cache));
+  ASSERT_FALSE(wbf->enabled());
+  ASSERT_TRUE(wbf->cost_to_cache());
+
+  // Memory is charged in whole dummy entries
+  wbf->ReserveMem(333 * 1024);
+  ASSERT_EQ(333 * 1024U, wbf->memory_usage());
+  ASSERT_EQ(kMB, wbf->dummy_entries_in_cache_usage());
+  ASSERT_GE(cache->GetPinnedUsage(), kMB);
+  ASSERT_LT(cache->GetPinnedUsage(), kMB + 10000);
+
+  wbf->ReserveMem(9 * kMB);
+  ASSERT_EQ(10 * kMB, wbf->dummy_entries_in_cache_usage());
+  ASSERT_GE(cache->GetPinnedUsage(), 10 * kMB);
+  ASSERT_FALSE(wbf->ShouldFlush());
+
+  // Still above 3/4 of the reservation: nothing is given back
+  wbf->FreeMem(kMB);
+  ASSERT_EQ(10 * kMB, wbf->dummy_entries_in_cache_usage());
+
+  // Below 3/4: entries are released until the reservation is close again
+  wbf->FreeMem(3 * kMB);
+  ASSERT_LT(wbf->dummy_entries_in_cache_usage(), 10 * kMB);
+  ASSERT_GE(wbf->dummy_entries_in_cache_usage(), wbf->memory_usage());
+  ASSERT_EQ(wbf->dummy_entries_in_cache_usage() / kMB,
+            cache->GetPinnedUsage() / kMB);
+
+  // Everything is given back once the memtables are gone
+  wbf->FreeMem(wbf->memory_usage());
+  ASSERT_EQ(0U, wbf->memory_usage());
+  ASSERT_EQ(0U, wbf->dummy_entries_in_cache_usage());
+  ASSERT_LT(cache->GetPinnedUsage(), 10000U);
+
+  // Destroying the manager releases what is left
+  wbf->ReserveMem(5 * kMB);
+  ASSERT_GE(cache->GetUsage(), 5 * kMB);
+  wbf.reset();
+  ASSERT_LT(cache->GetUsage(), 10000U);
+}
+
+TEST_F(WriteBufferManagerTest, CacheCostEvictsBlocks) {
+  const size_t kMB = 1024 * 1024;
+  std::shared_ptr<Cache> cache = NewLRUCache(10 * kMB, 0);
+  // Fill the cache with unpinned entries
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(cache->Insert("block" + ToString(i), nullptr, kMB, nullptr));
+  }
+  ASSERT_EQ(10 * kMB, cache->GetUsage());
+
+  WriteBufferManager wbf(0, cache);
+  wbf.ReserveMem(4 * kMB);
+  // Memtable memory took the place of blocks
+  ASSERT_LE(cache->GetUsage(), 10 * kMB);
+  ASSERT_EQ(4 * kMB, cache->GetPinnedUsage());
+  ASSERT_FALSE(wbf.ShouldFlush());
+}
+
+TEST_F(WriteBufferManagerTest, ShouldFlushWhenCacheFull) {
+  const size_t kMB = 1024 * 1024;
+  std::shared_ptr<Cache> cache = NewLRUCache(4 * kMB, 0, true);
+  WriteBufferManager wbf(100 * kMB, cache);
+  wbf.ReserveMem(3 * kMB);
+  ASSERT_FALSE(wbf.ShouldFlush());
+
+  // The cache cannot fit the memtables any more
+  wbf.ReserveMem(2 * kMB);
+  ASSERT_TRUE(wbf.ShouldFlush());
+
+  // Flushing gives the memory back
+  wbf.FreeMem(4 * kMB);
+  ASSERT_FALSE(wbf.ShouldFlush());
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -232,6 +232,12 @@ extern void InitOnce(OnceType* once, void (*initializer)());
 
 #define CACHE_LINE_SIZE 64U
 
+#if (defined _MSC_VER) && (_MSC_VER >= 1900)
+#define ALIGN_AS(n) alignas(n)
+#else
+#define ALIGN_AS(n) __declspec(align(n))
+#endif
+
 static inline void AsmVolatilePause() {
 #if defined(_M_IX86) || defined(_M_X64)
   YieldProcessor();
@@ -27,6 +27,8 @@ LIB_SOURCES =                                                   \
   db/flush_job.cc                                               \
   db/flush_scheduler.cc                                         \
   db/forward_iterator.cc                                        \
+  db/hot_blocks.cc                                              \
+  db/in_memory_stats_history.cc                                 \
   db/internal_stats.cc                                          \
   db/log_reader.cc                                              \
   db/log_writer.cc                                              \
@@ -55,6 +57,7 @@ LIB_SOURCES =                                                   \
   memtable/hash_skiplist_rep.cc                                 \
   memtable/skiplistrep.cc                                       \
   memtable/vectorrep.cc                                         \
+  memtable/write_buffer_manager.cc                              \
   port/stack_trace.cc                                           \
   port/port_posix.cc                                            \
   table/adaptive_table_factory.cc                               \
@@ -66,6 +69,9 @@ LIB_SOURCES =                                                   \
   table/block.cc                                                \
   table/block_prefix_index.cc                                   \
   table/bloom_block.cc                                          \
+  table/column_aware_table_builder.cc                           \
+  table/column_aware_table_factory.cc                           \
+  table/column_aware_table_reader.cc                            \
   table/cuckoo_table_builder.cc                                 \
   table/cuckoo_table_factory.cc                                 \
   table/cuckoo_table_reader.cc                                  \
@@ -86,7 +92,9 @@ LIB_SOURCES =                                                   \
   table/table_properties.cc                                     \
   table/two_level_iterator.cc                                   \
   tools/dump/db_dump_tool.cc                                    \
+  util/aligned_buffer_pool.cc                                   \
   util/arena.cc                                                 \
+  util/block_cache_tracer.cc                                    \
   util/bloom.cc                                                 \
   util/build_version.cc                                         \
   util/cf_options.cc                                            \
@@ -94,6 +102,7 @@ LIB_SOURCES =                                                   \
   util/coding.cc                                                \
   util/comparator.cc                                            \
   util/compaction_job_stats_impl.cc                             \
+  util/compression_context_cache.cc                             \
   util/concurrent_arena.cc                                      \
   util/crc32c.cc                                                \
   util/db_options.cc                                            \
@@ -107,10 +116,12 @@ LIB_SOURCES =                                                   \
   util/file_util.cc                                             \
   util/file_reader_writer.cc                                    \
   util/filter_policy.cc                                         \
+  util/frequency_sketch.cc                                      \
   util/hash.cc                                                  \
   util/histogram.cc                                             \
   util/histogram_windowing.cc                                   \
   util/instrumented_mutex.cc                                    \
+  util/io_tracer.cc                                             \
   util/iostats_context.cc                                       \
   util/io_posix.cc                                              \
   util/log_buffer.cc                                            \
@@ -141,6 +152,8 @@ LIB_SOURCES =                                                   \
   util/thread_status_util.cc                                    \
   util/thread_status_util_debug.cc                              \
   util/threadpool_imp.cc                                        \
+  util/trace_reader_writer.cc                                   \
+  util/trace_replay.cc                                          \
   util/transaction_test_util.cc                                 \
   util/xfunc.cc                                                 \
   util/xxhash.cc                                                \
@@ -148,6 +161,8 @@ LIB_SOURCES =                                                   \
   utilities/blob_db/blob_db.cc                                  \
   utilities/convenience/info_log_finder.cc                      \
   utilities/checkpoint/checkpoint.cc                            \
+  utilities/col_buf_decoder.cc                                  \
+  utilities/col_buf_encoder.cc                                  \
   utilities/compaction_filters/remove_emptyvalue_compactionfilter.cc    \
   utilities/document/document_db.cc                             \
   utilities/document/json_document_builder.cc                   \
@@ -170,6 +185,7 @@ LIB_SOURCES =                                                   \
   utilities/persistent_cache/block_cache_tier_metadata.cc       \
   utilities/persistent_cache/block_cache_tier.cc                \
   utilities/redis/redis_lists.cc                                \
+  utilities/simulator_cache/cache_simulator.cc                  \
   utilities/simulator_cache/sim_cache.cc                        \
   utilities/spatialdb/spatial_db.cc                             \
   utilities/table_properties_collectors/compact_on_deletion_collector.cc \
@@ -200,8 +216,6 @@ BENCH_LIB_SOURCES = \
   tools/db_bench_tool.cc                                        \
 
 EXP_LIB_SOURCES = \
-  utilities/col_buf_encoder.cc                                          \
-  utilities/col_buf_decoder.cc                                          \
   utilities/column_aware_encoding_util.cc
 
 TEST_LIB_SOURCES = \
@@ -266,8 +280,10 @@ MAIN_SOURCES =                                                    \
   db/write_batch_test.cc                                                \
   db/write_controller_test.cc                                           \
   db/write_callback_test.cc                                             \
+  memtable/write_buffer_manager_test.cc                                 \
   table/block_based_filter_block_test.cc                                \
   table/block_test.cc                                                   \
+  table/column_aware_table_test.cc                                      \
   table/cuckoo_table_builder_test.cc                                    \
   table/cuckoo_table_reader_test.cc                                     \
   table/full_filter_block_test.cc                                       \
@@ -276,12 +292,16 @@ MAIN_SOURCES =                                                    \
   table/table_test.cc                                                   \
   tools/db_bench.cc                                                     \
   tools/db_bench_tool_test.cc                                           \
+  tools/block_cache_trace_analyzer.cc                                   \
+  tools/io_trace_analyzer.cc                                            \
   tools/db_sanity_test.cc                                               \
   tools/ldb_cmd_test.cc                                                 \
   tools/reduce_levels_test.cc                                           \
   tools/sst_dump_test.cc                                                \
+  util/aligned_buffer_pool_test.cc                                      \
   util/arena_test.cc                                                    \
   util/autovector_test.cc                                               \
+  util/block_cache_tracer_test.cc                                       \
   util/bloom_test.cc                                                    \
   util/cache_bench.cc                                                   \
   util/cache_test.cc                                                    \
@@ -292,6 +312,7 @@ MAIN_SOURCES =                                                    \
   util/env_test.cc                                                      \
   util/filelock_test.cc                                                 \
   util/histogram_test.cc                                                \
+  util/io_tracer_test.cc                                                \
   util/statistics_test.cc                                               \
   utilities/backupable/backupable_db_test.cc                            \
   utilities/blob_db/blob_db_test.cc                                     \
@@ -305,6 +326,7 @@ MAIN_SOURCES =                                                    \
   utilities/option_change_migration/option_change_migration_test.cc           \
   utilities/options/options_util_test.cc                                \
   utilities/redis/redis_lists_test.cc                                   \
+  utilities/simulator_cache/cache_simulator_test.cc                     \
   utilities/simulator_cache/sim_cache_test.cc                           \
   utilities/spatialdb/spatial_db_test.cc                                \
   utilities/table_properties_collectors/compact_on_deletion_collector_test.cc  \
@@ -317,10 +339,12 @@ MAIN_SOURCES =                                                    \
   utilities/lua/rocks_lua_test.cc                                       \
   util/iostats_context_test.cc                                          \
   util/log_write_bench.cc                                               \
+  util/microbench.cc                                                    \
   util/mock_env_test.cc                                                 \
   util/options_test.cc                                                  \
   util/event_logger_test.cc                                             \
   util/rate_limiter_test.cc                                             \
+  util/repeatable_thread_test.cc                                        \
   util/slice_transform_test.cc                                          \
   util/thread_list_test.cc                                              \
   util/thread_local_test.cc                                             \
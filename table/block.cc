@@ -14,6 +14,9 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
 
 #include "port/port.h"
 #include "port/stack_trace.h"
@@ -33,10 +36,26 @@ namespace rocksdb {
 //
 // If any errors are detected, returns nullptr.  Otherwise, returns a
 // pointer to the key delta (just past the three decoded values).
+//
+// If value_inline is false, the value is stored apart from the entry and its
+// length is not checked against "limit". If has_value_length is false, the
+// entry does not store the length of its value and "*value_length" is set to
+// zero.
 static inline const char* DecodeEntry(const char* p, const char* limit,
                                       uint32_t* shared,
                                       uint32_t* non_shared,
-                                      uint32_t* value_length) {
+                                      uint32_t* value_length,
+                                      bool value_inline = true,
+                                      bool has_value_length = true) {
+  if (!has_value_length) {
+    *value_length = 0;
+    if ((p = GetVarint32Ptr(p, limit, shared)) == nullptr) return nullptr;
+    if ((p = GetVarint32Ptr(p, limit, non_shared)) == nullptr) return nullptr;
+    if (static_cast<uint32_t>(limit - p) < *non_shared) {
+      return nullptr;
+    }
+    return p;
+  }
   if (limit - p < 3) return nullptr;
   *shared = reinterpret_cast<const unsigned char*>(p)[0];
   *non_shared = reinterpret_cast<const unsigned char*>(p)[1];
@@ -50,7 +69,8 @@ static inline const char* DecodeEntry(const char* p, const char* limit,
     if ((p = GetVarint32Ptr(p, limit, value_length)) == nullptr) return nullptr;
   }
 
-  if (static_cast<uint32_t>(limit - p) < (*non_shared + *value_length)) {
+  if (static_cast<uint32_t>(limit - p) <
+      (*non_shared + (value_inline ? *value_length : 0))) {
     return nullptr;
   }
   return p;
@@ -86,9 +106,26 @@ void BlockIter::Prev() {
     }
     const Slice current_key(key_ptr, current_prev_entry.key_size);
 
+    if (values_separated_) {
+      // The previous entry ends where the current one starts
+      next_entry_offset_ = current_;
+      next_value_offset_ = static_cast<uint32_t>(
+          current_prev_entry.value.data() + current_prev_entry.value.size() -
+          data_);
+    } else if (values_delta_encoded_) {
+      next_entry_offset_ = current_;
+    }
     current_ = current_prev_entry.offset;
     key_.SetKey(current_key, false /* copy */);
-    value_ = current_prev_entry.value;
+    if (keys_are_user_keys_) {
+      SetInternalKeyFromUserKey();
+    }
+    if (values_delta_encoded_) {
+      decoded_handle_ = current_prev_entry.handle;
+      SetDecodedValue();
+    } else {
+      value_ = current_prev_entry.value;
+    }
 
     return;
   }
@@ -116,19 +153,22 @@ void BlockIter::Prev() {
     if (!ParseNextKey()) {
       break;
     }
-    Slice current_key = key();
+    Slice current_key = key_.GetKey();
 
     if (key_.IsKeyPinned()) {
       // The key is not delta encoded
       prev_entries_.emplace_back(current_, current_key.data(), 0,
-                                 current_key.size(), value());
+                                 current_key.size(), value_);
     } else {
       // The key is delta encoded, cache decoded key in buffer
       size_t new_key_offset = prev_entries_keys_buff_.size();
       prev_entries_keys_buff_.append(current_key.data(), current_key.size());
 
       prev_entries_.emplace_back(current_, nullptr, new_key_offset,
-                                 current_key.size(), value());
+                                 current_key.size(), value_);
+    }
+    if (values_delta_encoded_) {
+      prev_entries_.back().handle = decoded_handle_;
     }
     // Loop until end of current entry hits the start of original entry
   } while (NextEntryOffset() < original);
@@ -140,12 +180,14 @@ void BlockIter::Seek(const Slice& target) {
   if (data_ == nullptr) {  // Not init yet
     return;
   }
+  // The keys past an internal key of a user key are the keys past the user key
+  const Slice seek_key = keys_are_user_keys_ ? ExtractUserKey(target) : target;
   uint32_t index = 0;
   bool ok = false;
   if (prefix_index_) {
-    ok = PrefixSeek(target, &index);
+    ok = PrefixSeek(seek_key, &index);
   } else {
-    ok = BinarySeek(target, 0, num_restarts_ - 1, &index);
+    ok = BinarySeek(seek_key, 0, num_restarts_ - 1, &index);
   }
 
   if (!ok) {
@@ -155,7 +197,7 @@ void BlockIter::Seek(const Slice& target) {
   // Linear search (within restart block) for first key >= target
 
   while (true) {
-    if (!ParseNextKey() || Compare(key_.GetKey(), target) >= 0) {
+    if (!ParseNextKey() || Compare(key_.GetKey(), seek_key) >= 0) {
       return;
     }
   }
@@ -166,9 +208,10 @@ void BlockIter::SeekForPrev(const Slice& target) {
   if (data_ == nullptr) {  // Not init yet
     return;
   }
+  const Slice seek_key = keys_are_user_keys_ ? ExtractUserKey(target) : target;
   uint32_t index = 0;
   bool ok = false;
-  ok = BinarySeek(target, 0, num_restarts_ - 1, &index);
+  ok = BinarySeek(seek_key, 0, num_restarts_ - 1, &index);
 
   if (!ok) {
     return;
@@ -176,12 +219,12 @@ void BlockIter::SeekForPrev(const Slice& target) {
   SeekToRestartPoint(index);
   // Linear search (within restart block) for first key >= target
 
-  while (ParseNextKey() && Compare(key_.GetKey(), target) < 0) {
+  while (ParseNextKey() && Compare(key_.GetKey(), seek_key) < 0) {
   }
   if (!Valid()) {
     SeekToLast();
   } else {
-    while (Valid() && Compare(key_.GetKey(), target) > 0) {
+    while (Valid() && Compare(key_.GetKey(), seek_key) > 0) {
       Prev();
     }
   }
@@ -226,8 +269,11 @@ bool BlockIter::ParseNextKey() {
 
   // Decode next entry
   uint32_t shared, non_shared, value_length;
-  p = DecodeEntry(p, limit, &shared, &non_shared, &value_length);
-  if (p == nullptr || key_.Size() < shared) {
+  p = DecodeEntry(p, limit, &shared, &non_shared, &value_length,
+                  !values_separated_, !values_delta_encoded_);
+  if (p == nullptr || key_.Size() < shared ||
+      (values_separated_ && (next_value_offset_ > values_end_ ||
+                             value_length > values_end_ - next_value_offset_))) {
     CorruptionError();
     return false;
   } else {
@@ -261,8 +307,22 @@ bool BlockIter::ParseNextKey() {
 
       key_.UpdateInternalKey(global_seqno_, ValueType::kTypeValue);
     }
+    if (keys_are_user_keys_) {
+      SetInternalKeyFromUserKey();
+    }
 
-    value_ = Slice(p + non_shared, value_length);
+    if (values_separated_) {
+      value_ = Slice(data_ + next_value_offset_, value_length);
+      next_value_offset_ += value_length;
+      next_entry_offset_ = static_cast<uint32_t>(p + non_shared - data_);
+    } else if (values_delta_encoded_) {
+      if (!ParseDeltaEncodedValue(p + non_shared, limit)) {
+        CorruptionError();
+        return false;
+      }
+    } else {
+      value_ = Slice(p + non_shared, value_length);
+    }
     while (restart_index_ + 1 < num_restarts_ &&
            GetRestartPoint(restart_index_ + 1) < current_) {
       ++restart_index_;
@@ -271,6 +331,41 @@ bool BlockIter::ParseNextKey() {
   }
 }
 
+bool BlockIter::ParseDeltaEncodedValue(const char* p, const char* limit) {
+  // restart_index_ may lag behind the restart point of current_
+  uint32_t index = restart_index_;
+  while (index + 1 < num_restarts_ && GetRestartPoint(index + 1) <= current_) {
+    ++index;
+  }
+  const bool restart_point = GetRestartPoint(index) == current_;
+  uint64_t size;
+  if (restart_point) {
+    uint64_t offset;
+    if ((p = GetVarint64Ptr(p, limit, &offset)) == nullptr ||
+        (p = GetVarint64Ptr(p, limit, &size)) == nullptr) {
+      return false;
+    }
+    decoded_handle_.set_offset(offset);
+  } else {
+    // The block follows the block of the previous entry and its trailer
+    if ((p = GetVarint64Ptr(p, limit, &size)) == nullptr) {
+      return false;
+    }
+    decoded_handle_.set_offset(decoded_handle_.offset() +
+                               decoded_handle_.size() + kBlockTrailerSize);
+  }
+  decoded_handle_.set_size(size);
+  next_entry_offset_ = static_cast<uint32_t>(p - data_);
+  SetDecodedValue();
+  return true;
+}
+
+void BlockIter::SetDecodedValue() {
+  char* end = EncodeVarint64(value_buf_, decoded_handle_.offset());
+  end = EncodeVarint64(end, decoded_handle_.size());
+  value_ = Slice(value_buf_, end - value_buf_);
+}
+
 // Binary search in restart array to find the first restart point that
 // is either the last restart point with a key less than target,
 // which means the key of next restart point is larger than target, or
@@ -278,13 +373,18 @@ bool BlockIter::ParseNextKey() {
 bool BlockIter::BinarySeek(const Slice& target, uint32_t left, uint32_t right,
                            uint32_t* index) {
   assert(left <= right);
+  if (key_prefixes_ != nullptr) {
+    NarrowByKeyPrefixes(target, &left, &right);
+  }
 
   while (left < right) {
     uint32_t mid = (left + right + 1) / 2;
     uint32_t region_offset = GetRestartPoint(mid);
     uint32_t shared, non_shared, value_length;
-    const char* key_ptr = DecodeEntry(data_ + region_offset, data_ + restarts_,
-                                      &shared, &non_shared, &value_length);
+    const char* key_ptr =
+        DecodeEntry(data_ + region_offset, data_ + restarts_, &shared,
+                    &non_shared, &value_length, !values_separated_,
+                    !values_delta_encoded_);
     if (key_ptr == nullptr || (shared != 0)) {
       CorruptionError();
       return false;
@@ -308,13 +408,87 @@ bool BlockIter::BinarySeek(const Slice& target, uint32_t left, uint32_t right,
   return true;
 }
 
+// Ranges of key prefixes at most this long are scanned rather than halved
+static const uint32_t kKeyPrefixScanLength = 16;
+
+// Index of the first of the ordered key prefixes in [begin, end) of
+// key_prefixes that is past prefix, or at or past it if !past_equal
+static uint32_t FindKeyPrefix(const char* key_prefixes, uint32_t begin,
+                              uint32_t end, uint64_t prefix, bool past_equal) {
+  // Halve the range until it is short enough to scan
+  while (end - begin > kKeyPrefixScanLength) {
+    uint32_t mid = begin + (end - begin) / 2;
+    uint64_t mid_prefix = DecodeFixed64(key_prefixes + mid * sizeof(uint64_t));
+    if (mid_prefix < prefix || (past_equal && mid_prefix == prefix)) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+
+  // As the prefixes are ordered, the index is the number of prefixes of the
+  // range that come before it
+  uint32_t i = begin;
+#ifdef __SSE4_2__
+  if (port::kLittleEndian) {
+    // Compare two prefixes at a time. The compares are signed, so flip the
+    // sign bits.
+    const __m128i sign = _mm_set1_epi64x(static_cast<int64_t>(1ull << 63));
+    const __m128i target = _mm_xor_si128(
+        _mm_set1_epi64x(static_cast<int64_t>(prefix)), sign);
+    for (; i + 2 <= end; i += 2) {
+      __m128i prefixes = _mm_xor_si128(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+              key_prefixes + i * sizeof(uint64_t))),
+          sign);
+      // Lanes of the prefixes that come before the index
+      int before =
+          past_equal
+              ? _mm_movemask_pd(_mm_castsi128_pd(
+                    _mm_cmpgt_epi64(prefixes, target))) ^ 3
+              : _mm_movemask_pd(_mm_castsi128_pd(
+                    _mm_cmpgt_epi64(target, prefixes)));
+      if (before != 3) {
+        return i + (before & 1);
+      }
+    }
+  }
+#endif
+  for (; i < end; i++) {
+    uint64_t i_prefix = DecodeFixed64(key_prefixes + i * sizeof(uint64_t));
+    if (i_prefix > prefix || (!past_equal && i_prefix == prefix)) {
+      break;
+    }
+  }
+  return i;
+}
+
+void BlockIter::NarrowByKeyPrefixes(const Slice& target, uint32_t* left,
+                                    uint32_t* right) {
+  if (internal_key_prefixes_ && target.size() < 8) {
+    return;
+  }
+  const uint64_t prefix =
+      BlockKeyPrefix(internal_key_prefixes_ ? ExtractUserKey(target) : target);
+  // The keys of the restart points before `less` are less than target, and
+  // the ones from `at_most` on are greater
+  uint32_t less = FindKeyPrefix(key_prefixes_, 0, num_restarts_, prefix,
+                                false /* past_equal */);
+  uint32_t at_most = FindKeyPrefix(key_prefixes_, less, num_restarts_, prefix,
+                                   true /* past_equal */);
+  *left = std::max(*left, less > 0 ? less - 1 : 0);
+  *right = std::max(*left, std::min(*right, at_most > 0 ? at_most - 1 : 0));
+}
+
 // Compare target key and the block key of the block of `block_index`.
 // Return -1 if error.
 int BlockIter::CompareBlockKey(uint32_t block_index, const Slice& target) {
   uint32_t region_offset = GetRestartPoint(block_index);
   uint32_t shared, non_shared, value_length;
-  const char* key_ptr = DecodeEntry(data_ + region_offset, data_ + restarts_,
-                                    &shared, &non_shared, &value_length);
+  const char* key_ptr =
+      DecodeEntry(data_ + region_offset, data_ + restarts_, &shared,
+                  &non_shared, &value_length, !values_separated_,
+                  !values_delta_encoded_);
   if (key_ptr == nullptr || (shared != 0)) {
     CorruptionError();
     return 1;  // Return target is smaller
@@ -390,7 +564,25 @@ bool BlockIter::PrefixSeek(const Slice& target, uint32_t* index) {
 
 uint32_t Block::NumRestarts() const {
   assert(size_ >= 2*sizeof(uint32_t));
-  return DecodeFixed32(data_ + size_ - sizeof(uint32_t));
+  return DecodeFixed32(data_ + size_ - sizeof(uint32_t)) & ~kBlockRestartFlags;
+}
+
+bool Block::values_separated() const {
+  assert(size_ >= 2*sizeof(uint32_t));
+  return (DecodeFixed32(data_ + size_ - sizeof(uint32_t)) &
+          kBlockValuesSeparatedFlag) != 0;
+}
+
+bool Block::values_delta_encoded() const {
+  assert(size_ >= 2*sizeof(uint32_t));
+  return (DecodeFixed32(data_ + size_ - sizeof(uint32_t)) &
+          kBlockValuesDeltaEncodedFlag) != 0;
+}
+
+bool Block::has_key_prefixes() const {
+  assert(size_ >= 2*sizeof(uint32_t));
+  return (DecodeFixed32(data_ + size_ - sizeof(uint32_t)) &
+          kBlockKeyPrefixesFlag) != 0;
 }
 
 Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
@@ -402,11 +594,28 @@ Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
   } else {
-    restart_offset_ =
-        static_cast<uint32_t>(size_) - (1 + NumRestarts()) * sizeof(uint32_t);
-    if (restart_offset_ > size_ - sizeof(uint32_t)) {
-      // The size is too small for NumRestarts() and therefore
-      // restart_offset_ wrapped around.
+    // A block with separated values has an array of value restart points
+    // after its restart points, and a block with key prefixes has an array of
+    // key prefixes before its restart count
+    const uint64_t key_prefixes_size =
+        has_key_prefixes()
+            ? static_cast<uint64_t>(NumRestarts()) * sizeof(uint64_t)
+            : 0;
+    const uint64_t restarts_size =
+        (1 + static_cast<uint64_t>(NumRestarts()) *
+                 (values_separated() ? 2 : 1)) *
+            sizeof(uint32_t) +
+        key_prefixes_size;
+    restart_offset_ = static_cast<uint32_t>(size_ - restarts_size);
+    key_prefixes_offset_ = static_cast<uint32_t>(size_ - sizeof(uint32_t) -
+                                                 key_prefixes_size);
+    if (restarts_size > size_) {
+      // The size is too small for NumRestarts()
+      size_ = 0;
+    } else if (values_separated() &&
+               (NumRestarts() == 0 ||
+                DecodeFixed32(data_ + restart_offset_) > restart_offset_)) {
+      // The values run past the key entries
       size_ = 0;
     }
   }
@@ -417,7 +626,8 @@ Block::Block(BlockContents&& contents, SequenceNumber _global_seqno,
 }
 
 InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
-                                     bool total_order_seek, Statistics* stats) {
+                                     bool total_order_seek, Statistics* stats,
+                                     bool key_only, bool keys_are_user_keys) {
   if (size_ < 2*sizeof(uint32_t)) {
     if (iter != nullptr) {
       iter->SetStatus(Status::Corruption("bad block contents"));
@@ -427,6 +637,11 @@ InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
     }
   }
   const uint32_t num_restarts = NumRestarts();
+  const char* key_prefixes =
+      has_key_prefixes() ? data_ + key_prefixes_offset_ : nullptr;
+  const bool internal_key_prefixes =
+      (DecodeFixed32(data_ + size_ - sizeof(uint32_t)) &
+       kBlockInternalKeyPrefixesFlag) != 0;
   if (num_restarts == 0) {
     if (iter != nullptr) {
       iter->SetStatus(Status::OK());
@@ -440,11 +655,17 @@ InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
 
     if (iter != nullptr) {
       iter->Initialize(cmp, data_, restart_offset_, num_restarts,
-                       prefix_index_ptr, global_seqno_, read_amp_bitmap_.get());
+                       prefix_index_ptr, global_seqno_, read_amp_bitmap_.get(),
+                       values_separated(), key_only, values_delta_encoded(),
+                       keys_are_user_keys, key_prefixes,
+                       internal_key_prefixes);
     } else {
       iter = new BlockIter(cmp, data_, restart_offset_, num_restarts,
                            prefix_index_ptr, global_seqno_,
-                           read_amp_bitmap_.get());
+                           read_amp_bitmap_.get(), values_separated(),
+                           key_only, values_delta_encoded(),
+                           keys_are_user_keys, key_prefixes,
+                           internal_key_prefixes);
     }
 
     if (read_amp_bitmap_) {
@@ -169,6 +169,13 @@ class Block {
     return size_;
   }
   uint32_t NumRestarts() const;
+  // Whether the values of the block are stored apart from its keys
+  bool values_separated() const;
+  // Whether the values of the block are block handles delta-encoded past the
+  // restart points
+  bool values_delta_encoded() const;
+  // Whether the block stores a prefix of the key of each restart point
+  bool has_key_prefixes() const;
   CompressionType compression_type() const {
     return contents_.compression_type;
   }
@@ -186,10 +193,20 @@ class Block {
   // If total_order_seek is true, hash_index_ and prefix_index_ are ignored.
   // This option only applies for index block. For data block, hash_index_
   // and prefix_index_ are null, so this option does not matter.
+  //
+  // If key_only is true, the iterator returns empty values and does not touch
+  // the values of the block.
+  //
+  // If keys_are_user_keys is true, the block stores user keys, compared with
+  // comparator, while the iterator is sought to internal keys and returns
+  // the internal keys that sort after every entry of their user keys. Only
+  // index blocks are built that way.
   InternalIterator* NewIterator(const Comparator* comparator,
                                 BlockIter* iter = nullptr,
                                 bool total_order_seek = true,
-                                Statistics* stats = nullptr);
+                                Statistics* stats = nullptr,
+                                bool key_only = false,
+                                bool keys_are_user_keys = false);
   void SetBlockPrefixIndex(BlockPrefixIndex* prefix_index);
 
   // Report an approximation of how much memory has been used.
@@ -202,6 +219,9 @@ class Block {
   const char* data_;            // contents_.data.data()
   size_t size_;                 // contents_.data.size()
   uint32_t restart_offset_;     // Offset in data_ of restart array
+  // Offset in data_ of the key prefixes of the restart points, if
+  // has_key_prefixes()
+  uint32_t key_prefixes_offset_;
   std::unique_ptr<BlockPrefixIndex> prefix_index_;
   std::unique_ptr<BlockReadAmpBitmap> read_amp_bitmap_;
   // All keys in the block will have seqno = global_seqno_, regardless of
@@ -226,21 +246,41 @@ class BlockIter : public InternalIterator {
         prefix_index_(nullptr),
         key_pinned_(false),
         global_seqno_(kDisableGlobalSequenceNumber),
+        values_separated_(false),
+        key_only_(false),
+        values_delta_encoded_(false),
+        keys_are_user_keys_(false),
+        key_prefixes_(nullptr),
+        internal_key_prefixes_(false),
+        values_end_(0),
+        next_entry_offset_(0),
+        next_value_offset_(0),
         read_amp_bitmap_(nullptr),
         last_bitmap_offset_(0) {}
 
   BlockIter(const Comparator* comparator, const char* data, uint32_t restarts,
             uint32_t num_restarts, BlockPrefixIndex* prefix_index,
-            SequenceNumber global_seqno, BlockReadAmpBitmap* read_amp_bitmap)
+            SequenceNumber global_seqno, BlockReadAmpBitmap* read_amp_bitmap,
+            bool values_separated = false, bool key_only = false,
+            bool values_delta_encoded = false, bool keys_are_user_keys = false,
+            const char* key_prefixes = nullptr,
+            bool internal_key_prefixes = false)
       : BlockIter() {
     Initialize(comparator, data, restarts, num_restarts, prefix_index,
-               global_seqno, read_amp_bitmap);
+               global_seqno, read_amp_bitmap, values_separated, key_only,
+               values_delta_encoded, keys_are_user_keys, key_prefixes,
+               internal_key_prefixes);
   }
 
   void Initialize(const Comparator* comparator, const char* data,
                   uint32_t restarts, uint32_t num_restarts,
                   BlockPrefixIndex* prefix_index, SequenceNumber global_seqno,
-                  BlockReadAmpBitmap* read_amp_bitmap) {
+                  BlockReadAmpBitmap* read_amp_bitmap,
+                  bool values_separated = false, bool key_only = false,
+                  bool values_delta_encoded = false,
+                  bool keys_are_user_keys = false,
+                  const char* key_prefixes = nullptr,
+                  bool internal_key_prefixes = false) {
     assert(data_ == nullptr);           // Ensure it is called only once
     assert(num_restarts > 0);           // Ensure the param is valid
 
@@ -252,6 +292,14 @@ class BlockIter : public InternalIterator {
     restart_index_ = num_restarts_;
     prefix_index_ = prefix_index;
     global_seqno_ = global_seqno;
+    values_separated_ = values_separated;
+    key_only_ = key_only;
+    values_delta_encoded_ = values_delta_encoded;
+    keys_are_user_keys_ = keys_are_user_keys;
+    key_prefixes_ = key_prefixes;
+    internal_key_prefixes_ = internal_key_prefixes;
+    // The values end where the first key entry starts
+    values_end_ = values_separated_ ? GetRestartPoint(0) : 0;
     read_amp_bitmap_ = read_amp_bitmap;
     last_bitmap_offset_ = current_ + 1;
   }
@@ -264,14 +312,22 @@ class BlockIter : public InternalIterator {
   virtual Status status() const override { return status_; }
   virtual Slice key() const override {
     assert(Valid());
-    return key_.GetKey();
+    return keys_are_user_keys_ ? internal_key_.GetKey() : key_.GetKey();
   }
   virtual Slice value() const override {
     assert(Valid());
+    if (key_only_) {
+      return Slice();
+    }
     if (read_amp_bitmap_ && current_ < restarts_ &&
         current_ != last_bitmap_offset_) {
       read_amp_bitmap_->Mark(current_ /* current entry offset */,
                              NextEntryOffset() - 1);
+      if (values_separated_ && !value_.empty()) {
+        read_amp_bitmap_->Mark(ValueOffset(), static_cast<uint32_t>(
+                                                  ValueOffset() +
+                                                  value_.size() - 1));
+      }
       last_bitmap_offset_ = current_;
     }
     return value_;
@@ -302,9 +358,13 @@ class BlockIter : public InternalIterator {
   PinnedIteratorsManager* pinned_iters_mgr_ = nullptr;
 #endif
 
-  virtual bool IsKeyPinned() const override { return key_pinned_; }
+  virtual bool IsKeyPinned() const override {
+    return key_pinned_ && !keys_are_user_keys_;
+  }
 
-  virtual bool IsValuePinned() const override { return true; }
+  virtual bool IsValuePinned() const override {
+    return !values_delta_encoded_;
+  }
 
   size_t TEST_CurrentEntrySize() { return NextEntryOffset() - current_; }
 
@@ -327,6 +387,31 @@ class BlockIter : public InternalIterator {
   BlockPrefixIndex* prefix_index_;
   bool key_pinned_;
   SequenceNumber global_seqno_;
+  // If values_separated_, the key entries only hold the lengths of the values,
+  // which are stored in order in [0, values_end_). next_entry_offset_ and
+  // next_value_offset_ are the offsets of the next key entry and its value.
+  bool values_separated_;
+  bool key_only_;
+  // If values_delta_encoded_, the values are block handles, decoded into
+  // decoded_handle_ and encoded in full into value_buf_. Past the restart
+  // points, the entries only hold the size of the block, which follows the
+  // block of the previous entry. The key entries end at next_entry_offset_.
+  bool values_delta_encoded_;
+  BlockHandle decoded_handle_;
+  char value_buf_[BlockHandle::kMaxEncodedLength];
+  // If keys_are_user_keys_, key_ holds user keys and key() returns
+  // internal_key_, the internal key that sorts after every entry of the user
+  // key.
+  bool keys_are_user_keys_;
+  IterKey internal_key_;
+  // If not null, the prefixes of the keys of the restart points, see
+  // BlockKeyPrefix(). They are the prefixes of the user keys if
+  // internal_key_prefixes_.
+  const char* key_prefixes_;
+  bool internal_key_prefixes_;
+  uint32_t values_end_;
+  uint32_t next_entry_offset_;
+  uint32_t next_value_offset_;
 
   // read-amp bitmap
   BlockReadAmpBitmap* read_amp_bitmap_;
@@ -352,6 +437,8 @@ class BlockIter : public InternalIterator {
     size_t key_size;
     // value slice pointing to data in block
     Slice value;
+    // decoded value, if the values are delta-encoded
+    BlockHandle handle;
   };
   std::string prev_entries_keys_buff_;
   std::vector<CachedPrevEntry> prev_entries_;
@@ -363,6 +450,9 @@ class BlockIter : public InternalIterator {
 
   // Return the offset in data_ just past the end of the current entry.
   inline uint32_t NextEntryOffset() const {
+    if (values_separated_ || values_delta_encoded_) {
+      return next_entry_offset_;
+    }
     // NOTE: We don't support blocks bigger than 2GB
     return static_cast<uint32_t>((value_.data() + value_.size()) - data_);
   }
@@ -372,6 +462,13 @@ class BlockIter : public InternalIterator {
     return DecodeFixed32(data_ + restarts_ + index * sizeof(uint32_t));
   }
 
+  // Offset of the value of the restart point, if values_separated_
+  uint32_t GetValueRestartPoint(uint32_t index) {
+    assert(values_separated_ && index < num_restarts_);
+    return DecodeFixed32(data_ + restarts_ +
+                         (num_restarts_ + index) * sizeof(uint32_t));
+  }
+
   void SeekToRestartPoint(uint32_t index) {
     key_.Clear();
     restart_index_ = index;
@@ -379,16 +476,41 @@ class BlockIter : public InternalIterator {
 
     // ParseNextKey() starts at the end of value_, so set value_ accordingly
     uint32_t offset = GetRestartPoint(index);
-    value_ = Slice(data_ + offset, 0);
+    if (values_separated_) {
+      next_entry_offset_ = offset;
+      next_value_offset_ = GetValueRestartPoint(index);
+      value_.clear();
+    } else if (values_delta_encoded_) {
+      next_entry_offset_ = offset;
+      value_.clear();
+    } else {
+      value_ = Slice(data_ + offset, 0);
+    }
   }
 
   void CorruptionError();
 
   bool ParseNextKey();
 
+  // Decode the value of the entry at current_, starting at p, into value_
+  bool ParseDeltaEncodedValue(const char* p, const char* limit);
+  // Point value_ to the encoding of decoded_handle_
+  void SetDecodedValue();
+  // Set internal_key_ from the user key in key_
+  void SetInternalKeyFromUserKey() {
+    // No internal key with the same user key sorts after (user key, 0,
+    // kTypeDeletion)
+    internal_key_.SetInternalKey(key_.GetKey(), 0, kTypeDeletion);
+  }
+
   bool BinarySeek(const Slice& target, uint32_t left, uint32_t right,
                   uint32_t* index);
 
+  // Narrow [*left, *right] down to the restart points whose key prefixes do
+  // not tell them apart from target
+  void NarrowByKeyPrefixes(const Slice& target, uint32_t* left,
+                           uint32_t* right);
+
   int CompareBlockKey(uint32_t block_index, const Slice& target);
 
   bool BinaryBlockIndexSeek(const Slice& target, uint32_t* block_ids,
@@ -13,12 +13,14 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#include <algorithm>
 #include <list>
 #include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "db/dbformat.h"
 
@@ -60,7 +62,8 @@ namespace {
 rocksdb::IndexBuilder* CreateIndexBuilder(
     IndexType index_type, const InternalKeyComparator* comparator,
     const SliceTransform* prefix_extractor, int index_block_restart_interval,
-    uint64_t index_per_partition);
+    uint64_t index_per_partition, bool compact_index_entries = false,
+    bool index_key_prefixes = false);
 }
 
 // The interface for building index.
@@ -134,6 +137,10 @@ class IndexBuilder {
   // Get the estimated size for index block.
   virtual size_t EstimatedSize() const = 0;
 
+  // Whether the keys of the index blocks are user keys rather than internal
+  // keys. Only valid once Finish() has been called.
+  virtual bool IndexKeysAreUserKeys() const { return false; }
+
  protected:
   const InternalKeyComparator* comparator_;
 };
@@ -147,16 +154,70 @@ class IndexBuilder {
 //  2. Shorten the key length for index block. Other than honestly using the
 //     last key in the data block as the index key, we instead find a shortest
 //     substitute key that serves the same function.
+//  3. If compact_entries is set (format_version 3), the handles past the
+//     restart points only store the size of their block, which follows the
+//     block of the previous entry. The keys are separators of the user keys,
+//     unless a user key spans two data blocks.
+//  4. If key_prefixes is set (format_version 4), the index block stores the
+//     key prefixes of its restart points, see BlockBuilder.
 class ShortenedIndexBuilder : public IndexBuilder {
  public:
   explicit ShortenedIndexBuilder(const InternalKeyComparator* comparator,
-                                 int index_block_restart_interval)
+                                 int index_block_restart_interval,
+                                 bool compact_entries = false,
+                                 bool key_prefixes = false)
       : IndexBuilder(comparator),
-        index_block_builder_(index_block_restart_interval) {}
+        index_block_builder_(index_block_restart_interval,
+                             true /* use_delta_encoding */,
+                             false /* separate_values */, compact_entries,
+                             key_prefixes, true /* internal_keys */),
+        user_key_index_block_builder_(index_block_restart_interval,
+                                      true /* use_delta_encoding */,
+                                      false /* separate_values */,
+                                      true /* delta_encode_values */,
+                                      key_prefixes, false /* internal_keys */),
+        compact_entries_(compact_entries),
+        keys_are_user_keys_(compact_entries) {}
 
   virtual void AddIndexEntry(std::string* last_key_in_current_block,
                              const Slice* first_key_in_next_block,
                              const BlockHandle& block_handle) override {
+    std::string handle_encoding;
+    block_handle.EncodeTo(&handle_encoding);
+    std::string size_encoding;
+    Slice size_slice;
+    const Slice* delta_value = nullptr;
+    if (compact_entries_ && !last_handle_.IsNull() &&
+        block_handle.offset() ==
+            last_handle_.offset() + last_handle_.size() + kBlockTrailerSize) {
+      PutVarint64(&size_encoding, block_handle.size());
+      size_slice = size_encoding;
+      delta_value = &size_slice;
+    }
+    last_handle_ = block_handle;
+
+    if (keys_are_user_keys_) {
+      // The separators of the user keys are the separators of the internal
+      // keys as long as no user key spans two data blocks
+      const Comparator* user_comparator = comparator_->user_comparator();
+      Slice last_user_key = ExtractUserKey(*last_key_in_current_block);
+      std::string separator(last_user_key.data(), last_user_key.size());
+      if (first_key_in_next_block == nullptr) {
+        user_comparator->FindShortSuccessor(&separator);
+      } else {
+        Slice next_user_key = ExtractUserKey(*first_key_in_next_block);
+        if (user_comparator->Compare(last_user_key, next_user_key) < 0) {
+          user_comparator->FindShortestSeparator(&separator, next_user_key);
+        } else {
+          keys_are_user_keys_ = false;
+        }
+      }
+      if (keys_are_user_keys_) {
+        user_key_index_block_builder_.Add(separator, handle_encoding,
+                                          delta_value);
+      }
+    }
+
     if (first_key_in_next_block != nullptr) {
       comparator_->FindShortestSeparator(last_key_in_current_block,
                                          *first_key_in_next_block);
@@ -164,24 +225,37 @@ class ShortenedIndexBuilder : public IndexBuilder {
       comparator_->FindShortSuccessor(last_key_in_current_block);
     }
 
-    std::string handle_encoding;
-    block_handle.EncodeTo(&handle_encoding);
-    index_block_builder_.Add(*last_key_in_current_block, handle_encoding);
+    index_block_builder_.Add(*last_key_in_current_block, handle_encoding,
+                             delta_value);
   }
 
   virtual Status Finish(
       IndexBlocks* index_blocks,
       const BlockHandle& last_partition_block_handle) override {
-    index_blocks->index_block_contents = index_block_builder_.Finish();
+    index_blocks->index_block_contents =
+        keys_are_user_keys_ ? user_key_index_block_builder_.Finish()
+                            : index_block_builder_.Finish();
     return Status::OK();
   }
 
   virtual size_t EstimatedSize() const override {
-    return index_block_builder_.CurrentSizeEstimate();
+    return keys_are_user_keys_
+               ? user_key_index_block_builder_.CurrentSizeEstimate()
+               : index_block_builder_.CurrentSizeEstimate();
+  }
+
+  virtual bool IndexKeysAreUserKeys() const override {
+    return keys_are_user_keys_;
   }
 
  private:
   BlockBuilder index_block_builder_;
+  // The same entries with user keys, while compact_entries_ and no user key
+  // spans two data blocks
+  BlockBuilder user_key_index_block_builder_;
+  const bool compact_entries_;
+  bool keys_are_user_keys_;
+  BlockHandle last_handle_ = BlockHandle::NullBlockHandle();
 };
 
 /**
@@ -407,11 +481,15 @@ IndexBuilder* CreateIndexBuilder(IndexType index_type,
                                  const InternalKeyComparator* comparator,
                                  const SliceTransform* prefix_extractor,
                                  int index_block_restart_interval,
-                                 uint64_t index_per_partition) {
+                                 uint64_t index_per_partition,
+                                 bool compact_index_entries,
+                                 bool index_key_prefixes) {
   switch (index_type) {
     case BlockBasedTableOptions::kBinarySearch: {
       return new ShortenedIndexBuilder(comparator,
-                                       index_block_restart_interval);
+                                       index_block_restart_interval,
+                                       compact_index_entries,
+                                       index_key_prefixes);
     }
     case BlockBasedTableOptions::kHashSearch: {
       return new HashIndexBuilder(comparator, prefix_extractor,
@@ -459,7 +537,7 @@ bool GoodCompressionRatio(size_t compressed_size, size_t raw_size) {
 Slice CompressBlock(const Slice& raw,
                     const CompressionOptions& compression_options,
                     CompressionType* type, uint32_t format_version,
-                    const Slice& compression_dict,
+                    const CompressionDict& compression_dict,
                     std::string* compressed_output) {
   if (*type == kNoCompression) {
     return raw;
@@ -479,7 +557,8 @@ Slice CompressBlock(const Slice& raw,
       if (Zlib_Compress(
               compression_options,
               GetCompressFormatForVersion(kZlibCompression, format_version),
-              raw.data(), raw.size(), compressed_output, compression_dict) &&
+              raw.data(), raw.size(), compressed_output,
+              compression_dict.GetRawDict()) &&
           GoodCompressionRatio(compressed_output->size(), raw.size())) {
         return *compressed_output;
       }
@@ -497,7 +576,8 @@ Slice CompressBlock(const Slice& raw,
       if (LZ4_Compress(
               compression_options,
               GetCompressFormatForVersion(kLZ4Compression, format_version),
-              raw.data(), raw.size(), compressed_output, compression_dict) &&
+              raw.data(), raw.size(), compressed_output,
+              compression_dict.GetRawDict()) &&
           GoodCompressionRatio(compressed_output->size(), raw.size())) {
         return *compressed_output;
       }
@@ -506,7 +586,8 @@ Slice CompressBlock(const Slice& raw,
       if (LZ4HC_Compress(
               compression_options,
               GetCompressFormatForVersion(kLZ4HCCompression, format_version),
-              raw.data(), raw.size(), compressed_output, compression_dict) &&
+              raw.data(), raw.size(), compressed_output,
+              compression_dict.GetRawDict()) &&
           GoodCompressionRatio(compressed_output->size(), raw.size())) {
         return *compressed_output;
       }
@@ -535,6 +616,161 @@ Slice CompressBlock(const Slice& raw,
   return raw;
 }
 
+namespace {
+
+// Picks the compression type of each data block among
+// BlockBasedTableOptions::adaptive_compression_candidates. The ratio and the
+// CPU cost of every candidate are measured on the sampled blocks and
+// averaged with more weight on the recent samples, so that the choice
+// follows the data as it changes along the table.
+class AdaptiveCompression {
+ public:
+  AdaptiveCompression(const BlockBasedTableOptions& table_options,
+                      const CompressionOptions& compression_options, Env* env)
+      : compression_options_(compression_options),
+        format_version_(table_options.format_version),
+        sampling_interval_(
+            std::max(table_options.adaptive_compression_sampling_interval,
+                     1u)),
+        max_nanos_per_kb_(table_options.adaptive_compression_max_nanos_per_kb),
+        env_(env) {
+    for (auto type : table_options.adaptive_compression_candidates) {
+      candidates_.emplace_back(type);
+    }
+  }
+
+  // Compresses raw like CompressBlock() but with the type picked for it,
+  // which is returned in *type
+  Slice Compress(const Slice& raw, const CompressionDict& compression_dict,
+                 CompressionType* type, std::string* compressed_output) {
+    if (num_blocks_++ % sampling_interval_ != 0) {
+      if (picked_ < 0) {
+        *type = kNoCompression;
+        return raw;
+      }
+      *type = candidates_[picked_].type;
+      return CompressBlock(raw, compression_options_, type, format_version_,
+                           compression_dict, compressed_output);
+    }
+
+    std::vector<double> block_ratios;
+    for (auto& candidate : candidates_) {
+      CompressionType candidate_type = candidate.type;
+      candidate.output.clear();
+      const uint64_t start = env_->NowNanos();
+      Slice compressed =
+          CompressBlock(raw, compression_options_, &candidate_type,
+                        format_version_, compression_dict, &candidate.output);
+      const double nanos_per_kb = (env_->NowNanos() - start) * 1024.0 /
+                                  std::max<size_t>(raw.size(), 1);
+      // Unsupported types and ratios that are not good enough count as no
+      // compression
+      const double ratio =
+          candidate_type == kNoCompression
+              ? 1.0
+              : static_cast<double>(compressed.size()) / raw.size();
+      block_ratios.push_back(ratio);
+      if (num_blocks_ == 1) {
+        candidate.ratio = ratio;
+        candidate.nanos_per_kb = nanos_per_kb;
+      } else {
+        candidate.ratio += kSampleWeight * (ratio - candidate.ratio);
+        candidate.nanos_per_kb +=
+            kSampleWeight * (nanos_per_kb - candidate.nanos_per_kb);
+      }
+    }
+
+    std::vector<double> average_ratios;
+    for (const auto& candidate : candidates_) {
+      average_ratios.push_back(candidate.ratio);
+    }
+    picked_ = Best(average_ratios);
+
+    const int best = Best(block_ratios);
+    if (best < 0) {
+      *type = kNoCompression;
+      return raw;
+    }
+    *type = candidates_[best].type;
+    compressed_output->swap(candidates_[best].output);
+    return *compressed_output;
+  }
+
+  // Counts a data block written with type
+  void AddBlock(CompressionType type) { ++block_counts_[type]; }
+
+  // Value of BlockBasedTablePropertyNames::kDataBlockCompressionTypes
+  std::string BlockCounts() const {
+    std::string result;
+    for (const auto& count : block_counts_) {
+      if (!result.empty()) {
+        result.append(";");
+      }
+      result.append(CompressionTypeToString(count.first));
+      result.append("=");
+      result.append(ToString(count.second));
+    }
+    return result;
+  }
+
+ private:
+  struct Candidate {
+    explicit Candidate(CompressionType _type) : type(_type) {}
+
+    CompressionType type;
+    // Compressed size over raw size
+    double ratio = 1.0;
+    double nanos_per_kb = 0;
+    std::string output;
+  };
+
+  // Weight of the last sample in the averages of the candidates
+  static constexpr double kSampleWeight = 0.25;
+  // Same threshold as GoodCompressionRatio()
+  static constexpr double kMaxGoodRatio = 0.875;
+
+  // Index of the candidate with the best of ratios within the CPU budget,
+  // or the cheapest one when none fits the budget, among the candidates
+  // that compress well enough. -1 if none does.
+  int Best(const std::vector<double>& ratios) const {
+    int best = -1;
+    bool best_fits = false;
+    for (size_t i = 0; i < candidates_.size(); ++i) {
+      if (ratios[i] >= kMaxGoodRatio) {
+        continue;
+      }
+      const bool fits = max_nanos_per_kb_ == 0 ||
+                        candidates_[i].nanos_per_kb <= max_nanos_per_kb_;
+      bool better;
+      if (best < 0 || fits != best_fits) {
+        better = best < 0 || fits;
+      } else if (fits) {
+        better = ratios[i] < ratios[best];
+      } else {
+        better = candidates_[i].nanos_per_kb < candidates_[best].nanos_per_kb;
+      }
+      if (better) {
+        best = static_cast<int>(i);
+        best_fits = fits;
+      }
+    }
+    return best;
+  }
+
+  const CompressionOptions compression_options_;
+  const uint32_t format_version_;
+  const uint32_t sampling_interval_;
+  const uint64_t max_nanos_per_kb_;
+  Env* env_;
+  std::vector<Candidate> candidates_;
+  uint64_t num_blocks_ = 0;
+  // Candidate for the blocks that are not sampled, -1 for no compression
+  int picked_ = -1;
+  std::map<CompressionType, uint64_t> block_counts_;
+};
+
+}  // namespace
+
 // kBlockBasedTableMagicNumber was picked by running
 //    echo rocksdb.table.block_based | sha1sum
 // and taking the leading 64 bits.
@@ -604,6 +840,9 @@ struct BlockBasedTableBuilder::Rep {
   WritableFileWriter* file;
   uint64_t offset = 0;
   Status status;
+  // Whether the data and index blocks store the key prefixes of their restart
+  // points
+  const bool key_prefixes;
   BlockBuilder data_block;
   BlockBuilder range_del_block;
 
@@ -615,6 +854,10 @@ struct BlockBasedTableBuilder::Rep {
   const CompressionOptions compression_opts;
   // Data for presetting the compression library's dictionary, or nullptr.
   const std::string* compression_dict;
+  // compression_dict digested once for compressing the data blocks, and for
+  // verifying them if verify_compression is set
+  const CompressionDict data_block_compression_dict;
+  const UncompressionDict data_block_verify_dict;
   TableProperties props;
 
   bool closed = false;  // Either Finish() or Abandon() has been called.
@@ -625,6 +868,9 @@ struct BlockBasedTableBuilder::Rep {
   BlockHandle pending_handle;  // Handle to add to index block
 
   std::string compressed_output;
+  // Set when BlockBasedTableOptions::adaptive_compression_candidates is not
+  // empty
+  std::unique_ptr<AdaptiveCompression> adaptive_compression;
   std::unique_ptr<FlushBlockPolicy> flush_block_policy;
   uint32_t column_family_id;
   const std::string& column_family_name;
@@ -645,18 +891,35 @@ struct BlockBasedTableBuilder::Rep {
         table_options(table_opt),
         internal_comparator(icomparator),
         file(f),
+        // Key prefixes are only ordered like the keys with the bytewise
+        // comparator
+        key_prefixes(table_options.format_version >= 4 &&
+                     icomparator.user_comparator() == BytewiseComparator()),
         data_block(table_options.block_restart_interval,
-                   table_options.use_delta_encoding),
+                   table_options.use_delta_encoding,
+                   table_options.separate_data_block_values,
+                   false /* delta_encode_values */, key_prefixes,
+                   true /* internal_keys */),
         range_del_block(1),  // TODO(andrewkr): restart_interval unnecessary
         internal_prefix_transform(_ioptions.prefix_extractor),
         index_builder(
             CreateIndexBuilder(table_options.index_type, &internal_comparator,
                                &this->internal_prefix_transform,
                                table_options.index_block_restart_interval,
-                               table_options.index_per_partition)),
+                               table_options.index_per_partition,
+                               table_options.format_version >= 3,
+                               key_prefixes)),
         compression_type(_compression_type),
         compression_opts(_compression_opts),
         compression_dict(_compression_dict),
+        data_block_compression_dict(
+            _compression_dict ? Slice(*_compression_dict) : Slice(),
+            _compression_type, _compression_opts.level),
+        data_block_verify_dict(
+            _compression_dict && table_opt.verify_compression
+                ? Slice(*_compression_dict)
+                : Slice(),
+            _compression_type),
         filter_block(skip_filters ? nullptr : CreateFilterBlockBuilder(
                                                   _ioptions, table_options)),
         flush_block_policy(
@@ -672,6 +935,10 @@ struct BlockBasedTableBuilder::Rep {
         new BlockBasedTablePropertiesCollector(
             table_options.index_type, table_options.whole_key_filtering,
             _ioptions.prefix_extractor != nullptr));
+    if (!table_options.adaptive_compression_candidates.empty()) {
+      adaptive_compression.reset(new AdaptiveCompression(
+          table_options, compression_opts, _ioptions.env));
+    }
   }
 };
 
@@ -816,15 +1083,20 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
     ShouldReportDetailedTime(r->ioptions.env, r->ioptions.statistics));
 
   if (raw_block_contents.size() < kCompressionSizeLimit) {
-    Slice compression_dict;
-    if (is_data_block && r->compression_dict && r->compression_dict->size()) {
-      compression_dict = *r->compression_dict;
+    const CompressionDict& compression_dict =
+        is_data_block ? r->data_block_compression_dict
+                      : CompressionDict::GetEmptyDict();
+
+    if (is_data_block && r->adaptive_compression != nullptr &&
+        type != kNoCompression) {
+      block_contents = r->adaptive_compression->Compress(
+          raw_block_contents, compression_dict, &type, &r->compressed_output);
+    } else {
+      block_contents = CompressBlock(raw_block_contents, r->compression_opts,
+                                     &type, r->table_options.format_version,
+                                     compression_dict, &r->compressed_output);
     }
 
-    block_contents = CompressBlock(raw_block_contents, r->compression_opts,
-                                   &type, r->table_options.format_version,
-                                   compression_dict, &r->compressed_output);
-
     // Some of the compression algorithms are known to be unreliable. If
     // the verify_compression flag is set then try to de-compress the
     // compressed data and compare to the input.
@@ -833,8 +1105,10 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
       BlockContents contents;
       Status stat = UncompressBlockContentsForCompressionType(
           block_contents.data(), block_contents.size(), &contents,
-          r->table_options.format_version, compression_dict, type,
-          r->ioptions);
+          r->table_options.format_version,
+          is_data_block ? r->data_block_verify_dict
+                        : UncompressionDict::GetEmptyDict(),
+          type, r->ioptions);
 
       if (stat.ok()) {
         bool compressed_ok = contents.data.compare(raw_block_contents) == 0;
@@ -873,6 +1147,9 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
     RecordTick(r->ioptions.statistics, NUMBER_BLOCK_COMPRESSED);
   }
 
+  if (is_data_block && r->adaptive_compression != nullptr) {
+    r->adaptive_compression->AddBlock(type);
+  }
   WriteRawBlock(block_contents, type, handle);
   r->compressed_output.clear();
 }
@@ -901,11 +1178,21 @@ void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
         break;
       }
       case kxxHash: {
-        void* xxh = XXH32_init(0);
-        XXH32_update(xxh, block_contents.data(),
+        XXH32_stateSpace_t xxh;
+        XXH32_resetState(&xxh, 0);
+        XXH32_update(&xxh, block_contents.data(),
                      static_cast<uint32_t>(block_contents.size()));
-        XXH32_update(xxh, trailer, 1);  // Extend  to cover block type
-        EncodeFixed32(trailer_without_type, XXH32_digest(xxh));
+        XXH32_update(&xxh, trailer, 1);  // Extend  to cover block type
+        EncodeFixed32(trailer_without_type, XXH32_intermediateDigest(&xxh));
+        break;
+      }
+      case kxxHash64: {
+        XXH64_state_t xxh;
+        XXH64_reset(&xxh, 0);
+        XXH64_update(&xxh, block_contents.data(), block_contents.size());
+        XXH64_update(&xxh, trailer, 1);  // Extend  to cover block type
+        EncodeFixed32(trailer_without_type,
+                      static_cast<uint32_t>(XXH64_digest(&xxh)));
         break;
       }
     }
@@ -1072,6 +1359,15 @@ Status BlockBasedTableBuilder::Finish() {
       NotifyCollectTableCollectorsOnFinish(r->table_properties_collectors,
                                            r->ioptions.info_log,
                                            &property_block_builder);
+      if (r->adaptive_compression != nullptr) {
+        property_block_builder.Add(
+            BlockBasedTablePropertyNames::kDataBlockCompressionTypes,
+            r->adaptive_compression->BlockCounts());
+      }
+      if (r->index_builder->IndexKeysAreUserKeys()) {
+        property_block_builder.Add(
+            BlockBasedTablePropertyNames::kIndexKeyIsUserKey, kPropTrue);
+      }
 
       BlockHandle properties_block_handle;
       WriteRawBlock(
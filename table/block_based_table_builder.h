@@ -23,6 +23,7 @@ namespace rocksdb {
 
 class BlockBuilder;
 class BlockHandle;
+class CompressionDict;
 class WritableFile;
 struct BlockBasedTableOptions;
 
@@ -121,7 +122,7 @@ class BlockBasedTableBuilder : public TableBuilder {
 Slice CompressBlock(const Slice& raw,
                     const CompressionOptions& compression_options,
                     CompressionType* type, uint32_t format_version,
-                    const Slice& compression_dict,
+                    const CompressionDict& compression_dict,
                     std::string* compressed_output);
 
 }  // namespace rocksdb
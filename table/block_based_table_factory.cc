@@ -10,6 +10,7 @@
 
 #include "table/block_based_table_factory.h"
 
+#include <inttypes.h>
 #include <memory>
 #include <string>
 #include <stdint.h>
@@ -94,6 +95,11 @@ Status BlockBasedTableFactory::SanitizeOptions(
         "Enable pin_l0_filter_and_index_blocks_in_cache, "
         ", but block cache is disabled");
   }
+  if (!table_options_.adaptive_compression_candidates.empty() &&
+      table_options_.adaptive_compression_sampling_interval == 0) {
+    return Status::InvalidArgument(
+        "adaptive_compression_sampling_interval must not be 0");
+  }
   if (!BlockBasedTableSupportedVersion(table_options_.format_version)) {
     return Status::InvalidArgument(
         "Unsupported BlockBasedTable format_version. Please check "
@@ -162,6 +168,9 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
     ret.append("  block_cache_compressed_options:\n");
     ret.append(table_options_.block_cache_compressed->GetPrintableOptions());
   }
+  snprintf(buffer, kBufferSize, "  block_cache_tracer: %p\n",
+           static_cast<void*>(table_options_.block_cache_tracer.get()));
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  persistent_cache: %p\n",
            static_cast<void*>(table_options_.persistent_cache.get()));
   ret.append(buffer);
@@ -182,6 +191,9 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  index_block_restart_interval: %d\n",
            table_options_.index_block_restart_interval);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  separate_data_block_values: %d\n",
+           table_options_.separate_data_block_values);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  filter_policy: %s\n",
            table_options_.filter_policy == nullptr ?
              "nullptr" : table_options_.filter_policy->Name());
@@ -192,9 +204,30 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  skip_table_builder_flush: %d\n",
            table_options_.skip_table_builder_flush);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  verify_persistent_cache_checksums: %d\n",
+           table_options_.verify_persistent_cache_checksums);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  format_version: %d\n",
            table_options_.format_version);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  max_auto_readahead_size: %" ROCKSDB_PRIszt
+           "\n",
+           table_options_.max_auto_readahead_size);
+  ret.append(buffer);
+  ret.append("  adaptive_compression_candidates:");
+  for (auto type : table_options_.adaptive_compression_candidates) {
+    ret.append(" ");
+    ret.append(CompressionTypeToString(type));
+  }
+  ret.append("\n");
+  snprintf(buffer, kBufferSize,
+           "  adaptive_compression_sampling_interval: %u\n",
+           table_options_.adaptive_compression_sampling_interval);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize,
+           "  adaptive_compression_max_nanos_per_kb: %" PRIu64 "\n",
+           table_options_.adaptive_compression_max_nanos_per_kb);
+  ret.append(buffer);
   return ret;
 }
 
@@ -213,6 +246,10 @@ const std::string BlockBasedTablePropertyNames::kWholeKeyFiltering =
     "rocksdb.block.based.table.whole.key.filtering";
 const std::string BlockBasedTablePropertyNames::kPrefixFiltering =
     "rocksdb.block.based.table.prefix.filtering";
+const std::string BlockBasedTablePropertyNames::kDataBlockCompressionTypes =
+    "rocksdb.block.based.table.data.block.compression.types";
+const std::string BlockBasedTablePropertyNames::kIndexKeyIsUserKey =
+    "rocksdb.block.based.table.index.key.is.user.key";
 const std::string kHashIndexPrefixesBlock = "rocksdb.hashindex.prefixes";
 const std::string kHashIndexPrefixesMetadataBlock =
     "rocksdb.hashindex.metadata";
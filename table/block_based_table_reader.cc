@@ -11,6 +11,8 @@
 #include <algorithm>
 #include <limits>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -62,19 +64,20 @@ namespace {
 // The only relevant option is options.verify_checksums for now.
 // On failure return non-OK.
 // On success fill *result and return OK - caller owns *result
-// @param compression_dict Data for presetting the compression library's
+// @param uncompression_dict Data for presetting the compression library's
 //    dictionary.
 Status ReadBlockFromFile(RandomAccessFileReader* file, const Footer& footer,
                          const ReadOptions& options, const BlockHandle& handle,
                          std::unique_ptr<Block>* result,
                          const ImmutableCFOptions& ioptions, bool do_uncompress,
-                         const Slice& compression_dict,
+                         const UncompressionDict& uncompression_dict,
                          const PersistentCacheOptions& cache_options,
                          SequenceNumber global_seqno,
                          size_t read_amp_bytes_per_bit) {
   BlockContents contents;
-  Status s = ReadBlockContents(file, footer, options, handle, &contents, ioptions,
-                               do_uncompress, compression_dict, cache_options);
+  Status s =
+      ReadBlockContents(file, footer, options, handle, &contents, ioptions,
+                        do_uncompress, uncompression_dict, cache_options);
   if (s.ok()) {
     result->reset(new Block(std::move(contents), global_seqno,
                             read_amp_bytes_per_bit, ioptions.statistics));
@@ -99,6 +102,35 @@ void DeleteCachedEntry(const Slice& key, void* value) {
 void DeleteCachedFilterEntry(const Slice& key, void* value);
 void DeleteCachedIndexEntry(const Slice& key, void* value);
 
+// A data block saved to the compressed tier of the block cache is its
+// global seqno followed by its uncompressed contents.
+void SaveBlockToCacheTier(void* value, std::string* output) {
+  auto block = reinterpret_cast<Block*>(value);
+  PutFixed64(output, block->global_seqno());
+  output->append(block->data(), block->size());
+}
+
+Status CreateBlockFromCacheTier(const Slice& data, void** value,
+                                size_t* charge) {
+  if (data.size() < sizeof(uint64_t)) {
+    return Status::Corruption("Block in compressed tier is too short");
+  }
+  SequenceNumber global_seqno = DecodeFixed64(data.data());
+  size_t size = data.size() - sizeof(uint64_t);
+  std::unique_ptr<char[]> buf(new char[size]);
+  memcpy(buf.get(), data.data() + sizeof(uint64_t), size);
+  auto block = new Block(
+      BlockContents(std::move(buf), size, true /* cachable */, kNoCompression),
+      global_seqno);
+  *value = block;
+  *charge = block->usable_size();
+  return Status::OK();
+}
+
+const CacheTierHelper kDataBlockCacheTierHelper = {
+    &SaveBlockToCacheTier, &CreateBlockFromCacheTier,
+    &DeleteCachedEntry<Block>};
+
 // Release the cached entry and decrement its ref count.
 void ReleaseCachedEntry(void* arg, void* h) {
   Cache* cache = reinterpret_cast<Cache*>(arg);
@@ -141,6 +173,15 @@ Cache::Handle* GetEntryFromCache(Cache* block_cache, const Slice& key,
   return cache_handle;
 }
 
+// Count a block read from the file in perf_context
+void RecordBlockRead(TraceBlockType block_type) {
+  if (block_type == TraceBlockType::kDataBlock) {
+    PERF_COUNTER_ADD(data_block_read_count, 1);
+  } else if (block_type == TraceBlockType::kIndexBlock) {
+    PERF_COUNTER_ADD(index_block_read_count, 1);
+  }
+}
+
 }  // namespace
 
 // -- IndexReader and its subclasses
@@ -159,8 +200,11 @@ class BlockBasedTable::IndexReader {
   // wrapps the passed iter. In the latter case the return value would point to
   // a different object then iter and the callee has the ownership of the
   // returned object.
-  virtual InternalIterator* NewIterator(BlockIter* iter = nullptr,
-                                        bool total_order_seek = true) = 0;
+  // caller is passed on to the lookups of index partitions in the block
+  // cache.
+  virtual InternalIterator* NewIterator(
+      BlockIter* iter = nullptr, bool total_order_seek = true,
+      TableReaderCaller caller = TableReaderCaller::kOther) = 0;
 
   // The size of the index.
   virtual size_t size() const = 0;
@@ -194,8 +238,10 @@ class PartitionIndexReader : public IndexReader {
     std::unique_ptr<Block> index_block;
     auto s = ReadBlockFromFile(
         file, footer, ReadOptions(), index_handle, &index_block, ioptions,
-        true /* decompress */, Slice() /*compression dict*/, cache_options,
+        true /* decompress */, UncompressionDict::GetEmptyDict(),
+        cache_options,
         kDisableGlobalSequenceNumber, 0 /* read_amp_bytes_per_bit */);
+    RecordBlockRead(TraceBlockType::kIndexBlock);
 
     if (s.ok()) {
       *index_reader = new PartitionIndexReader(
@@ -206,11 +252,12 @@ class PartitionIndexReader : public IndexReader {
   }
 
   // return a two-level iterator: first level is on the partition index
-  virtual InternalIterator* NewIterator(BlockIter* iter = nullptr,
-                                        bool dont_care = true) override {
+  virtual InternalIterator* NewIterator(
+      BlockIter* iter = nullptr, bool dont_care = true,
+      TableReaderCaller caller = TableReaderCaller::kOther) override {
     return NewTwoLevelIterator(
-        new BlockBasedTable::BlockEntryIteratorState(table_, ReadOptions(),
-                                                     false),
+        new BlockBasedTable::BlockEntryIteratorState(
+            table_, ReadOptions(), false, TraceBlockType::kIndexBlock, caller),
         index_block_->NewIterator(comparator_, iter, true));
   }
 
@@ -245,28 +292,38 @@ class BinarySearchIndexReader : public IndexReader {
   // `BinarySearchIndexReader`.
   // On success, index_reader will be populated; otherwise it will remain
   // unmodified.
+  //
+  // If keys_are_user_keys is true, comparator compares the user keys of the
+  // index block.
   static Status Create(RandomAccessFileReader* file, const Footer& footer,
                        const BlockHandle& index_handle,
                        const ImmutableCFOptions &ioptions,
                        const Comparator* comparator, IndexReader** index_reader,
-                       const PersistentCacheOptions& cache_options) {
+                       const PersistentCacheOptions& cache_options,
+                       bool keys_are_user_keys = false) {
     std::unique_ptr<Block> index_block;
     auto s = ReadBlockFromFile(
         file, footer, ReadOptions(), index_handle, &index_block, ioptions,
-        true /* decompress */, Slice() /*compression dict*/, cache_options,
+        true /* decompress */, UncompressionDict::GetEmptyDict(),
+        cache_options,
         kDisableGlobalSequenceNumber, 0 /* read_amp_bytes_per_bit */);
+    RecordBlockRead(TraceBlockType::kIndexBlock);
 
     if (s.ok()) {
       *index_reader = new BinarySearchIndexReader(
-          comparator, std::move(index_block), ioptions.statistics);
+          comparator, std::move(index_block), ioptions.statistics,
+          keys_are_user_keys);
     }
 
     return s;
   }
 
-  virtual InternalIterator* NewIterator(BlockIter* iter = nullptr,
-                                        bool dont_care = true) override {
-    return index_block_->NewIterator(comparator_, iter, true);
+  virtual InternalIterator* NewIterator(
+      BlockIter* iter = nullptr, bool dont_care = true,
+      TableReaderCaller caller = TableReaderCaller::kOther) override {
+    return index_block_->NewIterator(comparator_, iter, true, nullptr,
+                                     false /* key_only */,
+                                     keys_are_user_keys_);
   }
 
   virtual size_t size() const override { return index_block_->size(); }
@@ -282,11 +339,14 @@ class BinarySearchIndexReader : public IndexReader {
  private:
   BinarySearchIndexReader(const Comparator* comparator,
                           std::unique_ptr<Block>&& index_block,
-                          Statistics* stats)
-      : IndexReader(comparator, stats), index_block_(std::move(index_block)) {
+                          Statistics* stats, bool keys_are_user_keys)
+      : IndexReader(comparator, stats),
+        index_block_(std::move(index_block)),
+        keys_are_user_keys_(keys_are_user_keys) {
     assert(index_block_ != nullptr);
   }
   std::unique_ptr<Block> index_block_;
+  const bool keys_are_user_keys_;
 };
 
 // Index that leverages an internal hash table to quicken the lookup for a given
@@ -305,8 +365,10 @@ class HashIndexReader : public IndexReader {
     std::unique_ptr<Block> index_block;
     auto s = ReadBlockFromFile(
         file, footer, ReadOptions(), index_handle, &index_block, ioptions,
-        true /* decompress */, Slice() /*compression dict*/, cache_options,
+        true /* decompress */, UncompressionDict::GetEmptyDict(),
+        cache_options,
         kDisableGlobalSequenceNumber, 0 /* read_amp_bytes_per_bit */);
+    RecordBlockRead(TraceBlockType::kIndexBlock);
 
     if (!s.ok()) {
       return s;
@@ -343,14 +405,14 @@ class HashIndexReader : public IndexReader {
     BlockContents prefixes_contents;
     s = ReadBlockContents(file, footer, ReadOptions(), prefixes_handle,
                           &prefixes_contents, ioptions, true /* decompress */,
-                          Slice() /*compression dict*/, cache_options);
+                          UncompressionDict::GetEmptyDict(), cache_options);
     if (!s.ok()) {
       return s;
     }
     BlockContents prefixes_meta_contents;
     s = ReadBlockContents(file, footer, ReadOptions(), prefixes_meta_handle,
                           &prefixes_meta_contents, ioptions, true /* decompress */,
-                          Slice() /*compression dict*/, cache_options);
+                          UncompressionDict::GetEmptyDict(), cache_options);
     if (!s.ok()) {
       // TODO: log error
       return Status::OK();
@@ -367,8 +429,9 @@ class HashIndexReader : public IndexReader {
     return Status::OK();
   }
 
-  virtual InternalIterator* NewIterator(BlockIter* iter = nullptr,
-                                        bool total_order_seek = true) override {
+  virtual InternalIterator* NewIterator(
+      BlockIter* iter = nullptr, bool total_order_seek = true,
+      TableReaderCaller caller = TableReaderCaller::kOther) override {
     return index_block_->NewIterator(comparator_, iter, total_order_seek);
   }
 
@@ -430,10 +493,13 @@ struct BlockBasedTable::Rep {
         filter_policy(skip_filters ? nullptr : _table_opt.filter_policy.get()),
         internal_comparator(_internal_comparator),
         filter_type(FilterType::kNoFilter),
+        uncompression_dict(new UncompressionDict()),
         whole_key_filtering(_table_opt.whole_key_filtering),
         prefix_filtering(true),
+        index_key_is_user_key(false),
         range_del_handle(BlockHandle::NullBlockHandle()),
-        global_seqno(kDisableGlobalSequenceNumber) {}
+        global_seqno(kDisableGlobalSequenceNumber),
+        level(-1) {}
 
   const ImmutableCFOptions& ioptions;
   const EnvOptions& env_options;
@@ -474,10 +540,15 @@ struct BlockBasedTable::Rep {
   // is easier because the Slice member depends on the continued existence of
   // another member ("allocation").
   std::unique_ptr<const BlockContents> compression_dict_block;
+  // The dictionary of compression_dict_block, digested once for the
+  // compression library of the table. Empty if the table has no dictionary.
+  std::unique_ptr<const UncompressionDict> uncompression_dict;
   BlockBasedTableOptions::IndexType index_type;
   bool hash_index_allow_collision;
   bool whole_key_filtering;
   bool prefix_filtering;
+  // Whether the keys of the binary search index are user keys
+  bool index_key_is_user_key;
   // TODO(kailiu) It is very ugly to use internal key in table, since table
   // module should not be relying on db module. However to make things easier
   // and compatible with existing code, we introduce a wrapper that allows
@@ -502,6 +573,10 @@ struct BlockBasedTable::Rep {
   // A value of kDisableGlobalSequenceNumber means that this feature is disabled
   // and every key have it's own seqno.
   SequenceNumber global_seqno;
+
+  // Level of the table in the LSM tree, -1 if unknown. Only used to label
+  // block cache trace records.
+  int level;
 };
 
 BlockBasedTable::~BlockBasedTable() {
@@ -672,6 +747,7 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
   rep->footer = footer;
   rep->index_type = table_options.index_type;
   rep->hash_index_allow_collision = table_options.hash_index_allow_collision;
+  rep->level = level;
   // We need to wrap data with internal_prefix_transform to make sure it can
   // handle prefix correctly.
   rep->internal_prefix_transform.reset(
@@ -680,11 +756,12 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
   unique_ptr<BlockBasedTable> new_table(new BlockBasedTable(rep));
 
   // page cache options
-  rep->persistent_cache_options =
-      PersistentCacheOptions(rep->table_options.persistent_cache,
-                             std::string(rep->persistent_cache_key_prefix,
-                                         rep->persistent_cache_key_prefix_size),
-                                         rep->ioptions.statistics);
+  rep->persistent_cache_options = PersistentCacheOptions(
+      rep->table_options.persistent_cache,
+      std::string(rep->persistent_cache_key_prefix,
+                  rep->persistent_cache_key_prefix_size),
+      rep->ioptions.statistics,
+      rep->table_options.verify_persistent_cache_checksums);
 
   // Read meta index
   std::unique_ptr<Block> meta;
@@ -762,6 +839,23 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
           s.ToString().c_str());
     } else {
       rep->compression_dict_block = std::move(compression_dict_block);
+      // Only the data blocks of the table's own compression type, or of the
+      // types adaptive compression picked, use the dictionary
+      CompressionType dict_compression_type = kNoCompression;
+      if (rep->table_properties) {
+        const std::string zstd_name = CompressionTypeToString(kZSTD);
+        const auto& user_props =
+            rep->table_properties->user_collected_properties;
+        auto block_types = user_props.find(
+            BlockBasedTablePropertyNames::kDataBlockCompressionTypes);
+        if (rep->table_properties->compression_name == zstd_name ||
+            (block_types != user_props.end() &&
+             block_types->second.find(zstd_name + "=") != std::string::npos)) {
+          dict_compression_type = kZSTD;
+        }
+      }
+      rep->uncompression_dict.reset(new UncompressionDict(
+          rep->compression_dict_block->data, dict_compression_type));
     }
   }
 
@@ -776,9 +870,10 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
   } else {
     if (found_range_del_block && !rep->range_del_handle.IsNull()) {
       ReadOptions read_options;
-      s = MaybeLoadDataBlockToCache(rep, read_options, rep->range_del_handle,
-                                    Slice() /* compression_dict */,
-                                    &rep->range_del_entry);
+      s = MaybeLoadDataBlockToCache(
+          rep, read_options, rep->range_del_handle,
+          UncompressionDict::GetEmptyDict(), &rep->range_del_entry,
+          TraceBlockType::kRangeDeletionBlock, TableReaderCaller::kPrefetch);
       if (!s.ok()) {
         Log(InfoLogLevel::WARN_LEVEL, rep->ioptions.info_log,
             "Encountered error while reading data from range del block %s",
@@ -799,6 +894,10 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
 
     rep->global_seqno = GetGlobalSequenceNumber(*(rep->table_properties),
                                                 rep->ioptions.info_log);
+
+    auto& props = rep->table_properties->user_collected_properties;
+    auto pos = props.find(BlockBasedTablePropertyNames::kIndexKeyIsUserKey);
+    rep->index_key_is_user_key = pos != props.end() && pos->second == kPropTrue;
   }
 
     // pre-fetching of blocks is turned on
@@ -819,13 +918,13 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
           level == 0) {
         index_entry = &rep->index_entry;
       }
-      unique_ptr<InternalIterator> iter(
-          new_table->NewIndexIterator(ReadOptions(), nullptr, index_entry));
+      unique_ptr<InternalIterator> iter(new_table->NewIndexIterator(
+          ReadOptions(), TableReaderCaller::kPrefetch, nullptr, index_entry));
       s = iter->status();
 
       if (s.ok()) {
         // Hack: Call GetFilter() to implicitly add filter to the block_cache
-        auto filter_entry = new_table->GetFilter();
+        auto filter_entry = new_table->GetFilter(TableReaderCaller::kPrefetch);
         // if pin_l0_filter_and_index_blocks_in_cache is true, and this is
         // a level0 file, then save it in rep_->filter_entry; it will be
         // released in the destructor only, hence it will be pinned in the
@@ -911,7 +1010,7 @@ Status BlockBasedTable::ReadMetaBlock(Rep* rep,
   Status s = ReadBlockFromFile(
       rep->file.get(), rep->footer, ReadOptions(),
       rep->footer.metaindex_handle(), &meta, rep->ioptions,
-      true /* decompress */, Slice() /*compression dict*/,
+      true /* decompress */, UncompressionDict::GetEmptyDict(),
       rep->persistent_cache_options, kDisableGlobalSequenceNumber,
       0 /* read_amp_bytes_per_bit */);
 
@@ -933,7 +1032,8 @@ Status BlockBasedTable::GetDataBlockFromCache(
     Cache* block_cache, Cache* block_cache_compressed,
     const ImmutableCFOptions& ioptions, const ReadOptions& read_options,
     BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version,
-    const Slice& compression_dict, size_t read_amp_bytes_per_bit) {
+    const UncompressionDict& uncompression_dict, size_t read_amp_bytes_per_bit,
+    bool* is_cache_hit) {
   Status s;
   Block* compressed_block = nullptr;
   Cache::Handle* block_cache_compressed_handle = nullptr;
@@ -947,9 +1047,15 @@ Status BlockBasedTable::GetDataBlockFromCache(
     if (block->cache_handle != nullptr) {
       block->value =
           reinterpret_cast<Block*>(block_cache->Value(block->cache_handle));
+      if (is_cache_hit != nullptr) {
+        *is_cache_hit = true;
+      }
       return s;
     }
   }
+  if (is_cache_hit != nullptr) {
+    *is_cache_hit = false;
+  }
 
   // If not found, search from the compressed block cache.
   assert(block->cache_handle == nullptr && block->value == nullptr);
@@ -978,7 +1084,7 @@ Status BlockBasedTable::GetDataBlockFromCache(
   BlockContents contents;
   s = UncompressBlockContents(compressed_block->data(),
                               compressed_block->size(), &contents,
-                              format_version, compression_dict,
+                              format_version, uncompression_dict,
                               ioptions);
 
   // Insert uncompressed block into block cache
@@ -990,9 +1096,9 @@ Status BlockBasedTable::GetDataBlockFromCache(
     assert(block->value->compression_type() == kNoCompression);
     if (block_cache != nullptr && block->value->cachable() &&
         read_options.fill_cache) {
-      s = block_cache->Insert(
+      s = block_cache->InsertWithHelper(
           block_cache_key, block->value, block->value->usable_size(),
-          &DeleteCachedEntry<Block>, &(block->cache_handle));
+          &kDataBlockCacheTierHelper, &(block->cache_handle));
       if (s.ok()) {
         RecordTick(statistics, BLOCK_CACHE_ADD);
         RecordTick(statistics, BLOCK_CACHE_DATA_ADD);
@@ -1018,7 +1124,8 @@ Status BlockBasedTable::PutDataBlockToCache(
     Cache* block_cache, Cache* block_cache_compressed,
     const ReadOptions& read_options, const ImmutableCFOptions& ioptions,
     CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
-    const Slice& compression_dict, size_t read_amp_bytes_per_bit) {
+    const UncompressionDict& uncompression_dict, size_t read_amp_bytes_per_bit,
+    Cache::Priority priority) {
   assert(raw_block->compression_type() == kNoCompression ||
          block_cache_compressed != nullptr);
 
@@ -1028,7 +1135,7 @@ Status BlockBasedTable::PutDataBlockToCache(
   Statistics* statistics = ioptions.statistics;
   if (raw_block->compression_type() != kNoCompression) {
     s = UncompressBlockContents(raw_block->data(), raw_block->size(), &contents,
-                                format_version, compression_dict, ioptions);
+                                format_version, uncompression_dict, ioptions);
   }
   if (!s.ok()) {
     delete raw_block;
@@ -1064,9 +1171,10 @@ Status BlockBasedTable::PutDataBlockToCache(
   // insert into uncompressed block cache
   assert((block->value->compression_type() == kNoCompression));
   if (block_cache != nullptr && block->value->cachable()) {
-    s = block_cache->Insert(block_cache_key, block->value,
-                            block->value->usable_size(),
-                            &DeleteCachedEntry<Block>, &(block->cache_handle));
+    s = block_cache->InsertWithHelper(block_cache_key, block->value,
+                                      block->value->usable_size(),
+                                      &kDataBlockCacheTierHelper,
+                                      &(block->cache_handle), priority);
     if (s.ok()) {
       assert(block->cache_handle != nullptr);
       RecordTick(statistics, BLOCK_CACHE_ADD);
@@ -1096,7 +1204,8 @@ FilterBlockReader* BlockBasedTable::ReadFilter(Rep* rep) {
   BlockContents block;
   if (!ReadBlockContents(rep->file.get(), rep->footer, ReadOptions(),
                          rep->filter_handle, &block, rep->ioptions,
-                         false /* decompress */, Slice() /*compression dict*/,
+                         false /* decompress */,
+                         UncompressionDict::GetEmptyDict(),
                          rep->persistent_cache_options)
            .ok()) {
     // Error reading the block
@@ -1128,7 +1237,7 @@ FilterBlockReader* BlockBasedTable::ReadFilter(Rep* rep) {
 }
 
 BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
-                                                          bool no_io) const {
+    TableReaderCaller caller, bool no_io) const {
   // If cache_index_and_filter_blocks is false, filter should be pre-populated.
   // We will return rep_->filter anyway. rep_->filter can be nullptr if filter
   // read fails at Open() time. We don't want to reload again since it will
@@ -1165,13 +1274,22 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
   if (cache_handle != nullptr) {
     filter = reinterpret_cast<FilterBlockReader*>(
         block_cache->Value(cache_handle));
+    TraceBlockCacheAccess(rep_, key, TraceBlockType::kFilterBlock, caller,
+                          true /* is_cache_hit */, false /* no_insert */,
+                          block_cache->GetUsage(cache_handle));
   } else if (no_io) {
+    TraceBlockCacheAccess(rep_, key, TraceBlockType::kFilterBlock, caller,
+                          false /* is_cache_hit */, true /* no_insert */,
+                          0 /* block_size */);
     // Do not invoke any io.
     return CachableEntry<FilterBlockReader>();
   } else {
     filter = ReadFilter(rep_);
     if (filter != nullptr) {
       assert(filter->size() > 0);
+      TraceBlockCacheAccess(rep_, key, TraceBlockType::kFilterBlock, caller,
+                            false /* is_cache_hit */, false /* no_insert */,
+                            filter->size());
       Status s = block_cache->Insert(
           key, filter, filter->size(), &DeleteCachedFilterEntry, &cache_handle,
           rep_->table_options.cache_index_and_filter_blocks_with_high_priority
@@ -1194,17 +1312,17 @@ BlockBasedTable::CachableEntry<FilterBlockReader> BlockBasedTable::GetFilter(
 }
 
 InternalIterator* BlockBasedTable::NewIndexIterator(
-    const ReadOptions& read_options, BlockIter* input_iter,
-    CachableEntry<IndexReader>* index_entry) {
+    const ReadOptions& read_options, TableReaderCaller caller,
+    BlockIter* input_iter, CachableEntry<IndexReader>* index_entry) {
   // index reader has already been pre-populated.
   if (rep_->index_reader) {
     return rep_->index_reader->NewIterator(
-        input_iter, read_options.total_order_seek);
+        input_iter, read_options.total_order_seek, caller);
   }
   // we have a pinned index block
   if (rep_->index_entry.IsSet()) {
-    return rep_->index_entry.value->NewIterator(input_iter,
-                                                read_options.total_order_seek);
+    return rep_->index_entry.value->NewIterator(
+        input_iter, read_options.total_order_seek, caller);
   }
 
   PERF_TIMER_GUARD(read_index_block_nanos);
@@ -1220,7 +1338,14 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
       GetEntryFromCache(block_cache, key, BLOCK_CACHE_INDEX_MISS,
                         BLOCK_CACHE_INDEX_HIT, statistics);
 
-  if (cache_handle == nullptr && no_io) {
+  if (cache_handle != nullptr) {
+    TraceBlockCacheAccess(rep_, key, TraceBlockType::kIndexBlock, caller,
+                          true /* is_cache_hit */, false /* no_insert */,
+                          block_cache->GetUsage(cache_handle));
+  } else if (no_io) {
+    TraceBlockCacheAccess(rep_, key, TraceBlockType::kIndexBlock, caller,
+                          false /* is_cache_hit */, true /* no_insert */,
+                          0 /* block_size */);
     if (input_iter != nullptr) {
       input_iter->SetStatus(Status::Incomplete("no blocking io"));
       return input_iter;
@@ -1243,6 +1368,9 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
     TEST_SYNC_POINT("BlockBasedTable::NewIndexIterator::thread1:4");
     if (s.ok()) {
       assert(index_reader != nullptr);
+      TraceBlockCacheAccess(rep_, key, TraceBlockType::kIndexBlock, caller,
+                            false /* is_cache_hit */, false /* no_insert */,
+                            index_reader->usable_size());
       s = block_cache->Insert(
           key, index_reader, index_reader->usable_size(),
           &DeleteCachedIndexEntry, &cache_handle,
@@ -1275,7 +1403,7 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
 
   assert(cache_handle);
   auto* iter = index_reader->NewIterator(
-      input_iter, read_options.total_order_seek);
+      input_iter, read_options.total_order_seek, caller);
 
   // the caller would like to take ownership of the index block
   // don't call RegisterCleanup() in this case, the caller will take care of it
@@ -1294,7 +1422,8 @@ InternalIterator* BlockBasedTable::NewIndexIterator(
 // If input_iter is not null, update this iter and return it
 InternalIterator* BlockBasedTable::NewDataBlockIterator(
     Rep* rep, const ReadOptions& ro, const Slice& index_value,
-    BlockIter* input_iter) {
+    BlockIter* input_iter, TraceBlockType block_type,
+    TableReaderCaller caller, bool key_only, bool* read_from_file) {
   PERF_TIMER_GUARD(new_table_block_iter_nanos);
 
   const bool no_io = (ro.read_tier == kBlockCacheTier);
@@ -1305,12 +1434,9 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
   // We intentionally allow extra stuff in index_value so that we
   // can add more features in the future.
   Status s = handle.DecodeFrom(&input);
-  Slice compression_dict;
   if (s.ok()) {
-    if (rep->compression_dict_block) {
-      compression_dict = rep->compression_dict_block->data;
-    }
-    s = MaybeLoadDataBlockToCache(rep, ro, handle, compression_dict, &block);
+    s = MaybeLoadDataBlockToCache(rep, ro, handle, *rep->uncompression_dict,
+                                  &block, block_type, caller, read_from_file);
   }
 
   // Didn't get any data from block caches.
@@ -1327,8 +1453,13 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
     std::unique_ptr<Block> block_value;
     s = ReadBlockFromFile(
         rep->file.get(), rep->footer, ro, handle, &block_value, rep->ioptions,
-        true /* compress */, compression_dict, rep->persistent_cache_options,
+        true /* compress */, *rep->uncompression_dict,
+        rep->persistent_cache_options,
         rep->global_seqno, rep->table_options.read_amp_bytes_per_bit);
+    RecordBlockRead(block_type);
+    if (read_from_file != nullptr) {
+      *read_from_file = true;
+    }
     if (s.ok()) {
       block.value = block_value.release();
     }
@@ -1338,7 +1469,7 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
   if (s.ok()) {
     assert(block.value != nullptr);
     iter = block.value->NewIterator(&rep->internal_comparator, input_iter, true,
-                                    rep->ioptions.statistics);
+                                    rep->ioptions.statistics, key_only);
     if (block.cache_handle != nullptr) {
       iter->RegisterCleanup(&ReleaseCachedEntry, block_cache,
                             block.cache_handle);
@@ -1359,7 +1490,9 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
 
 Status BlockBasedTable::MaybeLoadDataBlockToCache(
     Rep* rep, const ReadOptions& ro, const BlockHandle& handle,
-    Slice compression_dict, CachableEntry<Block>* block_entry) {
+    const UncompressionDict& uncompression_dict,
+    CachableEntry<Block>* block_entry, TraceBlockType block_type,
+    TableReaderCaller caller, bool* read_from_file) {
   const bool no_io = (ro.read_tier == kBlockCacheTier);
   Cache* block_cache = rep->table_options.block_cache.get();
   Cache* block_cache_compressed =
@@ -1386,45 +1519,176 @@ Status BlockBasedTable::MaybeLoadDataBlockToCache(
                          compressed_cache_key);
     }
 
+    bool is_cache_hit = false;
     s = GetDataBlockFromCache(
         key, ckey, block_cache, block_cache_compressed, rep->ioptions, ro,
-        block_entry, rep->table_options.format_version, compression_dict,
-        rep->table_options.read_amp_bytes_per_bit);
+        block_entry, rep->table_options.format_version, uncompression_dict,
+        rep->table_options.read_amp_bytes_per_bit, &is_cache_hit);
 
-    if (block_entry->value == nullptr && !no_io && ro.fill_cache) {
+    const bool no_insert = no_io || !ro.fill_cache;
+    if (block_entry->value == nullptr && !no_insert) {
       std::unique_ptr<Block> raw_block;
       {
         StopWatch sw(rep->ioptions.env, statistics, READ_BLOCK_GET_MICROS);
         s = ReadBlockFromFile(
             rep->file.get(), rep->footer, ro, handle, &raw_block, rep->ioptions,
-            block_cache_compressed == nullptr, compression_dict,
+            block_cache_compressed == nullptr, uncompression_dict,
             rep->persistent_cache_options, rep->global_seqno,
             rep->table_options.read_amp_bytes_per_bit);
+        RecordBlockRead(block_type);
+      }
+      if (read_from_file != nullptr) {
+        *read_from_file = true;
       }
 
       if (s.ok()) {
         s = PutDataBlockToCache(
             key, ckey, block_cache, block_cache_compressed, ro, rep->ioptions,
             block_entry, raw_block.release(), rep->table_options.format_version,
-            compression_dict, rep->table_options.read_amp_bytes_per_bit);
+            uncompression_dict, rep->table_options.read_amp_bytes_per_bit);
       }
     }
+
+    if (block_cache != nullptr) {
+      // Without a block to charge, assume the block takes its size on disk
+      TraceBlockCacheAccess(rep, key, block_type, caller, is_cache_hit,
+                            no_insert,
+                            block_entry->value != nullptr
+                                ? block_entry->value->usable_size()
+                                : handle.size());
+    }
   }
   return s;
 }
 
+void BlockBasedTable::TraceBlockCacheAccess(Rep* rep, const Slice& block_key,
+                                            TraceBlockType block_type,
+                                            TableReaderCaller caller,
+                                            bool is_cache_hit, bool no_insert,
+                                            uint64_t block_size) {
+  BlockCacheTracer* tracer = rep->table_options.block_cache_tracer.get();
+  if (tracer == nullptr || !tracer->IsTracing()) {
+    return;
+  }
+  BlockCacheTraceRecord record;
+  record.access_timestamp = rep->ioptions.env->NowMicros();
+  record.block_key.assign(block_key.data(), block_key.size());
+  record.block_type = block_type;
+  record.block_size = block_size;
+  if (rep->table_properties != nullptr) {
+    record.cf_id =
+        static_cast<uint32_t>(rep->table_properties->column_family_id);
+  } else {
+    record.cf_id =
+        TablePropertiesCollectorFactory::Context::kUnknownColumnFamily;
+  }
+  record.level = rep->level;
+  record.caller = caller;
+  record.is_cache_hit = is_cache_hit;
+  record.no_insert = no_insert;
+  tracer->WriteBlockAccess(record);
+}
+
 BlockBasedTable::BlockEntryIteratorState::BlockEntryIteratorState(
-    BlockBasedTable* table, const ReadOptions& read_options, bool skip_filters)
+    BlockBasedTable* table, const ReadOptions& read_options, bool skip_filters,
+    TraceBlockType block_type, TableReaderCaller caller)
     : TwoLevelIteratorState(table->rep_->ioptions.prefix_extractor != nullptr),
       table_(table),
       read_options_(read_options),
-      skip_filters_(skip_filters) {}
+      skip_filters_(skip_filters),
+      block_type_(block_type),
+      caller_(caller),
+      prev_block_end_(0),
+      num_sequential_reads_(0),
+      readahead_size_(kInitAutoReadaheadSize),
+      readahead_supported_(true),
+      readahead_start_(0),
+      readahead_limit_(0),
+      readahead_useful_bytes_(0) {}
+
+BlockBasedTable::BlockEntryIteratorState::~BlockEntryIteratorState() {
+  FinishReadaheadWindow();
+}
 
 InternalIterator*
 BlockBasedTable::BlockEntryIteratorState::NewSecondaryIterator(
     const Slice& index_value) {
-  // Return a block iterator on the index partition
-  return NewDataBlockIterator(table_->rep_, read_options_, index_value);
+  if (block_type_ != TraceBlockType::kDataBlock) {
+    // Return a block iterator on the index partition
+    return NewDataBlockIterator(table_->rep_, read_options_, index_value,
+                                nullptr /* input_iter */, block_type_,
+                                caller_);
+  }
+  bool read_from_file = false;
+  InternalIterator* iter = NewDataBlockIterator(
+      table_->rep_, read_options_, index_value, nullptr /* input_iter */,
+      block_type_, caller_, read_options_.keys_only, &read_from_file);
+  MaybeReadahead(index_value, read_from_file);
+  return iter;
+}
+
+void BlockBasedTable::BlockEntryIteratorState::MaybeReadahead(
+    const Slice& index_value, bool read_from_file) {
+  Rep* rep = table_->rep_;
+  const size_t max_readahead_size = rep->table_options.max_auto_readahead_size;
+  if (max_readahead_size == 0 || !readahead_supported_ ||
+      read_options_.readahead_size > 0 ||
+      read_options_.read_tier == kBlockCacheTier ||
+      rep->file->use_direct_io()) {
+    return;
+  }
+  BlockHandle handle;
+  Slice input = index_value;
+  if (!handle.DecodeFrom(&input).ok()) {
+    return;
+  }
+  const uint64_t block_end = handle.offset() + handle.size() + kBlockTrailerSize;
+  if (handle.offset() != prev_block_end_) {
+    // Not a sequential scan (any more), start over
+    FinishReadaheadWindow();
+    num_sequential_reads_ = 0;
+    readahead_size_ = kInitAutoReadaheadSize;
+  }
+  prev_block_end_ = block_end;
+  if (!read_from_file) {
+    // Served by the block cache, there is nothing to read ahead of
+    return;
+  }
+  ++num_sequential_reads_;
+
+  if (handle.offset() >= readahead_start_ && block_end <= readahead_limit_) {
+    readahead_useful_bytes_ += block_end - handle.offset();
+    return;
+  }
+  if (num_sequential_reads_ <= kMinSequentialReadsForReadahead) {
+    return;
+  }
+
+  // This block has been read already, read ahead of what follows it
+  Status s = rep->file->Prefetch(block_end, readahead_size_);
+  if (!s.ok()) {
+    // Do not try again for this iterator
+    readahead_supported_ = false;
+    return;
+  }
+  FinishReadaheadWindow();
+  RecordTick(rep->ioptions.statistics, AUTO_READAHEAD_BYTES, readahead_size_);
+  readahead_start_ = block_end;
+  readahead_limit_ = block_end + readahead_size_;
+  readahead_useful_bytes_ = 0;
+  readahead_size_ = std::min(max_readahead_size, readahead_size_ * 2);
+}
+
+void BlockBasedTable::BlockEntryIteratorState::FinishReadaheadWindow() {
+  if (readahead_limit_ > readahead_start_) {
+    Statistics* statistics = table_->rep_->ioptions.statistics;
+    uint64_t window = readahead_limit_ - readahead_start_;
+    RecordTick(statistics, AUTO_READAHEAD_USEFUL_BYTES,
+               readahead_useful_bytes_);
+    RecordTick(statistics, AUTO_READAHEAD_WASTED_BYTES,
+               window - std::min(window, readahead_useful_bytes_));
+  }
+  readahead_start_ = readahead_limit_ = readahead_useful_bytes_ = 0;
 }
 
 bool BlockBasedTable::BlockEntryIteratorState::PrefixMayMatch(
@@ -1473,14 +1737,16 @@ bool BlockBasedTable::PrefixMayMatch(const Slice& internal_key) {
   no_io_read_options.read_tier = kBlockCacheTier;
 
   // First, try check with full filter
-  auto filter_entry = GetFilter(true /* no io */);
+  auto filter_entry = GetFilter(TableReaderCaller::kUserIterator,
+                                true /* no io */);
   FilterBlockReader* filter = filter_entry.value;
   if (filter != nullptr) {
     if (!filter->IsBlockBased()) {
       may_match = filter->PrefixMayMatch(prefix);
     } else {
       // Then, try find it within each block
-      unique_ptr<InternalIterator> iiter(NewIndexIterator(no_io_read_options));
+      unique_ptr<InternalIterator> iiter(NewIndexIterator(
+          no_io_read_options, TableReaderCaller::kUserIterator));
       iiter->Seek(internal_prefix);
 
       if (!iiter->Valid()) {
@@ -1534,11 +1800,15 @@ bool BlockBasedTable::PrefixMayMatch(const Slice& internal_key) {
 }
 
 InternalIterator* BlockBasedTable::NewIterator(const ReadOptions& read_options,
-                                               Arena* arena,
-                                               bool skip_filters) {
+                                               Arena* arena, bool skip_filters,
+                                               bool for_compaction) {
+  const TableReaderCaller caller = for_compaction
+                                       ? TableReaderCaller::kCompaction
+                                       : TableReaderCaller::kUserIterator;
   return NewTwoLevelIterator(
-      new BlockEntryIteratorState(this, read_options, skip_filters),
-      NewIndexIterator(read_options), arena);
+      new BlockEntryIteratorState(this, read_options, skip_filters,
+                                  TraceBlockType::kDataBlock, caller),
+      NewIndexIterator(read_options, caller), arena);
 }
 
 InternalIterator* BlockBasedTable::NewRangeTombstoneIterator(
@@ -1568,7 +1838,10 @@ InternalIterator* BlockBasedTable::NewRangeTombstoneIterator(
   rep_->range_del_handle.EncodeTo(&str);
   // The meta-block exists but isn't in uncompressed block cache (maybe because
   // it is disabled), so go through the full lookup process.
-  return NewDataBlockIterator(rep_, read_options, Slice(str));
+  return NewDataBlockIterator(rep_, read_options, Slice(str),
+                              nullptr /* input_iter */,
+                              TraceBlockType::kRangeDeletionBlock,
+                              TableReaderCaller::kOther);
 }
 
 bool BlockBasedTable::FullFilterKeyMayMatch(const ReadOptions& read_options,
@@ -1597,7 +1870,8 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
   Status s;
   CachableEntry<FilterBlockReader> filter_entry;
   if (!skip_filters) {
-    filter_entry = GetFilter(read_options.read_tier == kBlockCacheTier);
+    filter_entry = GetFilter(TableReaderCaller::kUserGet,
+                             read_options.read_tier == kBlockCacheTier);
   }
   FilterBlockReader* filter = filter_entry.value;
 
@@ -1607,7 +1881,8 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
     RecordTick(rep_->ioptions.statistics, BLOOM_FILTER_USEFUL);
   } else {
     BlockIter iiter_on_stack;
-    auto iiter = NewIndexIterator(read_options, &iiter_on_stack);
+    auto iiter = NewIndexIterator(read_options, TableReaderCaller::kUserGet,
+                                  &iiter_on_stack);
     std::unique_ptr<InternalIterator> iiter_unique_ptr;
     if (iiter != &iiter_on_stack) {
       iiter_unique_ptr = std::unique_ptr<InternalIterator>(iiter);
@@ -1634,7 +1909,9 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
         break;
       } else {
         BlockIter biter;
-        NewDataBlockIterator(rep_, read_options, iiter->value(), &biter);
+        NewDataBlockIterator(rep_, read_options, iiter->value(), &biter,
+                             TraceBlockType::kDataBlock,
+                             TableReaderCaller::kUserGet);
 
         if (read_options.read_tier == kBlockCacheTier &&
             biter.status().IsIncomplete()) {
@@ -1683,6 +1960,55 @@ Status BlockBasedTable::Get(const ReadOptions& read_options, const Slice& key,
   return s;
 }
 
+void BlockBasedTable::MultiGet(const ReadOptions& read_options,
+                               size_t num_keys, const Slice* keys,
+                               GetContext** get_contexts, Status* statuses) {
+  if (num_keys > 1 && read_options.read_tier != kBlockCacheTier &&
+      read_options.fill_cache && CanLoadDataBlocksToCache(rep_)) {
+    CachableEntry<FilterBlockReader> filter_entry =
+        GetFilter(TableReaderCaller::kUserGet);
+    FilterBlockReader* filter = filter_entry.value;
+    BlockIter iiter_on_stack;
+    auto iiter = NewIndexIterator(read_options, TableReaderCaller::kUserGet,
+                                  &iiter_on_stack);
+    std::unique_ptr<InternalIterator> iiter_unique_ptr;
+    if (iiter != &iiter_on_stack) {
+      iiter_unique_ptr.reset(iiter);
+    }
+
+    // The data block each key would be found in, once
+    std::vector<BlockHandle> handles;
+    std::unordered_set<uint64_t> offsets;
+    for (size_t i = 0; i < num_keys; ++i) {
+      if (!FullFilterKeyMayMatch(read_options, filter, keys[i])) {
+        continue;
+      }
+      iiter->Seek(keys[i]);
+      if (!iiter->Valid()) {
+        continue;
+      }
+      Slice handle_value = iiter->value();
+      BlockHandle handle;
+      if (handle.DecodeFrom(&handle_value).ok() &&
+          offsets.insert(handle.offset()).second) {
+        handles.push_back(handle);
+      }
+    }
+    if (!rep_->filter_entry.IsSet()) {
+      filter_entry.Release(rep_->table_options.block_cache.get());
+    }
+
+    // Failed reads are retried, and reported, by Get()
+    for (size_t i = 0; i < handles.size(); i += kPrefetchBatchSize) {
+      std::vector<BlockHandle> batch(
+          handles.begin() + i,
+          handles.begin() + std::min(handles.size(), i + kPrefetchBatchSize));
+      LoadDataBlocksToCache(rep_, batch);
+    }
+  }
+  TableReader::MultiGet(read_options, num_keys, keys, get_contexts, statuses);
+}
+
 Status BlockBasedTable::Prefetch(const Slice* const begin,
                                  const Slice* const end) {
   auto& comparator = rep_->internal_comparator;
@@ -1692,7 +2018,8 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
   }
 
   BlockIter iiter_on_stack;
-  auto iiter = NewIndexIterator(ReadOptions(), &iiter_on_stack);
+  auto iiter = NewIndexIterator(ReadOptions(), TableReaderCaller::kPrefetch,
+                                &iiter_on_stack);
   std::unique_ptr<InternalIterator> iiter_unique_ptr;
   if (iiter != &iiter_on_stack) {
     iiter_unique_ptr = std::unique_ptr<InternalIterator>(iiter);
@@ -1706,6 +2033,12 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
   // indicates if we are on the last page that need to be pre-fetched
   bool prefetching_boundary_page = false;
 
+  // With a block cache, the blocks are read in batches through MultiRead() so
+  // that the file system can serve them in parallel. The persistent cache is
+  // looked up block by block, so it keeps using the one at a time path.
+  const bool batched = CanLoadDataBlocksToCache(rep_);
+  std::vector<BlockHandle> handles;
+
   for (begin ? iiter->Seek(*begin) : iiter->SeekToFirst(); iiter->Valid();
        iiter->Next()) {
     Slice block_handle = iiter->value();
@@ -1720,9 +2053,28 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
       prefetching_boundary_page = true;
     }
 
+    if (batched) {
+      BlockHandle handle;
+      Status s = handle.DecodeFrom(&block_handle);
+      if (!s.ok()) {
+        return s;
+      }
+      handles.push_back(handle);
+      if (handles.size() >= kPrefetchBatchSize) {
+        s = LoadDataBlocksToCache(rep_, handles);
+        if (!s.ok()) {
+          return s;
+        }
+        handles.clear();
+      }
+      continue;
+    }
+
     // Load the block specified by the block_handle into the block cache
     BlockIter biter;
-    NewDataBlockIterator(rep_, ReadOptions(), block_handle, &biter);
+    NewDataBlockIterator(rep_, ReadOptions(), block_handle, &biter,
+                         TraceBlockType::kDataBlock,
+                         TableReaderCaller::kPrefetch);
 
     if (!biter.status().ok()) {
       // there was an unexpected error while pre-fetching
@@ -1730,12 +2082,221 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
     }
   }
 
+  if (!handles.empty()) {
+    return LoadDataBlocksToCache(rep_, handles);
+  }
   return Status::OK();
 }
 
+bool BlockBasedTable::CanLoadDataBlocksToCache(Rep* rep) {
+  return (rep->table_options.block_cache != nullptr ||
+          rep->table_options.block_cache_compressed != nullptr) &&
+         rep->persistent_cache_options.persistent_cache == nullptr;
+}
+
+Status BlockBasedTable::LoadDataBlocksToCache(
+    Rep* rep, const std::vector<BlockHandle>& handles,
+    Cache::Priority priority) {
+  Cache* block_cache = rep->table_options.block_cache.get();
+  Cache* block_cache_compressed =
+      rep->table_options.block_cache_compressed.get();
+  assert(CanLoadDataBlocksToCache(rep));
+  const UncompressionDict& uncompression_dict = *rep->uncompression_dict;
+
+  // Skip the blocks that are already cached. Without an uncompressed block
+  // cache, the blocks are only loaded into the compressed block cache.
+  std::vector<BlockHandle> to_read;
+  for (const auto& handle : handles) {
+    char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+    Slice key =
+        block_cache != nullptr
+            ? GetCacheKey(rep->cache_key_prefix, rep->cache_key_prefix_size,
+                          handle, cache_key)
+            : GetCacheKey(rep->compressed_cache_key_prefix,
+                          rep->compressed_cache_key_prefix_size, handle,
+                          cache_key);
+    Cache* cache = block_cache != nullptr ? block_cache : block_cache_compressed;
+    Cache::Handle* cache_handle = cache->Lookup(key);
+    if (cache_handle != nullptr) {
+      if (block_cache != nullptr) {
+        TraceBlockCacheAccess(rep, key, TraceBlockType::kDataBlock,
+                              TableReaderCaller::kPrefetch,
+                              true /* is_cache_hit */, false /* no_insert */,
+                              block_cache->GetUsage(cache_handle));
+      }
+      cache->Release(cache_handle);
+    } else {
+      to_read.push_back(handle);
+    }
+  }
+  if (to_read.empty()) {
+    return Status::OK();
+  }
+
+  std::vector<std::unique_ptr<char[]>> bufs(to_read.size());
+  std::vector<ReadRequest> reqs(to_read.size());
+  for (size_t i = 0; i < to_read.size(); ++i) {
+    size_t n = static_cast<size_t>(to_read[i].size()) + kBlockTrailerSize;
+    bufs[i].reset(new char[n]);
+    reqs[i].offset = to_read[i].offset();
+    reqs[i].len = n;
+    reqs[i].scratch = bufs[i].get();
+  }
+  Status s;
+  {
+    StopWatch sw(rep->ioptions.env, rep->ioptions.statistics,
+                 READ_BLOCK_GET_MICROS);
+    PERF_TIMER_GUARD(block_read_time);
+    s = rep->file->MultiRead(reqs.data(), reqs.size());
+  }
+
+  ReadOptions ro;
+  for (size_t i = 0; s.ok() && i < to_read.size(); ++i) {
+    s = reqs[i].status;
+    BlockContents contents;
+    if (s.ok()) {
+      s = BlockContentsFromReadBuffer(
+          rep->footer, ro, to_read[i], reqs[i].result, &bufs[i], &contents,
+          rep->ioptions, block_cache_compressed == nullptr,
+          uncompression_dict);
+    }
+    if (!s.ok()) {
+      break;
+    }
+
+    char compressed_cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+    if (block_cache == nullptr) {
+      // Only compressed blocks go to the compressed block cache
+      if (contents.compression_type == kNoCompression || !contents.cachable) {
+        continue;
+      }
+      Slice ckey = GetCacheKey(rep->compressed_cache_key_prefix,
+                               rep->compressed_cache_key_prefix_size,
+                               to_read[i], compressed_cache_key);
+      Block* raw_block = new Block(std::move(contents), rep->global_seqno);
+      Status insert_status = block_cache_compressed->Insert(
+          ckey, raw_block, raw_block->usable_size(),
+          &DeleteCachedEntry<Block>);
+      if (insert_status.ok()) {
+        RecordTick(rep->ioptions.statistics, BLOCK_CACHE_COMPRESSED_ADD);
+      } else {
+        RecordTick(rep->ioptions.statistics,
+                   BLOCK_CACHE_COMPRESSED_ADD_FAILURES);
+        delete raw_block;
+      }
+      continue;
+    }
+
+    char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+    Slice key = GetCacheKey(rep->cache_key_prefix, rep->cache_key_prefix_size,
+                            to_read[i], cache_key);
+    Slice ckey;
+    if (block_cache_compressed != nullptr) {
+      ckey = GetCacheKey(rep->compressed_cache_key_prefix,
+                         rep->compressed_cache_key_prefix_size, to_read[i],
+                         compressed_cache_key);
+    }
+    CachableEntry<Block> block;
+    s = PutDataBlockToCache(
+        key, ckey, block_cache, block_cache_compressed, ro, rep->ioptions,
+        &block,
+        new Block(std::move(contents), rep->global_seqno,
+                  rep->table_options.read_amp_bytes_per_bit,
+                  rep->ioptions.statistics),
+        rep->table_options.format_version, uncompression_dict,
+        rep->table_options.read_amp_bytes_per_bit, priority);
+    if (block.value != nullptr) {
+      TraceBlockCacheAccess(rep, key, TraceBlockType::kDataBlock,
+                            TableReaderCaller::kPrefetch,
+                            false /* is_cache_hit */, false /* no_insert */,
+                            block.value->usable_size());
+    }
+    if (block.cache_handle != nullptr) {
+      block.Release(block_cache);
+    } else {
+      // The block was not cachable
+      delete block.value;
+    }
+  }
+  return s;
+}
+
+Cache* BlockBasedTable::GetBlockCache() const {
+  return rep_->table_options.block_cache.get();
+}
+
+void BlockBasedTable::GetHotBlocks(
+    const std::map<std::string, Cache::Priority>& hot_keys,
+    std::vector<HotBlock>* blocks) {
+  if (rep_->cache_key_prefix_size == 0) {
+    return;
+  }
+  // Keys of this table's blocks are its cache key prefix followed by the
+  // block offset, so they are next to each other in hot_keys
+  const Slice prefix(rep_->cache_key_prefix, rep_->cache_key_prefix_size);
+  std::unordered_map<uint64_t, Cache::Priority> offsets;
+  for (auto iter = hot_keys.lower_bound(prefix.ToString());
+       iter != hot_keys.end() && Slice(iter->first).starts_with(prefix);
+       ++iter) {
+    Slice rest(iter->first);
+    rest.remove_prefix(prefix.size());
+    uint64_t offset;
+    if (GetVarint64(&rest, &offset) && rest.empty()) {
+      offsets.emplace(offset, iter->second);
+    }
+  }
+  if (offsets.empty()) {
+    return;
+  }
+
+  // The index has the size of each data block. Keys of index and filter
+  // blocks are not found in it and are skipped; those blocks are loaded when
+  // the table is opened anyway.
+  BlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(ReadOptions(), TableReaderCaller::kOther,
+                                &iiter_on_stack);
+  std::unique_ptr<InternalIterator> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
+  for (iiter->SeekToFirst(); iiter->Valid() && !offsets.empty();
+       iiter->Next()) {
+    Slice input = iiter->value();
+    BlockHandle handle;
+    if (!handle.DecodeFrom(&input).ok()) {
+      break;
+    }
+    auto found = offsets.find(handle.offset());
+    if (found != offsets.end()) {
+      blocks->push_back({handle.offset(), handle.size(), found->second});
+      offsets.erase(found);
+    }
+  }
+}
+
+Status BlockBasedTable::WarmUp(const std::vector<HotBlock>& blocks) {
+  if (!CanLoadDataBlocksToCache(rep_)) {
+    return Status::OK();
+  }
+  std::vector<BlockHandle> handles[2];
+  for (const auto& block : blocks) {
+    handles[block.priority == Cache::Priority::HIGH ? 0 : 1].emplace_back(
+        block.offset, block.size);
+  }
+  Status s;
+  if (!handles[0].empty()) {
+    s = LoadDataBlocksToCache(rep_, handles[0], Cache::Priority::HIGH);
+  }
+  if (s.ok() && !handles[1].empty()) {
+    s = LoadDataBlocksToCache(rep_, handles[1], Cache::Priority::LOW);
+  }
+  return s;
+}
+
 bool BlockBasedTable::TEST_KeyInCache(const ReadOptions& options,
                                       const Slice& key) {
-  std::unique_ptr<InternalIterator> iiter(NewIndexIterator(options));
+  std::unique_ptr<InternalIterator> iiter(
+      NewIndexIterator(options, TableReaderCaller::kOther));
   iiter->Seek(key);
   assert(iiter->Valid());
   CachableEntry<Block> block;
@@ -1755,9 +2316,7 @@ bool BlockBasedTable::TEST_KeyInCache(const ReadOptions& options,
 
   s = GetDataBlockFromCache(
       cache_key, ckey, block_cache, nullptr, rep_->ioptions, options, &block,
-      rep_->table_options.format_version,
-      rep_->compression_dict_block ? rep_->compression_dict_block->data
-                                   : Slice(),
+      rep_->table_options.format_version, *rep_->uncompression_dict,
       0 /* read_amp_bytes_per_bit */);
   assert(s.ok());
   bool in_cache = block.value != nullptr;
@@ -1789,6 +2348,12 @@ Status BlockBasedTable::CreateIndexReader(
 
   auto file = rep_->file.get();
   auto comparator = &rep_->internal_comparator;
+  // The binary search index compares its keys with the user comparator if
+  // they are user keys
+  const Comparator* binary_search_comparator =
+      rep_->index_key_is_user_key
+          ? rep_->internal_comparator.user_comparator()
+          : comparator;
   const Footer& footer = rep_->footer;
   if (index_type_on_file == BlockBasedTableOptions::kHashSearch &&
       rep_->ioptions.prefix_extractor == nullptr) {
@@ -1807,8 +2372,9 @@ Status BlockBasedTable::CreateIndexReader(
     }
     case BlockBasedTableOptions::kBinarySearch: {
       return BinarySearchIndexReader::Create(
-          file, footer, footer.index_handle(), rep_->ioptions, comparator,
-          index_reader, rep_->persistent_cache_options);
+          file, footer, footer.index_handle(), rep_->ioptions,
+          binary_search_comparator, index_reader,
+          rep_->persistent_cache_options, rep_->index_key_is_user_key);
     }
     case BlockBasedTableOptions::kHashSearch: {
       std::unique_ptr<Block> meta_guard;
@@ -1823,8 +2389,9 @@ Status BlockBasedTable::CreateIndexReader(
               "Unable to read the metaindex block."
               " Fall back to binary search index.");
           return BinarySearchIndexReader::Create(
-              file, footer, footer.index_handle(), rep_->ioptions, comparator,
-              index_reader, rep_->persistent_cache_options);
+              file, footer, footer.index_handle(), rep_->ioptions,
+              binary_search_comparator, index_reader,
+              rep_->persistent_cache_options, rep_->index_key_is_user_key);
         }
         meta_index_iter = meta_iter_guard.get();
       }
@@ -1843,7 +2410,8 @@ Status BlockBasedTable::CreateIndexReader(
 }
 
 uint64_t BlockBasedTable::ApproximateOffsetOf(const Slice& key) {
-  unique_ptr<InternalIterator> index_iter(NewIndexIterator(ReadOptions()));
+  unique_ptr<InternalIterator> index_iter(
+      NewIndexIterator(ReadOptions(), TableReaderCaller::kOther));
 
   index_iter->Seek(key);
   uint64_t result;
@@ -1886,7 +2454,7 @@ bool BlockBasedTable::TEST_index_reader_preloaded() const {
 Status BlockBasedTable::GetKVPairsFromDataBlocks(
     std::vector<KVPairBlock>* kv_pair_blocks) {
   std::unique_ptr<InternalIterator> blockhandles_iter(
-      NewIndexIterator(ReadOptions()));
+      NewIndexIterator(ReadOptions(), TableReaderCaller::kOther));
 
   Status s = blockhandles_iter->status();
   if (!s.ok()) {
@@ -1904,7 +2472,10 @@ Status BlockBasedTable::GetKVPairsFromDataBlocks(
 
     std::unique_ptr<InternalIterator> datablock_iter;
     datablock_iter.reset(
-        NewDataBlockIterator(rep_, ReadOptions(), blockhandles_iter->value()));
+        NewDataBlockIterator(rep_, ReadOptions(), blockhandles_iter->value(),
+                             nullptr /* input_iter */,
+                             TraceBlockType::kDataBlock,
+                             TableReaderCaller::kOther));
     s = datablock_iter->status();
 
     if (!s.ok()) {
@@ -2007,7 +2578,8 @@ Status BlockBasedTable::DumpTable(WritableFile* out_file) {
         if (ReadBlockContents(
                 rep_->file.get(), rep_->footer, ReadOptions(), handle, &block,
                 rep_->ioptions, false /*decompress*/,
-                Slice() /*compression dict*/, rep_->persistent_cache_options)
+                UncompressionDict::GetEmptyDict(),
+                rep_->persistent_cache_options)
                 .ok()) {
           rep_->filter.reset(new BlockBasedFilterBlockReader(
               rep_->ioptions.prefix_extractor, table_options,
@@ -2093,7 +2665,7 @@ Status BlockBasedTable::DumpIndexBlock(WritableFile* out_file) {
       "--------------------------------------\n");
 
   std::unique_ptr<InternalIterator> blockhandles_iter(
-      NewIndexIterator(ReadOptions()));
+      NewIndexIterator(ReadOptions(), TableReaderCaller::kOther));
   Status s = blockhandles_iter->status();
   if (!s.ok()) {
     out_file->Append("Can not read Index Block \n\n");
@@ -2135,7 +2707,7 @@ Status BlockBasedTable::DumpIndexBlock(WritableFile* out_file) {
 
 Status BlockBasedTable::DumpDataBlocks(WritableFile* out_file) {
   std::unique_ptr<InternalIterator> blockhandles_iter(
-      NewIndexIterator(ReadOptions()));
+      NewIndexIterator(ReadOptions(), TableReaderCaller::kOther));
   Status s = blockhandles_iter->status();
   if (!s.ok()) {
     out_file->Append("Can not read Index Block \n\n");
@@ -2171,7 +2743,10 @@ Status BlockBasedTable::DumpDataBlocks(WritableFile* out_file) {
 
     std::unique_ptr<InternalIterator> datablock_iter;
     datablock_iter.reset(
-        NewDataBlockIterator(rep_, ReadOptions(), blockhandles_iter->value()));
+        NewDataBlockIterator(rep_, ReadOptions(), blockhandles_iter->value(),
+                             nullptr /* input_iter */,
+                             TraceBlockType::kDataBlock,
+                             TableReaderCaller::kOther));
     s = datablock_iter->status();
 
     if (!s.ok()) {
@@ -15,6 +15,7 @@
 #include <utility>
 #include <vector>
 
+#include "rocksdb/block_cache_tracer.h"
 #include "rocksdb/options.h"
 #include "rocksdb/persistent_cache.h"
 #include "rocksdb/statistics.h"
@@ -42,6 +43,7 @@ class Iterator;
 class RandomAccessFile;
 class TableCache;
 class TableReader;
+class UncompressionDict;
 class WritableFile;
 struct BlockBasedTableOptions;
 struct EnvOptions;
@@ -96,7 +98,8 @@ class BlockBasedTable : public TableReader {
   // call one of the Seek methods on the iterator before using it).
   // @param skip_filters Disables loading/accessing the filter block
   InternalIterator* NewIterator(const ReadOptions&, Arena* arena = nullptr,
-                                bool skip_filters = false) override;
+                                bool skip_filters = false,
+                                bool for_compaction = false) override;
 
   InternalIterator* NewRangeTombstoneIterator(
       const ReadOptions& read_options) override;
@@ -105,11 +108,24 @@ class BlockBasedTable : public TableReader {
   Status Get(const ReadOptions& readOptions, const Slice& key,
              GetContext* get_context, bool skip_filters = false) override;
 
+  // Reads the uncached data blocks of the keys with batched MultiRead()s
+  // before looking the keys up one by one.
+  void MultiGet(const ReadOptions& readOptions, size_t num_keys,
+                const Slice* keys, GetContext** get_contexts,
+                Status* statuses) override;
+
   // Pre-fetch the disk blocks that correspond to the key range specified by
   // (kbegin, kend). The call will return error status in the event of
   // IO or iteration error.
   Status Prefetch(const Slice* begin, const Slice* end) override;
 
+  Cache* GetBlockCache() const override;
+
+  void GetHotBlocks(const std::map<std::string, Cache::Priority>& hot_keys,
+                    std::vector<HotBlock>* blocks) override;
+
+  Status WarmUp(const std::vector<HotBlock>& blocks) override;
+
   // Given a key, return an approximate byte offset in the file where
   // the data for that key begins (or would begin if the key were
   // present in the file).  The returned value is in terms of file
@@ -161,9 +177,15 @@ class BlockBasedTable : public TableReader {
   bool compaction_optimized_;
 
   // input_iter: if it is not null, update this one and return it as Iterator
+  // block_type and caller describe the lookup to the block cache tracer.
+  // key_only: the iterator returns empty values, see Block::NewIterator()
+  // read_from_file: if not null, set to whether the block missed the block
+  // caches and was read from the file
   static InternalIterator* NewDataBlockIterator(
       Rep* rep, const ReadOptions& ro, const Slice& index_value,
-      BlockIter* input_iter = nullptr);
+      BlockIter* input_iter, TraceBlockType block_type,
+      TableReaderCaller caller, bool key_only = false,
+      bool* read_from_file = nullptr);
   // If block cache enabled (compressed or uncompressed), looks for the block
   // identified by handle in (1) uncompressed cache, (2) compressed cache, and
   // then (3) file. If found, inserts into the cache(s) that were searched
@@ -173,14 +195,45 @@ class BlockBasedTable : public TableReader {
   // @param block_entry value is set to the uncompressed block if found. If
   //    in uncompressed block cache, also sets cache_handle to reference that
   //    block.
+  // @param read_from_file if not null, set to true when the block was read
+  //    from the file.
   static Status MaybeLoadDataBlockToCache(
       Rep* rep, const ReadOptions& ro, const BlockHandle& handle,
-      Slice compression_dict, CachableEntry<Block>* block_entry);
+      const UncompressionDict& uncompression_dict,
+      CachableEntry<Block>* block_entry, TraceBlockType block_type,
+      TableReaderCaller caller, bool* read_from_file = nullptr);
+
+  // Records a lookup of a block in the block cache if
+  // BlockBasedTableOptions::block_cache_tracer is tracing.
+  static void TraceBlockCacheAccess(Rep* rep, const Slice& block_key,
+                                    TraceBlockType block_type,
+                                    TableReaderCaller caller,
+                                    bool is_cache_hit, bool no_insert,
+                                    uint64_t block_size);
+
+  // Maximum number of data blocks Prefetch() and MultiGet() read with a
+  // single MultiRead()
+  static const size_t kPrefetchBatchSize = 32;
+
+  // Whether LoadDataBlocksToCache() can be used: there is a block cache or a
+  // compressed block cache, and no persistent cache, which is looked up block
+  // by block.
+  static bool CanLoadDataBlocksToCache(Rep* rep);
+
+  // Reads the data blocks identified by handles that are not in the block
+  // cache yet with a single MultiRead() and inserts them into the block
+  // cache(s) with the given priority. Without a block cache, only the
+  // compressed blocks are inserted into the compressed block cache.
+  // REQUIRES: CanLoadDataBlocksToCache(rep)
+  static Status LoadDataBlocksToCache(
+      Rep* rep, const std::vector<BlockHandle>& handles,
+      Cache::Priority priority = Cache::Priority::LOW);
 
   // For the following two functions:
   // if `no_io == true`, we will not try to read filter/index from sst file
   // were they not present in cache yet.
-  CachableEntry<FilterBlockReader> GetFilter(bool no_io = false) const;
+  CachableEntry<FilterBlockReader> GetFilter(TableReaderCaller caller,
+                                             bool no_io = false) const;
 
   // Get the iterator from the index reader.
   // If input_iter is not set, return new Iterator
@@ -193,21 +246,26 @@ class BlockBasedTable : public TableReader {
   //  3. We disallowed any io to be performed, that is, read_options ==
   //     kBlockCacheTier
   InternalIterator* NewIndexIterator(
-      const ReadOptions& read_options, BlockIter* input_iter = nullptr,
+      const ReadOptions& read_options, TableReaderCaller caller,
+      BlockIter* input_iter = nullptr,
       CachableEntry<IndexReader>* index_entry = nullptr);
 
   // Read block cache from block caches (if set): block_cache and
   // block_cache_compressed.
   // On success, Status::OK with be returned and @block will be populated with
   // pointer to the block as well as its block handle.
-  // @param compression_dict Data for presetting the compression library's
+  // @param uncompression_dict Data for presetting the compression library's
   //    dictionary.
+  // @param is_cache_hit if not null, set to whether the block was found in
+  //    block_cache, as opposed to block_cache_compressed.
   static Status GetDataBlockFromCache(
       const Slice& block_cache_key, const Slice& compressed_block_cache_key,
       Cache* block_cache, Cache* block_cache_compressed,
       const ImmutableCFOptions& ioptions, const ReadOptions& read_options,
       BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version,
-      const Slice& compression_dict, size_t read_amp_bytes_per_bit);
+      const UncompressionDict& uncompression_dict,
+      size_t read_amp_bytes_per_bit,
+      bool* is_cache_hit = nullptr);
 
   // Put a raw block (maybe compressed) to the corresponding block caches.
   // This method will perform decompression against raw_block if needed and then
@@ -217,14 +275,16 @@ class BlockBasedTable : public TableReader {
   //
   // REQUIRES: raw_block is heap-allocated. PutDataBlockToCache() will be
   // responsible for releasing its memory if error occurs.
-  // @param compression_dict Data for presetting the compression library's
+  // @param uncompression_dict Data for presetting the compression library's
   //    dictionary.
   static Status PutDataBlockToCache(
       const Slice& block_cache_key, const Slice& compressed_block_cache_key,
       Cache* block_cache, Cache* block_cache_compressed,
       const ReadOptions& read_options, const ImmutableCFOptions& ioptions,
       CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
-      const Slice& compression_dict, size_t read_amp_bytes_per_bit);
+      const UncompressionDict& uncompression_dict,
+      size_t read_amp_bytes_per_bit,
+      Cache::Priority priority = Cache::Priority::LOW);
 
   // Calls (*handle_result)(arg, ...) repeatedly, starting with the entry found
   // after a call to Seek(key), until handle_result returns false.
@@ -278,16 +338,45 @@ class BlockBasedTable : public TableReader {
 // Maitaning state of a two-level iteration on a partitioned index structure
 class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
  public:
+  // block_type is the type of the blocks the index entries point to
   BlockEntryIteratorState(BlockBasedTable* table,
-                          const ReadOptions& read_options, bool skip_filters);
+                          const ReadOptions& read_options, bool skip_filters,
+                          TraceBlockType block_type, TableReaderCaller caller);
+  ~BlockEntryIteratorState();
   InternalIterator* NewSecondaryIterator(const Slice& index_value) override;
   bool PrefixMayMatch(const Slice& internal_key) override;
 
  private:
+  // Readahead starts once this many blocks have been read one after the
+  // other.
+  static const int kMinSequentialReadsForReadahead = 2;
+  static const size_t kInitAutoReadaheadSize = 8 * 1024;
+
+  // Called for each data block the iterator moves to, after the block was
+  // looked up. Detects sequential scans that miss the block cache and reads
+  // ahead of them, see BlockBasedTableOptions::max_auto_readahead_size.
+  void MaybeReadahead(const Slice& index_value, bool read_from_file);
+  // Closes the current readahead window, recording how much of it was used
+  void FinishReadaheadWindow();
+
   // Don't own table_
   BlockBasedTable* table_;
   const ReadOptions read_options_;
   bool skip_filters_;
+  TraceBlockType block_type_;
+  TableReaderCaller caller_;
+
+  // End offset of the last block the iterator moved to
+  uint64_t prev_block_end_;
+  // Number of blocks of the current sequential scan read from the file
+  int num_sequential_reads_;
+  size_t readahead_size_;
+  // False once the file has refused a Prefetch()
+  bool readahead_supported_;
+  // Current readahead window and how many of its bytes have been read
+  uint64_t readahead_start_;
+  uint64_t readahead_limit_;
+  uint64_t readahead_useful_bytes_;
 };
 
 }  // namespace rocksdb
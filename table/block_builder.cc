@@ -30,6 +30,38 @@
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+//
+// A block built with separate_values stores all the values first and the
+// key entries after them, without their values:
+//     values: char[]
+//     entries: [shared_bytes, unshared_bytes, value_length, key_delta]*
+//     restarts: uint32[num_restarts]
+//     value_restarts: uint32[num_restarts]
+//     num_restarts | kBlockValuesSeparatedFlag: uint32
+// value_restarts[i] contains the offset within the block of the value of the
+// ith restart point. The values of the following entries come right after it,
+// in order. The values end where the first restart point starts.
+//
+// A block built with delta_encode_values does not store the lengths of the
+// values, which decode themselves:
+//     entries: [shared_bytes, unshared_bytes, key_delta, value]*
+//     restarts: uint32[num_restarts]
+//     num_restarts | kBlockValuesDeltaEncodedFlag: uint32
+// Only index blocks are built that way, with block handles as values. Past the
+// restart points, an entry may only hold the size of its block, which follows
+// the block of the previous entry and its trailer.
+//
+// A block built with key_prefixes has an array of key prefixes right before
+// its restart count:
+//     restarts: uint32[num_restarts]
+//     [value_restarts: uint32[num_restarts]]
+//     key_prefixes: fixed64[num_restarts]
+//     num_restarts | kBlockKeyPrefixesFlag [| kBlockInternalKeyPrefixesFlag]
+//                  [| kBlockValuesSeparatedFlag | ...]: uint32
+// key_prefixes[i] is BlockKeyPrefix() of the key of the ith restart point, or
+// of its user key if the block holds internal keys. As the prefixes are
+// ordered like the keys, a reader first searches the contiguous prefixes, and
+// only compares the full keys of the restart points it could not tell apart.
 
 #include "table/block_builder.h"
 
@@ -37,19 +69,31 @@
 #include <assert.h>
 #include "rocksdb/comparator.h"
 #include "db/dbformat.h"
+#include "table/format.h"
 #include "util/coding.h"
 
 namespace rocksdb {
 
-BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding)
+BlockBuilder::BlockBuilder(int block_restart_interval, bool use_delta_encoding,
+                           bool separate_values, bool delta_encode_values,
+                           bool key_prefixes, bool internal_keys)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
+      separate_values_(separate_values),
+      delta_encode_values_(delta_encode_values),
+      key_prefixes_(key_prefixes),
+      internal_keys_(internal_keys),
       restarts_(),
       counter_(0),
       finished_(false) {
   assert(block_restart_interval_ >= 1);
+  assert(!(separate_values_ && delta_encode_values_));
   restarts_.push_back(0);       // First restart point is at offset 0
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
+  if (separate_values_) {
+    value_restarts_.push_back(0);
+    estimate_ += sizeof(uint32_t);
+  }
 }
 
 void BlockBuilder::Reset() {
@@ -57,6 +101,13 @@ void BlockBuilder::Reset() {
   restarts_.clear();
   restarts_.push_back(0);       // First restart point is at offset 0
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
+  if (separate_values_) {
+    values_.clear();
+    value_restarts_.clear();
+    value_restarts_.push_back(0);
+    estimate_ += sizeof(uint32_t);
+  }
+  restart_key_prefixes_.clear();
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
@@ -68,6 +119,12 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key, const Slice& value)
   estimate += key.size() + value.size();
   if (counter_ >= block_restart_interval_) {
     estimate += sizeof(uint32_t); // a new restart entry.
+    if (separate_values_) {
+      estimate += sizeof(uint32_t);  // a new value restart entry.
+    }
+    if (key_prefixes_) {
+      estimate += sizeof(uint64_t);  // a new key prefix.
+    }
   }
 
   estimate += sizeof(int32_t); // varint for shared prefix length.
@@ -78,23 +135,61 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key, const Slice& value)
 }
 
 Slice BlockBuilder::Finish() {
-  // Append restart array
-  for (size_t i = 0; i < restarts_.size(); i++) {
-    PutFixed32(&buffer_, restarts_[i]);
+  // An empty block has a restart point but no key to take a prefix of
+  const bool with_key_prefixes = key_prefixes_ && counter_ > 0;
+  assert(!with_key_prefixes ||
+         restart_key_prefixes_.size() == restarts_.size());
+  uint32_t flags = 0;
+  if (with_key_prefixes) {
+    flags |= kBlockKeyPrefixesFlag |
+             (internal_keys_ ? kBlockInternalKeyPrefixesFlag : 0);
+  }
+
+  if (separate_values_) {
+    // Move the key entries after the values
+    const uint32_t values_size = static_cast<uint32_t>(values_.size());
+    values_.append(buffer_);
+    buffer_.swap(values_);
+    for (size_t i = 0; i < restarts_.size(); i++) {
+      PutFixed32(&buffer_, restarts_[i] + values_size);
+    }
+    for (size_t i = 0; i < value_restarts_.size(); i++) {
+      PutFixed32(&buffer_, value_restarts_[i]);
+    }
+    flags |= kBlockValuesSeparatedFlag;
+  } else {
+    // Append restart array
+    for (size_t i = 0; i < restarts_.size(); i++) {
+      PutFixed32(&buffer_, restarts_[i]);
+    }
+    if (delta_encode_values_) {
+      flags |= kBlockValuesDeltaEncodedFlag;
+    }
   }
-  PutFixed32(&buffer_, static_cast<uint32_t>(restarts_.size()));
+  if (with_key_prefixes) {
+    for (size_t i = 0; i < restart_key_prefixes_.size(); i++) {
+      PutFixed64(&buffer_, restart_key_prefixes_[i]);
+    }
+  }
+  PutFixed32(&buffer_, static_cast<uint32_t>(restarts_.size()) | flags);
   finished_ = true;
   return Slice(buffer_);
 }
 
-void BlockBuilder::Add(const Slice& key, const Slice& value) {
+void BlockBuilder::Add(const Slice& key, const Slice& value,
+                       const Slice* delta_value) {
   assert(!finished_);
   assert(counter_ <= block_restart_interval_);
   size_t shared = 0;  // number of bytes shared with prev key
-  if (counter_ >= block_restart_interval_) {
+  if (counter_ >= block_restart_interval_ ||
+      (delta_encode_values_ && delta_value == nullptr && counter_ > 0)) {
     // Restart compression
     restarts_.push_back(static_cast<uint32_t>(buffer_.size()));
     estimate_ += sizeof(uint32_t);
+    if (separate_values_) {
+      value_restarts_.push_back(static_cast<uint32_t>(values_.size()));
+      estimate_ += sizeof(uint32_t);
+    }
     counter_ = 0;
 
     if (use_delta_encoding_) {
@@ -112,9 +207,29 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
     last_key_.assign(key.data(), key.size());
   }
 
+  if (key_prefixes_ && counter_ == 0) {
+    assert(!internal_keys_ || key.size() >= 8);
+    restart_key_prefixes_.push_back(
+        BlockKeyPrefix(internal_keys_ ? ExtractUserKey(key) : key));
+    estimate_ += sizeof(uint64_t);
+  }
+
   const size_t non_shared = key.size() - shared;
   const size_t curr_size = buffer_.size();
 
+  if (delta_encode_values_) {
+    // Add "<shared><non_shared><key_delta>" to buffer_ followed by the value,
+    // or its delta past the restart point
+    PutVarint32Varint32(&buffer_, static_cast<uint32_t>(shared),
+                        static_cast<uint32_t>(non_shared));
+    buffer_.append(key.data() + shared, non_shared);
+    const Slice& stored_value = counter_ > 0 ? *delta_value : value;
+    buffer_.append(stored_value.data(), stored_value.size());
+    counter_++;
+    estimate_ += buffer_.size() - curr_size;
+    return;
+  }
+
   // Add "<shared><non_shared><value_size>" to buffer_
   PutVarint32Varint32Varint32(&buffer_, static_cast<uint32_t>(shared),
                               static_cast<uint32_t>(non_shared),
@@ -122,10 +237,17 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
 
   // Add string delta to buffer_ followed by value
   buffer_.append(key.data() + shared, non_shared);
-  buffer_.append(value.data(), value.size());
+  if (separate_values_) {
+    values_.append(value.data(), value.size());
+  } else {
+    buffer_.append(value.data(), value.size());
+  }
 
   counter_++;
   estimate_ += buffer_.size() - curr_size;
+  if (separate_values_) {
+    estimate_ += value.size();
+  }
 }
 
 }  // namespace rocksdb
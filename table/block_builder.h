@@ -20,15 +20,36 @@ class BlockBuilder {
   BlockBuilder(const BlockBuilder&) = delete;
   void operator=(const BlockBuilder&) = delete;
 
+  // If separate_values is true, the values of the block are stored apart
+  // from its keys, so that seeking and iterating over keys does not bring the
+  // values into the CPU cache.
+  //
+  // If delta_encode_values is true, the values must be self-delimiting
+  // encodings, as their lengths are not stored, and entries past the restart
+  // points may store a delta from the previous value instead of the value.
+  // It cannot be combined with separate_values.
+  //
+  // If key_prefixes is true, the block also stores a fixed-width prefix of the
+  // key of each restart point, which lets readers narrow down their binary
+  // searches without decoding the keys. The keys must be ordered bytewise,
+  // or by their user keys if internal_keys is true.
   explicit BlockBuilder(int block_restart_interval,
-                        bool use_delta_encoding = true);
+                        bool use_delta_encoding = true,
+                        bool separate_values = false,
+                        bool delta_encode_values = false,
+                        bool key_prefixes = false, bool internal_keys = false);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
 
   // REQUIRES: Finish() has not been called since the last call to Reset().
   // REQUIRES: key is larger than any previously added key
-  void Add(const Slice& key, const Slice& value);
+  //
+  // If the block delta-encodes its values, delta_value is stored instead of
+  // value unless the entry is a restart point. A null delta_value makes the
+  // entry a restart point.
+  void Add(const Slice& key, const Slice& value,
+           const Slice* delta_value = nullptr);
 
   // Finish building the block and return a slice that refers to the
   // block contents.  The returned slice will remain valid for the
@@ -50,9 +71,19 @@ class BlockBuilder {
  private:
   const int          block_restart_interval_;
   const bool         use_delta_encoding_;
+  const bool         separate_values_;
+  const bool         delta_encode_values_;
+  const bool         key_prefixes_;
+  const bool         internal_keys_;
 
   std::string           buffer_;    // Destination buffer
   std::vector<uint32_t> restarts_;  // Restart points
+  // Values and offsets of the values at the restart points, if
+  // separate_values_
+  std::string           values_;
+  std::vector<uint32_t> value_restarts_;
+  // Prefixes of the keys of the restart points, if key_prefixes_
+  std::vector<uint64_t> restart_key_prefixes_;
   size_t                estimate_;
   int                   counter_;   // Number of entries emitted since restart
   bool                  finished_;  // Has Finish() been called?
@@ -23,6 +23,7 @@
 #include "table/block_builder.h"
 #include "table/format.h"
 #include "util/random.h"
+#include "util/string_util.h"
 #include "util/testharness.h"
 #include "util/testutil.h"
 
@@ -129,6 +130,348 @@ TEST_F(BlockTest, SimpleTest) {
   delete iter;
 }
 
+TEST_F(BlockTest, SeparatedValues) {
+  Random rnd(301);
+  Options options = Options();
+
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  GenerateRandomKVs(&keys, &values, 0, 1000);
+  for (size_t i = 0; i < values.size(); i += 7) {
+    // Empty values and values longer than one byte varints
+    values[i] = i % 2 == 0 ? "" : RandomString(&rnd, 300);
+  }
+
+  BlockBuilder interleaved_builder(16);
+  BlockBuilder builder(16, true /* use_delta_encoding */,
+                       true /* separate_values */);
+  for (size_t i = 0; i < keys.size(); i++) {
+    interleaved_builder.Add(keys[i], values[i]);
+    builder.Add(keys[i], values[i]);
+  }
+  Slice interleaved_block = interleaved_builder.Finish();
+  Slice rawblock = builder.Finish();
+  // Only the value restart points are added
+  ASSERT_EQ(interleaved_block.size() + ((keys.size() + 15) / 16) * 4,
+            rawblock.size());
+  ASSERT_EQ(rawblock.size(), builder.CurrentSizeEstimate());
+
+  BlockContents contents;
+  contents.data = rawblock;
+  contents.cachable = false;
+  Block reader(std::move(contents), kDisableGlobalSequenceNumber);
+  ASSERT_TRUE(reader.values_separated());
+  ASSERT_EQ((keys.size() + 15) / 16, reader.NumRestarts());
+
+  std::unique_ptr<InternalIterator> iter(
+      reader.NewIterator(options.comparator));
+  size_t count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), count++) {
+    ASSERT_EQ(keys[count], iter->key().ToString());
+    ASSERT_EQ(values[count], iter->value().ToString());
+  }
+  ASSERT_EQ(keys.size(), count);
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    count--;
+    ASSERT_EQ(keys[count], iter->key().ToString());
+    ASSERT_EQ(values[count], iter->value().ToString());
+  }
+  ASSERT_EQ(0U, count);
+  ASSERT_OK(iter->status());
+
+  for (int i = 0; i < 1000; i++) {
+    size_t index = rnd.Uniform(static_cast<int>(keys.size()));
+    iter->Seek(keys[index]);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(values[index], iter->value().ToString());
+    iter->SeekForPrev(keys[index]);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(values[index], iter->value().ToString());
+    if (index > 0) {
+      iter->Prev();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(values[index - 1], iter->value().ToString());
+    }
+  }
+
+  // Key-only iterators see the same keys and empty values
+  std::unique_ptr<InternalIterator> key_iter(reader.NewIterator(
+      options.comparator, nullptr, true /* total_order_seek */,
+      nullptr /* stats */, true /* key_only */));
+  count = 0;
+  for (key_iter->SeekToFirst(); key_iter->Valid(); key_iter->Next()) {
+    ASSERT_EQ(keys[count++], key_iter->key().ToString());
+    ASSERT_TRUE(key_iter->value().empty());
+  }
+  ASSERT_EQ(keys.size(), count);
+  for (key_iter->SeekToLast(); key_iter->Valid(); key_iter->Prev()) {
+    ASSERT_EQ(keys[--count], key_iter->key().ToString());
+  }
+  ASSERT_EQ(0U, count);
+  ASSERT_OK(key_iter->status());
+}
+
+TEST_F(BlockTest, SeparatedValuesCorruption) {
+  Options options = Options();
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  GenerateRandomKVs(&keys, &values, 0, 100);
+
+  BlockBuilder builder(16, true /* use_delta_encoding */,
+                       true /* separate_values */);
+  for (size_t i = 0; i < keys.size(); i++) {
+    builder.Add(keys[i], values[i]);
+  }
+  std::string rawblock = builder.Finish().ToString();
+  const uint32_t num_restarts = 7;
+  const size_t restarts_offset =
+      rawblock.size() - (1 + 2 * num_restarts) * sizeof(uint32_t);
+  const uint32_t values_end = DecodeFixed32(rawblock.data() + restarts_offset);
+  ASSERT_EQ(100U * 100U, values_end);
+
+  // The last value restart point runs past the values
+  std::string corrupted = rawblock;
+  EncodeFixed32(&corrupted[restarts_offset + (2 * num_restarts - 1) * 4],
+                values_end - 10);
+  BlockContents contents;
+  contents.data = corrupted;
+  Block reader(std::move(contents), kDisableGlobalSequenceNumber);
+  std::unique_ptr<InternalIterator> iter(
+      reader.NewIterator(options.comparator));
+  iter->SeekToLast();
+  ASSERT_FALSE(iter->Valid());
+  ASSERT_TRUE(iter->status().IsCorruption());
+
+  // The values run past the key entries
+  corrupted = rawblock;
+  EncodeFixed32(&corrupted[restarts_offset],
+                static_cast<uint32_t>(restarts_offset + 1));
+  contents.data = corrupted;
+  Block bad_block(std::move(contents), kDisableGlobalSequenceNumber);
+  iter.reset(bad_block.NewIterator(options.comparator));
+  ASSERT_TRUE(iter->status().IsCorruption());
+}
+
+TEST_F(BlockTest, DeltaEncodedHandles) {
+  Random rnd(301);
+  std::vector<std::string> keys;
+  std::vector<BlockHandle> handles;
+  uint64_t offset = 0;
+  for (int i = 0; i < 1000; i++) {
+    char key[16];
+    snprintf(key, sizeof(key), "key%06d", i * 3);
+    keys.push_back(key);
+    if (i % 37 == 5) {
+      // A gap between the blocks
+      offset += 100;
+    }
+    handles.emplace_back(offset, 3000 + rnd.Uniform(2000));
+    offset += handles.back().size() + kBlockTrailerSize;
+  }
+
+  for (int restart_interval : {16, 1}) {
+    BlockBuilder full_builder(restart_interval);
+    BlockBuilder builder(restart_interval, true /* use_delta_encoding */,
+                         false /* separate_values */,
+                         true /* delta_encode_values */);
+    for (size_t i = 0; i < keys.size(); i++) {
+      std::string handle_encoding;
+      handles[i].EncodeTo(&handle_encoding);
+      full_builder.Add(keys[i], handle_encoding);
+      std::string size_encoding;
+      PutVarint64(&size_encoding, handles[i].size());
+      Slice size_slice(size_encoding);
+      const bool follows = i > 0 && handles[i].offset() ==
+                                        handles[i - 1].offset() +
+                                            handles[i - 1].size() +
+                                            kBlockTrailerSize;
+      builder.Add(keys[i], handle_encoding, follows ? &size_slice : nullptr);
+    }
+    Slice full_block = full_builder.Finish();
+    Slice rawblock = builder.Finish();
+    ASSERT_EQ(rawblock.size(), builder.CurrentSizeEstimate());
+    if (restart_interval > 1) {
+      ASSERT_LT(rawblock.size() * 10, full_block.size() * 7);
+    } else {
+      // Only the lengths of the values are gone
+      ASSERT_EQ(full_block.size() - keys.size(), rawblock.size());
+    }
+
+    BlockContents contents;
+    contents.data = rawblock;
+    contents.cachable = false;
+    Block reader(std::move(contents), kDisableGlobalSequenceNumber);
+    ASSERT_TRUE(reader.values_delta_encoded());
+    ASSERT_FALSE(reader.values_separated());
+    if (restart_interval > 1) {
+      // The gaps start restart points
+      ASSERT_GT(reader.NumRestarts(), (keys.size() + 15) / 16);
+    } else {
+      ASSERT_EQ(keys.size(), reader.NumRestarts());
+    }
+
+    auto check_entry = [&](InternalIterator* iter, size_t i) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(keys[i], ExtractUserKey(iter->key()).ToString());
+      BlockHandle handle;
+      Slice value = iter->value();
+      ASSERT_OK(handle.DecodeFrom(&value));
+      ASSERT_EQ(handles[i].offset(), handle.offset());
+      ASSERT_EQ(handles[i].size(), handle.size());
+    };
+
+    // The keys are user keys sought with internal keys
+    std::unique_ptr<InternalIterator> iter(reader.NewIterator(
+        BytewiseComparator(), nullptr, true /* total_order_seek */,
+        nullptr /* stats */, false /* key_only */,
+        true /* keys_are_user_keys */));
+    size_t count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), count++) {
+      check_entry(iter.get(), count);
+    }
+    ASSERT_EQ(keys.size(), count);
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      check_entry(iter.get(), --count);
+    }
+    ASSERT_EQ(0U, count);
+    ASSERT_OK(iter->status());
+
+    for (int i = 0; i < 1000; i++) {
+      size_t index = rnd.Uniform(static_cast<int>(keys.size()));
+      iter->Seek(InternalKey(keys[index], 100, kTypeValue).Encode());
+      check_entry(iter.get(), index);
+      // The internal keys of an index key sort before the internal key returned
+      iter->SeekForPrev(InternalKey(keys[index], 0, kTypeValue).Encode());
+      check_entry(iter.get(), index);
+      if (index > 0) {
+        iter->Prev();
+        check_entry(iter.get(), index - 1);
+      }
+      // A user key between two keys
+      iter->Seek(InternalKey(keys[index] + "a", kMaxSequenceNumber, kTypeValue)
+                     .Encode());
+      if (index + 1 < keys.size()) {
+        check_entry(iter.get(), index + 1);
+      } else {
+        ASSERT_FALSE(iter->Valid());
+      }
+    }
+    ASSERT_OK(iter->status());
+  }
+}
+
+TEST_F(BlockTest, KeyPrefixes) {
+  Random rnd(301);
+  // Short keys over an alphabet with the lowest and the highest bytes, so
+  // that many keys share their 8-byte prefixes or are shorter than them
+  const char kAlphabet[] = {'\0', 'a', 'b', '\xff'};
+  auto random_user_key = [&]() {
+    std::string key;
+    for (int len = rnd.Uniform(13); len > 0; len--) {
+      key.push_back(kAlphabet[rnd.Uniform(4)]);
+    }
+    return key;
+  };
+  std::set<std::string> user_key_set;
+  for (int i = 0; i < 2000; i++) {
+    user_key_set.insert(random_user_key());
+  }
+  std::vector<std::string> user_keys(user_key_set.begin(),
+                                     user_key_set.end());
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < user_keys.size(); i++) {
+    keys.push_back(
+        InternalKey(user_keys[i], i + 1, kTypeValue).Encode().ToString());
+  }
+  std::vector<std::string> targets;
+  for (int i = 0; i < 1000; i++) {
+    targets.push_back(random_user_key());
+  }
+  targets.push_back(user_keys.front());
+  targets.push_back(user_keys.back());
+  targets.push_back(user_keys.back() + "a");
+
+  InternalKeyComparator icomp(BytewiseComparator());
+  for (bool internal_keys : {true, false}) {
+    const std::vector<std::string>& block_keys =
+        internal_keys ? keys : user_keys;
+    const Comparator* cmp =
+        internal_keys ? static_cast<const Comparator*>(&icomp)
+                      : BytewiseComparator();
+    for (int restart_interval : {1, 3, 16}) {
+      for (bool separate_values : {false, true}) {
+        BlockBuilder ref_builder(restart_interval, true /* use_delta_encoding */,
+                                 separate_values);
+        BlockBuilder builder(restart_interval, true /* use_delta_encoding */,
+                             separate_values, false /* delta_encode_values */,
+                             true /* key_prefixes */, internal_keys);
+        for (size_t i = 0; i < block_keys.size(); i++) {
+          ref_builder.Add(block_keys[i], ToString(i));
+          builder.Add(block_keys[i], ToString(i));
+        }
+        Slice ref_block = ref_builder.Finish();
+        Slice rawblock = builder.Finish();
+        ASSERT_EQ(rawblock.size(), builder.CurrentSizeEstimate());
+
+        BlockContents ref_contents;
+        ref_contents.data = ref_block;
+        Block ref_reader(std::move(ref_contents), kDisableGlobalSequenceNumber);
+        BlockContents contents;
+        contents.data = rawblock;
+        Block reader(std::move(contents), kDisableGlobalSequenceNumber);
+        ASSERT_FALSE(ref_reader.has_key_prefixes());
+        ASSERT_TRUE(reader.has_key_prefixes());
+        ASSERT_EQ(separate_values, reader.values_separated());
+        ASSERT_EQ(ref_reader.NumRestarts(), reader.NumRestarts());
+        ASSERT_EQ(ref_block.size() + reader.NumRestarts() * sizeof(uint64_t),
+                  rawblock.size());
+
+        std::unique_ptr<InternalIterator> ref_iter(
+            ref_reader.NewIterator(cmp));
+        std::unique_ptr<InternalIterator> iter(reader.NewIterator(cmp));
+        size_t count = 0;
+        for (iter->SeekToFirst(); iter->Valid(); iter->Next(), count++) {
+          ASSERT_EQ(block_keys[count], iter->key().ToString());
+          ASSERT_EQ(ToString(count), iter->value().ToString());
+        }
+        ASSERT_EQ(block_keys.size(), count);
+
+        auto check_seeks = [&](const Slice& target) {
+          ref_iter->Seek(target);
+          iter->Seek(target);
+          ASSERT_EQ(ref_iter->Valid(), iter->Valid());
+          if (iter->Valid()) {
+            ASSERT_EQ(ref_iter->key().ToString(), iter->key().ToString());
+            ASSERT_EQ(ref_iter->value().ToString(), iter->value().ToString());
+          }
+          ref_iter->SeekForPrev(target);
+          iter->SeekForPrev(target);
+          ASSERT_EQ(ref_iter->Valid(), iter->Valid());
+          if (iter->Valid()) {
+            ASSERT_EQ(ref_iter->key().ToString(), iter->key().ToString());
+          }
+        };
+        for (const std::string& target : targets) {
+          if (internal_keys) {
+            check_seeks(InternalKey(target, kMaxSequenceNumber, kTypeValue)
+                            .Encode());
+            check_seeks(InternalKey(target, 0, kTypeValue).Encode());
+          } else {
+            check_seeks(target);
+          }
+        }
+        for (const std::string& key : block_keys) {
+          check_seeks(key);
+          iter->Seek(key);
+          ASSERT_TRUE(iter->Valid());
+          ASSERT_EQ(key, iter->key().ToString());
+        }
+        ASSERT_OK(iter->status());
+      }
+    }
+  }
+}
+
 // return the block contents
 BlockContents GetBlockContents(std::unique_ptr<BlockBuilder> *builder,
                                const std::vector<std::string> &keys,
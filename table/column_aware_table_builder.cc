@@ -0,0 +1,260 @@
+// Copyright (c) 2011-present, Facebook, Inc. All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef ROCKSDB_LITE
+#include "table/column_aware_table_builder.h"
+
+#include <assert.h>
+#include <string>
+#include <vector>
+#include "db/dbformat.h"
+#include "rocksdb/env.h"
+#include "rocksdb/merge_operator.h"
+#include "table/block_based_table_builder.h"
+#include "table/format.h"
+#include "table/meta_blocks.h"
+#include "util/coding.h"
+#include "util/compression.h"
+#include "util/crc32c.h"
+#include "util/file_reader_writer.h"
+
+namespace rocksdb {
+
+// kColumnAwareTableMagicNumber was picked by running
+//    echo rocksdb.table.column.aware | sha1sum
+// and taking the leading 64 bits.
+extern const uint64_t kColumnAwareTableMagicNumber = 0x3ce2139aa247c54dull;
+
+ColumnAwareTableBuilder::ColumnAwareTableBuilder(
+    const ImmutableCFOptions& ioptions, const ColumnAwareSchema& schema,
+    const ColumnAwareTableOptions& table_options,
+    const std::vector<std::unique_ptr<IntTblPropCollectorFactory>>*
+        int_tbl_prop_collector_factories,
+    CompressionType compression_type,
+    const CompressionOptions& compression_opts, uint32_t column_family_id,
+    const std::string& column_family_name, WritableFileWriter* file)
+    : ioptions_(ioptions),
+      schema_(schema),
+      table_options_(table_options),
+      compression_type_(compression_type),
+      compression_opts_(compression_opts),
+      file_(file),
+      offset_(0),
+      block_entries_(0),
+      block_raw_size_(0),
+      num_raw_entries_(0),
+      closed_(false) {
+  properties_.column_family_id = column_family_id;
+  properties_.column_family_name = column_family_name;
+  properties_.comparator_name = ioptions.user_comparator != nullptr
+                                    ? ioptions.user_comparator->Name()
+                                    : "nullptr";
+  properties_.merge_operator_name = ioptions.merge_operator != nullptr
+                                        ? ioptions.merge_operator->Name()
+                                        : "nullptr";
+  properties_.compression_name = CompressionTypeToString(compression_type);
+  properties_.prefix_extractor_name = "nullptr";
+  schema_.EncodeTo(&properties_.user_collected_properties
+                        [ColumnAwareTablePropertyNames::kSchema]);
+
+  for (auto& collector_factories : *int_tbl_prop_collector_factories) {
+    table_properties_collectors_.emplace_back(
+        collector_factories->CreateIntTblPropCollector(column_family_id));
+  }
+  ResetEncoders();
+}
+
+void ColumnAwareTableBuilder::ResetEncoders() {
+  entry_kinds_.reset(new FixedLengthColBufEncoder(1, kColRle));
+  // The footers are seq << 8 | type, so the footers of nearby sequence
+  // numbers of the same type differ by small multiples of 256. Runs of equal
+  // deltas, such as the zero sequence numbers of the last level, take one run.
+  key_footers_.reset(new FixedLengthColBufEncoder(8, kColRleDeltaVarint));
+  columns_.reset(new KVPairColBufEncoders(schema_.declarations()));
+  raw_entries_.clear();
+  block_entries_ = 0;
+  block_raw_size_ = 0;
+}
+
+void ColumnAwareTableBuilder::Add(const Slice& key, const Slice& value) {
+  assert(!closed_);
+  if (!status_.ok()) {
+    return;
+  }
+  ParsedInternalKey internal_key;
+  if (!ParseInternalKey(key, &internal_key)) {
+    status_ = Status::Corruption("Bad internal key");
+    return;
+  }
+  if (internal_key.type == kTypeRangeDeletion) {
+    status_ = Status::NotSupported("Range deletion unsupported");
+    return;
+  }
+
+  if (block_entries_ > 0 && block_raw_size_ >= table_options_.block_size) {
+    FlushDataBlock();
+    if (!status_.ok()) {
+      return;
+    }
+  }
+
+  if (schema_.Fits(internal_key.user_key, value)) {
+    char kind = kColumnarEntry;
+    entry_kinds_->Append(&kind);
+    uint64_t footer = DecodeFixed64(key.data() + key.size() - 8);
+    key_footers_->Append(reinterpret_cast<const char*>(&footer));
+    const char* key_ptr = internal_key.user_key.data();
+    for (auto& col : columns_->key_col_bufs) {
+      key_ptr += col->Append(key_ptr);
+    }
+    const char* value_ptr = value.data();
+    for (auto& col : columns_->value_col_bufs) {
+      value_ptr += col->Append(value_ptr);
+    }
+    if (columns_->value_checksum_buf) {
+      columns_->value_checksum_buf->Append(
+          value_ptr < value.data() + value.size() ? value_ptr : nullptr);
+    }
+  } else {
+    char kind = kRawEntry;
+    entry_kinds_->Append(&kind);
+    PutLengthPrefixedSlice(&raw_entries_, key);
+    PutLengthPrefixedSlice(&raw_entries_, value);
+    num_raw_entries_++;
+  }
+  block_entries_++;
+  block_raw_size_ += key.size() + value.size();
+  last_key_.assign(key.data(), key.size());
+
+  properties_.num_entries++;
+  properties_.raw_key_size += key.size();
+  properties_.raw_value_size += value.size();
+
+  NotifyCollectTableCollectorsOnAdd(key, value, offset_,
+                                    table_properties_collectors_,
+                                    ioptions_.info_log);
+}
+
+void ColumnAwareTableBuilder::FlushDataBlock() {
+  entry_kinds_->Finish();
+  key_footers_->Finish();
+  columns_->Finish();
+
+  std::vector<const std::string*> columns;
+  columns.push_back(&entry_kinds_->GetData());
+  columns.push_back(&key_footers_->GetData());
+  for (auto& col : columns_->key_col_bufs) {
+    columns.push_back(&col->GetData());
+  }
+  for (auto& col : columns_->value_col_bufs) {
+    columns.push_back(&col->GetData());
+  }
+  if (columns_->value_checksum_buf) {
+    columns.push_back(&columns_->value_checksum_buf->GetData());
+  }
+  columns.push_back(&raw_entries_);
+
+  std::string raw_block;
+  PutVarint32(&raw_block, block_entries_);
+  for (auto* col : columns) {
+    PutVarint64(&raw_block, col->size());
+  }
+  for (auto* col : columns) {
+    raw_block.append(*col);
+  }
+
+  CompressionType type = compression_type_;
+  std::string compressed_output;
+  Slice block_contents =
+      CompressBlock(raw_block, compression_opts_, &type, 2 /* format_version */,
+                    CompressionDict::GetEmptyDict(), &compressed_output);
+  BlockHandle handle;
+  WriteBlock(block_contents, type, &handle);
+  if (status_.ok()) {
+    PutLengthPrefixedSlice(&index_block_, last_key_);
+    handle.EncodeTo(&index_block_);
+    properties_.num_data_blocks++;
+    properties_.data_size = offset_;
+  }
+  ResetEncoders();
+}
+
+void ColumnAwareTableBuilder::WriteBlock(const Slice& block_contents,
+                                         CompressionType type,
+                                         BlockHandle* handle) {
+  handle->set_offset(offset_);
+  handle->set_size(block_contents.size());
+  status_ = file_->Append(block_contents);
+  if (status_.ok()) {
+    char trailer[kBlockTrailerSize];
+    trailer[0] = type;
+    auto crc = crc32c::Value(block_contents.data(), block_contents.size());
+    crc = crc32c::Extend(crc, trailer, 1);  // Extend to cover block type
+    EncodeFixed32(trailer + 1, crc32c::Mask(crc));
+    status_ = file_->Append(Slice(trailer, kBlockTrailerSize));
+    if (status_.ok()) {
+      offset_ += block_contents.size() + kBlockTrailerSize;
+    }
+  }
+}
+
+Status ColumnAwareTableBuilder::Finish() {
+  assert(!closed_);
+  closed_ = true;
+
+  if (status_.ok() && block_entries_ > 0) {
+    FlushDataBlock();
+  }
+  if (!status_.ok()) {
+    return status_;
+  }
+
+  BlockHandle index_block_handle;
+  WriteBlock(index_block_, kNoCompression, &index_block_handle);
+  if (!status_.ok()) {
+    return status_;
+  }
+  properties_.index_size = index_block_.size() + kBlockTrailerSize;
+
+  PropertyBlockBuilder property_block_builder;
+  std::string num_raw_entries;
+  PutVarint64(&num_raw_entries, num_raw_entries_);
+  properties_.user_collected_properties
+      [ColumnAwareTablePropertyNames::kNumRawEntries] = num_raw_entries;
+  property_block_builder.AddTableProperty(properties_);
+  property_block_builder.Add(properties_.user_collected_properties);
+  NotifyCollectTableCollectorsOnFinish(table_properties_collectors_,
+                                       ioptions_.info_log,
+                                       &property_block_builder);
+  BlockHandle property_block_handle;
+  WriteBlock(property_block_builder.Finish(), kNoCompression,
+             &property_block_handle);
+  if (!status_.ok()) {
+    return status_;
+  }
+
+  MetaIndexBuilder meta_index_builder;
+  meta_index_builder.Add(kPropertiesBlock, property_block_handle);
+  BlockHandle metaindex_block_handle;
+  WriteBlock(meta_index_builder.Finish(), kNoCompression,
+             &metaindex_block_handle);
+  if (!status_.ok()) {
+    return status_;
+  }
+
+  Footer footer(kColumnAwareTableMagicNumber, 2);
+  footer.set_metaindex_handle(metaindex_block_handle);
+  footer.set_index_handle(index_block_handle);
+  std::string footer_encoding;
+  footer.EncodeTo(&footer_encoding);
+  status_ = file_->Append(footer_encoding);
+  if (status_.ok()) {
+    offset_ += footer_encoding.size();
+  }
+  return status_;
+}
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,134 @@
+// Copyright (c) 2011-present, Facebook, Inc. All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+#ifndef ROCKSDB_LITE
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "rocksdb/options.h"
+#include "rocksdb/status.h"
+#include "rocksdb/table_properties.h"
+#include "table/column_aware_table_factory.h"
+#include "table/table_builder.h"
+#include "utilities/col_buf_encoder.h"
+
+namespace rocksdb {
+
+class BlockHandle;
+class WritableFileWriter;
+
+// A column-aware table is laid out as
+//
+//   [data block 1]
+//   ...
+//   [data block N]
+//   [index block]
+//   [meta block: properties]
+//   [metaindex block]
+//   [footer]
+//
+// All the blocks but the footer have the block trailer of block-based tables.
+// The index block has the last key and the handle of each data block. A data
+// block starts with the number of entries, then the size of each column,
+// then the columns:
+//
+//   [entry kinds]      kColumnarEntry or kRawEntry, run-length encoded
+//   [key footers]      sequence numbers and types of the columnar entries,
+//                      delta and run-length encoded
+//   [key columns]      as declared by the schema
+//   [value columns]
+//   [value checksum]   if the schema declares one
+//   [raw entries]      length-prefixed keys and values of the raw entries
+class ColumnAwareTableBuilder : public TableBuilder {
+ public:
+  ColumnAwareTableBuilder(
+      const ImmutableCFOptions& ioptions, const ColumnAwareSchema& schema,
+      const ColumnAwareTableOptions& table_options,
+      const std::vector<std::unique_ptr<IntTblPropCollectorFactory>>*
+          int_tbl_prop_collector_factories,
+      CompressionType compression_type,
+      const CompressionOptions& compression_opts, uint32_t column_family_id,
+      const std::string& column_family_name, WritableFileWriter* file);
+
+  // REQUIRES: Either Finish() or Abandon() has been called.
+  ~ColumnAwareTableBuilder() {}
+
+  // Add key,value to the table being constructed.
+  // REQUIRES: key is after any previously added key according to comparator.
+  // REQUIRES: Finish(), Abandon() have not been called
+  void Add(const Slice& key, const Slice& value) override;
+
+  // Return non-ok iff some error has been detected.
+  Status status() const override { return status_; }
+
+  // Finish building the table.  Stops using the file passed to the
+  // constructor after this function returns.
+  // REQUIRES: Finish(), Abandon() have not been called
+  Status Finish() override;
+
+  // Indicate that the contents of this builder should be abandoned.  Stops
+  // using the file passed to the constructor after this function returns.
+  // If the caller is not going to call Finish(), it must call Abandon()
+  // before destroying this builder.
+  // REQUIRES: Finish(), Abandon() have not been called
+  void Abandon() override { closed_ = true; }
+
+  // Number of calls to Add() so far.
+  uint64_t NumEntries() const override { return properties_.num_entries; }
+
+  // Size of the file generated so far.  If invoked after a successful
+  // Finish() call, returns the size of the final generated file.
+  uint64_t FileSize() const override { return offset_; }
+
+  TableProperties GetTableProperties() const override { return properties_; }
+
+  enum EntryKind : char {
+    kColumnarEntry = 0,
+    kRawEntry = 1,
+  };
+
+ private:
+  void ResetEncoders();
+  // Encode, compress and write the entries added since the last data block
+  void FlushDataBlock();
+  void WriteBlock(const Slice& block_contents, CompressionType type,
+                  BlockHandle* handle);
+
+  const ImmutableCFOptions& ioptions_;
+  ColumnAwareSchema schema_;
+  const ColumnAwareTableOptions table_options_;
+  const CompressionType compression_type_;
+  const CompressionOptions compression_opts_;
+  WritableFileWriter* file_;
+  uint64_t offset_;
+  Status status_;
+  TableProperties properties_;
+  std::vector<std::unique_ptr<IntTblPropCollector>>
+      table_properties_collectors_;
+
+  // Columns of the current data block
+  std::unique_ptr<ColBufEncoder> entry_kinds_;
+  std::unique_ptr<ColBufEncoder> key_footers_;
+  std::unique_ptr<KVPairColBufEncoders> columns_;
+  std::string raw_entries_;
+  uint32_t block_entries_;
+  // Size of the keys and values of the current data block
+  size_t block_raw_size_;
+  std::string last_key_;
+
+  std::string index_block_;
+  uint64_t num_raw_entries_;
+
+  bool closed_;  // Either Finish() or Abandon() has been called.
+
+  // No copying allowed
+  ColumnAwareTableBuilder(const ColumnAwareTableBuilder&) = delete;
+  void operator=(const ColumnAwareTableBuilder&) = delete;
+};
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,303 @@
+// Copyright (c) 2011-present, Facebook, Inc. All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef ROCKSDB_LITE
+#include "table/column_aware_table_factory.h"
+
+#include "db/dbformat.h"
+#include "port/port.h"
+#include "table/column_aware_table_builder.h"
+#include "table/column_aware_table_reader.h"
+#include "util/coding.h"
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+const std::string ColumnAwareTablePropertyNames::kSchema =
+    "rocksdb.column.aware.schema";
+const std::string ColumnAwareTablePropertyNames::kNumRawEntries =
+    "rocksdb.column.aware.num.raw.entries";
+
+namespace {
+
+const uint32_t kSchemaVersion = 1;
+
+bool IsRunLength(ColCompressionType type) {
+  return type == kColRle || type == kColRleVarint ||
+         type == kColRleDeltaVarint || type == kColRleDict;
+}
+
+void EncodeColDeclaration(const ColDeclaration& col, std::string* dst) {
+  PutLengthPrefixedSlice(dst, col.col_type);
+  PutVarint32(dst, static_cast<uint32_t>(col.col_compression_type));
+  PutVarint64(dst, col.size);
+  dst->push_back(col.nullable ? 1 : 0);
+  dst->push_back(col.big_endian ? 1 : 0);
+}
+
+bool DecodeColDeclaration(Slice* input, ColDeclaration* col) {
+  Slice col_type;
+  uint32_t compression_type;
+  uint64_t size;
+  if (!GetLengthPrefixedSlice(input, &col_type) ||
+      !GetVarint32(input, &compression_type) ||
+      compression_type > kColRleDict || !GetVarint64(input, &size) ||
+      input->size() < 2) {
+    return false;
+  }
+  col->col_type = col_type.ToString();
+  col->col_compression_type = static_cast<ColCompressionType>(compression_type);
+  col->size = static_cast<size_t>(size);
+  col->nullable = (*input)[0] != 0;
+  col->big_endian = (*input)[1] != 0;
+  input->remove_prefix(2);
+  return true;
+}
+
+Status ValidateColDeclaration(const ColDeclaration& col) {
+  ColCompressionType type = col.col_compression_type;
+  if (col.col_type == "FixedLength") {
+    if (col.size == 0 || col.size > 8) {
+      return Status::InvalidArgument(
+          "FixedLength columns must be 1 to 8 bytes long");
+    }
+  } else if (col.col_type == "LongFixedLength") {
+    if (col.size == 0 || type != kColNoCompression) {
+      return Status::InvalidArgument(
+          "LongFixedLength columns must not be empty or encoded");
+    }
+  } else if (col.col_type == "VariableLength") {
+    if (type != kColNoCompression) {
+      return Status::InvalidArgument(
+          "VariableLength columns must not be encoded");
+    }
+  } else if (col.col_type == "VariableChunk") {
+    if (type != kColNoCompression && type != kColDict) {
+      return Status::InvalidArgument(
+          "VariableChunk columns only support dictionary encoding");
+    }
+  } else {
+    return Status::InvalidArgument("Unknown column type " + col.col_type);
+  }
+  // The null marks are written as the values come, but runs only when they
+  // end
+  if (col.nullable && (IsRunLength(type) || col.col_type == "VariableLength" ||
+                       col.col_type == "VariableChunk")) {
+    return Status::InvalidArgument(
+        "Nullable columns must have a fixed length and no run-length "
+        "encoding");
+  }
+  return Status::OK();
+}
+
+// Size of the value of col at the start of data, or 0 if data does not start
+// with a value the column can store
+size_t ColumnValueSize(const ColDeclaration& col, const Slice& data) {
+  if (col.col_type == "FixedLength" || col.col_type == "LongFixedLength") {
+    return data.size() >= col.size ? col.size : 0;
+  } else if (col.col_type == "VariableLength") {
+    if (data.empty()) {
+      return 0;
+    }
+    size_t size = 1 + static_cast<uint8_t>(data[0]);
+    return data.size() >= size ? size : 0;
+  } else if (col.col_type == "VariableChunk") {
+    // 8-byte chunks, each followed by a mark that is 0xFF if more chunks
+    // follow, and 0xF7 plus the number of bytes used in the chunk otherwise
+    for (size_t size = 9; size <= data.size(); size += 9) {
+      uint8_t mark = static_cast<uint8_t>(data[size - 1]);
+      if (mark == 0xFF) {
+        continue;
+      }
+      if (mark < 0xF7) {
+        return 0;
+      }
+      if (col.col_compression_type != kColDict) {
+        // Only the used bytes are stored, and they are decoded zero padded
+        for (size_t i = mark - 0xF7; i < 8; i++) {
+          if (data[size - 9 + i] != 0) {
+            return 0;
+          }
+        }
+      }
+      return size;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+ColumnAwareSchema::ColumnAwareSchema(const KVPairColDeclarations& declarations)
+    : key_col_declarations(*declarations.key_col_declarations),
+      value_col_declarations(*declarations.value_col_declarations) {
+  if (declarations.value_checksum_declaration != nullptr) {
+    value_checksum_declaration.reset(
+        new ColDeclaration(*declarations.value_checksum_declaration));
+  }
+}
+
+ColumnAwareSchema::ColumnAwareSchema(const ColumnAwareSchema& other)
+    : key_col_declarations(other.key_col_declarations),
+      value_col_declarations(other.value_col_declarations) {
+  if (other.value_checksum_declaration) {
+    value_checksum_declaration.reset(
+        new ColDeclaration(*other.value_checksum_declaration));
+  }
+}
+
+KVPairColDeclarations ColumnAwareSchema::declarations() {
+  return KVPairColDeclarations(&key_col_declarations, &value_col_declarations,
+                               value_checksum_declaration.get());
+}
+
+void ColumnAwareSchema::EncodeTo(std::string* dst) const {
+  PutVarint32(dst, kSchemaVersion);
+  PutVarint32(dst, static_cast<uint32_t>(key_col_declarations.size()));
+  for (const auto& col : key_col_declarations) {
+    EncodeColDeclaration(col, dst);
+  }
+  PutVarint32(dst, static_cast<uint32_t>(value_col_declarations.size()));
+  for (const auto& col : value_col_declarations) {
+    EncodeColDeclaration(col, dst);
+  }
+  dst->push_back(value_checksum_declaration ? 1 : 0);
+  if (value_checksum_declaration) {
+    EncodeColDeclaration(*value_checksum_declaration, dst);
+  }
+}
+
+Status ColumnAwareSchema::DecodeFrom(const Slice& input) {
+  Slice in = input;
+  uint32_t version;
+  if (!GetVarint32(&in, &version) || version != kSchemaVersion) {
+    return Status::Corruption("Unknown column-aware schema version");
+  }
+  for (auto* cols : {&key_col_declarations, &value_col_declarations}) {
+    uint32_t num_cols;
+    if (!GetVarint32(&in, &num_cols)) {
+      return Status::Corruption("Bad column-aware schema");
+    }
+    cols->clear();
+    for (uint32_t i = 0; i < num_cols; i++) {
+      cols->emplace_back("");
+      if (!DecodeColDeclaration(&in, &cols->back())) {
+        return Status::Corruption("Bad column declaration");
+      }
+    }
+  }
+  if (in.empty()) {
+    return Status::Corruption("Bad column-aware schema");
+  }
+  bool has_value_checksum = in[0] != 0;
+  in.remove_prefix(1);
+  value_checksum_declaration.reset();
+  if (has_value_checksum) {
+    value_checksum_declaration.reset(new ColDeclaration(""));
+    if (!DecodeColDeclaration(&in, value_checksum_declaration.get())) {
+      return Status::Corruption("Bad column declaration");
+    }
+  }
+  return Status::OK();
+}
+
+Status ColumnAwareSchema::Validate() const {
+  for (const auto* cols : {&key_col_declarations, &value_col_declarations}) {
+    for (const auto& col : *cols) {
+      Status s = ValidateColDeclaration(col);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+  }
+  if (value_checksum_declaration) {
+    return ValidateColDeclaration(*value_checksum_declaration);
+  }
+  return Status::OK();
+}
+
+bool ColumnAwareSchema::Fits(const Slice& user_key, const Slice& value) const {
+  Slice key_rest = user_key;
+  for (const auto& col : key_col_declarations) {
+    size_t size = ColumnValueSize(col, key_rest);
+    if (size == 0) {
+      return false;
+    }
+    key_rest.remove_prefix(size);
+  }
+  if (!key_rest.empty()) {
+    return false;
+  }
+  Slice value_rest = value;
+  for (const auto& col : value_col_declarations) {
+    size_t size = ColumnValueSize(col, value_rest);
+    if (size == 0) {
+      return false;
+    }
+    value_rest.remove_prefix(size);
+  }
+  if (value_rest.empty()) {
+    return !value_checksum_declaration || value_checksum_declaration->nullable;
+  }
+  return value_checksum_declaration &&
+         ColumnValueSize(*value_checksum_declaration, value_rest) ==
+             value_rest.size();
+}
+
+Status ColumnAwareTableFactory::NewTableReader(
+    const TableReaderOptions& table_reader_options,
+    unique_ptr<RandomAccessFileReader>&& file, uint64_t file_size,
+    std::unique_ptr<TableReader>* table,
+    bool prefetch_index_and_filter_in_cache) const {
+  return ColumnAwareTableReader::Open(
+      table_reader_options.ioptions, table_reader_options.internal_comparator,
+      std::move(file), file_size, table);
+}
+
+TableBuilder* ColumnAwareTableFactory::NewTableBuilder(
+    const TableBuilderOptions& table_builder_options, uint32_t column_family_id,
+    WritableFileWriter* file) const {
+  return new ColumnAwareTableBuilder(
+      table_builder_options.ioptions, schema_, table_options_,
+      table_builder_options.int_tbl_prop_collector_factories,
+      table_builder_options.compression_type,
+      table_builder_options.compression_opts, column_family_id,
+      table_builder_options.column_family_name, file);
+}
+
+Status ColumnAwareTableFactory::SanitizeOptions(
+    const DBOptions& db_opts, const ColumnFamilyOptions& cf_opts) const {
+  return schema_.Validate();
+}
+
+std::string ColumnAwareTableFactory::GetPrintableTableOptions() const {
+  std::string ret;
+  ret.reserve(2000);
+  const int kBufferSize = 200;
+  char buffer[kBufferSize];
+
+  snprintf(buffer, kBufferSize, "  block_size: %" ROCKSDB_PRIszt "\n",
+           table_options_.block_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  key_columns: %" ROCKSDB_PRIszt "\n",
+           schema_.key_col_declarations.size());
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  value_columns: %" ROCKSDB_PRIszt "\n",
+           schema_.value_col_declarations.size());
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  value_checksum_column: %d\n",
+           schema_.value_checksum_declaration != nullptr);
+  ret.append(buffer);
+  return ret;
+}
+
+TableFactory* NewColumnAwareTableFactory(
+    const KVPairColDeclarations& declarations,
+    const ColumnAwareTableOptions& table_options) {
+  return new ColumnAwareTableFactory(declarations, table_options);
+}
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,116 @@
+// Copyright (c) 2011-present, Facebook, Inc. All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "rocksdb/options.h"
+#include "rocksdb/table.h"
+#include "utilities/col_buf_encoder.h"
+
+namespace rocksdb {
+
+struct ColumnAwareTablePropertyNames {
+  // The encoded ColumnAwareSchema of the table
+  static const std::string kSchema;
+  // Number of entries that did not fit the schema and were stored as is
+  static const std::string kNumRawEntries;
+};
+
+// The column declarations of a column-aware table. Unlike
+// KVPairColDeclarations, it owns them.
+struct ColumnAwareSchema {
+  ColumnAwareSchema() {}
+  explicit ColumnAwareSchema(const KVPairColDeclarations& declarations);
+  ColumnAwareSchema(const ColumnAwareSchema& other);
+
+  // Columns a user key is split into. They must cover the whole key.
+  std::vector<ColDeclaration> key_col_declarations;
+  // Columns a value starts with
+  std::vector<ColDeclaration> value_col_declarations;
+  // The rest of a value, if any. A value without a rest is stored as null,
+  // so this must be nullable for such values to fit the schema.
+  std::unique_ptr<ColDeclaration> value_checksum_declaration;
+
+  // The declarations to create KVPairColBufEncoders and KVPairColBufDecoders
+  // from. They point into this schema.
+  KVPairColDeclarations declarations();
+
+  void EncodeTo(std::string* dst) const;
+  Status DecodeFrom(const Slice& input);
+
+  // Returns InvalidArgument if the column encoders and decoders cannot
+  // round-trip some declaration
+  Status Validate() const;
+
+  // Whether the columns of the schema can store user_key and value. Entries
+  // that do not fit are stored as is.
+  bool Fits(const Slice& user_key, const Slice& value) const;
+
+ private:
+  void operator=(const ColumnAwareSchema&) = delete;
+};
+
+struct ColumnAwareTableOptions {
+  // Approximate size of the keys and values stored in a data block before
+  // they are encoded and compressed
+  size_t block_size = 16 * 1024;
+};
+
+// Column-aware table stores the entries of a data block column by column, so
+// that fixed-schema keys and values can be encoded with the delta, run-length
+// and dictionary encodings of ColBufEncoder before the block is compressed.
+// Get() and iterators reconstruct the entries. Iterators that set
+// ReadOptions::projected_value_columns only decode the requested columns.
+//
+// The schema is stored in the table, so a table can be read whatever the
+// declarations of the factory are. Entries whose key or value does not fit
+// the schema are stored as is.
+//
+// Some assumptions:
+// - Does not support range deletions.
+// - Data blocks are not cached.
+class ColumnAwareTableFactory : public TableFactory {
+ public:
+  ColumnAwareTableFactory(const KVPairColDeclarations& declarations,
+                          const ColumnAwareTableOptions& table_options)
+      : schema_(declarations), table_options_(table_options) {}
+  ~ColumnAwareTableFactory() {}
+
+  const char* Name() const override { return "ColumnAwareTable"; }
+
+  Status NewTableReader(
+      const TableReaderOptions& table_reader_options,
+      unique_ptr<RandomAccessFileReader>&& file, uint64_t file_size,
+      unique_ptr<TableReader>* table,
+      bool prefetch_index_and_filter_in_cache = true) const override;
+
+  TableBuilder* NewTableBuilder(
+      const TableBuilderOptions& table_builder_options,
+      uint32_t column_family_id, WritableFileWriter* file) const override;
+
+  // Returns InvalidArgument if the declarations are not supported
+  Status SanitizeOptions(const DBOptions& db_opts,
+                         const ColumnFamilyOptions& cf_opts) const override;
+
+  std::string GetPrintableTableOptions() const override;
+
+  void* GetOptions() override { return &table_options_; }
+
+ private:
+  ColumnAwareSchema schema_;
+  ColumnAwareTableOptions table_options_;
+};
+
+// The declarations are copied
+extern TableFactory* NewColumnAwareTableFactory(
+    const KVPairColDeclarations& declarations,
+    const ColumnAwareTableOptions& table_options = ColumnAwareTableOptions());
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,469 @@
+// Copyright (c) 2011-present, Facebook, Inc. All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef ROCKSDB_LITE
+#include "table/column_aware_table_reader.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include "db/pinned_iterators_manager.h"
+#include "table/column_aware_table_builder.h"
+#include "table/get_context.h"
+#include "table/internal_iterator.h"
+#include "table/meta_blocks.h"
+#include "util/arena.h"
+#include "util/coding.h"
+#include "utilities/col_buf_decoder.h"
+
+namespace rocksdb {
+
+extern const uint64_t kColumnAwareTableMagicNumber;
+
+namespace {
+
+// Decode the next value of col from *src, which must not pass limit, to the
+// end of *dest
+Status DecodeColumnValue(const ColDeclaration& col, ColBufDecoder* decoder,
+                         const char* limit, const char** src,
+                         std::string* dest) {
+  if (!decoder->CheckNext(*src, limit)) {
+    return Status::Corruption("Column overflows its data block");
+  }
+  size_t max_size = col.size;
+  if (col.col_type == "VariableLength") {
+    max_size = 1 + 255;
+  } else if (col.col_type == "VariableChunk") {
+    // Checked above: the chunks of size fit before limit
+    uint64_t size = 0;
+    GetVarint64Ptr(*src, limit, &size);
+    max_size = static_cast<size_t>(size / 8 + 1) * 9;
+  }
+  size_t old_size = dest->size();
+  dest->resize(old_size + max_size);
+  char* out = &(*dest)[old_size];
+  *src += decoder->Decode(*src, &out);
+  dest->resize(out - dest->data());
+  return Status::OK();
+}
+
+}  // namespace
+
+size_t ColumnAwareEntries::LowerBound(const InternalKeyComparator& icomp,
+                                      const Slice& target) const {
+  size_t left = 0;
+  size_t right = size();
+  while (left < right) {
+    size_t mid = left + (right - left) / 2;
+    if (icomp.Compare(key(mid), target) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+void ColumnAwareEntries::Clear() {
+  keys_.clear();
+  values_.clear();
+  key_ends_.assign(1, 0);
+  value_ends_.assign(1, 0);
+}
+
+class ColumnAwareTableIterator : public InternalIterator {
+ public:
+  ColumnAwareTableIterator(ColumnAwareTableReader* table,
+                           const ReadOptions& read_options)
+      : table_(table),
+        read_options_(read_options),
+        num_blocks_(table->block_handles_.size()),
+        block_(num_blocks_),
+        entry_(0),
+        entries_(new ColumnAwareEntries()),
+        pinned_iters_mgr_(nullptr) {}
+  ~ColumnAwareTableIterator() {}
+
+  bool Valid() const override {
+    return block_ < num_blocks_ && entry_ < entries_->size();
+  }
+
+  void SeekToFirst() override {
+    LoadBlock(0);
+    entry_ = 0;
+  }
+
+  void SeekToLast() override {
+    LoadBlock(num_blocks_ - 1);
+    entry_ = entries_->size() - 1;
+  }
+
+  void Seek(const Slice& target) override {
+    size_t block = table_->FindBlock(target);
+    LoadBlock(block);
+    if (block_ < num_blocks_) {
+      entry_ = entries_->LowerBound(table_->icomp_, target);
+    }
+  }
+
+  void SeekForPrev(const Slice& target) override {
+    SeekForPrevImpl(target, &table_->icomp_);
+  }
+
+  void Next() override {
+    assert(Valid());
+    if (++entry_ == entries_->size()) {
+      LoadBlock(block_ + 1);
+      entry_ = 0;
+    }
+  }
+
+  void Prev() override {
+    assert(Valid());
+    if (entry_ == 0) {
+      // Wraps around to num_blocks_ from the first block
+      LoadBlock(block_ - 1);
+      entry_ = entries_->size() - 1;
+    } else {
+      entry_--;
+    }
+  }
+
+  Slice key() const override {
+    assert(Valid());
+    return entries_->key(entry_);
+  }
+
+  Slice value() const override {
+    assert(Valid());
+    return entries_->value(entry_);
+  }
+
+  Status status() const override { return status_; }
+
+  void SetPinnedItersMgr(PinnedIteratorsManager* pinned_iters_mgr) override {
+    pinned_iters_mgr_ = pinned_iters_mgr;
+  }
+
+  // The entries of the blocks left while pinning is enabled are handed to
+  // the PinnedIteratorsManager
+  bool IsKeyPinned() const override {
+    return pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled();
+  }
+
+  bool IsValuePinned() const override {
+    return pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled();
+  }
+
+ private:
+  // Make block i current, or invalidate the iterator if there is no such
+  // block
+  void LoadBlock(size_t i) {
+    if (i == block_ && status_.ok()) {
+      return;
+    }
+    if (pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled() &&
+        block_ < num_blocks_) {
+      pinned_iters_mgr_->PinPtr(entries_.release(), &ReleaseEntries);
+      entries_.reset(new ColumnAwareEntries());
+    }
+    if (i >= num_blocks_ || !status_.ok()) {
+      block_ = num_blocks_;
+      entries_->Clear();
+      return;
+    }
+    status_ = table_->ReadEntries(read_options_, i,
+                                  read_options_.projected_value_columns,
+                                  entries_.get());
+    block_ = status_.ok() ? i : num_blocks_;
+  }
+
+  ColumnAwareTableReader* table_;
+  const ReadOptions read_options_;
+  const size_t num_blocks_;
+  size_t block_;
+  size_t entry_;
+  std::unique_ptr<ColumnAwareEntries> entries_;
+  Status status_;
+  PinnedIteratorsManager* pinned_iters_mgr_;
+
+  static void ReleaseEntries(void* entries) {
+    delete reinterpret_cast<ColumnAwareEntries*>(entries);
+  }
+
+  // No copying allowed
+  ColumnAwareTableIterator(const ColumnAwareTableIterator&) = delete;
+  void operator=(const ColumnAwareTableIterator&) = delete;
+};
+
+ColumnAwareTableReader::ColumnAwareTableReader(
+    const ImmutableCFOptions& ioptions,
+    const InternalKeyComparator& internal_comparator,
+    unique_ptr<RandomAccessFileReader>&& file, const Footer& footer,
+    TableProperties* table_props)
+    : ioptions_(ioptions),
+      icomp_(internal_comparator),
+      file_(std::move(file)),
+      footer_(footer),
+      table_props_(table_props) {}
+
+Status ColumnAwareTableReader::Open(
+    const ImmutableCFOptions& ioptions,
+    const InternalKeyComparator& internal_comparator,
+    unique_ptr<RandomAccessFileReader>&& file, uint64_t file_size,
+    unique_ptr<TableReader>* table) {
+  Footer footer;
+  Status s = ReadFooterFromFile(file.get(), file_size, &footer,
+                                kColumnAwareTableMagicNumber);
+  if (!s.ok()) {
+    return s;
+  }
+  TableProperties* props = nullptr;
+  s = ReadTableProperties(file.get(), file_size, kColumnAwareTableMagicNumber,
+                          ioptions, &props);
+  if (!s.ok()) {
+    return s;
+  }
+  std::unique_ptr<ColumnAwareTableReader> new_reader(new ColumnAwareTableReader(
+      ioptions, internal_comparator, std::move(file), footer, props));
+
+  auto& user_props = props->user_collected_properties;
+  auto schema = user_props.find(ColumnAwareTablePropertyNames::kSchema);
+  if (schema == user_props.end()) {
+    return Status::Corruption("Column-aware table without a schema");
+  }
+  s = new_reader->schema_.DecodeFrom(schema->second);
+  if (s.ok()) {
+    s = new_reader->schema_.Validate();
+  }
+  if (s.ok()) {
+    s = new_reader->ReadIndex();
+  }
+  if (s.ok()) {
+    *table = std::move(new_reader);
+  }
+  return s;
+}
+
+Status ColumnAwareTableReader::ReadIndex() {
+  BlockContents contents;
+  Status s = ReadBlockContents(file_.get(), footer_, ReadOptions(),
+                               footer_.index_handle(), &contents, ioptions_,
+                               false /* decompress */);
+  if (!s.ok()) {
+    return s;
+  }
+  Slice input = contents.data;
+  while (!input.empty()) {
+    Slice last_key;
+    BlockHandle handle;
+    if (!GetLengthPrefixedSlice(&input, &last_key) ||
+        !handle.DecodeFrom(&input).ok()) {
+      return Status::Corruption("Bad column-aware table index");
+    }
+    last_keys_.push_back(last_key.ToString());
+    block_handles_.push_back(handle);
+  }
+  return Status::OK();
+}
+
+size_t ColumnAwareTableReader::FindBlock(const Slice& target) const {
+  return std::lower_bound(last_keys_.begin(), last_keys_.end(), target,
+                          [this](const std::string& last_key,
+                                 const Slice& key) {
+                            return icomp_.Compare(last_key, key) < 0;
+                          }) -
+         last_keys_.begin();
+}
+
+Status ColumnAwareTableReader::ReadEntries(
+    const ReadOptions& read_options, size_t i,
+    const std::vector<uint32_t>* projected_value_columns,
+    ColumnAwareEntries* entries) {
+  BlockContents contents;
+  Status s = ReadBlockContents(file_.get(), footer_, read_options,
+                               block_handles_[i], &contents, ioptions_);
+  if (!s.ok()) {
+    return s;
+  }
+  return DecodeEntries(contents.data, projected_value_columns, entries);
+}
+
+Status ColumnAwareTableReader::DecodeEntries(
+    const Slice& block, const std::vector<uint32_t>* projected_value_columns,
+    ColumnAwareEntries* entries) {
+  entries->Clear();
+
+  KVPairColBufDecoders decoders(schema_.declarations());
+  FixedLengthColBufDecoder entry_kinds(1, kColRle);
+  FixedLengthColBufDecoder key_footers(8, kColRleDeltaVarint);
+  // Same order as the columns in the block, but for the raw entries
+  std::vector<ColBufDecoder*> columns;
+  std::vector<const ColDeclaration*> declarations;
+  columns.push_back(&entry_kinds);
+  columns.push_back(&key_footers);
+  declarations.resize(2, nullptr);
+  for (size_t i = 0; i < decoders.key_col_bufs.size(); i++) {
+    columns.push_back(decoders.key_col_bufs[i].get());
+    declarations.push_back(&schema_.key_col_declarations[i]);
+  }
+  const size_t first_value_column = columns.size();
+  for (size_t i = 0; i < decoders.value_col_bufs.size(); i++) {
+    columns.push_back(decoders.value_col_bufs[i].get());
+    declarations.push_back(&schema_.value_col_declarations[i]);
+  }
+  if (decoders.value_checksum_buf) {
+    columns.push_back(decoders.value_checksum_buf.get());
+    declarations.push_back(schema_.value_checksum_declaration.get());
+  }
+  std::vector<bool> decode_column(columns.size(),
+                                  projected_value_columns == nullptr);
+  std::fill(decode_column.begin(), decode_column.begin() + first_value_column,
+            true);
+  if (projected_value_columns != nullptr) {
+    for (uint32_t i : *projected_value_columns) {
+      if (first_value_column + i < columns.size()) {
+        decode_column[first_value_column + i] = true;
+      }
+    }
+  }
+
+  Slice input = block;
+  uint32_t num_entries;
+  std::vector<uint64_t> sizes(columns.size() + 1);
+  if (!GetVarint32(&input, &num_entries)) {
+    return Status::Corruption("Bad column-aware data block");
+  }
+  for (auto& size : sizes) {
+    if (!GetVarint64(&input, &size)) {
+      return Status::Corruption("Bad column-aware data block");
+    }
+  }
+  std::vector<const char*> pos(columns.size());
+  std::vector<const char*> limits(columns.size());
+  for (size_t i = 0; i < sizes.size(); i++) {
+    if (sizes[i] > input.size()) {
+      return Status::Corruption("Column overflows its data block");
+    }
+    if (i < columns.size()) {
+      pos[i] = input.data();
+      limits[i] = input.data() + sizes[i];
+      if (decode_column[i]) {
+        if (!columns[i]->CheckInit(pos[i], limits[i])) {
+          return Status::Corruption("Column overflows its data block");
+        }
+        pos[i] += columns[i]->Init(pos[i]);
+      }
+      input.remove_prefix(static_cast<size_t>(sizes[i]));
+    }
+  }
+  Slice raw_entries = input;
+
+  for (uint32_t n = 0; n < num_entries; n++) {
+    if (!entry_kinds.CheckNext(pos[0], limits[0])) {
+      return Status::Corruption("Bad entry kinds");
+    }
+    char kind;
+    char* out = &kind;
+    pos[0] += entry_kinds.Decode(pos[0], &out);
+    if (kind == ColumnAwareTableBuilder::kRawEntry) {
+      Slice key, value;
+      if (!GetLengthPrefixedSlice(&raw_entries, &key) ||
+          !GetLengthPrefixedSlice(&raw_entries, &value)) {
+        return Status::Corruption("Bad raw entry");
+      }
+      entries->keys_.append(key.data(), key.size());
+      entries->values_.append(value.data(), value.size());
+    } else if (kind == ColumnAwareTableBuilder::kColumnarEntry) {
+      for (size_t i = 2; i < first_value_column; i++) {
+        Status s = DecodeColumnValue(*declarations[i], columns[i], limits[i],
+                                     &pos[i], &entries->keys_);
+        if (!s.ok()) {
+          return s;
+        }
+      }
+      if (!key_footers.CheckNext(pos[1], limits[1])) {
+        return Status::Corruption("Bad key footers");
+      }
+      char footer_buf[8];
+      out = footer_buf;
+      pos[1] += key_footers.Decode(pos[1], &out);
+      uint64_t footer;
+      memcpy(&footer, footer_buf, sizeof(footer));
+      PutFixed64(&entries->keys_, footer);
+      for (size_t i = first_value_column; i < columns.size(); i++) {
+        if (decode_column[i]) {
+          Status s = DecodeColumnValue(*declarations[i], columns[i],
+                                       limits[i], &pos[i], &entries->values_);
+          if (!s.ok()) {
+            return s;
+          }
+        }
+      }
+    } else {
+      return Status::Corruption("Unknown entry kind");
+    }
+    entries->key_ends_.push_back(entries->keys_.size());
+    entries->value_ends_.push_back(entries->values_.size());
+  }
+  return Status::OK();
+}
+
+Status ColumnAwareTableReader::Get(const ReadOptions& read_options,
+                                   const Slice& key, GetContext* get_context,
+                                   bool skip_filters) {
+  ColumnAwareEntries entries;
+  for (size_t block = FindBlock(key); block < block_handles_.size();
+       block++) {
+    // Values reach merge operators and the caller whole, so Get() never
+    // projects
+    Status s = ReadEntries(read_options, block,
+                           nullptr /* projected_value_columns */, &entries);
+    if (!s.ok()) {
+      return s;
+    }
+    for (size_t i = entries.LowerBound(icomp_, key); i < entries.size(); i++) {
+      ParsedInternalKey parsed_key;
+      if (!ParseInternalKey(entries.key(i), &parsed_key)) {
+        return Status::Corruption("Bad internal key");
+      }
+      if (!get_context->SaveValue(parsed_key, entries.value(i))) {
+        return Status::OK();
+      }
+    }
+  }
+  return Status::OK();
+}
+
+InternalIterator* ColumnAwareTableReader::NewIterator(
+    const ReadOptions& read_options, Arena* arena, bool skip_filters,
+    bool for_compaction) {
+  if (arena == nullptr) {
+    return new ColumnAwareTableIterator(this, read_options);
+  } else {
+    auto mem = arena->AllocateAligned(sizeof(ColumnAwareTableIterator));
+    return new (mem) ColumnAwareTableIterator(this, read_options);
+  }
+}
+
+uint64_t ColumnAwareTableReader::ApproximateOffsetOf(const Slice& key) {
+  size_t block = FindBlock(key);
+  if (block < block_handles_.size()) {
+    return block_handles_[block].offset();
+  }
+  return table_props_->data_size;
+}
+
+size_t ColumnAwareTableReader::ApproximateMemoryUsage() const {
+  size_t usage = block_handles_.size() * sizeof(BlockHandle);
+  for (const auto& last_key : last_keys_) {
+    usage += last_key.size();
+  }
+  return usage;
+}
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,122 @@
+// Copyright (c) 2011-present, Facebook, Inc. All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+#ifndef ROCKSDB_LITE
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/options.h"
+#include "table/column_aware_table_factory.h"
+#include "table/format.h"
+#include "table/table_reader.h"
+#include "util/cf_options.h"
+#include "util/file_reader_writer.h"
+
+namespace rocksdb {
+
+class Arena;
+class InternalIterator;
+
+// The entries of a data block, reconstructed from its columns
+class ColumnAwareEntries {
+ public:
+  ColumnAwareEntries() { Clear(); }
+
+  size_t size() const { return key_ends_.size() - 1; }
+  Slice key(size_t i) const {
+    return Slice(keys_.data() + key_ends_[i], key_ends_[i + 1] - key_ends_[i]);
+  }
+  Slice value(size_t i) const {
+    return Slice(values_.data() + value_ends_[i],
+                 value_ends_[i + 1] - value_ends_[i]);
+  }
+
+  // Index of the first entry at or past target
+  size_t LowerBound(const InternalKeyComparator& icomp,
+                    const Slice& target) const;
+
+  void Clear();
+
+ private:
+  friend class ColumnAwareTableReader;
+
+  std::string keys_;
+  std::string values_;
+  // Offsets of the entries in keys_ and values_, followed by the sizes of
+  // keys_ and values_
+  std::vector<size_t> key_ends_;
+  std::vector<size_t> value_ends_;
+};
+
+class ColumnAwareTableReader : public TableReader {
+ public:
+  static Status Open(const ImmutableCFOptions& ioptions,
+                     const InternalKeyComparator& internal_comparator,
+                     unique_ptr<RandomAccessFileReader>&& file,
+                     uint64_t file_size, unique_ptr<TableReader>* table);
+
+  ~ColumnAwareTableReader() {}
+
+  std::shared_ptr<const TableProperties> GetTableProperties() const override {
+    return table_props_;
+  }
+
+  Status Get(const ReadOptions& read_options, const Slice& key,
+             GetContext* get_context, bool skip_filters = false) override;
+
+  InternalIterator* NewIterator(const ReadOptions&, Arena* arena = nullptr,
+                                bool skip_filters = false,
+                                bool for_compaction = false) override;
+
+  uint64_t ApproximateOffsetOf(const Slice& key) override;
+
+  void SetupForCompaction() override {}
+
+  // Report an approximation of how much memory has been used.
+  size_t ApproximateMemoryUsage() const override;
+
+ private:
+  friend class ColumnAwareTableIterator;
+
+  ColumnAwareTableReader(const ImmutableCFOptions& ioptions,
+                         const InternalKeyComparator& internal_comparator,
+                         unique_ptr<RandomAccessFileReader>&& file,
+                         const Footer& footer, TableProperties* table_props);
+
+  Status ReadIndex();
+
+  // Index of the first data block whose last key is at or past target
+  size_t FindBlock(const Slice& target) const;
+
+  // Read data block i and reconstruct its entries, only with the value
+  // columns in projected_value_columns if it is not nullptr
+  Status ReadEntries(const ReadOptions& read_options, size_t i,
+                     const std::vector<uint32_t>* projected_value_columns,
+                     ColumnAwareEntries* entries);
+  Status DecodeEntries(const Slice& block,
+                       const std::vector<uint32_t>* projected_value_columns,
+                       ColumnAwareEntries* entries);
+
+  const ImmutableCFOptions& ioptions_;
+  const InternalKeyComparator& icomp_;
+  unique_ptr<RandomAccessFileReader> file_;
+  Footer footer_;
+  std::shared_ptr<const TableProperties> table_props_;
+  ColumnAwareSchema schema_;
+  // Last key and handle of each data block
+  std::vector<std::string> last_keys_;
+  std::vector<BlockHandle> block_handles_;
+
+  // No copying allowed
+  ColumnAwareTableReader(const ColumnAwareTableReader&) = delete;
+  void operator=(const ColumnAwareTableReader&) = delete;
+};
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,302 @@
+// Copyright (c) 2011-present, Facebook, Inc. All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef ROCKSDB_LITE
+
+#include <map>
+#include <string>
+#include <vector>
+#include "rocksdb/db.h"
+#include "rocksdb/table_properties.h"
+#include "table/column_aware_table_factory.h"
+#include "util/coding.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+#include "util/testutil.h"
+#include "utilities/merge_operators.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Keys are big-endian ids. Values are a category, a timestamp, a name and
+// an optional 4-byte checksum.
+std::string MakeKey(uint64_t id) {
+  std::string key(8, 0);
+  for (int i = 0; i < 8; i++) {
+    key[i] = static_cast<char>(id >> (56 - 8 * i));
+  }
+  return key;
+}
+
+std::string MakeValue(uint32_t category, uint64_t timestamp,
+                      const std::string& name, bool with_checksum) {
+  std::string value;
+  PutFixed32(&value, category);
+  PutFixed64(&value, timestamp);
+  value.push_back(static_cast<char>(name.size()));
+  value.append(name);
+  if (with_checksum) {
+    PutFixed32(&value, category * 31 + static_cast<uint32_t>(timestamp));
+  }
+  return value;
+}
+
+}  // namespace
+
+class ColumnAwareTableTest : public testing::Test {
+ public:
+  ColumnAwareTableTest()
+      : dbname_(test::TmpDir() + "/column_aware_table_test"),
+        key_cols_{ColDeclaration("FixedLength", kColDeltaVarint, 8, false,
+                                 true /* big_endian */)},
+        value_cols_{ColDeclaration("FixedLength", kColRleVarint, 4),
+                    ColDeclaration("FixedLength", kColDeltaVarint, 8),
+                    ColDeclaration("VariableLength")},
+        checksum_col_("LongFixedLength", kColNoCompression, 4,
+                      true /* nullable */),
+        db_(nullptr) {
+    EXPECT_OK(DestroyDB(dbname_, Options()));
+  }
+
+  ~ColumnAwareTableTest() {
+    delete db_;
+    EXPECT_OK(DestroyDB(dbname_, Options()));
+  }
+
+  Options CurrentOptions() {
+    Options options;
+    options.create_if_missing = true;
+    options.table_factory.reset(NewColumnAwareTableFactory(
+        KVPairColDeclarations(&key_cols_, &value_cols_, &checksum_col_),
+        table_options_));
+    return options;
+  }
+
+  void Reopen(const Options& options) {
+    delete db_;
+    db_ = nullptr;
+    ASSERT_OK(DB::Open(options, dbname_, &db_));
+  }
+
+  std::string Get(const std::string& key) {
+    std::string value;
+    Status s = db_->Get(ReadOptions(), key, &value);
+    if (s.IsNotFound()) {
+      return "NOT_FOUND";
+    }
+    EXPECT_OK(s);
+    return value;
+  }
+
+  // Fills the DB with structured values, values without checksum and
+  // entries that do not fit the schema, and returns what it should contain
+  std::map<std::string, std::string> Fill(int num) {
+    std::map<std::string, std::string> expected;
+    for (int i = 0; i < num; i++) {
+      std::string key = MakeKey(1000 + i * 3);
+      std::string value = MakeValue(i / 100, 1500000000 + i * 7,
+                                    "name" + ToString(i % 17), i % 5 != 0);
+      if (i % 97 == 0) {
+        // Too short for the columns
+        value = "unstructured";
+      }
+      if (i % 101 == 0) {
+        // Too long for the key column
+        key.append("x");
+      }
+      EXPECT_OK(db_->Put(WriteOptions(), key, value));
+      expected[key] = value;
+    }
+    for (int i = 0; i < num; i += 13) {
+      std::string key = MakeKey(1000 + i * 3);
+      EXPECT_OK(db_->Delete(WriteOptions(), key));
+      expected.erase(key);
+    }
+    return expected;
+  }
+
+  std::string dbname_;
+  std::vector<ColDeclaration> key_cols_;
+  std::vector<ColDeclaration> value_cols_;
+  ColDeclaration checksum_col_;
+  ColumnAwareTableOptions table_options_;
+  DB* db_;
+};
+
+TEST_F(ColumnAwareTableTest, SchemaFits) {
+  ColumnAwareSchema schema(
+      KVPairColDeclarations(&key_cols_, &value_cols_, &checksum_col_));
+  ASSERT_OK(schema.Validate());
+  ASSERT_TRUE(schema.Fits(MakeKey(1), MakeValue(1, 2, "abc", true)));
+  ASSERT_TRUE(schema.Fits(MakeKey(1), MakeValue(1, 2, "abc", false)));
+  ASSERT_FALSE(schema.Fits(MakeKey(1) + "x", MakeValue(1, 2, "abc", true)));
+  ASSERT_FALSE(schema.Fits(MakeKey(1), MakeValue(1, 2, "abc", true) + "x"));
+  ASSERT_FALSE(schema.Fits(MakeKey(1), ""));
+
+  std::string encoded;
+  schema.EncodeTo(&encoded);
+  ColumnAwareSchema decoded;
+  ASSERT_OK(decoded.DecodeFrom(encoded));
+  std::string reencoded;
+  decoded.EncodeTo(&reencoded);
+  ASSERT_EQ(encoded, reencoded);
+  ASSERT_TRUE(decoded.DecodeFrom(Slice(encoded.data(), encoded.size() - 1))
+                  .IsCorruption());
+
+  // Null marks cannot be interleaved with runs
+  value_cols_.emplace_back("FixedLength", kColRle, 4, true /* nullable */);
+  ASSERT_TRUE(
+      ColumnAwareSchema(
+          KVPairColDeclarations(&key_cols_, &value_cols_, &checksum_col_))
+          .Validate()
+          .IsInvalidArgument());
+  Options options = CurrentOptions();
+  ASSERT_TRUE(DB::Open(options, dbname_, &db_).IsInvalidArgument());
+}
+
+TEST_F(ColumnAwareTableTest, GetAndIterate) {
+  table_options_.block_size = 1024;
+  Options options = CurrentOptions();
+  Reopen(options);
+  std::map<std::string, std::string> expected = Fill(2000);
+  ASSERT_OK(db_->Flush(FlushOptions()));
+
+  TablePropertiesCollection props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+  ASSERT_EQ(1U, props.size());
+  auto table_props = props.begin()->second;
+  ASSERT_GT(table_props->num_data_blocks, 1U);
+  Slice num_raw_entries = table_props->user_collected_properties.at(
+      ColumnAwareTablePropertyNames::kNumRawEntries);
+  uint64_t raw_entries;
+  ASSERT_TRUE(GetVarint64(&num_raw_entries, &raw_entries));
+  // The unstructured values, the long keys and the deletions
+  ASSERT_GT(raw_entries, 20U);
+  ASSERT_LT(raw_entries, 250U);
+
+  for (const auto& kv : expected) {
+    ASSERT_EQ(kv.second, Get(kv.first));
+  }
+  ASSERT_EQ("NOT_FOUND", Get(MakeKey(1000)));
+  ASSERT_EQ("NOT_FOUND", Get(MakeKey(1001)));
+  ASSERT_EQ("NOT_FOUND", Get(MakeKey(1000000)));
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  auto it = expected.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+    ASSERT_TRUE(it != expected.end());
+    ASSERT_EQ(it->first, iter->key().ToString());
+    ASSERT_EQ(it->second, iter->value().ToString());
+  }
+  ASSERT_TRUE(it == expected.end());
+  ASSERT_OK(iter->status());
+  auto rit = expected.rbegin();
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++rit) {
+    ASSERT_TRUE(rit != expected.rend());
+    ASSERT_EQ(rit->first, iter->key().ToString());
+  }
+  ASSERT_TRUE(rit == expected.rend());
+  for (uint64_t id : {0, 1000, 1001, 2500, 4000, 7000}) {
+    iter->Seek(MakeKey(id));
+    auto lower = expected.lower_bound(MakeKey(id));
+    ASSERT_EQ(lower != expected.end(), iter->Valid());
+    if (iter->Valid()) {
+      ASSERT_EQ(lower->first, iter->key().ToString());
+    }
+  }
+
+  iter.reset();
+
+  // The table is read with the schema it was written with
+  key_cols_.clear();
+  value_cols_.clear();
+  Reopen(CurrentOptions());
+  for (const auto& kv : expected) {
+    ASSERT_EQ(kv.second, Get(kv.first));
+  }
+}
+
+TEST_F(ColumnAwareTableTest, ProjectedScan) {
+  Reopen(CurrentOptions());
+  std::map<std::string, std::string> expected = Fill(1000);
+  ASSERT_OK(db_->Flush(FlushOptions()));
+
+  // The timestamps and the checksums
+  std::vector<uint32_t> projection = {1, 3};
+  ReadOptions read_options;
+  read_options.projected_value_columns = &projection;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  auto it = expected.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++it) {
+    ASSERT_TRUE(it != expected.end());
+    ASSERT_EQ(it->first, iter->key().ToString());
+    const std::string& value = it->second;
+    if (value == "unstructured" || it->first.size() != 8) {
+      ASSERT_EQ(value, iter->value().ToString());
+      continue;
+    }
+    std::string projected = value.substr(4, 8);
+    size_t checksum_offset = 4 + 8 + 1 + static_cast<uint8_t>(value[12]);
+    projected.append(value.substr(checksum_offset));
+    ASSERT_EQ(projected, iter->value().ToString());
+  }
+  ASSERT_TRUE(it == expected.end());
+  iter.reset();
+
+  // Get() returns whole values
+  std::string value;
+  ASSERT_OK(db_->Get(read_options, MakeKey(1003), &value));
+  ASSERT_EQ(expected[MakeKey(1003)], value);
+
+  // Merge operands cannot be merged from some of their columns
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  Reopen(options);
+  iter.reset(db_->NewIterator(read_options));
+  ASSERT_TRUE(iter->status().IsNotSupported());
+  std::vector<Iterator*> iters;
+  ASSERT_TRUE(db_->NewIterators(read_options, {db_->DefaultColumnFamily()},
+                                &iters)
+                  .IsNotSupported());
+  ASSERT_OK(db_->Get(read_options, MakeKey(1003), &value));
+  ASSERT_EQ(expected[MakeKey(1003)], value);
+}
+
+TEST_F(ColumnAwareTableTest, SmallerThanRows) {
+  Options options = CurrentOptions();
+  options.compression = kNoCompression;
+  Reopen(options);
+  for (int i = 0; i < 10000; i++) {
+    ASSERT_OK(db_->Put(WriteOptions(), MakeKey(i),
+                       MakeValue(i / 1000, 1500000000 + i, "n", true)));
+  }
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  TablePropertiesCollection props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+  auto table_props = props.begin()->second;
+  // Keys and sequence numbers shrink to a byte or two, and so do the
+  // category and the timestamp
+  ASSERT_LT(table_props->data_size * 2,
+            table_props->raw_key_size + table_props->raw_value_size);
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+  fprintf(stderr,
+          "SKIPPED as ColumnAwareTable is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // ROCKSDB_LITE
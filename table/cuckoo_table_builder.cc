@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "db/dbformat.h"
+#include "port/port.h"
 #include "rocksdb/env.h"
 #include "rocksdb/table.h"
 #include "table/block_builder.h"
@@ -53,7 +54,8 @@ CuckooTableBuilder::CuckooTableBuilder(
     const Comparator* user_comparator, uint32_t cuckoo_block_size,
     bool use_module_hash, bool identity_as_first_hash,
     uint64_t (*get_slice_hash)(const Slice&, uint32_t, uint64_t),
-    uint32_t column_family_id, const std::string& column_family_name)
+    uint32_t column_family_id, const std::string& column_family_name,
+    uint32_t num_build_threads)
     : num_hash_func_(2),
       file_(file),
       max_hash_table_ratio_(max_hash_table_ratio),
@@ -72,6 +74,7 @@ CuckooTableBuilder::CuckooTableBuilder(
       use_module_hash_(use_module_hash),
       identity_as_first_hash_(identity_as_first_hash),
       get_slice_hash_(get_slice_hash),
+      num_build_threads_(std::max(1U, num_build_threads)),
       closed_(false) {
   // Data is in a huge block.
   properties_.num_data_blocks = 1;
@@ -183,18 +186,66 @@ Slice CuckooTableBuilder::GetValue(uint64_t idx) const {
   return Slice(&kvs_[idx * (key_size_ + value_size_) + key_size_], value_size_);
 }
 
+void CuckooTableBuilder::ComputeHashes() {
+  // Fewer threads for small tables, which are not worth starting them for
+  const uint64_t kMinKeysPerThread = 64 * 1024;
+  num_precomputed_hashes_ = num_hash_func_;
+  hashes_.resize(num_entries_ * num_precomputed_hashes_);
+  auto compute = [this](uint64_t begin, uint64_t end) {
+    for (uint64_t idx = begin; idx < end; ++idx) {
+      Slice user_key = GetUserKey(idx);
+      for (uint32_t hash_cnt = 0; hash_cnt < num_precomputed_hashes_;
+           ++hash_cnt) {
+        hashes_[idx * num_precomputed_hashes_ + hash_cnt] =
+            CuckooHash(user_key, hash_cnt, use_module_hash_, hash_table_size_,
+                       identity_as_first_hash_, get_slice_hash_);
+      }
+    }
+  };
+  uint64_t num_threads = std::min<uint64_t>(
+      num_build_threads_, num_entries_ / kMinKeysPerThread + 1);
+  uint64_t keys_per_thread = (num_entries_ + num_threads - 1) / num_threads;
+  std::vector<port::Thread> threads;
+  for (uint64_t t = 1; t < num_threads; ++t) {
+    threads.emplace_back(
+        compute, t * keys_per_thread,
+        std::min(num_entries_, (t + 1) * keys_per_thread));
+  }
+  compute(0, std::min(num_entries_, keys_per_thread));
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+inline uint64_t CuckooTableBuilder::GetHash(uint64_t idx,
+                                            uint32_t hash_cnt) const {
+  if (hash_cnt < num_precomputed_hashes_) {
+    return hashes_[idx * num_precomputed_hashes_ + hash_cnt];
+  }
+  return CuckooHash(GetUserKey(idx), hash_cnt, use_module_hash_,
+                    hash_table_size_, identity_as_first_hash_,
+                    get_slice_hash_);
+}
+
 Status CuckooTableBuilder::MakeHashTable(std::vector<CuckooBucket>* buckets) {
   buckets->resize(hash_table_size_ + cuckoo_block_size_ - 1);
+  // Hashing is what can be done in parallel. The keys are then inserted one
+  // by one, so that the table does not depend on the number of threads.
+  ComputeHashes();
+  // How many keys ahead to prefetch the first bucket of
+  const uint32_t kPrefetchDistance = 8;
   uint32_t make_space_for_key_call_id = 0;
   for (uint32_t vector_idx = 0; vector_idx < num_entries_; vector_idx++) {
+    if (vector_idx + kPrefetchDistance < num_entries_) {
+      PREFETCH(&(*buckets)[GetHash(vector_idx + kPrefetchDistance, 0)], 1, 3);
+    }
     uint64_t bucket_id;
     bool bucket_found = false;
     autovector<uint64_t> hash_vals;
     Slice user_key = GetUserKey(vector_idx);
     for (uint32_t hash_cnt = 0; hash_cnt < num_hash_func_ && !bucket_found;
         ++hash_cnt) {
-      uint64_t hash_val = CuckooHash(user_key, hash_cnt, use_module_hash_,
-          hash_table_size_, identity_as_first_hash_, get_slice_hash_);
+      uint64_t hash_val = GetHash(vector_idx, hash_cnt);
       // If there is a collision, check next cuckoo_block_size_ locations for
       // empty locations. While checking, if we reach end of the hash table,
       // stop searching and proceed for next hash function.
@@ -237,6 +288,8 @@ Status CuckooTableBuilder::MakeHashTable(std::vector<CuckooBucket>* buckets) {
     }
     (*buckets)[bucket_id].vector_idx = vector_idx;
   }
+  std::vector<uint64_t>().swap(hashes_);
+  num_precomputed_hashes_ = 0;
   return Status::OK();
 }
 
@@ -296,22 +349,30 @@ Status CuckooTableBuilder::Finish() {
 
   uint64_t bucket_size = key_size_ + value_size_;
   unused_bucket.resize(bucket_size, 'a');
-  // Write the table.
+  // Write the table, a batch of buckets at a time.
+  const size_t kWriteBatchSize = 1 << 20;
+  std::string batch;
+  batch.reserve(kWriteBatchSize + bucket_size);
   uint32_t num_added = 0;
-  for (auto& bucket : buckets) {
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    const CuckooBucket& bucket = buckets[i];
     if (bucket.vector_idx == kMaxVectorIdx) {
-      s = file_->Append(Slice(unused_bucket));
+      batch.append(unused_bucket);
     } else {
       ++num_added;
-      s = file_->Append(GetKey(bucket.vector_idx));
-      if (s.ok()) {
-        if (value_size_ > 0) {
-          s = file_->Append(GetValue(bucket.vector_idx));
-        }
+      Slice key = GetKey(bucket.vector_idx);
+      batch.append(key.data(), key.size());
+      if (value_size_ > 0) {
+        Slice value = GetValue(bucket.vector_idx);
+        batch.append(value.data(), value.size());
       }
     }
-    if (!s.ok()) {
-      return s;
+    if (batch.size() >= kWriteBatchSize || i + 1 == buckets.size()) {
+      s = file_->Append(batch);
+      if (!s.ok()) {
+        return s;
+      }
+      batch.clear();
     }
   }
   assert(num_added == NumEntries());
@@ -470,9 +531,7 @@ bool CuckooTableBuilder::MakeSpaceForKey(
     CuckooBucket& curr_bucket = (*buckets)[curr_node.bucket_id];
     for (uint32_t hash_cnt = 0;
         hash_cnt < num_hash_func_ && !null_found; ++hash_cnt) {
-      uint64_t child_bucket_id = CuckooHash(GetUserKey(curr_bucket.vector_idx),
-          hash_cnt, use_module_hash_, hash_table_size_, identity_as_first_hash_,
-          get_slice_hash_);
+      uint64_t child_bucket_id = GetHash(curr_bucket.vector_idx, hash_cnt);
       // Iterate inside Cuckoo Block.
       for (uint32_t block_idx = 0; block_idx < cuckoo_block_size_;
           ++block_idx, ++child_bucket_id) {
@@ -29,7 +29,8 @@ class CuckooTableBuilder: public TableBuilder {
                      uint64_t (*get_slice_hash)(const Slice&, uint32_t,
                                                 uint64_t),
                      uint32_t column_family_id,
-                     const std::string& column_family_name);
+                     const std::string& column_family_name,
+                     uint32_t num_build_threads = 1);
 
   // REQUIRES: Either Finish() or Abandon() has been called.
   ~CuckooTableBuilder() {}
@@ -78,6 +79,11 @@ class CuckooTableBuilder: public TableBuilder {
                        const uint32_t call_id,
                        std::vector<CuckooBucket>* buckets, uint64_t* bucket_id);
   Status MakeHashTable(std::vector<CuckooBucket>* buckets);
+  // Compute the buckets of all the keys for the num_hash_func_ hash
+  // functions in use, with up to num_build_threads_ threads.
+  void ComputeHashes();
+  // Bucket of key idx for hash function hash_cnt
+  inline uint64_t GetHash(uint64_t idx, uint32_t hash_cnt) const;
 
   inline bool IsDeletedKey(uint64_t idx) const;
   inline Slice GetKey(uint64_t idx) const;
@@ -114,6 +120,10 @@ class CuckooTableBuilder: public TableBuilder {
     uint64_t max_num_buckets);
   std::string largest_user_key_ = "";
   std::string smallest_user_key_ = "";
+  const uint32_t num_build_threads_;
+  // Buckets computed by ComputeHashes(), num_precomputed_hashes_ per key
+  std::vector<uint64_t> hashes_;
+  uint32_t num_precomputed_hashes_ = 0;
 
   bool closed_;  // Either Finish() or Abandon() has been called.
 
@@ -610,6 +610,35 @@ TEST_F(CuckooBuilderTest, FailWhenSameKeyInserted) {
   ASSERT_TRUE(builder.Finish().IsNotSupported());
   ASSERT_OK(file_writer->Close());
 }
+
+TEST_F(CuckooBuilderTest, ParallelBuild) {
+  // Enough keys to hash them with several threads
+  const uint32_t kNumKeys = 300000;
+  std::string contents[2];
+  for (uint32_t num_build_threads : {1, 4}) {
+    unique_ptr<WritableFile> writable_file;
+    fname = test::TmpDir() + "/ParallelBuild";
+    ASSERT_OK(env_->NewWritableFile(fname, &writable_file, env_options_));
+    unique_ptr<WritableFileWriter> file_writer(
+        new WritableFileWriter(std::move(writable_file), EnvOptions()));
+    CuckooTableBuilder builder(
+        file_writer.get(), kHashTableRatio, 64, 100, BytewiseComparator(), 5,
+        true, false, nullptr /* get_slice_hash */, 0 /* column_family_id */,
+        kDefaultColumnFamilyName, num_build_threads);
+    for (uint32_t i = 0; i < kNumKeys; i++) {
+      char user_key[16];
+      snprintf(user_key, sizeof(user_key), "key%012u", i);
+      builder.Add(Slice(GetInternalKey(user_key, true)), Slice("value"));
+    }
+    ASSERT_OK(builder.status());
+    ASSERT_OK(builder.Finish());
+    ASSERT_OK(file_writer->Close());
+    ASSERT_OK(ReadFileToString(env_, fname, &contents[num_build_threads > 1]));
+  }
+  // The table does not depend on the number of threads
+  ASSERT_GT(contents[0].size(), kNumKeys * 20);
+  ASSERT_TRUE(contents[0] == contents[1]);
+}
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
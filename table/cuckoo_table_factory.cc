@@ -40,7 +40,8 @@ TableBuilder* CuckooTableFactory::NewTableBuilder(
       table_builder_options.internal_comparator.user_comparator(),
       table_options_.cuckoo_block_size, table_options_.use_module_hash,
       table_options_.identity_as_first_hash, nullptr /* get_slice_hash */,
-      column_family_id, table_builder_options.column_family_name);
+      column_family_id, table_builder_options.column_family_name,
+      table_options_.num_build_threads);
 }
 
 std::string CuckooTableFactory::GetPrintableTableOptions() const {
@@ -61,6 +62,9 @@ std::string CuckooTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  identity_as_first_hash: %d\n",
            table_options_.identity_as_first_hash);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  num_build_threads: %u\n",
+           table_options_.num_build_threads);
+  ret.append(buffer);
   return ret;
 }
 
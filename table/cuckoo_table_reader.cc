@@ -10,11 +10,16 @@
 #ifndef ROCKSDB_LITE
 #include "table/cuckoo_table_reader.h"
 
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 #include <algorithm>
 #include <limits>
 #include <string>
 #include <utility>
 #include <vector>
+#include "rocksdb/comparator.h"
 #include "rocksdb/iterator.h"
 #include "rocksdb/table.h"
 #include "table/internal_iterator.h"
@@ -39,6 +44,7 @@ CuckooTableReader::CuckooTableReader(
     uint64_t (*get_slice_hash)(const Slice&, uint32_t, uint64_t))
     : file_(std::move(file)),
       ucomp_(comparator),
+      bytewise_(comparator == BytewiseComparator()),
       get_slice_hash_(get_slice_hash) {
   if (!ioptions.allow_mmap_reads) {
     status_ = Status::InvalidArgument("File is not mmaped");
@@ -127,6 +133,111 @@ CuckooTableReader::CuckooTableReader(
   status_ = file_->Read(0, file_size, &file_data_, nullptr);
 }
 
+namespace {
+// Fingerprint of a key or bucket: its first bytes
+inline uint32_t Fingerprint(const char* key) {
+  uint32_t fingerprint;
+  memcpy(&fingerprint, key, sizeof(fingerprint));
+  return fingerprint;
+}
+
+// Set bit i of *key_matches and *unused_matches if fingerprints[i] is
+// key_fingerprint and unused_fingerprint respectively, for i < 4.
+inline void MatchFingerprints(const uint32_t* fingerprints,
+                              uint32_t key_fingerprint,
+                              uint32_t unused_fingerprint,
+                              uint32_t* key_matches,
+                              uint32_t* unused_matches) {
+#ifdef __SSE2__
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fingerprints));
+  *key_matches = static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(
+      _mm_cmpeq_epi32(v, _mm_set1_epi32(key_fingerprint)))));
+  *unused_matches = static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(
+      _mm_cmpeq_epi32(v, _mm_set1_epi32(unused_fingerprint)))));
+#else
+  *key_matches = 0;
+  *unused_matches = 0;
+  for (uint32_t i = 0; i < 4; ++i) {
+    *key_matches |= static_cast<uint32_t>(fingerprints[i] == key_fingerprint)
+                    << i;
+    *unused_matches |=
+        static_cast<uint32_t>(fingerprints[i] == unused_fingerprint) << i;
+  }
+#endif
+}
+}  // namespace
+
+const char* CuckooTableReader::ProbeBlock(const Slice& user_key,
+                                          const char* block,
+                                          bool* done) const {
+  *done = true;
+  if (bytewise_ && user_key.size() >= sizeof(uint32_t)) {
+    // Compare the fingerprints of up to four buckets at once, and the whole
+    // keys of the buckets whose fingerprint matches only.
+    const uint32_t key_fingerprint = Fingerprint(user_key.data());
+    const uint32_t unused_fingerprint = Fingerprint(unused_key_.data());
+    for (uint32_t first = 0; first < cuckoo_block_size_; first += 4) {
+      uint32_t n = std::min(4U, cuckoo_block_size_ - first);
+      const char* buckets = block + first * bucket_length_;
+      uint32_t fingerprints[4] = {0, 0, 0, 0};
+      for (uint32_t i = 0; i < n; ++i) {
+        fingerprints[i] = Fingerprint(buckets + i * bucket_length_);
+      }
+      uint32_t key_matches;
+      uint32_t unused_matches;
+      MatchFingerprints(fingerprints, key_fingerprint, unused_fingerprint,
+                        &key_matches, &unused_matches);
+      for (uint32_t i = 0; i < n; ++i) {
+        const char* bucket = buckets + i * bucket_length_;
+        if (((unused_matches >> i) & 1) &&
+            memcmp(bucket, unused_key_.data(), user_key.size()) == 0) {
+          return nullptr;
+        }
+        if (((key_matches >> i) & 1) &&
+            memcmp(bucket, user_key.data(), user_key.size()) == 0) {
+          return bucket;
+        }
+      }
+    }
+    *done = false;
+    return nullptr;
+  }
+
+  const char* bucket = block;
+  for (uint32_t block_idx = 0; block_idx < cuckoo_block_size_;
+       ++block_idx, bucket += bucket_length_) {
+    if (ucomp_->Equal(Slice(unused_key_.data(), user_key.size()),
+                      Slice(bucket, user_key.size()))) {
+      return nullptr;
+    }
+    // Here, we compare only the user key part as we support only one entry
+    // per user key and we don't support snapshot.
+    if (ucomp_->Equal(user_key, Slice(bucket, user_key.size()))) {
+      return bucket;
+    }
+  }
+  *done = false;
+  return nullptr;
+}
+
+void CuckooTableReader::SaveBucket(const char* bucket,
+                                   GetContext* get_context) const {
+  Slice value(bucket + key_length_, value_length_);
+  if (is_last_level_) {
+    // Sequence number is not stored at the last level, so we will use
+    // kMaxSequenceNumber since it is unknown.  This could cause some
+    // transactions to fail to lock a key due to known sequence number.
+    // However, it is expected for anyone to use a CuckooTable in a
+    // TransactionDB.
+    get_context->SaveValue(value, kMaxSequenceNumber);
+  } else {
+    Slice full_key(bucket, key_length_);
+    ParsedInternalKey found_ikey;
+    ParseInternalKey(full_key, &found_ikey);
+    get_context->SaveValue(found_ikey, value);
+  }
+}
+
 Status CuckooTableReader::Get(const ReadOptions& readOptions, const Slice& key,
                               GetContext* get_context, bool skip_filters) {
   assert(key.size() == key_length_ + (is_last_level_ ? 8 : 0));
@@ -135,50 +246,76 @@ Status CuckooTableReader::Get(const ReadOptions& readOptions, const Slice& key,
     uint64_t offset = bucket_length_ * CuckooHash(
         user_key, hash_cnt, use_module_hash_, table_size_,
         identity_as_first_hash_, get_slice_hash_);
-    const char* bucket = &file_data_.data()[offset];
-    for (uint32_t block_idx = 0; block_idx < cuckoo_block_size_;
-         ++block_idx, bucket += bucket_length_) {
-      if (ucomp_->Equal(Slice(unused_key_.data(), user_key.size()),
-                        Slice(bucket, user_key.size()))) {
-        return Status::OK();
+    bool done;
+    const char* bucket = ProbeBlock(user_key, &file_data_.data()[offset], &done);
+    if (bucket != nullptr) {
+      // We don't support merge operations. So, we return here.
+      SaveBucket(bucket, get_context);
+    }
+    if (done) {
+      return Status::OK();
+    }
+  }
+  return Status::OK();
+}
+
+void CuckooTableReader::MultiGet(const ReadOptions& read_options,
+                                 size_t num_keys, const Slice* keys,
+                                 GetContext** get_contexts,
+                                 Status* statuses) {
+  // Enough keys for their memory accesses to overlap
+  const size_t kBatchSize = 16;
+  size_t pending[kBatchSize];
+  const char* blocks[kBatchSize];
+  for (size_t start = 0; start < num_keys; start += kBatchSize) {
+    size_t num_pending = std::min(kBatchSize, num_keys - start);
+    for (size_t i = 0; i < num_pending; ++i) {
+      assert(keys[start + i].size() ==
+             key_length_ + (is_last_level_ ? 8 : 0));
+      pending[i] = start + i;
+      statuses[start + i] = Status::OK();
+    }
+    for (uint32_t hash_cnt = 0; hash_cnt < num_hash_func_ && num_pending > 0;
+         ++hash_cnt) {
+      for (size_t i = 0; i < num_pending; ++i) {
+        blocks[i] = &file_data_.data()[bucket_length_ * CuckooHash(
+            ExtractUserKey(keys[pending[i]]), hash_cnt, use_module_hash_,
+            table_size_, identity_as_first_hash_, get_slice_hash_)];
+        PrefetchBlock(blocks[i]);
       }
-      // Here, we compare only the user key part as we support only one entry
-      // per user key and we don't support snapshot.
-      if (ucomp_->Equal(user_key, Slice(bucket, user_key.size()))) {
-        Slice value(bucket + key_length_, value_length_);
-        if (is_last_level_) {
-          // Sequence number is not stored at the last level, so we will use
-          // kMaxSequenceNumber since it is unknown.  This could cause some
-          // transactions to fail to lock a key due to known sequence number.
-          // However, it is expected for anyone to use a CuckooTable in a
-          // TransactionDB.
-          get_context->SaveValue(value, kMaxSequenceNumber);
-        } else {
-          Slice full_key(bucket, key_length_);
-          ParsedInternalKey found_ikey;
-          ParseInternalKey(full_key, &found_ikey);
-          get_context->SaveValue(found_ikey, value);
+      size_t still_pending = 0;
+      for (size_t i = 0; i < num_pending; ++i) {
+        bool done;
+        const char* bucket =
+            ProbeBlock(ExtractUserKey(keys[pending[i]]), blocks[i], &done);
+        if (bucket != nullptr) {
+          SaveBucket(bucket, get_contexts[pending[i]]);
+        }
+        if (!done) {
+          pending[still_pending++] = pending[i];
         }
-        // We don't support merge operations. So, we return here.
-        return Status::OK();
       }
+      num_pending = still_pending;
     }
   }
-  return Status::OK();
 }
 
-void CuckooTableReader::Prepare(const Slice& key) {
-  // Prefetch the first Cuckoo Block.
-  Slice user_key = ExtractUserKey(key);
-  uint64_t addr = reinterpret_cast<uint64_t>(file_data_.data()) +
-    bucket_length_ * CuckooHash(user_key, 0, use_module_hash_, table_size_,
-                                identity_as_first_hash_, nullptr);
+void CuckooTableReader::PrefetchBlock(const char* block) const {
+  uint64_t addr = reinterpret_cast<uint64_t>(block);
   uint64_t end_addr = addr + cuckoo_block_bytes_minus_one_;
   for (addr &= CACHE_LINE_MASK; addr < end_addr; addr += CACHE_LINE_SIZE) {
     PREFETCH(reinterpret_cast<const char*>(addr), 0, 3);
   }
 }
 
+void CuckooTableReader::Prepare(const Slice& key) {
+  // Prefetch the first Cuckoo Block.
+  Slice user_key = ExtractUserKey(key);
+  PrefetchBlock(&file_data_.data()[
+      bucket_length_ * CuckooHash(user_key, 0, use_module_hash_, table_size_,
+                                  identity_as_first_hash_, nullptr)]);
+}
+
 class CuckooTableIterator : public InternalIterator {
  public:
   explicit CuckooTableIterator(CuckooTableReader* reader);
@@ -364,7 +501,8 @@ extern InternalIterator* NewErrorInternalIterator(const Status& status,
                                                   Arena* arena);
 
 InternalIterator* CuckooTableReader::NewIterator(
-    const ReadOptions& read_options, Arena* arena, bool skip_filters) {
+    const ReadOptions& read_options, Arena* arena, bool skip_filters,
+    bool for_compaction) {
   if (!status().ok()) {
     return NewErrorInternalIterator(
         Status::Corruption("CuckooTableReader status is not okay."), arena);
@@ -45,8 +45,15 @@ class CuckooTableReader: public TableReader {
   Status Get(const ReadOptions& read_options, const Slice& key,
              GetContext* get_context, bool skip_filters = false) override;
 
+  // Looks the keys up a batch at a time and one hash function at a time,
+  // prefetching the cuckoo blocks of the whole batch before probing them.
+  void MultiGet(const ReadOptions& read_options, size_t num_keys,
+                const Slice* keys, GetContext** get_contexts,
+                Status* statuses) override;
+
   InternalIterator* NewIterator(const ReadOptions&, Arena* arena = nullptr,
-                                bool skip_filters = false) override;
+                                bool skip_filters = false,
+                                bool for_compaction = false) override;
   void Prepare(const Slice& target) override;
 
   // Report an approximation of how much memory has been used.
@@ -60,6 +67,14 @@ class CuckooTableReader: public TableReader {
  private:
   friend class CuckooTableIterator;
   void LoadAllKeys(std::vector<std::pair<Slice, uint32_t>>* key_to_bucket_id);
+  // Return the bucket of the cuckoo block starting at block that holds
+  // user_key, or nullptr. *done is set unless the block is full of other
+  // keys, in which case the key may be in the block of the next hash
+  // function.
+  const char* ProbeBlock(const Slice& user_key, const char* block,
+                         bool* done) const;
+  void SaveBucket(const char* bucket, GetContext* get_context) const;
+  void PrefetchBlock(const char* block) const;
   std::unique_ptr<RandomAccessFileReader> file_;
   Slice file_data_;
   bool is_last_level_;
@@ -77,6 +92,9 @@ class CuckooTableReader: public TableReader {
   uint32_t cuckoo_block_bytes_minus_one_;
   uint64_t table_size_;
   const Comparator* ucomp_;
+  // Keys are equal iff they are bytewise equal, and buckets can be compared
+  // by fingerprint first
+  const bool bytewise_;
   uint64_t (*get_slice_hash_)(const Slice& s, uint32_t index,
       uint64_t max_num_buckets);
 };
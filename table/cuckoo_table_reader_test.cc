@@ -130,6 +130,29 @@ class CuckooReaderTest : public testing::Test {
       ASSERT_OK(reader.Get(ReadOptions(), Slice(keys[i]), &get_context));
       ASSERT_EQ(values[i], value);
     }
+
+    // Look all the keys up at once
+    std::vector<Slice> multiget_keys;
+    std::vector<std::string> multiget_values(num_items);
+    std::vector<GetContext> get_contexts;
+    std::vector<GetContext*> get_context_ptrs;
+    std::vector<Status> statuses(num_items);
+    get_contexts.reserve(num_items);
+    for (uint32_t i = 0; i < num_items; ++i) {
+      multiget_keys.push_back(keys[i]);
+      get_contexts.emplace_back(ucomp, nullptr, nullptr, nullptr,
+                                GetContext::kNotFound, Slice(user_keys[i]),
+                                &multiget_values[i], nullptr, nullptr, nullptr,
+                                nullptr);
+      get_context_ptrs.push_back(&get_contexts[i]);
+    }
+    reader.MultiGet(ReadOptions(), num_items, multiget_keys.data(),
+                    get_context_ptrs.data(), statuses.data());
+    for (uint32_t i = 0; i < num_items; ++i) {
+      ASSERT_OK(statuses[i]);
+      ASSERT_EQ(GetContext::kFound, get_contexts[i].State());
+      ASSERT_EQ(values[i], multiget_values[i]);
+    }
   }
   void UpdateKeys(bool with_zero_seqno) {
     for (uint32_t i = 0; i < num_items; i++) {
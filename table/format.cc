@@ -252,18 +252,48 @@ Status ReadFooterFromFile(RandomAccessFileReader* file, uint64_t file_size,
 // Without anonymous namespace here, we fail the warning -Wmissing-prototypes
 namespace {
 
+// Check the crc of the type and the block contents. data holds the n bytes
+// of the block followed by its trailer.
+Status VerifyBlockChecksum(const Footer& footer, const char* data, size_t n) {
+  PERF_TIMER_GUARD(block_checksum_time);
+  uint32_t value = DecodeFixed32(data + n + 1);
+  uint32_t actual = 0;
+  switch (footer.checksum()) {
+    case kCRC32c:
+      value = crc32c::Unmask(value);
+      actual = crc32c::Value(data, n + 1);
+      break;
+    case kxxHash:
+      actual = XXH32(data, static_cast<int>(n) + 1, 0);
+      break;
+    case kxxHash64:
+      actual = static_cast<uint32_t>(XXH64(data, n + 1, 0));
+      break;
+    default:
+      return Status::Corruption("unknown checksum type");
+  }
+  if (actual != value) {
+    return Status::Corruption("block checksum mismatch");
+  }
+  return Status::OK();
+}
+
 // Read a block and check its CRC
 // contents is the result of reading.
 // According to the implementation of file->Read, contents may not point to buf
+// With direct I/O and aligned_buf set, contents points into *aligned_buf
+// instead, see RandomAccessFileReader::Read().
 Status ReadBlock(RandomAccessFileReader* file, const Footer& footer,
                  const ReadOptions& options, const BlockHandle& handle,
-                 Slice* contents, /* result of reading */ char* buf) {
+                 Slice* contents, /* result of reading */ char* buf,
+                 std::unique_ptr<char[]>* aligned_buf = nullptr) {
   size_t n = static_cast<size_t>(handle.size());
   Status s;
 
   {
     PERF_TIMER_GUARD(block_read_time);
-    s = file->Read(handle.offset(), n + kBlockTrailerSize, contents, buf);
+    s = file->Read(handle.offset(), n + kBlockTrailerSize, contents, buf,
+                   aligned_buf);
   }
 
   PERF_COUNTER_ADD(block_read_count, 1);
@@ -279,38 +309,58 @@ Status ReadBlock(RandomAccessFileReader* file, const Footer& footer,
   // Check the crc of the type and the block contents
   const char* data = contents->data();  // Pointer to where Read put the data
   if (options.verify_checksums) {
-    PERF_TIMER_GUARD(block_checksum_time);
-    uint32_t value = DecodeFixed32(data + n + 1);
-    uint32_t actual = 0;
-    switch (footer.checksum()) {
-      case kCRC32c:
-        value = crc32c::Unmask(value);
-        actual = crc32c::Value(data, n + 1);
-        break;
-      case kxxHash:
-        actual = XXH32(data, static_cast<int>(n) + 1, 0);
-        break;
-      default:
-        s = Status::Corruption("unknown checksum type");
-    }
-    if (s.ok() && actual != value) {
-      s = Status::Corruption("block checksum mismatch");
-    }
-    if (!s.ok()) {
-      return s;
-    }
+    s = VerifyBlockChecksum(footer, data, n);
   }
   return s;
 }
 
 }  // namespace
 
+Status BlockContentsFromReadBuffer(
+    const Footer& footer, const ReadOptions& read_options,
+    const BlockHandle& handle, const Slice& raw, std::unique_ptr<char[]>* buf,
+    BlockContents* contents, const ImmutableCFOptions& ioptions,
+    bool decompression_requested,
+    const UncompressionDict& uncompression_dict) {
+  size_t n = static_cast<size_t>(handle.size());
+
+  PERF_COUNTER_ADD(block_read_count, 1);
+  PERF_COUNTER_ADD(block_read_byte, n + kBlockTrailerSize);
+
+  if (raw.size() != n + kBlockTrailerSize) {
+    return Status::Corruption("truncated block read");
+  }
+  Status status;
+  if (read_options.verify_checksums) {
+    status = VerifyBlockChecksum(footer, raw.data(), n);
+    if (!status.ok()) {
+      return status;
+    }
+  }
+
+  PERF_TIMER_GUARD(block_decompress_time);
+
+  rocksdb::CompressionType compression_type =
+      static_cast<rocksdb::CompressionType>(raw.data()[n]);
+
+  if (decompression_requested && compression_type != kNoCompression) {
+    status = UncompressBlockContents(raw.data(), n, contents, footer.version(),
+                                     uncompression_dict, ioptions);
+  } else if (raw.data() != buf->get()) {
+    // the slice content is not the buffer provided
+    *contents = BlockContents(Slice(raw.data(), n), false, compression_type);
+  } else {
+    *contents = BlockContents(std::move(*buf), n, true, compression_type);
+  }
+  return status;
+}
+
 Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
                          const ReadOptions& read_options,
                          const BlockHandle& handle, BlockContents* contents,
                          const ImmutableCFOptions &ioptions,
                          bool decompression_requested,
-                         const Slice& compression_dict,
+                         const UncompressionDict& uncompression_dict,
                          const PersistentCacheOptions& cache_options) {
   Status status;
   Slice slice;
@@ -318,6 +368,8 @@ Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
   std::unique_ptr<char[]> heap_buf;
   char stack_buf[DefaultStackBufferSize];
   char* used_buf = nullptr;
+  // True if the block was read into an aligned buffer owned by heap_buf
+  bool aligned_read = false;
   rocksdb::CompressionType compression_type;
 
   if (cache_options.persistent_cache &&
@@ -343,6 +395,11 @@ Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
     // lookup uncompressed cache mode p-cache
     status = PersistentCacheHelper::LookupRawPage(
         cache_options, handle, &heap_buf, n + kBlockTrailerSize);
+    if (status.ok() && cache_options.verify_checksums &&
+        read_options.verify_checksums) {
+      // A corrupted page is read again from the file below
+      status = VerifyBlockChecksum(footer, heap_buf.get(), n);
+    }
   } else {
     status = Status::NotFound();
   }
@@ -358,22 +415,30 @@ Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
           "Error reading from persistent cache. %s", status.ToString().c_str());
     }
     // cache miss read from device
-    if (decompression_requested &&
-        n + kBlockTrailerSize < DefaultStackBufferSize) {
-      // If we've got a small enough hunk of data, read it in to the
-      // trivially allocated stack buffer instead of needing a full malloc()
-      used_buf = &stack_buf[0];
+    if (file->use_direct_io()) {
+      // Keep the block in the aligned buffer it is read into rather than
+      // copying it out, the buffer is handed over to the block contents.
+      aligned_read = true;
+      status = ReadBlock(file, footer, read_options, handle, &slice, nullptr,
+                         &heap_buf);
     } else {
-      heap_buf = std::unique_ptr<char[]>(new char[n + kBlockTrailerSize]);
-      used_buf = heap_buf.get();
-    }
+      if (decompression_requested &&
+          n + kBlockTrailerSize < DefaultStackBufferSize) {
+        // If we've got a small enough hunk of data, read it in to the
+        // trivially allocated stack buffer instead of needing a full malloc()
+        used_buf = &stack_buf[0];
+      } else {
+        heap_buf = std::unique_ptr<char[]>(new char[n + kBlockTrailerSize]);
+        used_buf = heap_buf.get();
+      }
 
-    status = ReadBlock(file, footer, read_options, handle, &slice, used_buf);
+      status = ReadBlock(file, footer, read_options, handle, &slice, used_buf);
+    }
     if (status.ok() && read_options.fill_cache &&
         cache_options.persistent_cache &&
         cache_options.persistent_cache->IsCompressed()) {
       // insert to raw cache
-      PersistentCacheHelper::InsertRawPage(cache_options, handle, used_buf,
+      PersistentCacheHelper::InsertRawPage(cache_options, handle, slice.data(),
                                            n + kBlockTrailerSize);
     }
   }
@@ -389,8 +454,11 @@ Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
   if (decompression_requested && compression_type != kNoCompression) {
     // compressed page, uncompress, update cache
     status = UncompressBlockContents(slice.data(), n, contents,
-                                     footer.version(), compression_dict,
+                                     footer.version(), uncompression_dict,
                                      ioptions);
+  } else if (aligned_read) {
+    *contents = BlockContents(std::move(heap_buf), Slice(slice.data(), n),
+                              true, compression_type);
   } else if (slice.data() != used_buf) {
     // the slice content is not the buffer provided
     *contents = BlockContents(Slice(slice.data(), n), false, compression_type);
@@ -416,7 +484,7 @@ Status ReadBlockContents(RandomAccessFileReader* file, const Footer& footer,
 
 Status UncompressBlockContentsForCompressionType(
     const char* data, size_t n, BlockContents* contents,
-    uint32_t format_version, const Slice& compression_dict,
+    uint32_t format_version, const UncompressionDict& uncompression_dict,
     CompressionType compression_type, const ImmutableCFOptions &ioptions) {
   std::unique_ptr<char[]> ubuf;
 
@@ -444,7 +512,7 @@ Status UncompressBlockContentsForCompressionType(
       ubuf.reset(Zlib_Uncompress(
           data, n, &decompress_size,
           GetCompressFormatForVersion(kZlibCompression, format_version),
-          compression_dict));
+          uncompression_dict.GetRawDict()));
       if (!ubuf) {
         static char zlib_corrupt_msg[] =
           "Zlib not supported or corrupted Zlib compressed block contents";
@@ -469,7 +537,7 @@ Status UncompressBlockContentsForCompressionType(
       ubuf.reset(LZ4_Uncompress(
           data, n, &decompress_size,
           GetCompressFormatForVersion(kLZ4Compression, format_version),
-          compression_dict));
+          uncompression_dict.GetRawDict()));
       if (!ubuf) {
         static char lz4_corrupt_msg[] =
           "LZ4 not supported or corrupted LZ4 compressed block contents";
@@ -482,7 +550,7 @@ Status UncompressBlockContentsForCompressionType(
       ubuf.reset(LZ4_Uncompress(
           data, n, &decompress_size,
           GetCompressFormatForVersion(kLZ4HCCompression, format_version),
-          compression_dict));
+          uncompression_dict.GetRawDict()));
       if (!ubuf) {
         static char lz4hc_corrupt_msg[] =
           "LZ4HC not supported or corrupted LZ4HC compressed block contents";
@@ -503,7 +571,8 @@ Status UncompressBlockContentsForCompressionType(
       break;
     case kZSTD:
     case kZSTDNotFinalCompression:
-      ubuf.reset(ZSTD_Uncompress(data, n, &decompress_size, compression_dict));
+      ubuf.reset(
+          ZSTD_Uncompress(data, n, &decompress_size, uncompression_dict));
       if (!ubuf) {
         static char zstd_corrupt_msg[] =
             "ZSTD not supported or corrupted ZSTD compressed block contents";
@@ -535,11 +604,11 @@ Status UncompressBlockContentsForCompressionType(
 // format_version is the block format as defined in include/rocksdb/table.h
 Status UncompressBlockContents(const char* data, size_t n,
                                BlockContents* contents, uint32_t format_version,
-                               const Slice& compression_dict,
+                               const UncompressionDict& uncompression_dict,
                                const ImmutableCFOptions &ioptions) {
   assert(data[n] != kNoCompression);
   return UncompressBlockContentsForCompressionType(
-      data, n, contents, format_version, compression_dict,
+      data, n, contents, format_version, uncompression_dict,
       (CompressionType)data[n], ioptions);
 }
 
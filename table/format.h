@@ -18,6 +18,7 @@
 #include "port/port.h" // noexcept
 #include "table/persistent_cache_helper.h"
 #include "util/cf_options.h"
+#include "util/compression.h"
 
 namespace rocksdb {
 
@@ -84,7 +85,7 @@ inline uint32_t GetCompressFormatForVersion(CompressionType compression_type,
 }
 
 inline bool BlockBasedTableSupportedVersion(uint32_t version) {
-  return version <= 2;
+  return version <= 4;
 }
 
 // Footer encapsulates the fixed information stored at the tail
@@ -180,6 +181,37 @@ Status ReadFooterFromFile(RandomAccessFileReader* file, uint64_t file_size,
 // 1-byte type + 32-bit crc
 static const size_t kBlockTrailerSize = 5;
 
+// Set in the restart count of blocks whose values are stored apart from their
+// keys. See block_builder.cc.
+static const uint32_t kBlockValuesSeparatedFlag = 1u << 31;
+// Set in the restart count of blocks whose entries do not store the length of
+// their values, and whose values are deltas from the previous value past the
+// restart points. See block_builder.cc.
+static const uint32_t kBlockValuesDeltaEncodedFlag = 1u << 30;
+// Set in the restart count of blocks that store a fixed-width prefix of the
+// key of each restart point after their restart points. With
+// kBlockInternalKeyPrefixesFlag, the keys are internal keys and the prefixes
+// are the prefixes of their user keys. See block_builder.cc.
+static const uint32_t kBlockKeyPrefixesFlag = 1u << 29;
+static const uint32_t kBlockInternalKeyPrefixesFlag = 1u << 28;
+static const uint32_t kBlockRestartFlags =
+    kBlockValuesSeparatedFlag | kBlockValuesDeltaEncodedFlag |
+    kBlockKeyPrefixesFlag | kBlockInternalKeyPrefixesFlag;
+
+// The prefix of key stored for the restart points of blocks with
+// kBlockKeyPrefixesFlag: the first 8 bytes of the key, zero-padded, as a
+// big-endian integer. Keys ordered bytewise have ordered prefixes.
+inline uint64_t BlockKeyPrefix(const Slice& key) {
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < sizeof(prefix); i++) {
+    prefix <<= 8;
+    if (i < key.size()) {
+      prefix |= static_cast<unsigned char>(key[i]);
+    }
+  }
+  return prefix;
+}
+
 struct BlockContents {
   Slice data;           // Actual contents of data
   bool cachable;        // True iff data can be cached
@@ -199,6 +231,15 @@ struct BlockContents {
         compression_type(_compression_type),
         allocation(std::move(_data)) {}
 
+  // data points into the buffer owned by _allocation, e.g. the aligned
+  // buffer a direct I/O read went to.
+  BlockContents(std::unique_ptr<char[]>&& _allocation, const Slice& _data,
+                bool _cachable, CompressionType _compression_type)
+      : data(_data),
+        cachable(_cachable),
+        compression_type(_compression_type),
+        allocation(std::move(_allocation)) {}
+
   BlockContents(BlockContents&& other) ROCKSDB_NOEXCEPT { *this = std::move(other); }
 
   BlockContents& operator=(BlockContents&& other) {
@@ -216,9 +257,25 @@ extern Status ReadBlockContents(
     RandomAccessFileReader* file, const Footer& footer,
     const ReadOptions& options, const BlockHandle& handle,
     BlockContents* contents, const ImmutableCFOptions &ioptions,
-    bool do_uncompress = true, const Slice& compression_dict = Slice(),
+    bool do_uncompress = true,
+    const UncompressionDict& uncompression_dict =
+        UncompressionDict::GetEmptyDict(),
     const PersistentCacheOptions& cache_options = PersistentCacheOptions());
 
+// Finish reading the block identified by "handle" out of "raw", the
+// handle.size() + kBlockTrailerSize bytes that the caller has already read
+// from the file, e.g. through RandomAccessFileReader::MultiRead(). The
+// checksum is verified if read_options.verify_checksums is set. If raw points
+// into *buf and the block is not decompressed, the ownership of *buf is
+// moved to *contents.
+extern Status BlockContentsFromReadBuffer(
+    const Footer& footer, const ReadOptions& read_options,
+    const BlockHandle& handle, const Slice& raw, std::unique_ptr<char[]>* buf,
+    BlockContents* contents, const ImmutableCFOptions& ioptions,
+    bool decompression_requested = true,
+    const UncompressionDict& uncompression_dict =
+        UncompressionDict::GetEmptyDict());
+
 // The 'data' points to the raw block contents read in from file.
 // This method allocates a new heap buffer and the raw block
 // contents are uncompresed into this buffer. This buffer is
@@ -226,18 +283,19 @@ extern Status ReadBlockContents(
 // free this buffer.
 // For description of compress_format_version and possible values, see
 // util/compression.h
-extern Status UncompressBlockContents(const char* data, size_t n,
-                                      BlockContents* contents,
-                                      uint32_t compress_format_version,
-                                      const Slice& compression_dict,
-                                      const ImmutableCFOptions &ioptions);
+extern Status UncompressBlockContents(
+    const char* data, size_t n, BlockContents* contents,
+    uint32_t compress_format_version,
+    const UncompressionDict& uncompression_dict,
+    const ImmutableCFOptions& ioptions);
 
 // This is an extension to UncompressBlockContents that accepts
 // a specific compression type. This is used by un-wrapped blocks
 // with no compression header.
 extern Status UncompressBlockContentsForCompressionType(
     const char* data, size_t n, BlockContents* contents,
-    uint32_t compress_format_version, const Slice& compression_dict,
+    uint32_t compress_format_version,
+    const UncompressionDict& uncompression_dict,
     CompressionType compression_type, const ImmutableCFOptions &ioptions);
 
 // Implementation details follow.  Clients should ignore,
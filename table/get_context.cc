@@ -53,7 +53,8 @@ GetContext::GetContext(const Comparator* ucmp,
       env_(env),
       seq_(seq),
       replay_log_(nullptr),
-      pinned_iters_mgr_(_pinned_iters_mgr) {
+      pinned_iters_mgr_(_pinned_iters_mgr),
+      num_key_matches_(0) {
   if (seq_) {
     *seq_ = kMaxSequenceNumber;
   }
@@ -73,6 +74,7 @@ void GetContext::MarkKeyMayExist() {
 
 void GetContext::SaveValue(const Slice& value, SequenceNumber seq) {
   assert(state_ == kNotFound);
+  num_key_matches_++;
   appendToReplayLog(replay_log_, kTypeValue, value);
 
   state_ = kFound;
@@ -86,6 +88,7 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
   assert((state_ != kMerge && parsed_key.type != kTypeMerge) ||
          merge_context_ != nullptr);
   if (ucmp_->Equal(parsed_key.user_key, user_key_)) {
+    num_key_matches_++;
     appendToReplayLog(replay_log_, parsed_key.type, value);
 
     if (seq_ != nullptr) {
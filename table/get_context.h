@@ -47,6 +47,9 @@ class GetContext {
 
   GetState State() const { return state_; }
 
+  // Number of entries of the user key passed to SaveValue() so far
+  uint64_t num_key_matches() const { return num_key_matches_; }
+
   RangeDelAggregator* range_del_agg() { return range_del_agg_; }
 
   PinnedIteratorsManager* pinned_iters_mgr() { return pinned_iters_mgr_; }
@@ -79,6 +82,7 @@ class GetContext {
   std::string* replay_log_;
   // Used to temporarily pin blocks when state_ == GetContext::kMerge
   PinnedIteratorsManager* pinned_iters_mgr_;
+  uint64_t num_key_matches_;
 };
 
 void replayGetContextLog(const Slice& replay_log, const Slice& user_key,
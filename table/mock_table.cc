@@ -29,7 +29,8 @@ stl_wrappers::KVMap MakeMockFile(
 }
 
 InternalIterator* MockTableReader::NewIterator(const ReadOptions&, Arena* arena,
-                                               bool skip_filters) {
+                                               bool skip_filters,
+                                               bool for_compaction) {
   return new MockTableIterator(table_);
 }
 
@@ -21,16 +21,20 @@ struct PersistentCacheOptions {
   PersistentCacheOptions() {}
   explicit PersistentCacheOptions(
       const std::shared_ptr<PersistentCache>& _persistent_cache,
-      const std::string _key_prefix, Statistics* const _statistics)
+      const std::string _key_prefix, Statistics* const _statistics,
+      bool _verify_checksums = false)
       : persistent_cache(_persistent_cache),
         key_prefix(_key_prefix),
-        statistics(_statistics) {}
+        statistics(_statistics),
+        verify_checksums(_verify_checksums) {}
 
   virtual ~PersistentCacheOptions() {}
 
   std::shared_ptr<PersistentCache> persistent_cache;
   std::string key_prefix;
   Statistics* statistics = nullptr;
+  // BlockBasedTableOptions::verify_persistent_cache_checksums
+  bool verify_checksums = false;
 };
 
 // PersistentCacheHelper
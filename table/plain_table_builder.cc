@@ -19,12 +19,14 @@
 #include "rocksdb/table.h"
 #include "table/plain_table_factory.h"
 #include "db/dbformat.h"
+#include "table/block_based_table_builder.h"
 #include "table/block_builder.h"
 #include "table/bloom_block.h"
 #include "table/plain_table_index.h"
 #include "table/format.h"
 #include "table/meta_blocks.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/file_reader_writer.h"
 #include "util/stop_watch.h"
@@ -48,6 +50,26 @@ Status WriteBlock(const Slice& block_contents, WritableFileWriter* file,
   return s;
 }
 
+// Like WriteBlock(), but followed by the trailer of block-based table blocks,
+// so that the block can be read with ReadBlockContents()
+Status WriteBlockWithTrailer(const Slice& block_contents, CompressionType type,
+                             WritableFileWriter* file, uint64_t* offset,
+                             BlockHandle* block_handle) {
+  Status s = WriteBlock(block_contents, file, offset, block_handle);
+  if (s.ok()) {
+    char trailer[kBlockTrailerSize];
+    trailer[0] = type;
+    auto crc = crc32c::Value(block_contents.data(), block_contents.size());
+    crc = crc32c::Extend(crc, trailer, 1);  // Extend to cover block type
+    EncodeFixed32(trailer + 1, crc32c::Mask(crc));
+    s = file->Append(Slice(trailer, kBlockTrailerSize));
+    if (s.ok()) {
+      *offset += kBlockTrailerSize;
+    }
+  }
+  return s;
+}
+
 }  // namespace
 
 // kPlainTableMagicNumber was picked by running
@@ -64,7 +86,9 @@ PlainTableBuilder::PlainTableBuilder(
     EncodingType encoding_type, size_t index_sparseness,
     uint32_t bloom_bits_per_key, const std::string& column_family_name,
     uint32_t num_probes, size_t huge_page_tlb_size, double hash_table_ratio,
-    bool store_index_in_file)
+    bool store_index_in_file, size_t chunk_size,
+    CompressionType compression_type,
+    const CompressionOptions& compression_opts)
     : ioptions_(ioptions),
       bloom_block_(num_probes),
       file_(file),
@@ -73,6 +97,9 @@ PlainTableBuilder::PlainTableBuilder(
       encoder_(encoding_type, user_key_len, ioptions.prefix_extractor,
                index_sparseness),
       store_index_in_file_(store_index_in_file),
+      chunk_size_(chunk_size),
+      compression_type_(compression_type),
+      compression_opts_(compression_opts),
       prefix_extractor_(ioptions.prefix_extractor) {
   // Build index block and save it in the file if hash_table_ratio > 0
   if (store_index_in_file_) {
@@ -104,6 +131,12 @@ PlainTableBuilder::PlainTableBuilder(
   PutFixed32(&val, static_cast<uint32_t>(encoder_.GetEncodingType()));
   properties_.user_collected_properties
       [PlainTablePropertyNames::kEncodingType] = val;
+  if (chunk_size_ > 0) {
+    properties_.compression_name = CompressionTypeToString(compression_type_);
+    PutVarint64(&properties_.user_collected_properties
+                     [PlainTablePropertyNames::kChunkSize],
+                chunk_size_);
+  }
 
   for (auto& collector_factories : *int_tbl_prop_collector_factories) {
     table_properties_collectors_.emplace_back(
@@ -141,11 +174,11 @@ void PlainTableBuilder::Add(const Slice& key, const Slice& value) {
   }
 
   // Write value
-  assert(offset_ <= std::numeric_limits<uint32_t>::max());
-  auto prev_offset = static_cast<uint32_t>(offset_);
+  assert(data_offset_ <= std::numeric_limits<uint32_t>::max());
+  auto prev_offset = static_cast<uint32_t>(data_offset_);
   // Write out the key
-  encoder_.AppendKey(key, file_, &offset_, meta_bytes_buf,
-                     &meta_bytes_buf_size);
+  record_.clear();
+  encoder_.AppendKey(key, &record_, meta_bytes_buf, &meta_bytes_buf_size);
   if (SaveIndexInFile()) {
     index_builder_->AddKeyPrefix(GetPrefix(internal_key), prev_offset);
   }
@@ -156,11 +189,21 @@ void PlainTableBuilder::Add(const Slice& key, const Slice& value) {
       EncodeVarint32(meta_bytes_buf + meta_bytes_buf_size, value_size);
   assert(end_ptr <= meta_bytes_buf + sizeof(meta_bytes_buf));
   meta_bytes_buf_size = end_ptr - meta_bytes_buf;
-  file_->Append(Slice(meta_bytes_buf, meta_bytes_buf_size));
+  record_.append(meta_bytes_buf, meta_bytes_buf_size);
 
   // Write value
-  file_->Append(value);
-  offset_ += value_size + meta_bytes_buf_size;
+  data_offset_ += record_.size() + value_size;
+  if (chunk_size_ > 0) {
+    chunk_.append(record_);
+    chunk_.append(value.data(), value.size());
+    if (chunk_.size() >= chunk_size_) {
+      FlushChunk();
+    }
+  } else {
+    file_->Append(record_);
+    file_->Append(value);
+    offset_ += record_.size() + value_size;
+  }
 
   properties_.num_entries++;
   properties_.raw_key_size += key.size();
@@ -171,23 +214,69 @@ void PlainTableBuilder::Add(const Slice& key, const Slice& value) {
       key, value, offset_, table_properties_collectors_, ioptions_.info_log);
 }
 
+void PlainTableBuilder::FlushChunk() {
+  if (!status_.ok()) {
+    return;
+  }
+  CompressionType type = compression_type_;
+  std::string compressed_output;
+  // Plain tables have a version 0 footer, which is what readers decompress
+  // the chunks with
+  Slice chunk_contents =
+      CompressBlock(chunk_, compression_opts_, &type, 0 /* format_version */,
+                    CompressionDict::GetEmptyDict(), &compressed_output);
+  BlockHandle handle;
+  status_ =
+      WriteBlockWithTrailer(chunk_contents, type, file_, &offset_, &handle);
+  if (status_.ok()) {
+    PutVarint32(&chunk_index_, static_cast<uint32_t>(chunk_.size()));
+    handle.EncodeTo(&chunk_index_);
+    num_chunks_++;
+  }
+  chunk_.clear();
+}
+
 Status PlainTableBuilder::status() const { return status_; }
 
 Status PlainTableBuilder::Finish() {
   assert(!closed_);
   closed_ = true;
 
+  if (!chunk_.empty()) {
+    FlushChunk();
+  }
+  if (!status_.ok()) {
+    return status_;
+  }
   properties_.data_size = offset_;
+  if (chunk_size_ > 0) {
+    properties_.num_data_blocks = num_chunks_;
+  }
 
   //  Write the following blocks
-  //  1. [meta block: bloom] - optional
-  //  2. [meta block: index] - optional
-  //  3. [meta block: properties]
-  //  4. [metaindex block]
-  //  5. [footer]
+  //  1. [meta block: chunk index] - optional
+  //  2. [meta block: bloom] - optional
+  //  3. [meta block: index] - optional
+  //  4. [meta block: properties]
+  //  5. [metaindex block]
+  //  6. [footer]
 
   MetaIndexBuilder meta_index_builer;
 
+  if (chunk_size_ > 0) {
+    std::string chunk_index_block;
+    PutVarint32(&chunk_index_block, num_chunks_);
+    chunk_index_block.append(chunk_index_);
+    BlockHandle chunk_index_block_handle;
+    Status s = WriteBlock(chunk_index_block, file_, &offset_,
+                          &chunk_index_block_handle);
+    if (!s.ok()) {
+      return s;
+    }
+    meta_index_builer.Add(PlainTableIndexBuilder::kPlainTableChunkIndexBlock,
+                          chunk_index_block_handle);
+  }
+
   if (store_index_in_file_ && (properties_.num_entries > 0)) {
     assert(properties_.num_entries <= std::numeric_limits<uint32_t>::max());
     Status s;
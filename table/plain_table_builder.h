@@ -40,7 +40,9 @@ class PlainTableBuilder: public TableBuilder {
       size_t index_sparseness, uint32_t bloom_bits_per_key,
       const std::string& column_family_name, uint32_t num_probes = 6,
       size_t huge_page_tlb_size = 0, double hash_table_ratio = 0,
-      bool store_index_in_file = false);
+      bool store_index_in_file = false, size_t chunk_size = 0,
+      CompressionType compression_type = kNoCompression,
+      const CompressionOptions& compression_opts = CompressionOptions());
 
   // REQUIRES: Either Finish() or Abandon() has been called.
   ~PlainTableBuilder();
@@ -77,6 +79,9 @@ class PlainTableBuilder: public TableBuilder {
   bool SaveIndexInFile() const { return store_index_in_file_; }
 
  private:
+  // Compress and write the records added since the last chunk
+  void FlushChunk();
+
   Arena arena_;
   const ImmutableCFOptions& ioptions_;
   std::vector<std::unique_ptr<IntTblPropCollector>>
@@ -87,6 +92,9 @@ class PlainTableBuilder: public TableBuilder {
 
   WritableFileWriter* file_;
   uint64_t offset_ = 0;
+  // Offset of the next record in the uncompressed records. Same as offset_
+  // unless the records are stored in chunks.
+  uint64_t data_offset_ = 0;
   uint32_t bloom_bits_per_key_;
   size_t huge_page_tlb_size_;
   Status status_;
@@ -95,6 +103,16 @@ class PlainTableBuilder: public TableBuilder {
 
   bool store_index_in_file_;
 
+  const size_t chunk_size_;
+  const CompressionType compression_type_;
+  const CompressionOptions compression_opts_;
+  // Encoded key and meta bytes of the record being added
+  std::string record_;
+  // Uncompressed records of the current chunk
+  std::string chunk_;
+  std::string chunk_index_;
+  uint32_t num_chunks_ = 0;
+
   std::vector<uint32_t> keys_or_prefixes_hashes_;
   bool closed_ = false;  // Either Finish() or Abandon() has been called.
 
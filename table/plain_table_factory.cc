@@ -24,7 +24,7 @@ Status PlainTableFactory::NewTableReader(
       table_reader_options.internal_comparator, std::move(file), file_size,
       table, table_options_.bloom_bits_per_key, table_options_.hash_table_ratio,
       table_options_.index_sparseness, table_options_.huge_page_tlb_size,
-      table_options_.full_scan_mode);
+      table_options_.full_scan_mode, table_options_.block_cache.get());
 }
 
 TableBuilder* PlainTableFactory::NewTableBuilder(
@@ -41,7 +41,9 @@ TableBuilder* PlainTableFactory::NewTableBuilder(
       table_options_.index_sparseness, table_options_.bloom_bits_per_key,
       table_builder_options.column_family_name, 6,
       table_options_.huge_page_tlb_size, table_options_.hash_table_ratio,
-      table_options_.store_index_in_file);
+      table_options_.store_index_in_file, table_options_.chunk_size,
+      table_builder_options.compression_type,
+      table_builder_options.compression_opts);
 }
 
 std::string PlainTableFactory::GetPrintableTableOptions() const {
@@ -74,6 +76,12 @@ std::string PlainTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  store_index_in_file: %d\n",
            table_options_.store_index_in_file);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  chunk_size: %" ROCKSDB_PRIszt "\n",
+           table_options_.chunk_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  block_cache: %p\n",
+           static_cast<void*>(table_options_.block_cache.get()));
+  ret.append(buffer);
   return ret;
 }
 
@@ -94,5 +102,8 @@ const std::string PlainTablePropertyNames::kBloomVersion =
 const std::string PlainTablePropertyNames::kNumBloomBlocks =
     "rocksdb.plain.table.bloom.numblocks";
 
+const std::string PlainTablePropertyNames::kChunkSize =
+    "rocksdb.plain.table.chunk.size";
+
 }  // namespace rocksdb
 #endif  // ROCKSDB_LITE
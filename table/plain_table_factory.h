@@ -123,6 +123,18 @@ class TableBuilder;
 // +----------- ..... --------------+----+
 // To save 7 bytes for the special case where sequence ID = 0.
 //
+// If PlainTableOptions::chunk_size > 0, the records above are not written to
+// the file as they are. They are grouped into chunks of about chunk_size
+// bytes, never splitting a record, and each chunk is compressed and written
+// with the trailer of block-based table blocks:
+// +---------------------+---------------------+-----+
+// | compressed chunk 1  | compressed chunk 2  | ... |
+// +---------------------+---------------------+-----+
+// A meta block, PlainTableIndexBuilder::kPlainTableChunkIndexBlock, has the
+// uncompressed size and the handle of each chunk. All the offsets, including
+// the ones in the index, are offsets in the uncompressed records, so a
+// reader finds the chunk of a record with a binary search on the chunk
+// starts.
 //
 class PlainTableFactory : public TableFactory {
  public:
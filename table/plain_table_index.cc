@@ -211,6 +211,8 @@ Slice PlainTableIndexBuilder::FillIndexes(
 
 const std::string PlainTableIndexBuilder::kPlainTableIndexBlock =
     "PlainTableIndexBlock";
+const std::string PlainTableIndexBuilder::kPlainTableChunkIndexBlock =
+    "PlainTableChunkIndexBlock";
 };  // namespace rocksdb
 
 #endif  // ROCKSDB_LITE
@@ -137,6 +137,9 @@ class PlainTableIndexBuilder {
   }
 
   static const std::string kPlainTableIndexBlock;
+  // Uncompressed sizes and handles of the chunks, if the records are stored
+  // in compressed chunks
+  static const std::string kPlainTableChunkIndexBlock;
 
  private:
   struct IndexRecord {
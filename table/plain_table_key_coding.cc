@@ -9,9 +9,12 @@
 #include <algorithm>
 #include <string>
 #include "db/dbformat.h"
+#include "rocksdb/statistics.h"
+#include "table/format.h"
 #include "table/plain_table_reader.h"
 #include "table/plain_table_factory.h"
 #include "util/file_reader_writer.h"
+#include "util/statistics.h"
 
 namespace rocksdb {
 
@@ -80,9 +83,8 @@ inline Status PlainTableKeyDecoder::DecodeSize(uint32_t start_offset,
   }
 }
 
-Status PlainTableKeyEncoder::AppendKey(const Slice& key,
-                                       WritableFileWriter* file,
-                                       uint64_t* offset, char* meta_bytes_buf,
+Status PlainTableKeyEncoder::AppendKey(const Slice& key, std::string* out,
+                                       char* meta_bytes_buf,
                                        size_t* meta_bytes_buf_size) {
   ParsedInternalKey parsed_key;
   if (!ParseInternalKey(key, &parsed_key)) {
@@ -95,15 +97,7 @@ Status PlainTableKeyEncoder::AppendKey(const Slice& key,
   if (encoding_type_ == kPlain) {
     if (fixed_user_key_len_ == kPlainTableVariableLength) {
       // Write key length
-      char key_size_buf[5];  // tmp buffer for key size as varint32
-      char* ptr = EncodeVarint32(key_size_buf, user_key_size);
-      assert(ptr <= key_size_buf + sizeof(key_size_buf));
-      auto len = ptr - key_size_buf;
-      Status s = file->Append(Slice(key_size_buf, len));
-      if (!s.ok()) {
-        return s;
-      }
-      *offset += len;
+      PutVarint32(out, user_key_size);
     }
   } else {
     assert(encoding_type_ == kPrefix);
@@ -117,11 +111,7 @@ Status PlainTableKeyEncoder::AppendKey(const Slice& key,
       key_count_for_prefix_ = 1;
       pre_prefix_.SetKey(prefix);
       size_bytes_pos += EncodeSize(kFullKey, user_key_size, size_bytes);
-      Status s = file->Append(Slice(size_bytes, size_bytes_pos));
-      if (!s.ok()) {
-        return s;
-      }
-      *offset += size_bytes_pos;
+      out->append(size_bytes, size_bytes_pos);
     } else {
       key_count_for_prefix_++;
       if (key_count_for_prefix_ == 2) {
@@ -134,11 +124,7 @@ Status PlainTableKeyEncoder::AppendKey(const Slice& key,
       uint32_t prefix_len = static_cast<uint32_t>(pre_prefix_.GetKey().size());
       size_bytes_pos += EncodeSize(kKeySuffix, user_key_size - prefix_len,
                                    size_bytes + size_bytes_pos);
-      Status s = file->Append(Slice(size_bytes, size_bytes_pos));
-      if (!s.ok()) {
-        return s;
-      }
-      *offset += size_bytes_pos;
+      out->append(size_bytes, size_bytes_pos);
       key_to_write = Slice(key.data() + prefix_len, key.size() - prefix_len);
     }
   }
@@ -148,17 +134,11 @@ Status PlainTableKeyEncoder::AppendKey(const Slice& key,
   // If the row is of value type with seqId 0, flush the special flag together
   // in this buffer to safe one file append call, which takes 1 byte.
   if (parsed_key.sequence == 0 && parsed_key.type == kTypeValue) {
-    Status s =
-        file->Append(Slice(key_to_write.data(), key_to_write.size() - 8));
-    if (!s.ok()) {
-      return s;
-    }
-    *offset += key_to_write.size() - 8;
+    out->append(key_to_write.data(), key_to_write.size() - 8);
     meta_bytes_buf[*meta_bytes_buf_size] = PlainTableFactory::kValueTypeSeqId0;
     *meta_bytes_buf_size += 1;
   } else {
-    file->Append(key_to_write);
-    *offset += key_to_write.size();
+    out->append(key_to_write.data(), key_to_write.size());
   }
 
   return Status::OK();
@@ -173,6 +153,17 @@ Slice PlainTableFileReader::GetFromBuffer(Buffer* buffer, uint32_t file_offset,
 
 bool PlainTableFileReader::ReadNonMmap(uint32_t file_offset, uint32_t len,
                                        Slice* out) {
+  if (file_info_->is_chunked) {
+    if (!ReadChunk(file_offset, len, out)) {
+      return false;
+    }
+    if (out->size() < len) {
+      status_ = Status::Corruption("Record crosses a chunk boundary");
+      return false;
+    }
+    return true;
+  }
+
   const uint32_t kPrefetchSize = 256u;
 
   // Try to read from buffers.
@@ -218,6 +209,131 @@ bool PlainTableFileReader::ReadNonMmap(uint32_t file_offset, uint32_t len,
   return true;
 }
 
+namespace {
+void DeleteCachedChunk(const Slice& key, void* value) {
+  delete reinterpret_cast<BlockContents*>(value);
+}
+}  // namespace
+
+void PlainTableFileReader::Buffer::ReleaseChunk() {
+  if (cache_handle != nullptr) {
+    cache->Release(cache_handle);
+    cache_handle = nullptr;
+  }
+  chunk = BlockContents();
+  chunk_data = nullptr;
+}
+
+bool PlainTableFileReader::ReadChunk(uint32_t file_offset, uint32_t len,
+                                     Slice* out) {
+  assert(file_info_->is_chunked);
+  assert(file_offset < file_info_->data_end_offset);
+
+  // Try the chunks in the buffers first.
+  Buffer* buffer = nullptr;
+  for (uint32_t i = 0; i < num_buf_; i++) {
+    Buffer* b = buffers_[num_buf_ - 1 - i].get();
+    if (file_offset >= b->buf_start_offset &&
+        file_offset < b->buf_start_offset + b->buf_len) {
+      buffer = b;
+      break;
+    }
+  }
+
+  if (buffer == nullptr) {
+    if (num_buf_ < buffers_.size()) {
+      buffer = new Buffer();
+      buffers_[num_buf_++].reset(buffer);
+    } else {
+      buffer = buffers_[num_buf_ - 1].get();
+    }
+    const auto& starts = file_info_->chunk_starts;
+    size_t chunk =
+        std::upper_bound(starts.begin(), starts.end(), file_offset) -
+        starts.begin() - 1;
+    if (!LoadChunk(chunk, buffer)) {
+      return false;
+    }
+  }
+
+  uint32_t offset_in_chunk = file_offset - buffer->buf_start_offset;
+  *out = Slice(buffer->chunk_data + offset_in_chunk,
+               std::min(len, buffer->buf_len - offset_in_chunk));
+  return true;
+}
+
+bool PlainTableFileReader::LoadChunk(size_t i, Buffer* buffer) {
+  buffer->ReleaseChunk();
+  // An empty buffer, in case the chunk cannot be loaded
+  buffer->buf_len = 0;
+
+  const BlockHandle& handle = file_info_->chunk_handles[i];
+  uint32_t chunk_size =
+      file_info_->chunk_starts[i + 1] - file_info_->chunk_starts[i];
+  Cache* block_cache = file_info_->block_cache;
+  Statistics* statistics = file_info_->ioptions->statistics;
+
+  std::string cache_key;
+  if (block_cache != nullptr) {
+    cache_key = file_info_->cache_key_prefix;
+    PutVarint64(&cache_key, handle.offset());
+    buffer->cache_handle = block_cache->Lookup(cache_key, statistics);
+  }
+
+  if (buffer->cache_handle != nullptr) {
+    RecordTick(statistics, BLOCK_CACHE_HIT);
+    RecordTick(statistics, BLOCK_CACHE_DATA_HIT);
+    buffer->cache = block_cache;
+    buffer->chunk_data = reinterpret_cast<BlockContents*>(
+                             block_cache->Value(buffer->cache_handle))
+                             ->data.data();
+  } else {
+    BlockContents contents;
+    Status s = ReadBlockContents(file_info_->file.get(), file_info_->footer,
+                                 ReadOptions(), handle, &contents,
+                                 *file_info_->ioptions);
+    if (s.ok() && contents.data.size() != chunk_size) {
+      s = Status::Corruption("Chunk size mismatch in PlainTable");
+    }
+    if (!s.ok()) {
+      status_ = s;
+      return false;
+    }
+    if (block_cache == nullptr) {
+      buffer->chunk = std::move(contents);
+      buffer->chunk_data = buffer->chunk.data.data();
+    } else {
+      RecordTick(statistics, BLOCK_CACHE_MISS);
+      RecordTick(statistics, BLOCK_CACHE_DATA_MISS);
+      if (contents.allocation == nullptr) {
+        // The chunk points into the mmapped file, which the cache may outlive
+        std::unique_ptr<char[]> copy(new char[chunk_size]);
+        memcpy(copy.get(), contents.data.data(), chunk_size);
+        contents = BlockContents(std::move(copy), chunk_size,
+                                 contents.cachable, contents.compression_type);
+      }
+      BlockContents* cached = new BlockContents(std::move(contents));
+      s = block_cache->Insert(cache_key, cached, chunk_size,
+                              &DeleteCachedChunk, &buffer->cache_handle);
+      if (s.ok()) {
+        RecordTick(statistics, BLOCK_CACHE_ADD);
+        RecordTick(statistics, BLOCK_CACHE_DATA_ADD);
+        buffer->cache = block_cache;
+        buffer->chunk_data = cached->data.data();
+      } else {
+        RecordTick(statistics, BLOCK_CACHE_ADD_FAILURES);
+        buffer->chunk = std::move(*cached);
+        buffer->chunk_data = buffer->chunk.data.data();
+        delete cached;
+      }
+    }
+  }
+
+  buffer->buf_start_offset = file_info_->chunk_starts[i];
+  buffer->buf_len = chunk_size;
+  return true;
+}
+
 inline bool PlainTableFileReader::ReadVarint32(uint32_t offset, uint32_t* out,
                                                uint32_t* bytes_read) {
   if (file_info_->is_mmap_mode) {
@@ -241,7 +357,12 @@ bool PlainTableFileReader::ReadVarint32NonMmap(uint32_t offset, uint32_t* out,
   uint32_t bytes_to_read =
       std::min(file_info_->data_end_offset - offset, kMaxVarInt32Size);
   Slice bytes;
-  if (!Read(offset, bytes_to_read, &bytes)) {
+  if (file_info_->is_chunked) {
+    // Varints are never split across chunks
+    if (!ReadChunk(offset, bytes_to_read, &bytes)) {
+      return false;
+    }
+  } else if (!Read(offset, bytes_to_read, &bytes)) {
     return false;
   }
   start = bytes.data();
@@ -7,6 +7,7 @@
 #ifndef ROCKSDB_LITE
 
 #include <array>
+#include "rocksdb/cache.h"
 #include "rocksdb/slice.h"
 #include "db/dbformat.h"
 #include "table/plain_table_reader.h"
@@ -32,14 +33,12 @@ class PlainTableKeyEncoder {
         index_sparseness_((index_sparseness > 1) ? index_sparseness : 1),
         key_count_for_prefix_(0) {}
   // key: the key to write out, in the format of internal key.
-  // file: the output file to write out
-  // offset: offset in the file. Needs to be updated after appending bytes
-  //         for the key
+  // out: the buffer to append the encoded key to
   // meta_bytes_buf: buffer for extra meta bytes
   // meta_bytes_buf_size: offset to append extra meta bytes. Will be updated
   //                      if meta_bytes_buf is updated.
-  Status AppendKey(const Slice& key, WritableFileWriter* file, uint64_t* offset,
-                   char* meta_bytes_buf, size_t* meta_bytes_buf_size);
+  Status AppendKey(const Slice& key, std::string* out, char* meta_bytes_buf,
+                   size_t* meta_bytes_buf_size);
 
   // Return actual encoding type to be picked
   EncodingType GetEncodingType() { return encoding_type_; }
@@ -89,6 +88,11 @@ class PlainTableFileReader {
   // If return false, status code is stored in status_.
   bool ReadNonMmap(uint32_t file_offset, uint32_t len, Slice* output);
 
+  // Read from the chunk that file_offset is in, which is loaded into one of
+  // the buffers if needed. Stops at the end of the chunk, so output may be
+  // shorter than len. If return false, status code is stored in status_.
+  bool ReadChunk(uint32_t file_offset, uint32_t len, Slice* output);
+
   // *bytes_read = 0 means eof. false means failure and status is saved
   // in status_. Not directly returning Status to save copying status
   // object to map previous performance of mmap mode.
@@ -106,11 +110,27 @@ class PlainTableFileReader {
   const PlainTableReaderFileInfo* file_info_;
 
   struct Buffer {
-    Buffer() : buf_start_offset(0), buf_len(0), buf_capacity(0) {}
+    Buffer()
+        : buf_start_offset(0),
+          buf_len(0),
+          buf_capacity(0),
+          chunk_data(nullptr),
+          cache(nullptr),
+          cache_handle(nullptr) {}
+    ~Buffer() { ReleaseChunk(); }
+    void ReleaseChunk();
+
     std::unique_ptr<char[]> buf;
     uint32_t buf_start_offset;
     uint32_t buf_len;
     uint32_t buf_capacity;
+
+    // For chunks, the uncompressed chunk, which is either owned by chunk or
+    // pinned in the block cache by cache_handle
+    const char* chunk_data;
+    BlockContents chunk;
+    Cache* cache;
+    Cache::Handle* cache_handle;
   };
 
   // Keep buffers for two recent reads.
@@ -119,6 +139,9 @@ class PlainTableFileReader {
   Status status_;
 
   Slice GetFromBuffer(Buffer* buf, uint32_t file_offset, uint32_t len);
+
+  // Load chunk i into buffer, from the block cache if it is there
+  bool LoadChunk(size_t i, Buffer* buffer);
 };
 
 // A helper class to decode keys from input buffer
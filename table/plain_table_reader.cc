@@ -123,7 +123,8 @@ Status PlainTableReader::Open(const ImmutableCFOptions& ioptions,
                               unique_ptr<TableReader>* table_reader,
                               const int bloom_bits_per_key,
                               double hash_table_ratio, size_t index_sparseness,
-                              size_t huge_page_tlb_size, bool full_scan_mode) {
+                              size_t huge_page_tlb_size, bool full_scan_mode,
+                              Cache* block_cache) {
   if (file_size > PlainTableIndex::kMaxFileSize) {
     return Status::NotSupported("File is too large for PlainTableReader!");
   }
@@ -166,6 +167,14 @@ Status PlainTableReader::Open(const ImmutableCFOptions& ioptions,
       ioptions, std::move(file), env_options, internal_comparator,
       encoding_type, file_size, props));
 
+  if (user_props.find(PlainTablePropertyNames::kChunkSize) !=
+      user_props.end()) {
+    s = new_reader->ReadChunkIndex(block_cache);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
   s = new_reader->MmapDataIfNeeded();
   if (!s.ok()) {
     return s;
@@ -192,7 +201,8 @@ void PlainTableReader::SetupForCompaction() {
 
 InternalIterator* PlainTableReader::NewIterator(const ReadOptions& options,
                                                 Arena* arena,
-                                                bool skip_filters) {
+                                                bool skip_filters,
+                                                bool for_compaction) {
   if (options.total_order_seek && !IsTotalOrderMode()) {
     return NewErrorInternalIterator(
         Status::InvalidArgument("total_order_seek not supported"), arena);
@@ -286,6 +296,64 @@ Status PlainTableReader::MmapDataIfNeeded() {
   return Status::OK();
 }
 
+Status PlainTableReader::ReadChunkIndex(Cache* block_cache) {
+  Status s = ReadFooterFromFile(file_info_.file.get(), file_size_,
+                                &file_info_.footer, kPlainTableMagicNumber);
+  if (!s.ok()) {
+    return s;
+  }
+  BlockContents chunk_index_contents;
+  s = ReadMetaBlock(file_info_.file.get(), file_size_, kPlainTableMagicNumber,
+                    ioptions_, PlainTableIndexBuilder::kPlainTableChunkIndexBlock,
+                    &chunk_index_contents);
+  if (!s.ok()) {
+    return s;
+  }
+
+  Slice input = chunk_index_contents.data;
+  uint32_t num_chunks;
+  if (!GetVarint32(&input, &num_chunks)) {
+    return Status::Corruption("Bad chunk index in PlainTable");
+  }
+  uint64_t data_size = 0;
+  file_info_.chunk_starts.reserve(num_chunks + 1);
+  file_info_.chunk_handles.reserve(num_chunks);
+  for (uint32_t i = 0; i < num_chunks; i++) {
+    uint32_t chunk_size;
+    BlockHandle handle;
+    if (!GetVarint32(&input, &chunk_size) || !handle.DecodeFrom(&input).ok() ||
+        chunk_size == 0) {
+      return Status::Corruption("Bad chunk index in PlainTable");
+    }
+    file_info_.chunk_starts.push_back(static_cast<uint32_t>(data_size));
+    file_info_.chunk_handles.push_back(handle);
+    data_size += chunk_size;
+    if (data_size > PlainTableIndex::kMaxFileSize) {
+      return Status::NotSupported("File is too large for PlainTableReader!");
+    }
+  }
+  file_info_.chunk_starts.push_back(static_cast<uint32_t>(data_size));
+
+  // The chunks are compressed, so they are always read into buffers
+  file_info_.is_mmap_mode = false;
+  file_info_.is_chunked = true;
+  file_info_.data_end_offset = static_cast<uint32_t>(data_size);
+  file_info_.ioptions = &ioptions_;
+  if (block_cache != nullptr) {
+    file_info_.block_cache = block_cache;
+    // Same as BlockBasedTable::GenerateCachePrefix()
+    char buffer[kMaxVarint64Length * 3 + 1];
+    size_t size =
+        file_info_.file->file()->GetUniqueId(buffer, sizeof(buffer));
+    if (size == 0) {
+      char* end = EncodeVarint64(buffer, block_cache->NewId());
+      size = static_cast<size_t>(end - buffer);
+    }
+    file_info_.cache_key_prefix.assign(buffer, size);
+  }
+  return Status::OK();
+}
+
 Status PlainTableReader::PopulateIndex(TableProperties* props,
                                        int bloom_bits_per_key,
                                        double hash_table_ratio,
@@ -17,6 +17,7 @@
 #include "rocksdb/slice_transform.h"
 #include "rocksdb/table.h"
 #include "rocksdb/table_properties.h"
+#include "table/format.h"
 #include "table/table_reader.h"
 #include "table/plain_table_factory.h"
 #include "table/plain_table_index.h"
@@ -51,6 +52,18 @@ struct PlainTableReaderFileInfo {
   uint32_t data_end_offset;
   unique_ptr<RandomAccessFileReader> file;
 
+  // Set if the records are stored in compressed chunks. data_end_offset is
+  // then the size of the uncompressed records, and chunk i has the records
+  // from chunk_starts[i] up to chunk_starts[i + 1].
+  bool is_chunked = false;
+  std::vector<uint32_t> chunk_starts;
+  std::vector<BlockHandle> chunk_handles;
+  Footer footer;
+  const ImmutableCFOptions* ioptions = nullptr;
+  // Cache of the uncompressed chunks, if any
+  Cache* block_cache = nullptr;
+  std::string cache_key_prefix;
+
   PlainTableReaderFileInfo(unique_ptr<RandomAccessFileReader>&& _file,
                            const EnvOptions& storage_options,
                            uint32_t _data_size_offset)
@@ -76,10 +89,11 @@ class PlainTableReader: public TableReader {
                      uint64_t file_size, unique_ptr<TableReader>* table,
                      const int bloom_bits_per_key, double hash_table_ratio,
                      size_t index_sparseness, size_t huge_page_tlb_size,
-                     bool full_scan_mode);
+                     bool full_scan_mode, Cache* block_cache = nullptr);
 
   InternalIterator* NewIterator(const ReadOptions&, Arena* arena = nullptr,
-                                bool skip_filters = false) override;
+                                bool skip_filters = false,
+                                bool for_compaction = false) override;
 
   void Prepare(const Slice& target) override;
 
@@ -126,6 +140,10 @@ class PlainTableReader: public TableReader {
 
   Status MmapDataIfNeeded();
 
+  // Read the chunk index of a table whose records are stored in compressed
+  // chunks, and switch file_info_ to reading the chunks.
+  Status ReadChunkIndex(Cache* block_cache);
+
  private:
   const InternalKeyComparator internal_comparator_;
   EncodingType encoding_type_;
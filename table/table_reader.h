@@ -8,7 +8,11 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #pragma once
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
+#include "rocksdb/cache.h"
 #include "table/internal_iterator.h"
 
 namespace rocksdb {
@@ -18,10 +22,19 @@ struct ParsedInternalKey;
 class Slice;
 class Arena;
 struct ReadOptions;
+class WritableFile;
 struct TableProperties;
 class GetContext;
 class InternalIterator;
 
+// A data block of a table that was hot in the block cache
+struct HotBlock {
+  uint64_t offset;
+  // Size of the block in the file, without the trailer
+  uint64_t size;
+  Cache::Priority priority;
+};
+
 // A Table is a sorted map from strings to strings.  Tables are
 // immutable and persistent.  A Table may be safely accessed from
 // multiple threads without external synchronization.
@@ -38,9 +51,12 @@ class TableReader {
   //        all the states but those allocated in arena.
   // skip_filters: disables checking the bloom filters even if they exist. This
   //               option is effective only for block-based table format.
+  // for_compaction: the iterator is used by a compaction. Only used to label
+  //                 block cache trace records.
   virtual InternalIterator* NewIterator(const ReadOptions&,
                                         Arena* arena = nullptr,
-                                        bool skip_filters = false) = 0;
+                                        bool skip_filters = false,
+                                        bool for_compaction = false) = 0;
 
   virtual InternalIterator* NewRangeTombstoneIterator(
       const ReadOptions& read_options) {
@@ -81,6 +97,21 @@ class TableReader {
   virtual Status Get(const ReadOptions& readOptions, const Slice& key,
                      GetContext* get_context, bool skip_filters = false) = 0;
 
+  // Look up num_keys keys as num_keys calls to Get() would, the result of
+  // keys[i] going to get_contexts[i] and statuses[i]. Tables can override it
+  // to overlap the memory accesses of the keys. The default prepares all the
+  // keys, then gets them one by one.
+  virtual void MultiGet(const ReadOptions& readOptions, size_t num_keys,
+                        const Slice* keys, GetContext** get_contexts,
+                        Status* statuses) {
+    for (size_t i = 0; i < num_keys; ++i) {
+      Prepare(keys[i]);
+    }
+    for (size_t i = 0; i < num_keys; ++i) {
+      statuses[i] = Get(readOptions, keys[i], get_contexts[i]);
+    }
+  }
+
   // Prefetch data corresponding to a give range of keys
   // Typically this functionality is required for table implementations that
   // persists the data on a non volatile storage medium like disk/SSD
@@ -93,6 +124,22 @@ class TableReader {
     return Status::OK();
   }
 
+  // The cache data blocks of this table are kept in, if any
+  virtual Cache* GetBlockCache() const { return nullptr; }
+
+  // Append to *blocks the data blocks of this table whose keys in the cache
+  // returned by GetBlockCache() are in hot_keys, in file offset order.
+  // hot_keys maps keys found in the cache to their priority.
+  virtual void GetHotBlocks(
+      const std::map<std::string, Cache::Priority>& hot_keys,
+      std::vector<HotBlock>* blocks) {}
+
+  // Load the given data blocks into the block cache, with the priority
+  // they had when GetHotBlocks() reported them.
+  virtual Status WarmUp(const std::vector<HotBlock>& blocks) {
+    return Status::OK();
+  }
+
   // convert db file to a human readable form
   virtual Status DumpTable(WritableFile* out_file) {
     return Status::NotSupported("DumpTable() not supported");
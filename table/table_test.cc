@@ -43,7 +43,9 @@
 #include "table/plain_table_factory.h"
 #include "table/scoped_arena_iterator.h"
 #include "table/sst_file_writer_collectors.h"
+#include "util/block_cache_tracer.h"
 #include "util/compression.h"
+#include "util/options_helper.h"
 #include "util/random.h"
 #include "util/statistics.h"
 #include "util/string_util.h"
@@ -214,7 +216,9 @@ class BlockConstructor: public Constructor {
                             const stl_wrappers::KVMap& kv_map) override {
     delete block_;
     block_ = nullptr;
-    BlockBuilder builder(table_options.block_restart_interval);
+    BlockBuilder builder(table_options.block_restart_interval,
+                         true /* use_delta_encoding */,
+                         table_options.separate_data_block_values);
 
     for (const auto kv : kv_map) {
       builder.Add(kv.first, kv.second);
@@ -560,6 +564,7 @@ struct TestArgs {
   CompressionType compression;
   uint32_t format_version;
   bool use_mmap;
+  bool separate_values;
 };
 
 static std::vector<TestArgs> GenerateArgList() {
@@ -617,6 +622,7 @@ static std::vector<TestArgs> GenerateArgList() {
         one_arg.reverse_compare = reverse_compare;
         one_arg.restart_interval = restart_intervals[0];
         one_arg.compression = compression_types[0].first;
+        one_arg.separate_values = false;
         one_arg.use_mmap = true;
         test_args.push_back(one_arg);
         one_arg.use_mmap = false;
@@ -634,7 +640,21 @@ static std::vector<TestArgs> GenerateArgList() {
           one_arg.compression = compression_type.first;
           one_arg.format_version = compression_type.second ? 2 : 1;
           one_arg.use_mmap = false;
+          one_arg.separate_values = false;
           test_args.push_back(one_arg);
+          if (test_type != MEMTABLE_TEST &&
+              compression_type == compression_types[0]) {
+            one_arg.separate_values = true;
+            test_args.push_back(one_arg);
+          }
+          if (test_type == BLOCK_BASED_TABLE_TEST &&
+              compression_type == compression_types[0]) {
+            one_arg.separate_values = false;
+            one_arg.format_version = 3;
+            test_args.push_back(one_arg);
+            one_arg.format_version = 4;
+            test_args.push_back(one_arg);
+          }
         }
       }
     }
@@ -684,6 +704,7 @@ class HarnessTest : public testing::Test {
     constructor_ = nullptr;
     options_ = Options();
     options_.compression = args.compression;
+    table_options_.separate_data_block_values = args.separate_values;
     // Use shorter block size for tests to exercise block boundary
     // conditions more.
     if (args.reverse_compare) {
@@ -1358,6 +1379,86 @@ TEST_F(BlockBasedTableTest, PrefetchTest) {
   c.ResetTableReader();
 }
 
+TEST_F(BlockBasedTableTest, BatchedBlockReads) {
+  Options opt;
+  unique_ptr<InternalKeyComparator> ikc;
+  ikc.reset(new test::PlainInternalKeyComparator(opt.comparator));
+  opt.compression = Zlib_Supported() ? kZlibCompression : kNoCompression;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  opt.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  TableConstructor c(BytewiseComparator(), true /* convert_to_internal_key_ */);
+  c.Add("k01", "hello");
+  c.Add("k02", "hello2");
+  c.Add("k03", std::string(10000, 'x'));
+  c.Add("k04", std::string(200000, 'x'));
+  c.Add("k05", std::string(300000, 'x'));
+  c.Add("k06", "hello3");
+  c.Add("k07", std::string(100000, 'x'));
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  const ImmutableCFOptions ioptions(opt);
+  c.Finish(opt, ioptions, table_options, *ikc, &keys, &kvmap);
+  c.ResetTableReader();
+
+  if (opt.compression != kNoCompression) {
+    // Without a block cache, Prefetch() fills the compressed block cache
+    table_options.block_cache_compressed = NewLRUCache(16 * 1024 * 1024, 4);
+    table_options.no_block_cache = true;
+    opt.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    const ImmutableCFOptions ioptions2(opt);
+    ASSERT_OK(c.Reopen(ioptions2));
+    ASSERT_EQ(0U, table_options.block_cache_compressed->GetUsage());
+    ASSERT_OK(c.GetTableReader()->Prefetch(nullptr, nullptr));
+    ASSERT_GT(table_options.block_cache_compressed->GetUsage(), 0U);
+    c.ResetTableReader();
+    table_options.block_cache_compressed.reset();
+    table_options.no_block_cache = false;
+  }
+
+  // MultiGet() loads the blocks of the keys into the block cache first
+  table_options.block_cache = NewLRUCache(16 * 1024 * 1024, 4);
+  opt.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  const ImmutableCFOptions ioptions3(opt);
+  ASSERT_OK(c.Reopen(ioptions3));
+  auto* table_reader = dynamic_cast<BlockBasedTable*>(c.GetTableReader());
+  const std::vector<std::string> user_keys = {"k01", "k04", "k06", "k08"};
+  std::vector<std::string> internal_keys;
+  std::vector<Slice> key_slices;
+  for (const auto& user_key : user_keys) {
+    internal_keys.push_back(
+        InternalKey(user_key, kMaxSequenceNumber, kTypeValue).Encode()
+            .ToString());
+  }
+  for (const auto& internal_key : internal_keys) {
+    key_slices.push_back(internal_key);
+  }
+  std::vector<std::string> values(user_keys.size());
+  std::vector<std::unique_ptr<GetContext>> get_contexts;
+  std::vector<GetContext*> get_context_ptrs;
+  for (size_t i = 0; i < user_keys.size(); i++) {
+    get_contexts.emplace_back(new GetContext(
+        opt.comparator, nullptr, nullptr, nullptr, GetContext::kNotFound,
+        user_keys[i], &values[i], nullptr, nullptr, nullptr, nullptr));
+    get_context_ptrs.push_back(get_contexts.back().get());
+  }
+  std::vector<Status> statuses(user_keys.size());
+  table_reader->MultiGet(ReadOptions(), user_keys.size(), key_slices.data(),
+                         get_context_ptrs.data(), statuses.data());
+  for (size_t i = 0; i < user_keys.size(); i++) {
+    ASSERT_OK(statuses[i]);
+  }
+  ASSERT_EQ(GetContext::kFound, get_contexts[0]->State());
+  ASSERT_EQ("hello", values[0]);
+  ASSERT_EQ(std::string(200000, 'x'), values[1]);
+  ASSERT_EQ("hello3", values[2]);
+  ASSERT_EQ(GetContext::kNotFound, get_contexts[3]->State());
+  AssertKeysInCache(table_reader, {"k01", "k02", "k03", "k04", "k06", "k07"},
+                    {"k05"}, true /* convert */);
+  c.ResetTableReader();
+}
+
 TEST_F(BlockBasedTableTest, TotalOrderSeekOnHashIndex) {
   BlockBasedTableOptions table_options;
   for (int i = 0; i < 4; ++i) {
@@ -1708,6 +1809,89 @@ TEST_F(BlockBasedTableTest, IndexSizeStat) {
   }
 }
 
+TEST_F(BlockBasedTableTest, CompactIndex) {
+  Random rnd(301);
+  std::vector<std::string> user_keys;
+  for (int i = 0; i < 2000; i++) {
+    user_keys.push_back(RandomString(&rnd, 16));
+  }
+  InternalKeyComparator icomp(BytewiseComparator());
+
+  for (bool spanning_user_key : {false, true}) {
+    uint64_t index_sizes[2];
+    for (uint32_t format_version : {2, 3}) {
+      Options options;
+      options.compression = kNoCompression;
+      BlockBasedTableOptions table_options;
+      table_options.block_size = 1024;
+      table_options.index_block_restart_interval = 16;
+      table_options.format_version = format_version;
+      options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+      Random value_rnd(302);
+      TableConstructor c(&icomp);
+      std::map<std::string, std::string> newest_values;
+      for (const auto& user_key : user_keys) {
+        newest_values[user_key] = RandomString(&value_rnd, 200);
+        c.Add(InternalKey(user_key, 1, kTypeValue).Encode().ToString(),
+              newest_values[user_key]);
+      }
+      if (spanning_user_key) {
+        // Versions of a user key over several data blocks
+        for (SequenceNumber seq = 2; seq < 30; seq++) {
+          newest_values[user_keys[0]] = RandomString(&value_rnd, 200);
+          c.Add(InternalKey(user_keys[0], seq, kTypeValue).Encode().ToString(),
+                newest_values[user_keys[0]]);
+        }
+      }
+
+      std::vector<std::string> keys;
+      stl_wrappers::KVMap kvmap;
+      const ImmutableCFOptions ioptions(options);
+      c.Finish(options, ioptions, table_options, icomp, &keys, &kvmap);
+      auto props = c.GetTableReader()->GetTableProperties();
+      ASSERT_GT(props->num_data_blocks, 100U);
+      ASSERT_EQ(format_version == 3 && !spanning_user_key,
+                props->user_collected_properties.count(
+                    BlockBasedTablePropertyNames::kIndexKeyIsUserKey) > 0);
+      index_sizes[format_version - 2] = props->index_size;
+
+      for (const auto& kv : newest_values) {
+        std::string value;
+        GetContext get_context(BytewiseComparator(), nullptr, nullptr, nullptr,
+                               GetContext::kNotFound, kv.first, &value,
+                               nullptr, nullptr, nullptr, nullptr);
+        InternalKey lookup_key(kv.first, kMaxSequenceNumber,
+                               kValueTypeForSeek);
+        ASSERT_OK(c.GetTableReader()->Get(ReadOptions(), lookup_key.Encode(),
+                                          &get_context));
+        ASSERT_EQ(GetContext::kFound, get_context.State());
+        ASSERT_EQ(kv.second, value);
+      }
+
+      std::unique_ptr<InternalIterator> iter(c.NewIterator());
+      for (const auto& key : keys) {
+        iter->Seek(key);
+        ASSERT_TRUE(iter->Valid());
+        ASSERT_EQ(key, iter->key().ToString());
+      }
+      size_t count = 0;
+      for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+        ASSERT_EQ(keys[keys.size() - ++count], iter->key().ToString());
+      }
+      ASSERT_EQ(keys.size(), count);
+      ASSERT_OK(iter->status());
+      c.ResetTableReader();
+    }
+    if (spanning_user_key) {
+      // Only the handles are smaller
+      ASSERT_LT(index_sizes[1], index_sizes[0]);
+    } else {
+      ASSERT_LT(index_sizes[1] * 10, index_sizes[0] * 7);
+    }
+  }
+}
+
 TEST_F(BlockBasedTableTest, NumBlockStat) {
   Random rnd(test::RandomSeed());
   TableConstructor c(BytewiseComparator(), true /* convert_to_internal_key_ */);
@@ -1840,6 +2024,88 @@ TEST_F(BlockBasedTableTest, BlockCacheDisabledTest) {
   }
 }
 
+namespace {
+// Keeps trace records in memory
+class VectorTraceWriter : public TraceWriter {
+ public:
+  explicit VectorTraceWriter(std::vector<std::string>* records)
+      : records_(records) {}
+  Status Write(const Slice& data) override {
+    records_->push_back(data.ToString());
+    return Status::OK();
+  }
+  Status Close() override { return Status::OK(); }
+  uint64_t GetFileSize() override { return 0; }
+
+ private:
+  std::vector<std::string>* records_;
+};
+}  // namespace
+
+TEST_F(BlockBasedTableTest, BlockCacheTrace) {
+  Options options;
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(1024 * 1024, 0);
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+  table_options.block_cache_tracer = NewBlockCacheTracer();
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+  std::vector<std::string> records;
+  ASSERT_OK(table_options.block_cache_tracer->StartTrace(
+      BlockCacheTraceOptions(),
+      std::unique_ptr<TraceWriter>(new VectorTraceWriter(&records))));
+
+  TableConstructor c(BytewiseComparator());
+  std::string user_key = "k01";
+  InternalKey internal_key(user_key, 0, kTypeValue);
+  c.Add(internal_key.Encode().ToString(), "hello");
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  const ImmutableCFOptions ioptions(options);
+  c.Finish(options, ioptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+  auto reader = c.GetTableReader();
+
+  std::string value;
+  GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                         GetContext::kNotFound, user_key, &value, nullptr,
+                         nullptr, nullptr, nullptr);
+  ASSERT_OK(reader->Get(ReadOptions(), internal_key.Encode(), &get_context));
+  ASSERT_EQ("hello", value);
+  std::unique_ptr<InternalIterator> iter(reader->NewIterator(ReadOptions()));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  iter.reset(reader->NewIterator(ReadOptions(), nullptr, false,
+                                 true /* for_compaction */));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  iter.reset();
+  ASSERT_OK(table_options.block_cache_tracer->EndTrace());
+
+  // The header, then the lookups
+  ASSERT_GT(records.size(), 1U);
+  std::map<std::pair<TraceBlockType, TableReaderCaller>, int> lookups;
+  for (size_t i = 1; i < records.size(); i++) {
+    BlockCacheTraceRecord record;
+    ASSERT_OK(DecodeBlockCacheTraceRecord(records[i], &record));
+    ASSERT_GT(record.block_size, 0U);
+    lookups[std::make_pair(record.block_type, record.caller)]++;
+  }
+  // Opening the table caches the index and filter blocks
+  ASSERT_EQ(1, lookups[std::make_pair(TraceBlockType::kIndexBlock,
+                                      TableReaderCaller::kPrefetch)]);
+  ASSERT_EQ(1, lookups[std::make_pair(TraceBlockType::kFilterBlock,
+                                      TableReaderCaller::kPrefetch)]);
+  ASSERT_EQ(1, lookups[std::make_pair(TraceBlockType::kFilterBlock,
+                                      TableReaderCaller::kUserGet)]);
+  ASSERT_EQ(1, lookups[std::make_pair(TraceBlockType::kDataBlock,
+                                      TableReaderCaller::kUserGet)]);
+  ASSERT_EQ(1, lookups[std::make_pair(TraceBlockType::kDataBlock,
+                                      TableReaderCaller::kUserIterator)]);
+  ASSERT_EQ(1, lookups[std::make_pair(TraceBlockType::kDataBlock,
+                                      TableReaderCaller::kCompaction)]);
+}
+
 // Due to the difficulities of the intersaction between statistics, this test
 // only tests the case when "index block is put to block cache"
 TEST_F(BlockBasedTableTest, FilterBlockInBlockCache) {
@@ -2402,6 +2668,124 @@ TEST_F(GeneralTableTest, ApproximateOffsetOfCompressed) {
   }
 }
 
+TEST_F(GeneralTableTest, DigestedZSTDDictionary) {
+  if (!ZSTD_Supported()) {
+    fprintf(stderr, "skipping zstd dictionary tests\n");
+    return;
+  }
+  Random rnd(301);
+  const std::string dict = RandomString(&rnd, 4 << 10);
+  // A block made of pieces of the dictionary compresses well only with it
+  std::string block;
+  while (block.size() < (4 << 10)) {
+    block.append(dict, rnd.Uniform(static_cast<int>(dict.size()) - 100), 100);
+  }
+
+  CompressionOptions opts;
+  std::string no_dict_output;
+  ASSERT_TRUE(ZSTD_Compress(opts, block.data(), block.size(), &no_dict_output));
+  CompressionDict digested_dict(dict, kZSTD, opts.level);
+  std::string output;
+  ASSERT_TRUE(ZSTD_Compress(opts, block.data(), block.size(), &output,
+                            digested_dict));
+  ASSERT_LT(output.size() * 2, no_dict_output.size());
+  CompressionDict raw_dict(dict, kNoCompression, opts.level);
+  std::string raw_dict_output;
+  ASSERT_TRUE(ZSTD_Compress(opts, block.data(), block.size(),
+                            &raw_dict_output, raw_dict));
+
+  // Blocks compressed with either form of the dictionary decompress with
+  // either form
+  UncompressionDict digested_uncompression_dict(dict, kZSTD);
+  UncompressionDict raw_uncompression_dict(dict, kNoCompression);
+  for (const std::string* compressed : {&output, &raw_dict_output}) {
+    for (const UncompressionDict* uncompression_dict :
+         {&digested_uncompression_dict, &raw_uncompression_dict}) {
+      int size = 0;
+      std::unique_ptr<char[]> uncompressed(ZSTD_Uncompress(
+          compressed->data(), compressed->size(), &size, *uncompression_dict));
+      ASSERT_TRUE(uncompressed != nullptr);
+      ASSERT_EQ(block, std::string(uncompressed.get(), size));
+    }
+  }
+}
+
+TEST_F(BlockBasedTableTest, AdaptiveCompression) {
+  if (!Zlib_Supported() || !ZSTD_Supported()) {
+    fprintf(stderr, "skipping adaptive compression tests\n");
+    return;
+  }
+  // Incompressible values followed by very compressible ones
+  TableConstructor c(BytewiseComparator(), true /* convert_to_internal_key_ */);
+  Random rnd(301);
+  for (int i = 0; i < 200; i++) {
+    std::string value(1000, 'a' + i % 26);
+    if (i < 100) {
+      for (auto& ch : value) {
+        ch = static_cast<char>(rnd.Uniform(256));
+      }
+    }
+    c.Add("key" + ToString(1000 + i), value);
+  }
+
+  Options options;
+  options.compression = kZlibCompression;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 4096;
+  table_options.adaptive_compression_candidates = {kZlibCompression, kZSTD};
+  table_options.adaptive_compression_sampling_interval = 4;
+  table_options.verify_compression = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  const ImmutableCFOptions ioptions(options);
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  c.Finish(options, ioptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+
+  // Both the incompressible and the compressible blocks were noticed
+  auto& props = *c.GetTableReader()->GetTableProperties();
+  auto block_types = props.user_collected_properties.find(
+      BlockBasedTablePropertyNames::kDataBlockCompressionTypes);
+  ASSERT_TRUE(block_types != props.user_collected_properties.end());
+  std::map<std::string, uint64_t> counts;
+  uint64_t total_blocks = 0;
+  for (const auto& type_count : StringSplit(block_types->second, ';')) {
+    auto pair = StringSplit(type_count, '=');
+    ASSERT_EQ(2, pair.size());
+    counts[pair[0]] = ParseUint64(pair[1]);
+    total_blocks += counts[pair[0]];
+  }
+  ASSERT_EQ(props.num_data_blocks, total_blocks);
+  ASSERT_GE(counts["NoCompression"], 20);
+  ASSERT_GE(counts["Zlib"] + counts["ZSTD"], 5);
+  ASSERT_LT(props.data_size, 150 * 1000);
+
+  std::unique_ptr<InternalIterator> iter(c.NewIterator());
+  auto expected = kvmap.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected) {
+    ASSERT_TRUE(expected != kvmap.end());
+    ASSERT_EQ(expected->first, iter->key().ToString());
+    ASSERT_EQ(expected->second, iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(expected == kvmap.end());
+  iter.reset();
+  c.ResetTableReader();
+
+  // Tables of levels that are not compressed stay uncompressed
+  options.compression = kNoCompression;
+  TableConstructor c2(BytewiseComparator(), true /* convert_to_internal_key_ */);
+  c2.Add("key", std::string(10000, 'a'));
+  c2.Finish(options, ioptions, table_options,
+            GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+  auto& uncompressed_props = *c2.GetTableReader()->GetTableProperties();
+  ASSERT_EQ(
+      "NoCompression=1",
+      uncompressed_props.user_collected_properties.at(
+          BlockBasedTablePropertyNames::kDataBlockCompressionTypes));
+  c2.ResetTableReader();
+}
+
 TEST_F(HarnessTest, Randomized) {
   std::vector<TestArgs> args = GenerateArgList();
   for (unsigned int i = 0; i < args.size(); i++) {
@@ -2426,7 +2810,7 @@ TEST_F(HarnessTest, Randomized) {
 #ifndef ROCKSDB_LITE
 TEST_F(HarnessTest, RandomizedLongDB) {
   Random rnd(test::RandomSeed());
-  TestArgs args = {DB_TEST, false, 16, kNoCompression, 0, false};
+  TestArgs args = {DB_TEST, false, 16, kNoCompression, 0, false, false};
   Init(args);
   int num_entries = 100000;
   for (int e = 0; e < num_entries; e++) {
@@ -0,0 +1,164 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+//
+// Replays a block cache trace, recorded with a BlockCacheTracer set as
+// BlockBasedTableOptions::block_cache_tracer, against simulated caches of
+// several sizes and policies and reports the miss ratio of each, overall and
+// for each block type, caller and level.
+//
+// Example:
+//   block_cache_trace_analyzer --block_cache_trace_path=/tmp/trace
+//     --cache_sizes=64M,256M,1G --cache_policies=lru,lru_tinylfu
+//     --mrc_output_path=/tmp/mrc.csv
+
+#include <cstdio>
+
+#ifndef GFLAGS
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <gflags/gflags.h>
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <string>
+#include <vector>
+
+#include "rocksdb/env.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/block_cache_tracer.h"
+#include "util/options_helper.h"
+#include "util/string_util.h"
+#include "utilities/simulator_cache/cache_simulator.h"
+
+using GFLAGS::ParseCommandLineFlags;
+using GFLAGS::SetUsageMessage;
+
+DEFINE_string(block_cache_trace_path, "", "The block cache trace to replay.");
+DEFINE_string(cache_sizes, "16M,64M,256M,1G",
+              "Comma-separated capacities of the simulated caches.");
+DEFINE_string(cache_policies, "lru,lru_priority,lru_tinylfu",
+              "Comma-separated policies of the simulated caches: lru, "
+              "lru_priority (index and filter blocks in a high priority "
+              "pool), lru_tinylfu (admission filter) or clock. Each policy is "
+              "simulated with every size.");
+DEFINE_string(mrc_output_path, "",
+              "If set, write the miss ratios of every simulated cache, block "
+              "type, caller and level to this file as CSV.");
+
+namespace rocksdb {
+
+namespace {
+
+void PrintMissRatios(const BlockCacheTraceSimulator& simulator) {
+  fprintf(stdout, "%-14s %14s %12s %8s %8s %8s %8s\n", "policy", "capacity",
+          "accesses", "all", "data", "index", "filter");
+  for (size_t i = 0; i < simulator.simulators().size(); i++) {
+    const auto& config = simulator.configs()[i];
+    const auto& sim = *simulator.simulators()[i];
+    fprintf(stdout,
+            "%-14s %14" PRIu64 " %12" PRIu64
+            " %7.2f%% %7.2f%% %7.2f%% %7.2f%%\n",
+            config.policy.c_str(), config.capacity, sim.total().accesses,
+            sim.total().miss_ratio(),
+            sim.block_type(TraceBlockType::kDataBlock).miss_ratio(),
+            sim.block_type(TraceBlockType::kIndexBlock).miss_ratio(),
+            sim.block_type(TraceBlockType::kFilterBlock).miss_ratio());
+  }
+
+  fprintf(stdout, "\nMiss ratio by level:\n");
+  for (size_t i = 0; i < simulator.simulators().size(); i++) {
+    const auto& config = simulator.configs()[i];
+    const auto& sim = *simulator.simulators()[i];
+    fprintf(stdout, "%-14s %14" PRIu64, config.policy.c_str(),
+            config.capacity);
+    for (const auto& level : sim.levels()) {
+      fprintf(stdout, "  L%d %.2f%%", level.first, level.second.miss_ratio());
+    }
+    fprintf(stdout, "\n");
+  }
+}
+
+int Run() {
+  if (FLAGS_block_cache_trace_path.empty()) {
+    fprintf(stderr, "--block_cache_trace_path is required\n");
+    return 1;
+  }
+
+  std::vector<CacheConfiguration> configs;
+  for (const auto& policy : StringSplit(FLAGS_cache_policies, ',')) {
+    for (const auto& size : StringSplit(FLAGS_cache_sizes, ',')) {
+      configs.push_back({policy, ParseUint64(size)});
+    }
+  }
+  std::unique_ptr<BlockCacheTraceSimulator> simulator;
+  Status s = BlockCacheTraceSimulator::Create(configs, &simulator);
+  if (!s.ok()) {
+    fprintf(stderr, "%s\n", s.ToString().c_str());
+    return 1;
+  }
+
+  Env* env = Env::Default();
+  std::unique_ptr<TraceReader> trace_reader;
+  s = NewFileTraceReader(env, EnvOptions(), FLAGS_block_cache_trace_path,
+                         &trace_reader);
+  if (!s.ok()) {
+    fprintf(stderr, "Cannot open trace: %s\n", s.ToString().c_str());
+    return 1;
+  }
+  BlockCacheTraceReader reader(std::move(trace_reader));
+  s = reader.ReadHeader();
+  if (!s.ok()) {
+    fprintf(stderr, "%s\n", s.ToString().c_str());
+    return 1;
+  }
+
+  BlockCacheTraceRecord access;
+  uint64_t num_accesses = 0;
+  uint64_t first_timestamp = 0;
+  uint64_t last_timestamp = 0;
+  while ((s = reader.ReadAccess(&access)).ok()) {
+    if (num_accesses == 0) {
+      first_timestamp = access.access_timestamp;
+    }
+    last_timestamp = access.access_timestamp;
+    num_accesses++;
+    simulator->Access(access);
+  }
+  if (!s.IsIncomplete()) {
+    fprintf(stderr, "Error after %" PRIu64 " accesses: %s\n", num_accesses,
+            s.ToString().c_str());
+    return 1;
+  }
+
+  fprintf(stdout, "Replayed %" PRIu64 " accesses over %" PRIu64 " seconds\n\n",
+          num_accesses, (last_timestamp - first_timestamp) / 1000000);
+  PrintMissRatios(*simulator);
+
+  if (!FLAGS_mrc_output_path.empty()) {
+    s = WriteStringToFile(env, simulator->ToCSV(), FLAGS_mrc_output_path);
+    if (!s.ok()) {
+      fprintf(stderr, "%s\n", s.ToString().c_str());
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " --block_cache_trace_path=<path> [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+  return rocksdb::Run();
+}
+
+#endif  // GFLAGS
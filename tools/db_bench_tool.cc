@@ -25,9 +25,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <condition_variable>
 #include <cstddef>
+#include <map>
 #include <mutex>
 #include <thread>
 #include <unordered_map>
@@ -47,6 +50,7 @@
 #include "rocksdb/rate_limiter.h"
 #include "rocksdb/slice.h"
 #include "rocksdb/slice_transform.h"
+#include "rocksdb/trace_reader_writer.h"
 #include "rocksdb/utilities/object_registry.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "rocksdb/utilities/options_util.h"
@@ -54,6 +58,7 @@
 #include "rocksdb/utilities/transaction.h"
 #include "rocksdb/utilities/transaction_db.h"
 #include "rocksdb/write_batch.h"
+#include "rocksdb/write_buffer_manager.h"
 #include "util/compression.h"
 #include "util/crc32c.h"
 #include "util/histogram.h"
@@ -63,6 +68,7 @@
 #include "util/stderr_logger.h"
 #include "util/string_util.h"
 #include "util/testutil.h"
+#include "util/trace_replay.h"
 #include "util/transaction_test_util.h"
 #include "util/xxhash.h"
 #include "utilities/blob_db/blob_db.h"
@@ -106,6 +112,7 @@ DEFINE_string(
     "fill100K,"
     "crc32c,"
     "xxhash,"
+    "xxhash64,"
     "compress,"
     "uncompress,"
     "acquireload,"
@@ -160,8 +167,10 @@ DEFINE_string(
     "overwrite\n"
     "\tseekrandomwhilemerging -- seekrandom and 1 thread doing "
     "merge\n"
-    "\tcrc32c        -- repeated crc32c of 4K of data\n"
-    "\txxhash        -- repeated xxHash of 4K of data\n"
+    "\tcrc32c        -- repeated crc32c of --checksum_size bytes of data\n"
+    "\txxhash        -- repeated xxHash of --checksum_size bytes of data\n"
+    "\txxhash64      -- repeated 64-bit xxHash of --checksum_size bytes of "
+    "data\n"
     "\tacquireload   -- load N*1000 times\n"
     "\tfillseekseq   -- write N values in sequential key, then read "
     "them by seeking to each key\n"
@@ -170,7 +179,19 @@ DEFINE_string(
     "\trandomreplacekeys     -- randomly replaces N keys by deleting "
     "the old version and putting the new version\n\n"
     "\ttimeseries            -- 1 writer generates time series data "
-    "and multiple readers doing random reads on id\n\n"
+    "and multiple readers doing random reads on id\n"
+    "\treplay        -- replay the queries traced in --trace_replay_file "
+    "against the DB\n"
+    "\tycsba         -- YCSB workload A: 50% reads, 50% updates\n"
+    "\tycsbb         -- YCSB workload B: 95% reads, 5% updates\n"
+    "\tycsbc         -- YCSB workload C: reads only\n"
+    "\tycsbd         -- YCSB workload D: 95% reads, 5% inserts, reading "
+    "the latest keys\n"
+    "\tycsbe         -- YCSB workload E: 95% short scans, 5% inserts\n"
+    "\tycsbf         -- YCSB workload F: 50% reads, 50% "
+    "read-modify-writes\n"
+    "\tmixgraph      -- gets, puts and seeks mixed by --mix_get_ratio, "
+    "--mix_put_ratio and --mix_seek_ratio\n\n"
     "Meta operations:\n"
     "\tcompact     -- Compact the entire DB\n"
     "\tstats       -- Print DB stats\n"
@@ -217,6 +238,26 @@ DEFINE_int32(duration, 0, "Time in seconds for the random-ops tests to run."
 
 DEFINE_int32(value_size, 100, "Size of each value");
 
+DEFINE_string(value_size_distribution_type, "fixed",
+              "Distribution of the sizes of the values written by the fill, "
+              "ycsb and mixgraph benchmarks: fixed (value_size), uniform "
+              "(between value_size_min and value_size_max), normal (centred "
+              "between them, 99.7% of sizes within them) or pareto "
+              "(value_size_min plus a generalized Pareto variable, capped at "
+              "value_size_max)");
+
+DEFINE_int32(value_size_min, 100, "Smallest value size of the uniform, "
+             "normal and pareto value size distributions");
+
+DEFINE_int32(value_size_max, 102400, "Largest value size of the uniform, "
+             "normal and pareto value size distributions");
+
+DEFINE_double(value_size_pareto_k, 0.2615, "Shape of the pareto value size "
+              "distribution");
+
+DEFINE_double(value_size_pareto_sigma, 25.45, "Scale of the pareto value size "
+              "distribution");
+
 DEFINE_int32(seek_nexts, 0,
              "How many times to call Next() after Seek() in "
              "fillseekseq, seekrandom, seekrandomwhilewriting and "
@@ -270,6 +311,10 @@ DEFINE_bool(enable_numa, false,
 DEFINE_int64(db_write_buffer_size, rocksdb::Options().db_write_buffer_size,
              "Number of bytes to buffer in all memtables before compacting");
 
+DEFINE_bool(cost_write_buffer_to_cache, false,
+            "Charge memtable memory to the block cache, so that memtables and "
+            "cached blocks share --cache_size");
+
 DEFINE_int64(write_buffer_size, rocksdb::Options().write_buffer_size,
              "Number of bytes to buffer in memtable before compacting");
 
@@ -369,6 +414,11 @@ DEFINE_double(cache_high_pri_pool_ratio, 0.0,
 DEFINE_bool(use_clock_cache, false,
             "Replace default LRU block cache with clock cache.");
 
+DEFINE_bool(cache_admission_filter, false,
+            "Only admit a block into a full LRU block cache if it was read "
+            "more often recently than the block it would evict. Also applies "
+            "to the simcache.");
+
 DEFINE_int64(simcache_size, -1,
              "Number of bytes to use as a simcache of "
              "uncompressed data. Nagative value disables simcache.");
@@ -393,10 +443,25 @@ DEFINE_int32(index_block_restart_interval,
              "Number of keys between restart points "
              "for delta encoding of keys in index block.");
 
+DEFINE_bool(separate_data_block_values,
+            rocksdb::BlockBasedTableOptions().separate_data_block_values,
+            "Store the values of each data block after all its keys");
+
+DEFINE_bool(keys_only, false,
+            "readseq only reads the keys, with ReadOptions::keys_only");
+
 DEFINE_int32(read_amp_bytes_per_bit,
              rocksdb::BlockBasedTableOptions().read_amp_bytes_per_bit,
              "Number of bytes per bit to be used in block read-amp bitmap");
 
+DEFINE_int32(checksum_type, rocksdb::BlockBasedTableOptions().checksum,
+             "Checksum of the table blocks: 1 for kCRC32c, 2 for kxxHash, 3 "
+             "for kxxHash64");
+
+DEFINE_int32(checksum_size, 4096,
+             "Bytes of data checksummed per op by the crc32c, xxhash and "
+             "xxhash64 benchmarks");
+
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
@@ -637,6 +702,56 @@ static std::string ColumnFamilyName(size_t i) {
   }
 }
 
+enum KeyDistribution : unsigned char {
+  kUniformKeys,
+  kZipfianKeys,
+  kLatestKeys,
+  kHotspotKeys
+};
+
+static enum KeyDistribution StringToKeyDistribution(const char* dist) {
+  assert(dist);
+
+  if (!strcasecmp(dist, "uniform"))
+    return kUniformKeys;
+  else if (!strcasecmp(dist, "zipfian"))
+    return kZipfianKeys;
+  else if (!strcasecmp(dist, "latest"))
+    return kLatestKeys;
+  else if (!strcasecmp(dist, "hotspot"))
+    return kHotspotKeys;
+
+  fprintf(stderr, "Cannot parse key distribution '%s'\n", dist);
+  exit(1);
+}
+
+enum ValueSizeDistribution : unsigned char {
+  kFixedValueSize,
+  kUniformValueSize,
+  kNormalValueSize,
+  kParetoValueSize
+};
+
+static enum ValueSizeDistribution StringToValueSizeDistribution(
+    const char* dist) {
+  assert(dist);
+
+  if (!strcasecmp(dist, "fixed"))
+    return kFixedValueSize;
+  else if (!strcasecmp(dist, "uniform"))
+    return kUniformValueSize;
+  else if (!strcasecmp(dist, "normal"))
+    return kNormalValueSize;
+  else if (!strcasecmp(dist, "pareto"))
+    return kParetoValueSize;
+
+  fprintf(stderr, "Cannot parse value size distribution '%s'\n", dist);
+  exit(1);
+}
+
+static enum ValueSizeDistribution FLAGS_value_size_distribution_type_e =
+    kFixedValueSize;
+
 DEFINE_string(compression_type, "snappy",
               "Algorithm to use to compress the database");
 static enum rocksdb::CompressionType FLAGS_compression_type_e =
@@ -650,6 +765,10 @@ DEFINE_int32(compression_max_dict_bytes, 0,
              "Maximum size of dictionary used to prime the compression "
              "library.");
 
+DEFINE_int32(compression_zstd_max_train_bytes, 0,
+             "Maximum size of the samples used to train the ZSTD compression "
+             "dictionary. 0 uses the samples as the dictionary.");
+
 static bool ValidateCompressionLevel(const char* flagname, int32_t value) {
   if (value < -1 || value > 9) {
     fprintf(stderr, "Invalid value for --%s: %d, must be between -1 and 9\n",
@@ -896,6 +1015,9 @@ DEFINE_bool(use_plain_table, false, "if use plain table "
             "instead of block-based table format");
 DEFINE_bool(use_cuckoo_table, false, "if use cuckoo table format");
 DEFINE_double(cuckoo_hash_ratio, 0.9, "Hash ratio for Cuckoo SST table.");
+DEFINE_int32(cuckoo_build_threads, 1,
+             "Number of threads hashing the keys when building Cuckoo SST "
+             "tables.");
 DEFINE_bool(use_hash_search, false, "if use kHashSearch "
             "instead of kBinarySearch. "
             "This is valid if only we use BlockTable");
@@ -912,6 +1034,51 @@ DEFINE_int32(skip_list_lookahead, 0, "Used with skip_list memtablerep; try "
 DEFINE_bool(report_file_operations, false, "if report number of file "
             "operations");
 
+DEFINE_string(trace_file, "", "If set, the queries made to the DB by the "
+              "benchmarks are traced to this file, for the replay benchmark. "
+              "Tracing stops when a benchmark recreates the DB.");
+DEFINE_int64(trace_sampling_frequency, 1, "Trace one in every this many "
+             "queries.");
+DEFINE_int64(trace_max_file_size, 64LL << 30, "Stop tracing once the trace "
+             "file reaches this size.");
+DEFINE_string(trace_replay_file, "", "The query trace replayed by the replay "
+              "benchmark, recorded with --trace_file or DB::StartTrace().");
+DEFINE_double(trace_replay_fast_forward, 1.0, "Replay the trace this many "
+              "times faster than it was recorded.");
+DEFINE_int32(trace_replay_threads, 1, "Number of threads issuing the "
+             "queries of the replay benchmark.");
+
+DEFINE_string(key_distribution, "", "Popularity of the keys requested by the "
+              "ycsb and mixgraph benchmarks: uniform, zipfian, latest (zipfian "
+              "over the most recently inserted keys) or hotspot. When empty, "
+              "each YCSB workload uses its own (latest for ycsbd, zipfian "
+              "otherwise) and mixgraph uses zipfian. The ycsb and mixgraph "
+              "benchmarks expect keys [0, num) to be loaded, e.g. by fillseq.");
+static enum KeyDistribution FLAGS_key_distribution_e = kZipfianKeys;
+
+DEFINE_double(zipfian_constant, 0.99, "Skew of the zipfian and latest key "
+              "distributions, in (0, 1). The larger, the more skewed.");
+
+DEFINE_double(hotspot_data_fraction, 0.2, "Fraction of the keys in the hot "
+              "set of the hotspot key distribution.");
+
+DEFINE_double(hotspot_op_fraction, 0.8, "Fraction of the requests of the "
+              "hotspot key distribution that go to the hot set.");
+
+DEFINE_int32(max_scan_length, 100, "The scans of ycsbe and mixgraph read a "
+             "uniformly random number of entries between 1 and this.");
+
+DEFINE_double(mix_get_ratio, 0.85, "Weight of gets in the mixgraph benchmark."
+              " The weights of gets, puts and seeks are normalized by their "
+              "sum. --histogram reports the latency of each type of "
+              "operation.");
+
+DEFINE_double(mix_put_ratio, 0.14, "Weight of puts in the mixgraph "
+              "benchmark.");
+
+DEFINE_double(mix_seek_ratio, 0.01, "Weight of seeks, each followed by a "
+              "scan, in the mixgraph benchmark.");
+
 static const bool FLAGS_soft_rate_limit_dummy __attribute__((unused)) =
     RegisterFlagValidator(&FLAGS_soft_rate_limit, &ValidateRateLimit);
 
@@ -1081,7 +1248,8 @@ class RandomGenerator {
     // large enough to serve all typical value sizes we want to write.
     Random rnd(301);
     std::string piece;
-    while (data_.size() < (unsigned)std::max(1048576, FLAGS_value_size)) {
+    while (data_.size() < (unsigned)std::max(
+                              {1048576, FLAGS_value_size, FLAGS_value_size_max})) {
       // Add a short fragment that is as compressible as specified
       // by FLAGS_compression_ratio.
       test::CompressibleString(&rnd, FLAGS_compression_ratio, 100, &piece);
@@ -1100,6 +1268,211 @@ class RandomGenerator {
   }
 };
 
+// Returns a uniformly distributed double in [0, 1)
+static double NextDouble(Random64* rand) {
+  return static_cast<double>(rand->Next() >> 11) * (1.0 / (1ULL << 53));
+}
+
+// Draws ranks from a zipfian distribution over [0, items), 0 being the most
+// popular, with the method of Gray et al., "Quickly Generating Billion-Record
+// Synthetic Databases", as YCSB does. The number of items can grow.
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(uint64_t items, double theta)
+      : items_(items),
+        theta_(theta),
+        alpha_(1.0 / (1.0 - theta)),
+        zeta2_(Zeta(0, 2, theta, 0)),
+        zetan_(CachedZeta(items, theta)) {
+    assert(items > 0);
+    UpdateEta();
+  }
+
+  void Grow(uint64_t items) {
+    if (items > items_) {
+      zetan_ = Zeta(items_, items, theta_, zetan_);
+      items_ = items;
+      UpdateEta();
+    }
+  }
+
+  uint64_t Next(Random64* rand) {
+    const double u = NextDouble(rand);
+    const double uz = u * zetan_;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta_)) {
+      return 1;
+    }
+    const uint64_t rank = static_cast<uint64_t>(
+        items_ * std::pow(eta_ * u - eta_ + 1, alpha_));
+    return std::min(rank, items_ - 1);
+  }
+
+ private:
+  // Returns initial plus the sum of 1 / i^theta for i in (from, to]
+  static double Zeta(uint64_t from, uint64_t to, double theta,
+                     double initial) {
+    double sum = initial;
+    for (uint64_t i = from; i < to; i++) {
+      sum += 1.0 / std::pow(static_cast<double>(i + 1), theta);
+    }
+    return sum;
+  }
+
+  // Zeta of the initial number of items is linear in it, so it is computed
+  // once rather than by every thread
+  static double CachedZeta(uint64_t items, double theta) {
+    static std::mutex mutex;
+    static std::map<std::pair<uint64_t, double>, double> cache;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = cache.find({items, theta});
+    if (it == cache.end()) {
+      it = cache.insert({{items, theta}, Zeta(0, items, theta, 0)}).first;
+    }
+    return it->second;
+  }
+
+  void UpdateEta() {
+    eta_ = (1 - std::pow(2.0 / items_, 1 - theta_)) / (1 - zeta2_ / zetan_);
+  }
+
+  uint64_t items_;
+  const double theta_;
+  const double alpha_;
+  const double zeta2_;
+  double zetan_;
+  double eta_;
+};
+
+// Draws the indexes of the keys requested by the ycsb and mixgraph
+// benchmarks, out of the keys [0, num_keys) where num_keys grows with the
+// keys inserted by the benchmark.
+class RequestKeyGenerator {
+ public:
+  RequestKeyGenerator(KeyDistribution dist, uint64_t num_keys,
+                      Random64* rand)
+      : dist_(dist), rand_(rand) {
+    if (dist_ == kZipfianKeys || dist_ == kLatestKeys) {
+      zipfian_.reset(
+          new ZipfianGenerator(std::max<uint64_t>(num_keys, 1),
+                               FLAGS_zipfian_constant));
+    }
+  }
+
+  uint64_t Next(uint64_t num_keys) {
+    assert(num_keys > 0);
+    switch (dist_) {
+      case kUniformKeys:
+        return rand_->Uniform(num_keys);
+      case kZipfianKeys:
+        // Scramble the ranks so that the popular keys are spread over the
+        // key space rather than clustered at its start
+        zipfian_->Grow(num_keys);
+        return Scramble(zipfian_->Next(rand_)) % num_keys;
+      case kLatestKeys:
+        zipfian_->Grow(num_keys);
+        return num_keys - 1 - zipfian_->Next(rand_);
+      case kHotspotKeys: {
+        const uint64_t hot_keys = std::max<uint64_t>(
+            static_cast<uint64_t>(num_keys * FLAGS_hotspot_data_fraction), 1);
+        if (hot_keys >= num_keys ||
+            NextDouble(rand_) < FLAGS_hotspot_op_fraction) {
+          return rand_->Uniform(std::min(hot_keys, num_keys));
+        }
+        return hot_keys + rand_->Uniform(num_keys - hot_keys);
+      }
+    }
+    assert(false);
+    return 0;
+  }
+
+ private:
+  static uint64_t Scramble(uint64_t v) {
+    v ^= v >> 33;
+    v *= 0xff51afd7ed558ccdULL;
+    v ^= v >> 33;
+    v *= 0xc4ceb9fe1a85ec53ULL;
+    v ^= v >> 33;
+    return v;
+  }
+
+  const KeyDistribution dist_;
+  Random64* const rand_;
+  std::unique_ptr<ZipfianGenerator> zipfian_;
+};
+
+// Draws the sizes of the values written, following
+// --value_size_distribution_type
+class ValueSizeGenerator {
+ public:
+  explicit ValueSizeGenerator(Random64* rand) : rand_(rand) {}
+
+  int Next() {
+    const int min_size = FLAGS_value_size_min;
+    const int max_size = std::max(FLAGS_value_size_max, min_size);
+    double size;
+    switch (FLAGS_value_size_distribution_type_e) {
+      case kUniformValueSize:
+        return min_size +
+               static_cast<int>(rand_->Uniform(max_size - min_size + 1));
+      case kNormalValueSize: {
+        // Box-Muller transform
+        const double u1 = 1.0 - NextDouble(rand_);
+        const double u2 = NextDouble(rand_);
+        const double z =
+            std::sqrt(-2.0 * std::log(u1)) * std::cos(2 * 3.14159265358979323846 * u2);
+        size = (min_size + max_size) / 2.0 + z * (max_size - min_size) / 6.0;
+        break;
+      }
+      case kParetoValueSize: {
+        const double u = 1.0 - NextDouble(rand_);
+        size = min_size + FLAGS_value_size_pareto_sigma *
+                              (std::pow(u, -FLAGS_value_size_pareto_k) - 1) /
+                              FLAGS_value_size_pareto_k;
+        break;
+      }
+      default:
+        return FLAGS_value_size;
+    }
+    return static_cast<int>(
+        std::max<double>(min_size, std::min<double>(max_size, size)));
+  }
+
+ private:
+  Random64* const rand_;
+};
+
+// The operation mix of a YCSB core workload, in percents
+struct YCSBWorkload {
+  const char* name;
+  int read_percent;
+  int update_percent;
+  int insert_percent;
+  int scan_percent;
+  int read_modify_write_percent;
+  KeyDistribution key_distribution;
+};
+
+static const YCSBWorkload kYCSBWorkloads[] = {
+    {"ycsba", 50, 50, 0, 0, 0, kZipfianKeys},
+    {"ycsbb", 95, 5, 0, 0, 0, kZipfianKeys},
+    {"ycsbc", 100, 0, 0, 0, 0, kZipfianKeys},
+    {"ycsbd", 95, 0, 5, 0, 0, kLatestKeys},
+    {"ycsbe", 0, 0, 5, 95, 0, kZipfianKeys},
+    {"ycsbf", 50, 0, 0, 0, 50, kZipfianKeys},
+};
+
+static const YCSBWorkload* FindYCSBWorkload(const std::string& name) {
+  for (const YCSBWorkload& workload : kYCSBWorkloads) {
+    if (name == workload.name) {
+      return &workload;
+    }
+  }
+  return nullptr;
+}
+
 static void AppendWithSpace(std::string* str, Slice msg) {
   if (msg.empty()) return;
   if (!str->empty()) {
@@ -1767,6 +2140,9 @@ class Benchmark {
   int64_t readwrites_;
   int64_t merge_keys_;
   bool report_file_operations_;
+  // Number of keys of the ycsb benchmarks, including the ones they inserted
+  std::atomic<int64_t> ycsb_num_keys_;
+  const YCSBWorkload* ycsb_workload_;
 
   bool SanityCheck() {
     if (FLAGS_compression_ratio > 1) {
@@ -1999,7 +2375,8 @@ class Benchmark {
     } else {
       return NewLRUCache((size_t)capacity, FLAGS_cache_numshardbits,
                          false /*strict_capacity_limit*/,
-                         FLAGS_cache_high_pri_pool_ratio);
+                         FLAGS_cache_high_pri_pool_ratio,
+                         FLAGS_cache_admission_filter);
     }
   }
 
@@ -2026,9 +2403,18 @@ class Benchmark {
                 ? FLAGS_num
                 : ((FLAGS_writes > FLAGS_reads) ? FLAGS_writes : FLAGS_reads)),
         merge_keys_(FLAGS_merge_keys < 0 ? FLAGS_num : FLAGS_merge_keys),
-        report_file_operations_(FLAGS_report_file_operations) {
+        report_file_operations_(FLAGS_report_file_operations),
+        ycsb_num_keys_(FLAGS_num),
+        ycsb_workload_(nullptr) {
     // use simcache instead of cache
-    if (FLAGS_simcache_size >= 0) {
+    if (FLAGS_simcache_size >= 0 && FLAGS_cache_admission_filter) {
+      cache_ = NewSimCache(
+          cache_, NewLRUCache(FLAGS_simcache_size,
+                              std::max(FLAGS_cache_numshardbits, 0),
+                              false /*strict_capacity_limit*/,
+                              0.0 /*high_pri_pool_ratio*/,
+                              true /*use_admission_filter*/));
+    } else if (FLAGS_simcache_size >= 0) {
       if (FLAGS_cache_numshardbits >= 1) {
         cache_ =
             NewSimCache(cache_, FLAGS_simcache_size, FLAGS_cache_numshardbits);
@@ -2349,6 +2735,8 @@ class Benchmark {
         method = &Benchmark::Crc32c;
       } else if (name == "xxhash") {
         method = &Benchmark::xxHash;
+      } else if (name == "xxhash64") {
+        method = &Benchmark::xxHash64;
       } else if (name == "acquireload") {
         method = &Benchmark::AcquireLoad;
       } else if (name == "compress") {
@@ -2372,6 +2760,18 @@ class Benchmark {
         }
         fresh_db = true;
         method = &Benchmark::TimeSeries;
+      } else if (name == "replay") {
+        if (num_threads > 1) {
+          fprintf(stderr, "Replay uses --trace_replay_threads, not "
+                          "--threads\n");
+          num_threads = 1;
+        }
+        method = &Benchmark::Replay;
+      } else if (FindYCSBWorkload(name) != nullptr) {
+        ycsb_workload_ = FindYCSBWorkload(name);
+        method = &Benchmark::YCSB;
+      } else if (name == "mixgraph") {
+        method = &Benchmark::MixGraph;
       } else if (name == "stats") {
         PrintStats("rocksdb.stats");
       } else if (name == "levelstats") {
@@ -2402,10 +2802,15 @@ class Benchmark {
             DestroyDB(GetPathForMultiple(FLAGS_db, i), options);
           }
           multi_dbs_.clear();
+          ycsb_num_keys_ = FLAGS_num;
         }
         Open(&open_options_);  // use open_options for the last accessed
       }
 
+      if (method != nullptr && !FLAGS_trace_file.empty() && !tracing_) {
+        StartTrace();
+      }
+
       if (method != nullptr) {
         fprintf(stdout, "DB path: [%s]\n", FLAGS_db.c_str());
         if (num_warmup > 0) {
@@ -2433,6 +2838,13 @@ class Benchmark {
         (this->*post_process_method)();
       }
     }
+    if (tracing_ && db_.db != nullptr) {
+      Status s = db_.db->EndTrace();
+      if (!s.ok()) {
+        fprintf(stderr, "Encountered an error ending the trace, %s\n",
+                s.ToString().c_str());
+      }
+    }
     if (FLAGS_statistics) {
       fprintf(stdout, "STATISTICS:\n%s\n", dbstats->ToString().c_str());
     }
@@ -2444,6 +2856,8 @@ class Benchmark {
 
  private:
   std::shared_ptr<TimestampEmulator> timestamp_emulator_;
+  // Set once the queries are traced to --trace_file
+  bool tracing_ = false;
 
   struct ThreadArg {
     Benchmark* bm;
@@ -2559,42 +2973,63 @@ class Benchmark {
     return merge_stats;
   }
 
-  void Crc32c(ThreadState* thread) {
+  // Cycles of the time stamp counter, 0 where there is none
+  static uint64_t CycleClock() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    uint32_t lo;
+    uint32_t hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return (static_cast<uint64_t>(hi) << 32) | lo;
+#else
+    return 0;
+#endif
+  }
+
+  template <typename ChecksumFunc>
+  void Checksum(ThreadState* thread, OperationType op_type, const char* name,
+                ChecksumFunc checksum) {
     // Checksum about 500MB of data total
-    const int size = 4096;
-    const char* label = "(4K per op)";
+    const int size = FLAGS_checksum_size;
     std::string data(size, 'x');
     int64_t bytes = 0;
-    uint32_t crc = 0;
+    uint64_t result = 0;
+    const uint64_t start_cycles = CycleClock();
     while (bytes < 500 * 1048576) {
-      crc = crc32c::Value(data.data(), size);
-      thread->stats.FinishedOps(nullptr, nullptr, 1, kCrc);
+      result += checksum(data.data(), size);
+      thread->stats.FinishedOps(nullptr, nullptr, 1, op_type);
       bytes += size;
     }
+    const uint64_t cycles = CycleClock() - start_cycles;
     // Print so result is not dead
-    fprintf(stderr, "... crc=0x%x\r", static_cast<unsigned int>(crc));
+    fprintf(stderr, "... %s=0x%" PRIx64 "\r", name, result);
 
+    char label[100];
+    if (cycles > 0) {
+      snprintf(label, sizeof(label), "(%d bytes per op, %.2f bytes/cycle)",
+               size, static_cast<double>(bytes) / cycles);
+    } else {
+      snprintf(label, sizeof(label), "(%d bytes per op)", size);
+    }
     thread->stats.AddBytes(bytes);
     thread->stats.AddMessage(label);
   }
 
+  void Crc32c(ThreadState* thread) {
+    Checksum(thread, kCrc, "crc", [](const char* data, int size) {
+      return crc32c::Value(data, size);
+    });
+  }
+
   void xxHash(ThreadState* thread) {
-    // Checksum about 500MB of data total
-    const int size = 4096;
-    const char* label = "(4K per op)";
-    std::string data(size, 'x');
-    int64_t bytes = 0;
-    unsigned int xxh32 = 0;
-    while (bytes < 500 * 1048576) {
-      xxh32 = XXH32(data.data(), size, 0);
-      thread->stats.FinishedOps(nullptr, nullptr, 1, kHash);
-      bytes += size;
-    }
-    // Print so result is not dead
-    fprintf(stderr, "... xxh32=0x%x\r", static_cast<unsigned int>(xxh32));
+    Checksum(thread, kHash, "xxh32", [](const char* data, int size) {
+      return XXH32(data, size, 0);
+    });
+  }
 
-    thread->stats.AddBytes(bytes);
-    thread->stats.AddMessage(label);
+  void xxHash64(ThreadState* thread) {
+    Checksum(thread, kHash, "xxh64", [](const char* data, int size) {
+      return XXH64(data, size, 0);
+    });
   }
 
   void AcquireLoad(ThreadState* thread) {
@@ -2741,6 +3176,10 @@ class Benchmark {
     options.create_missing_column_families = FLAGS_num_column_families > 1;
     options.max_open_files = FLAGS_open_files;
     options.db_write_buffer_size = FLAGS_db_write_buffer_size;
+    if (FLAGS_cost_write_buffer_to_cache && cache_ != nullptr) {
+      options.write_buffer_manager.reset(
+          new WriteBufferManager(FLAGS_db_write_buffer_size, cache_));
+    }
     options.write_buffer_size = FLAGS_write_buffer_size;
     options.max_write_buffer_number = FLAGS_max_write_buffer_number;
     options.min_write_buffer_number_to_merge =
@@ -2865,6 +3304,7 @@ class Benchmark {
       rocksdb::CuckooTableOptions table_options;
       table_options.hash_table_ratio = FLAGS_cuckoo_hash_ratio;
       table_options.identity_as_first_hash = FLAGS_identity_as_first_hash;
+      table_options.num_build_threads = FLAGS_cuckoo_build_threads;
       options.table_factory = std::shared_ptr<TableFactory>(
           NewCuckooTableFactory(table_options));
 #else
@@ -2905,6 +3345,10 @@ class Benchmark {
           FLAGS_skip_table_builder_flush;
       block_based_options.format_version = 2;
       block_based_options.read_amp_bytes_per_bit = FLAGS_read_amp_bytes_per_bit;
+      block_based_options.separate_data_block_values =
+          FLAGS_separate_data_block_values;
+      block_based_options.checksum =
+          static_cast<rocksdb::ChecksumType>(FLAGS_checksum_type);
       options.table_factory.reset(
           NewBlockBasedTableFactory(block_based_options));
     }
@@ -2926,6 +3370,8 @@ class Benchmark {
     options.compression = FLAGS_compression_type_e;
     options.compression_opts.level = FLAGS_compression_level;
     options.compression_opts.max_dict_bytes = FLAGS_compression_max_dict_bytes;
+    options.compression_opts.zstd_max_train_bytes =
+        FLAGS_compression_zstd_max_train_bytes;
     options.WAL_ttl_seconds = FLAGS_wal_ttl_seconds;
     options.WAL_size_limit_MB = FLAGS_wal_size_limit_MB;
     options.max_total_wal_size = FLAGS_max_total_wal_size;
@@ -3252,6 +3698,7 @@ class Benchmark {
     }
 
     RandomGenerator gen;
+    ValueSizeGenerator value_sizes(&thread->rand);
     WriteBatch batch;
     Status s;
     int64_t bytes = 0;
@@ -3302,19 +3749,23 @@ class Benchmark {
       for (int64_t j = 0; j < entries_per_batch_; j++) {
         int64_t rand_num = key_gens[id]->Next();
         GenerateKeyFromInt(rand_num, FLAGS_num, &key);
+        const int value_size = FLAGS_value_size_distribution_type_e ==
+                                       kFixedValueSize
+                                   ? value_size_
+                                   : value_sizes.Next();
         if (FLAGS_use_blob_db) {
           s = db_with_cfh->db->Put(write_options_, key,
-                                   gen.Generate(value_size_));
+                                   gen.Generate(value_size));
         } else if (FLAGS_num_column_families <= 1) {
-          batch.Put(key, gen.Generate(value_size_));
+          batch.Put(key, gen.Generate(value_size));
         } else {
           // We use same rand_num as seed for key and column family so that we
           // can deterministically find the cfh corresponding to a particular
           // key while reading the key.
           batch.Put(db_with_cfh->GetCfh(rand_num), key,
-                    gen.Generate(value_size_));
+                    gen.Generate(value_size));
         }
-        bytes += value_size_ + key_size_;
+        bytes += value_size + key_size_;
         ++num_written;
         if (writes_per_range_tombstone_ > 0 &&
             num_written / writes_per_range_tombstone_ <
@@ -3641,12 +4092,16 @@ class Benchmark {
   void ReadSequential(ThreadState* thread, DB* db) {
     ReadOptions options(FLAGS_verify_checksum, true);
     options.tailing = FLAGS_use_tailing_iterator;
+    options.keys_only = FLAGS_keys_only;
 
     Iterator* iter = db->NewIterator(options);
     int64_t i = 0;
     int64_t bytes = 0;
     for (iter->SeekToFirst(); i < reads_ && iter->Valid(); iter->Next()) {
-      bytes += iter->key().size() + iter->value().size();
+      bytes += iter->key().size();
+      if (!FLAGS_keys_only) {
+        bytes += iter->value().size();
+      }
       thread->stats.FinishedOps(nullptr, db, 1, kRead);
       ++i;
 
@@ -4299,6 +4754,184 @@ class Benchmark {
     thread->stats.AddMessage(msg);
   }
 
+  // Runs the YCSB core workload of the benchmark against the keys [0, num)
+  // loaded beforehand. Inserted records get new keys past the existing ones.
+  void YCSB(ThreadState* thread) {
+    const YCSBWorkload& workload = *ycsb_workload_;
+    ReadOptions options(FLAGS_verify_checksum, true);
+    RandomGenerator gen;
+    ValueSizeGenerator value_sizes(&thread->rand);
+    RequestKeyGenerator key_gen(FLAGS_key_distribution.empty()
+                                    ? workload.key_distribution
+                                    : FLAGS_key_distribution_e,
+                                ycsb_num_keys_.load(), &thread->rand);
+    std::string value;
+    int64_t reads_done = 0;
+    int64_t updates_done = 0;
+    int64_t inserts_done = 0;
+    int64_t scans_done = 0;
+    int64_t read_modify_writes_done = 0;
+    int64_t found = 0;
+    Duration duration(FLAGS_duration, readwrites_);
+
+    std::unique_ptr<const char[]> key_guard;
+    Slice key = AllocateKey(&key_guard);
+
+    while (!duration.Done(1)) {
+      DB* db = SelectDB(thread);
+      int op = static_cast<int>(thread->rand.Uniform(100));
+      if (op < workload.insert_percent) {
+        GenerateKeyFromInt(ycsb_num_keys_.fetch_add(1), FLAGS_num, &key);
+        Status s = db->Put(write_options_, key,
+                           gen.Generate(value_sizes.Next()));
+        if (!s.ok()) {
+          fprintf(stderr, "put error: %s\n", s.ToString().c_str());
+          exit(1);
+        }
+        inserts_done++;
+        thread->stats.FinishedOps(nullptr, db, 1, kWrite);
+        continue;
+      }
+      op -= workload.insert_percent;
+      GenerateKeyFromInt(key_gen.Next(ycsb_num_keys_.load()), FLAGS_num,
+                         &key);
+      if (op < workload.read_percent) {
+        Status s = db->Get(options, key, &value);
+        if (s.ok()) {
+          found++;
+        } else if (!s.IsNotFound()) {
+          fprintf(stderr, "get error: %s\n", s.ToString().c_str());
+        }
+        reads_done++;
+        thread->stats.FinishedOps(nullptr, db, 1, kRead);
+      } else if (op < workload.read_percent + workload.update_percent) {
+        Status s = db->Put(write_options_, key,
+                           gen.Generate(value_sizes.Next()));
+        if (!s.ok()) {
+          fprintf(stderr, "put error: %s\n", s.ToString().c_str());
+          exit(1);
+        }
+        updates_done++;
+        thread->stats.FinishedOps(nullptr, db, 1, kWrite);
+      } else if (op < workload.read_percent + workload.update_percent +
+                          workload.scan_percent) {
+        if (Scan(db, options, key, &thread->rand)) {
+          found++;
+        }
+        scans_done++;
+        thread->stats.FinishedOps(nullptr, db, 1, kSeek);
+      } else {
+        Status s = db->Get(options, key, &value);
+        if (s.ok()) {
+          found++;
+        } else if (!s.IsNotFound()) {
+          fprintf(stderr, "get error: %s\n", s.ToString().c_str());
+        }
+        s = db->Put(write_options_, key, gen.Generate(value_sizes.Next()));
+        if (!s.ok()) {
+          fprintf(stderr, "put error: %s\n", s.ToString().c_str());
+          exit(1);
+        }
+        read_modify_writes_done++;
+        thread->stats.FinishedOps(nullptr, db, 1, kUpdate);
+      }
+    }
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "( reads:%" PRIu64 " updates:%" PRIu64 " inserts:%" PRIu64
+             " scans:%" PRIu64 " read-modify-writes:%" PRIu64
+             " found:%" PRIu64 ")",
+             reads_done, updates_done, inserts_done, scans_done,
+             read_modify_writes_done, found);
+    thread->stats.AddMessage(msg);
+  }
+
+  // Mixes gets, puts and seeks by --mix_get_ratio, --mix_put_ratio and
+  // --mix_seek_ratio, over keys and value sizes drawn from the configured
+  // distributions.
+  void MixGraph(ThreadState* thread) {
+    const double total_ratio =
+        FLAGS_mix_get_ratio + FLAGS_mix_put_ratio + FLAGS_mix_seek_ratio;
+    if (!(total_ratio > 0) || FLAGS_mix_get_ratio < 0 ||
+        FLAGS_mix_put_ratio < 0 || FLAGS_mix_seek_ratio < 0) {
+      fprintf(stderr, "mixgraph needs non-negative ratios with a positive "
+                      "sum\n");
+      exit(1);
+    }
+    ReadOptions options(FLAGS_verify_checksum, true);
+    RandomGenerator gen;
+    ValueSizeGenerator value_sizes(&thread->rand);
+    RequestKeyGenerator key_gen(FLAGS_key_distribution.empty()
+                                    ? kZipfianKeys
+                                    : FLAGS_key_distribution_e,
+                                FLAGS_num, &thread->rand);
+    std::string value;
+    int64_t gets_done = 0;
+    int64_t puts_done = 0;
+    int64_t seeks_done = 0;
+    int64_t found = 0;
+    Duration duration(FLAGS_duration, readwrites_);
+
+    std::unique_ptr<const char[]> key_guard;
+    Slice key = AllocateKey(&key_guard);
+
+    while (!duration.Done(1)) {
+      DB* db = SelectDB(thread);
+      GenerateKeyFromInt(key_gen.Next(FLAGS_num), FLAGS_num, &key);
+      const double op = NextDouble(&thread->rand) * total_ratio;
+      if (op < FLAGS_mix_get_ratio) {
+        Status s = db->Get(options, key, &value);
+        if (s.ok()) {
+          found++;
+        } else if (!s.IsNotFound()) {
+          fprintf(stderr, "get error: %s\n", s.ToString().c_str());
+        }
+        gets_done++;
+        thread->stats.FinishedOps(nullptr, db, 1, kRead);
+      } else if (op < FLAGS_mix_get_ratio + FLAGS_mix_put_ratio) {
+        Status s = db->Put(write_options_, key,
+                           gen.Generate(value_sizes.Next()));
+        if (!s.ok()) {
+          fprintf(stderr, "put error: %s\n", s.ToString().c_str());
+          exit(1);
+        }
+        puts_done++;
+        thread->stats.FinishedOps(nullptr, db, 1, kWrite);
+      } else {
+        if (Scan(db, options, key, &thread->rand)) {
+          found++;
+        }
+        seeks_done++;
+        thread->stats.FinishedOps(nullptr, db, 1, kSeek);
+      }
+    }
+    char msg[100];
+    snprintf(msg, sizeof(msg),
+             "( gets:%" PRIu64 " puts:%" PRIu64 " seeks:%" PRIu64
+             " found:%" PRIu64 ")",
+             gets_done, puts_done, seeks_done, found);
+    thread->stats.AddMessage(msg);
+  }
+
+  // Seeks to key and reads up to a uniformly random 1..max_scan_length
+  // entries. Returns whether any entry was found.
+  bool Scan(DB* db, const ReadOptions& options, const Slice& key,
+            Random64* rand) {
+    const int64_t scan_length =
+        1 + static_cast<int64_t>(
+                rand->Uniform(std::max(FLAGS_max_scan_length, 1)));
+    std::unique_ptr<Iterator> iter(db->NewIterator(options));
+    iter->Seek(key);
+    const bool found = iter->Valid();
+    for (int64_t i = 0; i < scan_length && iter->Valid(); i++) {
+      iter->Next();
+    }
+    if (!iter->status().ok()) {
+      fprintf(stderr, "seek error: %s\n", iter->status().ToString().c_str());
+    }
+    return found;
+  }
+
   //
   // Read-modify-write for random keys
   void UpdateRandom(ThreadState* thread) {
@@ -4845,6 +5478,69 @@ class Benchmark {
     db->CompactRange(CompactRangeOptions(), nullptr, nullptr);
   }
 
+  void StartTrace() {
+    if (db_.db == nullptr) {
+      fprintf(stderr, "--trace_file is only supported with a single DB\n");
+      exit(1);
+    }
+    TraceOptions trace_options;
+    trace_options.sampling_frequency =
+        static_cast<uint64_t>(FLAGS_trace_sampling_frequency);
+    trace_options.max_trace_file_size =
+        static_cast<uint64_t>(FLAGS_trace_max_file_size);
+    std::unique_ptr<TraceWriter> trace_writer;
+    Status s = NewFileTraceWriter(FLAGS_env, EnvOptions(), FLAGS_trace_file,
+                                  &trace_writer);
+    if (s.ok()) {
+      s = db_.db->StartTrace(trace_options, std::move(trace_writer));
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Encountered an error starting a trace, %s\n",
+              s.ToString().c_str());
+      exit(1);
+    }
+    fprintf(stdout, "Tracing the queries to %s\n", FLAGS_trace_file.c_str());
+    tracing_ = true;
+  }
+
+  void Replay(ThreadState* thread) {
+    if (db_.db == nullptr) {
+      fprintf(stderr, "Replay is only supported with a single DB\n");
+      exit(1);
+    }
+    std::unique_ptr<TraceReader> trace_reader;
+    Status s = NewFileTraceReader(FLAGS_env, EnvOptions(),
+                                  FLAGS_trace_replay_file, &trace_reader);
+    if (!s.ok()) {
+      fprintf(stderr, "Encountered an error opening the trace, %s\n",
+              s.ToString().c_str());
+      exit(1);
+    }
+    std::vector<ColumnFamilyHandle*> handles = db_.cfh;
+    if (handles.empty()) {
+      handles.push_back(db_.db->DefaultColumnFamily());
+    }
+    Replayer replayer(db_.db, handles, std::move(trace_reader));
+    s = replayer.SetFastForward(FLAGS_trace_replay_fast_forward);
+    if (s.ok()) {
+      s = FLAGS_trace_replay_threads > 1
+              ? replayer.MultiThreadReplay(
+                    static_cast<uint32_t>(FLAGS_trace_replay_threads))
+              : replayer.Replay();
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Encountered an error replaying the trace, %s\n",
+              s.ToString().c_str());
+      exit(1);
+    }
+    thread->stats.FinishedOps(nullptr, db_.db,
+                              static_cast<int64_t>(replayer.num_queries()));
+    char msg[100];
+    snprintf(msg, sizeof(msg), "(%" PRIu64 " queries replayed)",
+             replayer.num_queries());
+    thread->stats.AddMessage(msg);
+  }
+
   void PrintStats(const char* key) {
     if (db_.db != nullptr) {
       PrintStats(db_.db, key, false);
@@ -4913,6 +5609,16 @@ int db_bench_tool(int argc, char** argv) {
 
   FLAGS_compression_type_e =
     StringToCompressionType(FLAGS_compression_type.c_str());
+  FLAGS_value_size_distribution_type_e = StringToValueSizeDistribution(
+      FLAGS_value_size_distribution_type.c_str());
+  if (!FLAGS_key_distribution.empty()) {
+    FLAGS_key_distribution_e =
+        StringToKeyDistribution(FLAGS_key_distribution.c_str());
+  }
+  if (!(FLAGS_zipfian_constant > 0 && FLAGS_zipfian_constant < 1)) {
+    fprintf(stderr, "--zipfian_constant must be in (0, 1)\n");
+    exit(1);
+  }
 
 #ifndef ROCKSDB_LITE
   std::unique_ptr<Env> custom_env_guard;
@@ -0,0 +1,370 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+//
+// Reads an I/O trace, recorded with an IOTracingEnv, and reports the latency
+// of each type of operation, the reads and writes of each file type and
+// caller with how sequential the reads were and how often the same bytes
+// were read again, and the slowest operations.
+//
+// Example:
+//   io_trace_analyzer --io_trace_path=/tmp/io_trace --top_k=20
+//     --access_pattern_output_path=/tmp/files.csv
+
+#include <cstdio>
+
+#ifndef GFLAGS
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <gflags/gflags.h>
+
+#define __STDC_FORMAT_MACROS
+#include <inttypes.h>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "db/filename.h"
+#include "rocksdb/env.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/histogram.h"
+#include "util/io_tracer.h"
+
+using GFLAGS::ParseCommandLineFlags;
+using GFLAGS::SetUsageMessage;
+
+DEFINE_string(io_trace_path, "", "The I/O trace to analyze.");
+DEFINE_int32(top_k, 10, "Number of slowest operations to list.");
+DEFINE_uint64(latency_outlier_threshold_us, 10000,
+              "Operations slower than this many microseconds are counted as "
+              "outliers for each file type and caller.");
+DEFINE_string(access_pattern_output_path, "",
+              "If set, write the reads and writes of every file to this file "
+              "as CSV.");
+
+namespace rocksdb {
+
+namespace {
+
+std::string FileTypeOf(const std::string& file_name) {
+  const size_t sep = file_name.find_last_of('/');
+  const std::string base =
+      sep == std::string::npos ? file_name : file_name.substr(sep + 1);
+  uint64_t number;
+  FileType type;
+  if (!ParseFileName(base, &number, &type)) {
+    return "other";
+  }
+  switch (type) {
+    case kTableFile:
+      return "sst";
+    case kLogFile:
+      return "wal";
+    case kDescriptorFile:
+      return "manifest";
+    case kInfoLogFile:
+      return "info_log";
+    default:
+      return "other";
+  }
+}
+
+bool IsRead(IOTraceOp op) {
+  return op == IOTraceOp::kRead || op == IOTraceOp::kMultiRead;
+}
+
+bool IsWrite(IOTraceOp op) {
+  return op == IOTraceOp::kAppend || op == IOTraceOp::kPositionedAppend;
+}
+
+// The byte ranges of a file that were read, merged
+class ReadRanges {
+ public:
+  void Add(uint64_t offset, uint64_t length) {
+    if (length == 0) {
+      return;
+    }
+    uint64_t begin = offset;
+    uint64_t end = offset + length;
+    auto it = ranges_.upper_bound(begin);
+    if (it != ranges_.begin()) {
+      auto prev = std::prev(it);
+      if (prev->second >= begin) {
+        begin = prev->first;
+        end = std::max(end, prev->second);
+        it = ranges_.erase(prev);
+      }
+    }
+    while (it != ranges_.end() && it->first <= end) {
+      end = std::max(end, it->second);
+      it = ranges_.erase(it);
+    }
+    ranges_[begin] = end;
+  }
+
+  uint64_t UniqueBytes() const {
+    uint64_t bytes = 0;
+    for (const auto& range : ranges_) {
+      bytes += range.second - range.first;
+    }
+    return bytes;
+  }
+
+ private:
+  // Begin to end of each range
+  std::map<uint64_t, uint64_t> ranges_;
+};
+
+struct FileStats {
+  std::string type;
+  uint64_t reads = 0;
+  uint64_t sequential_reads = 0;
+  uint64_t bytes_read = 0;
+  uint64_t writes = 0;
+  uint64_t bytes_written = 0;
+  uint64_t syncs = 0;
+  uint64_t next_read_offset = 0;
+  ReadRanges read_ranges;
+};
+
+// Reads, writes and latencies of a group of operations
+struct GroupStats {
+  uint64_t reads = 0;
+  uint64_t sequential_reads = 0;
+  uint64_t bytes_read = 0;
+  uint64_t unique_bytes_read = 0;
+  uint64_t writes = 0;
+  uint64_t bytes_written = 0;
+  uint64_t syncs = 0;
+  uint64_t failed = 0;
+  uint64_t outliers = 0;
+  HistogramImpl read_latency;
+  HistogramImpl write_latency;
+
+  void Add(const IOTraceRecord& record, bool sequential) {
+    if (!record.ok) {
+      failed++;
+    }
+    if (record.latency_nanos / 1000 > FLAGS_latency_outlier_threshold_us) {
+      outliers++;
+    }
+    if (IsRead(record.op)) {
+      reads++;
+      bytes_read += record.io_size;
+      if (sequential) {
+        sequential_reads++;
+      }
+      read_latency.Add(record.latency_nanos);
+    } else if (IsWrite(record.op)) {
+      writes++;
+      bytes_written += record.length;
+      write_latency.Add(record.latency_nanos);
+    } else if (record.op == IOTraceOp::kSync ||
+               record.op == IOTraceOp::kFsync ||
+               record.op == IOTraceOp::kRangeSync) {
+      syncs++;
+    }
+  }
+};
+
+double Percent(uint64_t part, uint64_t total) {
+  return total == 0 ? 0.0 : 100.0 * part / total;
+}
+
+void PrintGroups(const char* title,
+                 const std::map<std::string, GroupStats>& groups,
+                 bool with_unique_bytes) {
+  fprintf(stdout, "\n%s:\n", title);
+  fprintf(stdout,
+          "%-12s %10s %14s %8s %10s %10s %10s %10s %14s %10s %8s %8s %8s\n",
+          "", "reads", "bytes read", "seq", "avg read", "p99 read", "read amp",
+          "writes", "bytes written", "avg write", "syncs", "slow", "failed");
+  for (const auto& group : groups) {
+    const GroupStats& stats = group.second;
+    char read_amp[32] = "-";
+    if (with_unique_bytes && stats.unique_bytes_read > 0) {
+      snprintf(read_amp, sizeof(read_amp), "%.2f",
+               static_cast<double>(stats.bytes_read) /
+                   stats.unique_bytes_read);
+    }
+    fprintf(stdout,
+            "%-12s %10" PRIu64 " %14" PRIu64 " %7.1f%% %8.0fus %8.0fus "
+            "%10s %10" PRIu64 " %14" PRIu64 " %8.0fus %8" PRIu64 " %8" PRIu64
+            " %8" PRIu64 "\n",
+            group.first.c_str(), stats.reads, stats.bytes_read,
+            Percent(stats.sequential_reads, stats.reads),
+            stats.read_latency.Average() / 1000,
+            stats.read_latency.Percentile(99) / 1000, read_amp, stats.writes,
+            stats.bytes_written, stats.write_latency.Average() / 1000,
+            stats.syncs, stats.outliers, stats.failed);
+  }
+}
+
+int Run() {
+  if (FLAGS_io_trace_path.empty()) {
+    fprintf(stderr, "--io_trace_path is required\n");
+    return 1;
+  }
+
+  Env* env = Env::Default();
+  std::unique_ptr<TraceReader> trace_reader;
+  Status s =
+      NewFileTraceReader(env, EnvOptions(), FLAGS_io_trace_path, &trace_reader);
+  if (!s.ok()) {
+    fprintf(stderr, "Cannot open trace: %s\n", s.ToString().c_str());
+    return 1;
+  }
+  IOTraceReader reader(std::move(trace_reader));
+  s = reader.ReadHeader();
+  if (!s.ok()) {
+    fprintf(stderr, "%s\n", s.ToString().c_str());
+    return 1;
+  }
+
+  std::map<std::string, FileStats> files;
+  std::map<std::string, GroupStats> callers;
+  std::map<std::string, GroupStats> file_types;
+  std::map<std::string, HistogramImpl> op_latencies;
+  auto slower = [](const IOTraceRecord& a, const IOTraceRecord& b) {
+    return a.latency_nanos > b.latency_nanos;
+  };
+  // Min-heap of the slowest operations
+  std::priority_queue<IOTraceRecord, std::vector<IOTraceRecord>,
+                      decltype(slower)>
+      slowest(slower);
+
+  IOTraceRecord record;
+  uint64_t num_ops = 0;
+  uint64_t first_timestamp = 0;
+  uint64_t last_timestamp = 0;
+  while ((s = reader.ReadIOOp(&record)).ok()) {
+    if (num_ops == 0) {
+      first_timestamp = record.access_timestamp;
+    }
+    last_timestamp = std::max(last_timestamp, record.access_timestamp);
+    num_ops++;
+
+    FileStats& file = files[record.file_name];
+    if (file.type.empty()) {
+      file.type = FileTypeOf(record.file_name);
+    }
+    bool sequential = false;
+    if (IsRead(record.op)) {
+      sequential = file.reads > 0 && record.offset == file.next_read_offset;
+      file.reads++;
+      if (sequential) {
+        file.sequential_reads++;
+      }
+      file.bytes_read += record.io_size;
+      file.next_read_offset = record.offset + record.io_size;
+      file.read_ranges.Add(record.offset, record.io_size);
+    } else if (IsWrite(record.op)) {
+      file.writes++;
+      file.bytes_written += record.length;
+    } else if (record.op == IOTraceOp::kSync ||
+               record.op == IOTraceOp::kFsync ||
+               record.op == IOTraceOp::kRangeSync) {
+      file.syncs++;
+    }
+
+    op_latencies[IOTraceOpToString(record.op)].Add(record.latency_nanos);
+    callers[IOCallerToString(record.caller)].Add(record, sequential);
+    file_types[file.type].Add(record, sequential);
+
+    if (FLAGS_top_k > 0) {
+      if (slowest.size() < static_cast<size_t>(FLAGS_top_k)) {
+        slowest.push(record);
+      } else if (record.latency_nanos > slowest.top().latency_nanos) {
+        slowest.pop();
+        slowest.push(record);
+      }
+    }
+  }
+  if (!s.IsIncomplete()) {
+    fprintf(stderr, "Error after %" PRIu64 " operations: %s\n", num_ops,
+            s.ToString().c_str());
+    return 1;
+  }
+  for (const auto& file : files) {
+    file_types[file.second.type].unique_bytes_read +=
+        file.second.read_ranges.UniqueBytes();
+  }
+
+  fprintf(stdout, "Read %" PRIu64 " operations on %" PRIu64
+                  " files over %" PRIu64 " seconds\n",
+          num_ops, static_cast<uint64_t>(files.size()),
+          (last_timestamp - first_timestamp) / 1000000);
+
+  fprintf(stdout, "\nLatency by operation, in microseconds:\n");
+  fprintf(stdout, "%-18s %10s %10s %10s %10s %10s %10s\n", "", "count", "avg",
+          "p50", "p99", "p99.9", "max");
+  for (const auto& op : op_latencies) {
+    const HistogramImpl& hist = op.second;
+    fprintf(stdout,
+            "%-18s %10" PRIu64 " %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+            op.first.c_str(), hist.num(), hist.Average() / 1000, hist.Median() / 1000,
+            hist.Percentile(99) / 1000, hist.Percentile(99.9) / 1000,
+            hist.max() / 1000.0);
+  }
+
+  PrintGroups("By file type (read amp is bytes read over distinct bytes read)",
+              file_types, true /* with_unique_bytes */);
+  PrintGroups("By caller", callers, false /* with_unique_bytes */);
+
+  std::vector<IOTraceRecord> top;
+  while (!slowest.empty()) {
+    top.push_back(slowest.top());
+    slowest.pop();
+  }
+  std::reverse(top.begin(), top.end());
+  fprintf(stdout, "\nSlowest operations:\n");
+  for (const auto& op : top) {
+    fprintf(stdout,
+            "%12.1fus %-18s %-10s %s offset %" PRIu64 " length %" PRIu64
+            " at %" PRIu64 "%s\n",
+            op.latency_nanos / 1000.0, IOTraceOpToString(op.op),
+            IOCallerToString(op.caller), op.file_name.c_str(), op.offset,
+            op.length, op.access_timestamp, op.ok ? "" : " (failed)");
+  }
+
+  if (!FLAGS_access_pattern_output_path.empty()) {
+    std::ostringstream csv;
+    csv << "file,type,reads,sequential_reads,bytes_read,unique_bytes_read,"
+           "writes,bytes_written,syncs\n";
+    for (const auto& file : files) {
+      const FileStats& stats = file.second;
+      csv << file.first << "," << stats.type << "," << stats.reads << ","
+          << stats.sequential_reads << "," << stats.bytes_read << ","
+          << stats.read_ranges.UniqueBytes() << "," << stats.writes << ","
+          << stats.bytes_written << "," << stats.syncs << "\n";
+    }
+    s = WriteStringToFile(env, csv.str(), FLAGS_access_pattern_output_path);
+    if (!s.ok()) {
+      fprintf(stderr, "%s\n", s.ToString().c_str());
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " --io_trace_path=<path> [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+  return rocksdb::Run();
+}
+
+#endif  // GFLAGS
@@ -8,8 +8,10 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <assert.h>
 #include <algorithm>
 #include "port/port.h"
+#include "util/aligned_buffer_pool.h"
 
 namespace rocksdb {
 
@@ -26,31 +28,60 @@ inline size_t Roundup(size_t x, size_t y) {
 // This class is to manage an aligned user
 // allocated buffer for direct I/O purposes
 // though can be used for any purpose.
+// If a pool is given, the memory is taken from and given back to the pool
+// instead of being allocated for every buffer.
 class AlignedBuffer {
   size_t alignment_;
   std::unique_ptr<char[]> buf_;
   size_t capacity_;
   size_t cursize_;
   char* bufstart_;
+  AlignedBufferPool* pool_;
+  AlignedBufferPool::Chunk chunk_;
 
 public:
   AlignedBuffer()
     : alignment_(),
       capacity_(0),
       cursize_(0),
-      bufstart_(nullptr) {
+      bufstart_(nullptr),
+      pool_(nullptr) {
   }
 
-  AlignedBuffer(AlignedBuffer&& o) ROCKSDB_NOEXCEPT {
+  explicit AlignedBuffer(AlignedBufferPool* pool)
+    : alignment_(),
+      capacity_(0),
+      cursize_(0),
+      bufstart_(nullptr),
+      pool_(pool) {
+  }
+
+  ~AlignedBuffer() {
+    if (pool_ != nullptr) {
+      pool_->Release(chunk_);
+    }
+  }
+
+  AlignedBuffer(AlignedBuffer&& o) ROCKSDB_NOEXCEPT : pool_(nullptr) {
     *this = std::move(o);
   }
 
   AlignedBuffer& operator=(AlignedBuffer&& o) ROCKSDB_NOEXCEPT {
+    if (pool_ != nullptr) {
+      pool_->Release(chunk_);
+    }
     alignment_ = std::move(o.alignment_);
     buf_ = std::move(o.buf_);
     capacity_ = std::move(o.capacity_);
     cursize_ = std::move(o.cursize_);
     bufstart_ = std::move(o.bufstart_);
+    pool_ = o.pool_;
+    chunk_ = o.chunk_;
+    o.pool_ = nullptr;
+    o.chunk_ = AlignedBufferPool::Chunk();
+    o.bufstart_ = nullptr;
+    o.capacity_ = 0;
+    o.cursize_ = 0;
     return *this;
   }
 
@@ -101,15 +132,32 @@ public:
     assert((alignment_ & (alignment_ - 1)) == 0);
 
     size_t size = Roundup(requestedCapacity, alignment_);
-    buf_.reset(new char[size + alignment_]);
-
-    char* p = buf_.get();
-    bufstart_ = reinterpret_cast<char*>(
-      (reinterpret_cast<uintptr_t>(p)+(alignment_ - 1)) &
-      ~static_cast<uintptr_t>(alignment_ - 1));
+    if (pool_ != nullptr) {
+      pool_->Release(chunk_);
+      chunk_ = pool_->Acquire(alignment_, size);
+      bufstart_ = chunk_.aligned;
+    } else {
+      buf_.reset(new char[size + alignment_]);
+
+      char* p = buf_.get();
+      bufstart_ = reinterpret_cast<char*>(
+        (reinterpret_cast<uintptr_t>(p)+(alignment_ - 1)) &
+        ~static_cast<uintptr_t>(alignment_ - 1));
+    }
     capacity_ = size;
     cursize_ = 0;
   }
+
+  // Gives up the ownership of the underlying allocation, which BufferStart()
+  // points into, to the caller. The buffer is left empty.
+  // REQUIRES: the buffer does not come from a pool
+  std::unique_ptr<char[]> Release() {
+    assert(pool_ == nullptr);
+    bufstart_ = nullptr;
+    capacity_ = 0;
+    cursize_ = 0;
+    return std::move(buf_);
+  }
   // Used for write
   // Returns the number of bytes appended
   size_t Append(const char* src, size_t append_size) {
@@ -0,0 +1,127 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/aligned_buffer_pool.h"
+#ifndef OS_WIN
+#include <sys/mman.h>
+#endif
+#include <assert.h>
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+// MSVC complains that it is already defined since it is static in the header.
+#ifndef OS_WIN
+const size_t AlignedBufferPool::kMaxPooledChunkSize;
+#endif
+
+namespace {
+const size_t kMinChunkSize = 4096;
+const size_t kDefaultPoolCachedBytes = 64 << 20;
+
+size_t RoundUpToPowerOfTwo(size_t n) {
+  size_t result = kMinChunkSize;
+  while (result < n) {
+    result <<= 1;
+  }
+  return result;
+}
+}  // namespace
+
+AlignedBufferPool::AlignedBufferPool(size_t max_cached_bytes,
+                                     size_t huge_page_size)
+    : max_cached_bytes_(max_cached_bytes),
+      huge_page_size_(huge_page_size),
+      cached_bytes_(0) {}
+
+AlignedBufferPool::~AlignedBufferPool() {
+  for (const auto& size_class : free_chunks_) {
+    for (const auto& chunk : size_class.second) {
+      Free(chunk);
+    }
+  }
+}
+
+AlignedBufferPool::Chunk AlignedBufferPool::Acquire(size_t alignment,
+                                                    size_t size) {
+  assert(alignment > 0);
+  assert((alignment & (alignment - 1)) == 0);
+  const size_t capacity = RoundUpToPowerOfTwo(size);
+  if (capacity <= kMaxPooledChunkSize) {
+    MutexLock l(&mutex_);
+    auto iter = free_chunks_.find(std::make_pair(capacity, alignment));
+    if (iter != free_chunks_.end() && !iter->second.empty()) {
+      Chunk chunk = iter->second.back();
+      iter->second.pop_back();
+      cached_bytes_ -= chunk.capacity;
+      return chunk;
+    }
+  }
+
+  Chunk chunk;
+  chunk.capacity = capacity;
+  chunk.alignment = alignment;
+#ifdef MAP_HUGETLB
+  if (huge_page_size_ > 0 && capacity >= huge_page_size_ &&
+      alignment <= huge_page_size_) {
+    size_t length =
+        ((capacity - 1) / huge_page_size_ + 1) * huge_page_size_;
+    void* addr = mmap(nullptr, length, (PROT_READ | PROT_WRITE),
+                      (MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB), -1, 0);
+    if (addr != MAP_FAILED) {
+      chunk.addr = chunk.aligned = reinterpret_cast<char*>(addr);
+      chunk.mmap_length = length;
+      return chunk;
+    }
+    // fall back to the heap
+  }
+#endif
+  chunk.addr = new char[capacity + alignment];
+  chunk.aligned = reinterpret_cast<char*>(
+      (reinterpret_cast<uintptr_t>(chunk.addr) + (alignment - 1)) &
+      ~static_cast<uintptr_t>(alignment - 1));
+  return chunk;
+}
+
+void AlignedBufferPool::Release(const Chunk& chunk) {
+  if (chunk.addr == nullptr) {
+    return;
+  }
+  if (chunk.capacity <= kMaxPooledChunkSize) {
+    MutexLock l(&mutex_);
+    if (cached_bytes_ + chunk.capacity <= max_cached_bytes_) {
+      free_chunks_[std::make_pair(chunk.capacity, chunk.alignment)].push_back(
+          chunk);
+      cached_bytes_ += chunk.capacity;
+      return;
+    }
+  }
+  Free(chunk);
+}
+
+size_t AlignedBufferPool::GetCachedBytes() const {
+  MutexLock l(&mutex_);
+  return cached_bytes_;
+}
+
+AlignedBufferPool* AlignedBufferPool::Default() {
+  // Never destroyed so that buffers released during static destruction
+  // still have a pool to go back to.
+  static AlignedBufferPool* pool =
+      new AlignedBufferPool(kDefaultPoolCachedBytes);
+  return pool;
+}
+
+void AlignedBufferPool::Free(const Chunk& chunk) {
+#ifdef MAP_HUGETLB
+  if (chunk.mmap_length > 0) {
+    munmap(chunk.addr, chunk.mmap_length);
+    return;
+  }
+#endif
+  delete[] chunk.addr;
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,76 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <map>
+#include <utility>
+#include <vector>
+#include "port/port.h"
+
+namespace rocksdb {
+
+// AlignedBufferPool keeps aligned buffers around after they are released so
+// that the next direct I/O read or write of a similar size can reuse one
+// instead of allocating (and faulting in) a fresh buffer. Buffers are kept
+// in power of two size classes and the memory held for reuse is bounded.
+//
+// If huge_page_size is not 0, buffers of at least that size are allocated
+// from huge pages when the platform supports it, falling back to the heap
+// otherwise.
+//
+// Thread-safe.
+class AlignedBufferPool {
+ public:
+  // A piece of memory handed out by the pool
+  struct Chunk {
+    // Start of the underlying allocation
+    char* addr = nullptr;
+    // First byte aligned to `alignment`
+    char* aligned = nullptr;
+    // Number of usable bytes starting at `aligned`
+    size_t capacity = 0;
+    size_t alignment = 0;
+    // Length of the mapping if the chunk comes from huge pages, 0 otherwise
+    size_t mmap_length = 0;
+  };
+
+  // Buffers larger than this are never kept for reuse
+  static const size_t kMaxPooledChunkSize = 4 << 20;
+
+  explicit AlignedBufferPool(size_t max_cached_bytes,
+                             size_t huge_page_size = 0);
+  ~AlignedBufferPool();
+
+  AlignedBufferPool(const AlignedBufferPool&) = delete;
+  AlignedBufferPool& operator=(const AlignedBufferPool&) = delete;
+
+  // Returns a chunk of at least `size` bytes aligned to `alignment`, which
+  // must be a power of two.
+  Chunk Acquire(size_t alignment, size_t size);
+
+  // Gives back a chunk returned by Acquire(). It is either kept for reuse or
+  // freed.
+  void Release(const Chunk& chunk);
+
+  // Memory currently kept for reuse
+  size_t GetCachedBytes() const;
+
+  // The pool shared by the file readers and writers of the process
+  static AlignedBufferPool* Default();
+
+ private:
+  static void Free(const Chunk& chunk);
+
+  const size_t max_cached_bytes_;
+  const size_t huge_page_size_;
+
+  mutable port::Mutex mutex_;
+  size_t cached_bytes_;
+  // (capacity, alignment) -> chunks ready for reuse
+  std::map<std::pair<size_t, size_t>, std::vector<Chunk>> free_chunks_;
+};
+
+}  // namespace rocksdb
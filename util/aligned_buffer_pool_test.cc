@@ -0,0 +1,94 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/aligned_buffer.h"
+#include "util/aligned_buffer_pool.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class AlignedBufferPoolTest : public testing::Test {};
+
+TEST_F(AlignedBufferPoolTest, ReuseChunk) {
+  AlignedBufferPool pool(1 << 20);
+  AlignedBufferPool::Chunk chunk = pool.Acquire(4096, 10000);
+  ASSERT_TRUE(AlignedBuffer::isAligned(chunk.aligned, 4096));
+  ASSERT_GE(chunk.capacity, 10000U);
+  char* aligned = chunk.aligned;
+  pool.Release(chunk);
+  ASSERT_EQ(chunk.capacity, pool.GetCachedBytes());
+
+  // Same size class and alignment get the same memory back
+  chunk = pool.Acquire(4096, 9000);
+  ASSERT_EQ(aligned, chunk.aligned);
+  ASSERT_EQ(0U, pool.GetCachedBytes());
+
+  // A different alignment does not
+  AlignedBufferPool::Chunk other = pool.Acquire(512, 9000);
+  ASSERT_TRUE(AlignedBuffer::isAligned(other.aligned, 512));
+  ASSERT_NE(aligned, other.aligned);
+  pool.Release(other);
+  pool.Release(chunk);
+}
+
+TEST_F(AlignedBufferPoolTest, CachedBytesBounded) {
+  const size_t kMaxCached = 64 * 1024;
+  AlignedBufferPool pool(kMaxCached);
+  std::vector<AlignedBufferPool::Chunk> chunks;
+  for (int i = 0; i < 10; i++) {
+    chunks.push_back(pool.Acquire(4096, 16 * 1024));
+  }
+  for (const auto& chunk : chunks) {
+    pool.Release(chunk);
+  }
+  ASSERT_EQ(kMaxCached, pool.GetCachedBytes());
+
+  // Too large to be kept around
+  pool.Release(pool.Acquire(4096, AlignedBufferPool::kMaxPooledChunkSize + 1));
+  ASSERT_EQ(kMaxCached, pool.GetCachedBytes());
+}
+
+TEST_F(AlignedBufferPoolTest, HugePage) {
+  // Falls back to the heap when no huge page is available
+  const size_t kHugePageSize = 2 * 1024 * 1024;
+  AlignedBufferPool pool(8 * kHugePageSize, kHugePageSize);
+  AlignedBufferPool::Chunk chunk = pool.Acquire(4096, kHugePageSize);
+  ASSERT_TRUE(AlignedBuffer::isAligned(chunk.aligned, 4096));
+  ASSERT_GE(chunk.capacity, kHugePageSize);
+  memset(chunk.aligned, 'a', chunk.capacity);
+  pool.Release(chunk);
+  ASSERT_EQ(chunk.capacity, pool.GetCachedBytes());
+}
+
+TEST_F(AlignedBufferPoolTest, AlignedBufferUsesPool) {
+  AlignedBufferPool pool(1 << 20);
+  char* start;
+  {
+    AlignedBuffer buf(&pool);
+    buf.Alignment(4096);
+    buf.AllocateNewBuffer(8192);
+    start = buf.BufferStart();
+    ASSERT_EQ(8192U, buf.Capacity());
+    ASSERT_EQ(3U, buf.Append("abc", 3));
+
+    // Moving the buffer does not give the memory back
+    AlignedBuffer moved(std::move(buf));
+    ASSERT_EQ(start, moved.BufferStart());
+    ASSERT_EQ(0U, pool.GetCachedBytes());
+  }
+  ASSERT_EQ(8192U, pool.GetCachedBytes());
+
+  AlignedBuffer buf(&pool);
+  buf.Alignment(4096);
+  buf.AllocateNewBuffer(5000);
+  ASSERT_EQ(start, buf.BufferStart());
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
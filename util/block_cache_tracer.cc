@@ -0,0 +1,183 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/block_cache_tracer.h"
+
+#include <thread>
+
+#include "util/coding.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+namespace {
+const char kFlagCacheHit = 0x1;
+const char kFlagNoInsert = 0x2;
+}  // namespace
+
+void EncodeBlockCacheTraceRecord(const BlockCacheTraceRecord& record,
+                                 std::string* dst) {
+  PutFixed64(dst, record.access_timestamp);
+  PutLengthPrefixedSlice(dst, record.block_key);
+  dst->push_back(static_cast<char>(record.block_type));
+  dst->push_back(static_cast<char>(record.caller));
+  char flags = 0;
+  if (record.is_cache_hit) {
+    flags |= kFlagCacheHit;
+  }
+  if (record.no_insert) {
+    flags |= kFlagNoInsert;
+  }
+  dst->push_back(flags);
+  PutVarint64(dst, record.block_size);
+  PutVarint32(dst, record.cf_id);
+  PutVarint32(dst, static_cast<uint32_t>(record.level + 1));
+}
+
+Status DecodeBlockCacheTraceRecord(const Slice& input,
+                                   BlockCacheTraceRecord* record) {
+  Slice in = input;
+  Slice block_key;
+  if (in.size() < sizeof(uint64_t)) {
+    return Status::Corruption("Truncated block cache trace record");
+  }
+  record->access_timestamp = DecodeFixed64(in.data());
+  in.remove_prefix(sizeof(uint64_t));
+  if (!GetLengthPrefixedSlice(&in, &block_key) || in.size() < 3) {
+    return Status::Corruption("Truncated block cache trace record");
+  }
+  record->block_key.assign(block_key.data(), block_key.size());
+  const unsigned char block_type = static_cast<unsigned char>(in[0]);
+  const unsigned char caller = static_cast<unsigned char>(in[1]);
+  const char flags = in[2];
+  in.remove_prefix(3);
+  if (block_type >=
+          static_cast<unsigned char>(TraceBlockType::kNumBlockTypes) ||
+      caller >= static_cast<unsigned char>(TableReaderCaller::kNumCallers)) {
+    return Status::Corruption("Unknown block type or caller in block cache "
+                              "trace record");
+  }
+  record->block_type = static_cast<TraceBlockType>(block_type);
+  record->caller = static_cast<TableReaderCaller>(caller);
+  record->is_cache_hit = (flags & kFlagCacheHit) != 0;
+  record->no_insert = (flags & kFlagNoInsert) != 0;
+  uint32_t level_plus_one;
+  if (!GetVarint64(&in, &record->block_size) ||
+      !GetVarint32(&in, &record->cf_id) ||
+      !GetVarint32(&in, &level_plus_one)) {
+    return Status::Corruption("Truncated block cache trace record");
+  }
+  record->level = static_cast<int>(level_plus_one) - 1;
+  return Status::OK();
+}
+
+BlockCacheTracerImpl::BlockCacheTracerImpl()
+    : tracing_(false),
+      sampling_frequency_(1),
+      trace_writer_(nullptr),
+      trace_writer_users_(0) {}
+
+BlockCacheTracerImpl::~BlockCacheTracerImpl() { EndTrace(); }
+
+Status BlockCacheTracerImpl::StartTrace(
+    const BlockCacheTraceOptions& options,
+    std::unique_ptr<TraceWriter>&& trace_writer) {
+  MutexLock l(&mutex_);
+  if (tracing_.load(std::memory_order_relaxed)) {
+    return Status::Busy("Block cache trace already running");
+  }
+  // A trace that stopped by itself still has its writer
+  EndTraceLocked();
+  std::string header;
+  PutFixed32(&header, kBlockCacheTraceMagicNumber);
+  PutFixed32(&header, kBlockCacheTraceFormatVersion);
+  Status s = trace_writer->Write(header);
+  if (!s.ok()) {
+    return s;
+  }
+  trace_writer_.store(new ConcurrentTraceWriter(std::move(trace_writer),
+                                                options.max_trace_file_size));
+  sampling_frequency_.store(
+      options.sampling_frequency == 0 ? 1 : options.sampling_frequency,
+      std::memory_order_relaxed);
+  tracing_.store(true, std::memory_order_release);
+  return s;
+}
+
+Status BlockCacheTracerImpl::EndTrace() {
+  MutexLock l(&mutex_);
+  return EndTraceLocked();
+}
+
+Status BlockCacheTracerImpl::EndTraceLocked() {
+  mutex_.AssertHeld();
+  tracing_.store(false, std::memory_order_release);
+  std::unique_ptr<ConcurrentTraceWriter> trace_writer(
+      trace_writer_.exchange(nullptr));
+  if (trace_writer == nullptr) {
+    return Status::OK();
+  }
+  // Lookups that found the writer before it was cleared may still be
+  // writing to it
+  while (trace_writer_users_.load() != 0) {
+    std::this_thread::yield();
+  }
+  return trace_writer->Close(std::string() /* last_record */);
+}
+
+void BlockCacheTracerImpl::WriteBlockAccess(
+    const BlockCacheTraceRecord& record) {
+  const uint64_t sampling_frequency =
+      sampling_frequency_.load(std::memory_order_relaxed);
+  if (sampling_frequency > 1 &&
+      GetSliceHash(record.block_key) % sampling_frequency != 0) {
+    return;
+  }
+  std::string data;
+  EncodeBlockCacheTraceRecord(record, &data);
+
+  // Announce the use before looking at the writer, so that EndTrace()
+  // either waits for it or is seen to have cleared the writer
+  trace_writer_users_.fetch_add(1);
+  ConcurrentTraceWriter* trace_writer = trace_writer_.load();
+  // A trace that cannot be written any more is of no use; stop tracing
+  // rather than fail the lookups.
+  if (trace_writer != nullptr && !trace_writer->Write(std::move(data)).ok()) {
+    tracing_.store(false, std::memory_order_release);
+  }
+  trace_writer_users_.fetch_sub(1);
+}
+
+Status BlockCacheTraceReader::ReadHeader() {
+  Status s = trace_reader_->Read(&buffer_);
+  if (!s.ok()) {
+    return s.IsIncomplete() ? Status::Corruption("Empty block cache trace")
+                            : s;
+  }
+  if (buffer_.size() != 2 * sizeof(uint32_t) ||
+      DecodeFixed32(buffer_.data()) != kBlockCacheTraceMagicNumber) {
+    return Status::Corruption("Not a block cache trace");
+  }
+  if (DecodeFixed32(buffer_.data() + sizeof(uint32_t)) >
+      kBlockCacheTraceFormatVersion) {
+    return Status::NotSupported("Block cache trace has a newer format");
+  }
+  return Status::OK();
+}
+
+Status BlockCacheTraceReader::ReadAccess(BlockCacheTraceRecord* record) {
+  Status s = trace_reader_->Read(&buffer_);
+  if (!s.ok()) {
+    return s;
+  }
+  return DecodeBlockCacheTraceRecord(buffer_, record);
+}
+
+std::shared_ptr<BlockCacheTracer> NewBlockCacheTracer() {
+  return std::make_shared<BlockCacheTracerImpl>();
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,89 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include "port/port.h"
+#include "rocksdb/block_cache_tracer.h"
+#include "rocksdb/slice.h"
+#include "util/trace_replay.h"
+
+namespace rocksdb {
+
+// A block cache trace is a sequence of TraceWriter records. The first one is
+// a header:
+//   magic number: fixed32
+//   format version: fixed32
+// Every other record is one lookup:
+//   access timestamp: fixed64
+//   block key: varint32 length followed by the key
+//   block type: char
+//   caller: char
+//   flags, bit 0 for a hit and bit 1 for no insert: char
+//   block size: varint64
+//   column family id: varint32
+//   level plus one: varint32
+const uint32_t kBlockCacheTraceMagicNumber = 0x42435452;  // "BCTR"
+const uint32_t kBlockCacheTraceFormatVersion = 1;
+
+extern void EncodeBlockCacheTraceRecord(const BlockCacheTraceRecord& record,
+                                        std::string* dst);
+extern Status DecodeBlockCacheTraceRecord(const Slice& input,
+                                          BlockCacheTraceRecord* record);
+
+class BlockCacheTracerImpl : public BlockCacheTracer {
+ public:
+  BlockCacheTracerImpl();
+  ~BlockCacheTracerImpl();
+
+  Status StartTrace(const BlockCacheTraceOptions& options,
+                    std::unique_ptr<TraceWriter>&& trace_writer) override;
+  Status EndTrace() override;
+
+  bool IsTracing() const override {
+    return tracing_.load(std::memory_order_relaxed);
+  }
+
+  // Lookups traced concurrently do not wait for each other, see
+  // ConcurrentTraceWriter
+  void WriteBlockAccess(const BlockCacheTraceRecord& record) override;
+
+ private:
+  // REQUIRES: mutex_ held
+  Status EndTraceLocked();
+
+  std::atomic<bool> tracing_;
+  std::atomic<uint64_t> sampling_frequency_;
+  // Serializes StartTrace() and EndTrace()
+  port::Mutex mutex_;
+  // Set while tracing. WriteBlockAccess() uses it without taking mutex_,
+  // counting itself in trace_writer_users_ so that EndTrace() can wait for
+  // it before deleting the writer.
+  std::atomic<ConcurrentTraceWriter*> trace_writer_;
+  std::atomic<uint32_t> trace_writer_users_;
+};
+
+// Reads back a trace written by BlockCacheTracerImpl
+class BlockCacheTraceReader {
+ public:
+  explicit BlockCacheTraceReader(std::unique_ptr<TraceReader>&& trace_reader)
+      : trace_reader_(std::move(trace_reader)) {}
+
+  // Must be called first. Returns Corruption if the trace is not a block
+  // cache trace or NotSupported if it has a newer format.
+  Status ReadHeader();
+
+  // Returns Incomplete once all the lookups have been read
+  Status ReadAccess(BlockCacheTraceRecord* record);
+
+ private:
+  std::unique_ptr<TraceReader> trace_reader_;
+  std::string buffer_;
+};
+
+}  // namespace rocksdb
@@ -0,0 +1,233 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/block_cache_tracer.h"
+
+#include <deque>
+#include <map>
+#include <vector>
+#include "port/port.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Keeps the records in memory, shared with the reader below
+class StringTraceWriter : public TraceWriter {
+ public:
+  explicit StringTraceWriter(std::deque<std::string>* records)
+      : records_(records), size_(0), closed_(false) {}
+
+  Status Write(const Slice& data) override {
+    if (closed_) {
+      return Status::IOError("closed");
+    }
+    records_->push_back(data.ToString());
+    size_ += data.size();
+    return Status::OK();
+  }
+  Status Close() override {
+    closed_ = true;
+    return Status::OK();
+  }
+  uint64_t GetFileSize() override { return size_; }
+
+ private:
+  std::deque<std::string>* records_;
+  uint64_t size_;
+  bool closed_;
+};
+
+class StringTraceReader : public TraceReader {
+ public:
+  explicit StringTraceReader(std::deque<std::string>* records)
+      : records_(records) {}
+
+  Status Read(std::string* data) override {
+    if (records_->empty()) {
+      return Status::Incomplete();
+    }
+    *data = records_->front();
+    records_->pop_front();
+    return Status::OK();
+  }
+  Status Close() override { return Status::OK(); }
+
+ private:
+  std::deque<std::string>* records_;
+};
+
+BlockCacheTraceRecord MakeRecord(int i) {
+  BlockCacheTraceRecord record;
+  record.access_timestamp = 1000 + i;
+  record.block_key = "block" + ToString(i);
+  record.block_type = static_cast<TraceBlockType>(
+      i % static_cast<int>(TraceBlockType::kNumBlockTypes));
+  record.block_size = 4096 + i;
+  record.cf_id = i % 3;
+  record.level = i % 8 - 1;
+  record.caller = static_cast<TableReaderCaller>(
+      i % static_cast<int>(TableReaderCaller::kNumCallers));
+  record.is_cache_hit = i % 2 == 0;
+  record.no_insert = i % 3 == 0;
+  return record;
+}
+
+}  // namespace
+
+class BlockCacheTracerTest : public testing::Test {
+ protected:
+  std::unique_ptr<TraceWriter> NewWriter() {
+    return std::unique_ptr<TraceWriter>(new StringTraceWriter(&records_));
+  }
+
+  std::unique_ptr<BlockCacheTraceReader> NewReader() {
+    return std::unique_ptr<BlockCacheTraceReader>(new BlockCacheTraceReader(
+        std::unique_ptr<TraceReader>(new StringTraceReader(&records_))));
+  }
+
+  std::deque<std::string> records_;
+};
+
+TEST_F(BlockCacheTracerTest, RoundTrip) {
+  auto tracer = NewBlockCacheTracer();
+  ASSERT_FALSE(tracer->IsTracing());
+  // Nothing is written before the trace starts
+  tracer->WriteBlockAccess(MakeRecord(100));
+
+  ASSERT_OK(tracer->StartTrace(BlockCacheTraceOptions(), NewWriter()));
+  ASSERT_TRUE(tracer->IsTracing());
+  ASSERT_TRUE(
+      tracer->StartTrace(BlockCacheTraceOptions(), NewWriter()).IsBusy());
+  for (int i = 0; i < 20; i++) {
+    tracer->WriteBlockAccess(MakeRecord(i));
+  }
+  ASSERT_OK(tracer->EndTrace());
+  ASSERT_FALSE(tracer->IsTracing());
+  tracer->WriteBlockAccess(MakeRecord(101));
+
+  auto reader = NewReader();
+  ASSERT_OK(reader->ReadHeader());
+  for (int i = 0; i < 20; i++) {
+    BlockCacheTraceRecord expected = MakeRecord(i);
+    BlockCacheTraceRecord record;
+    ASSERT_OK(reader->ReadAccess(&record));
+    ASSERT_EQ(expected.access_timestamp, record.access_timestamp);
+    ASSERT_EQ(expected.block_key, record.block_key);
+    ASSERT_EQ(expected.block_type, record.block_type);
+    ASSERT_EQ(expected.block_size, record.block_size);
+    ASSERT_EQ(expected.cf_id, record.cf_id);
+    ASSERT_EQ(expected.level, record.level);
+    ASSERT_EQ(expected.caller, record.caller);
+    ASSERT_EQ(expected.is_cache_hit, record.is_cache_hit);
+    ASSERT_EQ(expected.no_insert, record.no_insert);
+  }
+  BlockCacheTraceRecord record;
+  ASSERT_TRUE(reader->ReadAccess(&record).IsIncomplete());
+}
+
+TEST_F(BlockCacheTracerTest, SamplesByKey) {
+  auto tracer = NewBlockCacheTracer();
+  BlockCacheTraceOptions options;
+  options.sampling_frequency = 4;
+  ASSERT_OK(tracer->StartTrace(options, NewWriter()));
+  // Every block is looked up twice
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < 1000; i++) {
+      tracer->WriteBlockAccess(MakeRecord(i));
+    }
+  }
+  ASSERT_OK(tracer->EndTrace());
+
+  auto reader = NewReader();
+  ASSERT_OK(reader->ReadHeader());
+  std::map<std::string, int> lookups;
+  BlockCacheTraceRecord record;
+  Status s;
+  while ((s = reader->ReadAccess(&record)).ok()) {
+    lookups[record.block_key]++;
+  }
+  ASSERT_TRUE(s.IsIncomplete());
+  // About a quarter of the blocks, each with all of its lookups
+  ASSERT_GT(lookups.size(), 150U);
+  ASSERT_LT(lookups.size(), 350U);
+  for (const auto& block : lookups) {
+    ASSERT_EQ(2, block.second);
+  }
+}
+
+TEST_F(BlockCacheTracerTest, StopsAtMaxTraceFileSize) {
+  auto tracer = NewBlockCacheTracer();
+  BlockCacheTraceOptions options;
+  options.max_trace_file_size = 1000;
+  ASSERT_OK(tracer->StartTrace(options, NewWriter()));
+  for (int i = 0; i < 1000 && tracer->IsTracing(); i++) {
+    tracer->WriteBlockAccess(MakeRecord(i));
+  }
+  ASSERT_FALSE(tracer->IsTracing());
+  ASSERT_LT(records_.size(), 100U);
+
+  // The tracer can be started again
+  ASSERT_OK(tracer->StartTrace(BlockCacheTraceOptions(), NewWriter()));
+  ASSERT_OK(tracer->EndTrace());
+}
+
+TEST_F(BlockCacheTracerTest, TracesManyThreads) {
+  const int kNumThreads = 4;
+  const int kNumLookups = 1000;
+  auto tracer = NewBlockCacheTracer();
+  ASSERT_OK(tracer->StartTrace(BlockCacheTraceOptions(), NewWriter()));
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumLookups; i++) {
+        tracer->WriteBlockAccess(MakeRecord(t * kNumLookups + i));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_OK(tracer->EndTrace());
+
+  // Every lookup is in the trace, in order for each thread
+  auto reader = NewReader();
+  ASSERT_OK(reader->ReadHeader());
+  std::vector<int> next_lookups(kNumThreads, 0);
+  BlockCacheTraceRecord record;
+  Status s;
+  while ((s = reader->ReadAccess(&record)).ok()) {
+    const int i = static_cast<int>(record.access_timestamp) - 1000;
+    ASSERT_EQ(next_lookups[i / kNumLookups]++, i % kNumLookups);
+  }
+  ASSERT_TRUE(s.IsIncomplete());
+  for (int lookups : next_lookups) {
+    ASSERT_EQ(kNumLookups, lookups);
+  }
+}
+
+TEST_F(BlockCacheTracerTest, RejectsOtherTraces) {
+  records_.push_back("not a block cache trace");
+  ASSERT_TRUE(NewReader()->ReadHeader().IsCorruption());
+  ASSERT_TRUE(NewReader()->ReadHeader().IsCorruption());
+
+  std::string record;
+  EncodeBlockCacheTraceRecord(MakeRecord(1), &record);
+  BlockCacheTraceRecord decoded;
+  ASSERT_OK(DecodeBlockCacheTraceRecord(record, &decoded));
+  ASSERT_TRUE(
+      DecodeBlockCacheTraceRecord(Slice(record.data(), record.size() - 1),
+                                  &decoded)
+          .IsCorruption());
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -12,9 +12,11 @@
 #include <algorithm>
 #include <limits>
 #include <string>
+#include <vector>
 
 #include "rocksdb/options.h"
 #include "util/coding.h"
+#include "util/compression_context_cache.h"
 
 #ifdef SNAPPY
 #include <snappy.h>
@@ -35,6 +37,9 @@
 
 #if defined(ZSTD)
 #include <zstd.h>
+#if ZSTD_VERSION_NUMBER >= 10103  // v1.1.3+
+#include <zdict.h>
+#endif  // ZSTD_VERSION_NUMBER >= 10103
 #endif
 
 #if defined(XPRESS)
@@ -86,6 +91,13 @@ inline bool ZSTD_Supported() {
   return false;
 }
 
+inline bool ZSTD_TrainDictionarySupported() {
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 10103  // v1.1.3+
+  return true;
+#endif
+  return false;
+}
+
 inline bool ZSTDNotFinal_Supported() {
 #ifdef ZSTD
   return true;
@@ -144,6 +156,94 @@ inline std::string CompressionTypeToString(CompressionType compression_type) {
   }
 }
 
+// A dictionary for presetting the compression library. ZSTD digests it once
+// here, when the table is built, instead of once per compressed block.
+// dict must outlive this object.
+class CompressionDict {
+ public:
+  CompressionDict() {}
+  CompressionDict(const Slice& dict, CompressionType type, int level)
+      : dict_(dict) {
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 700  // v0.7.0+
+    if (!dict.empty() && (type == kZSTD || type == kZSTDNotFinalCompression)) {
+      zstd_cdict_ = ZSTD_createCDict(dict.data(), dict.size(), level);
+    }
+#else
+    (void)type;
+    (void)level;
+#endif
+  }
+  ~CompressionDict() {
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 700
+    ZSTD_freeCDict(zstd_cdict_);
+#endif
+  }
+
+  const Slice& GetRawDict() const { return dict_; }
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 700
+  // nullptr if the dictionary is not digested for ZSTD
+  ZSTD_CDict* GetDigestedZstdCDict() const { return zstd_cdict_; }
+#endif
+
+  static const CompressionDict& GetEmptyDict() {
+    static CompressionDict empty_dict;
+    return empty_dict;
+  }
+
+ private:
+  Slice dict_;
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 700
+  ZSTD_CDict* zstd_cdict_ = nullptr;
+#endif
+
+  // No copying allowed
+  CompressionDict(const CompressionDict&) = delete;
+  void operator=(const CompressionDict&) = delete;
+};
+
+// The decompression side of CompressionDict. ZSTD digests it once, when the
+// table is opened, instead of once per block read. dict must outlive this
+// object.
+class UncompressionDict {
+ public:
+  UncompressionDict() {}
+  UncompressionDict(const Slice& dict, CompressionType type) : dict_(dict) {
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 700
+    if (!dict.empty() && (type == kZSTD || type == kZSTDNotFinalCompression)) {
+      zstd_ddict_ = ZSTD_createDDict(dict.data(), dict.size());
+    }
+#else
+    (void)type;
+#endif
+  }
+  ~UncompressionDict() {
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 700
+    ZSTD_freeDDict(zstd_ddict_);
+#endif
+  }
+
+  const Slice& GetRawDict() const { return dict_; }
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 700
+  // nullptr if the dictionary is not digested for ZSTD
+  ZSTD_DDict* GetDigestedZstdDDict() const { return zstd_ddict_; }
+#endif
+
+  static const UncompressionDict& GetEmptyDict() {
+    static UncompressionDict empty_dict;
+    return empty_dict;
+  }
+
+ private:
+  Slice dict_;
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 700
+  ZSTD_DDict* zstd_ddict_ = nullptr;
+#endif
+
+  // No copying allowed
+  UncompressionDict(const UncompressionDict&) = delete;
+  void operator=(const UncompressionDict&) = delete;
+};
+
 // compress_format_version can have two values:
 // 1 -- decompressed sizes for BZip2 and Zlib are not included in the compressed
 // block. Also, decompressed sizes for LZ4 are encoded in platform-dependent
@@ -721,11 +821,53 @@ inline char* XPRESS_Uncompress(const char* input_data, size_t input_length,
 }
 
 
+// Borrows the calling thread's cached ZSTD contexts for the lifetime of the
+// object
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 500  // v0.5.0+
+class ZSTDCompressionContext {
+ public:
+  ZSTDCompressionContext()
+      : ctx_(static_cast<ZSTD_CCtx*>(
+            CompressionContextCache::Instance()->GetZSTDCompressionContext())) {
+  }
+  ~ZSTDCompressionContext() {
+    CompressionContextCache::Instance()->ReturnZSTDCompressionContext(ctx_);
+  }
+  ZSTD_CCtx* get() const { return ctx_; }
+
+ private:
+  ZSTD_CCtx* const ctx_;
+
+  // No copying allowed
+  ZSTDCompressionContext(const ZSTDCompressionContext&) = delete;
+  void operator=(const ZSTDCompressionContext&) = delete;
+};
+
+class ZSTDUncompressionContext {
+ public:
+  ZSTDUncompressionContext()
+      : ctx_(static_cast<ZSTD_DCtx*>(CompressionContextCache::Instance()
+                                         ->GetZSTDUncompressionContext())) {}
+  ~ZSTDUncompressionContext() {
+    CompressionContextCache::Instance()->ReturnZSTDUncompressionContext(ctx_);
+  }
+  ZSTD_DCtx* get() const { return ctx_; }
+
+ private:
+  ZSTD_DCtx* const ctx_;
+
+  // No copying allowed
+  ZSTDUncompressionContext(const ZSTDUncompressionContext&) = delete;
+  void operator=(const ZSTDUncompressionContext&) = delete;
+};
+#endif  // ZSTD_VERSION_NUMBER >= 500
+
 // @param compression_dict Data for presetting the compression library's
-//    dictionary.
-inline bool ZSTD_Compress(const CompressionOptions& opts, const char* input,
-                          size_t length, ::std::string* output,
-                          const Slice& compression_dict = Slice()) {
+//    dictionary, digested once for all the blocks it compresses.
+inline bool ZSTD_Compress(
+    const CompressionOptions& opts, const char* input, size_t length,
+    ::std::string* output,
+    const CompressionDict& compression_dict = CompressionDict::GetEmptyDict()) {
 #ifdef ZSTD
   if (length > std::numeric_limits<uint32_t>::max()) {
     // Can't compress more than 4GB
@@ -739,11 +881,20 @@ inline bool ZSTD_Compress(const CompressionOptions& opts, const char* input,
   output->resize(static_cast<size_t>(output_header_len + compressBound));
   size_t outlen;
 #if ZSTD_VERSION_NUMBER >= 500  // v0.5.0+
-  ZSTD_CCtx* context = ZSTD_createCCtx();
-  outlen = ZSTD_compress_usingDict(
-      context, &(*output)[output_header_len], compressBound, input, length,
-      compression_dict.data(), compression_dict.size(), opts.level);
-  ZSTD_freeCCtx(context);
+  ZSTDCompressionContext context;
+#if ZSTD_VERSION_NUMBER >= 700  // v0.7.0+
+  if (compression_dict.GetDigestedZstdCDict() != nullptr) {
+    outlen = ZSTD_compress_usingCDict(
+        context.get(), &(*output)[output_header_len], compressBound, input,
+        length, compression_dict.GetDigestedZstdCDict());
+  } else
+#endif  // ZSTD_VERSION_NUMBER >= 700
+  {
+    const Slice& dict = compression_dict.GetRawDict();
+    outlen = ZSTD_compress_usingDict(
+        context.get(), &(*output)[output_header_len], compressBound, input,
+        length, dict.data(), dict.size(), opts.level);
+  }
 #else  // up to v0.4.x
   outlen = ZSTD_compress(&(*output)[output_header_len], compressBound, input,
                          length, opts.level);
@@ -758,10 +909,11 @@ inline bool ZSTD_Compress(const CompressionOptions& opts, const char* input,
 }
 
 // @param compression_dict Data for presetting the compression library's
-//    dictionary.
+//    dictionary, digested once for all the blocks it decompresses.
 inline char* ZSTD_Uncompress(const char* input_data, size_t input_length,
                              int* decompress_size,
-                             const Slice& compression_dict = Slice()) {
+                             const UncompressionDict& compression_dict =
+                                 UncompressionDict::GetEmptyDict()) {
 #ifdef ZSTD
   uint32_t output_len = 0;
   if (!compression::GetDecompressedSizeInfo(&input_data, &input_length,
@@ -772,11 +924,21 @@ inline char* ZSTD_Uncompress(const char* input_data, size_t input_length,
   char* output = new char[output_len];
   size_t actual_output_length;
 #if ZSTD_VERSION_NUMBER >= 500  // v0.5.0+
-  ZSTD_DCtx* context = ZSTD_createDCtx();
-  actual_output_length = ZSTD_decompress_usingDict(
-      context, output, output_len, input_data, input_length,
-      compression_dict.data(), compression_dict.size());
-  ZSTD_freeDCtx(context);
+  ZSTDUncompressionContext context;
+#if ZSTD_VERSION_NUMBER >= 700  // v0.7.0+
+  if (compression_dict.GetDigestedZstdDDict() != nullptr) {
+    actual_output_length = ZSTD_decompress_usingDDict(
+        context.get(), output, output_len, input_data, input_length,
+        compression_dict.GetDigestedZstdDDict());
+  } else
+#endif  // ZSTD_VERSION_NUMBER >= 700
+  {
+    const Slice& dict = compression_dict.GetRawDict();
+    actual_output_length =
+        ZSTD_decompress_usingDict(context.get(), output, output_len,
+                                  input_data, input_length, dict.data(),
+                                  dict.size());
+  }
 #else  // up to v0.4.x
   actual_output_length =
       ZSTD_decompress(output, output_len, input_data, input_length);
@@ -788,4 +950,47 @@ inline char* ZSTD_Uncompress(const char* input_data, size_t input_length,
   return nullptr;
 }
 
+// Trains a ZSTD dictionary of up to max_dict_bytes from samples, the
+// concatenation of samples of the lengths in sample_lens. Returns an empty
+// string if training fails, e.g. because there are too few samples, or is
+// not supported.
+inline std::string ZSTD_TrainDictionary(const std::string& samples,
+                                        const std::vector<size_t>& sample_lens,
+                                        size_t max_dict_bytes) {
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 10103  // v1.1.3+
+  if (samples.empty() || sample_lens.empty()) {
+    return "";
+  }
+  std::string dict_data(max_dict_bytes, '\0');
+  size_t dict_len = ZDICT_trainFromBuffer(
+      &dict_data[0], max_dict_bytes, samples.data(), sample_lens.data(),
+      static_cast<unsigned>(sample_lens.size()));
+  if (ZDICT_isError(dict_len)) {
+    return "";
+  }
+  assert(dict_len <= max_dict_bytes);
+  dict_data.resize(dict_len);
+  return dict_data;
+#else
+  (void)samples;
+  (void)sample_lens;
+  (void)max_dict_bytes;
+  return "";
+#endif  // ZSTD_VERSION_NUMBER >= 10103
+}
+
+// Same, for samples of 1 << sample_len_shift bytes each, but for the last
+// one that may be shorter
+inline std::string ZSTD_TrainDictionary(const std::string& samples,
+                                        size_t sample_len_shift,
+                                        size_t max_dict_bytes) {
+  const size_t sample_len = size_t{1} << sample_len_shift;
+  std::vector<size_t> sample_lens(samples.size() >> sample_len_shift,
+                                  sample_len);
+  if (samples.size() % sample_len != 0) {
+    sample_lens.push_back(samples.size() % sample_len);
+  }
+  return ZSTD_TrainDictionary(samples, sample_lens, max_dict_bytes);
+}
+
 }  // namespace rocksdb
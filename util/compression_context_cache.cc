@@ -0,0 +1,74 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/compression_context_cache.h"
+
+#ifdef ZSTD
+#include <zstd.h>
+#endif
+
+namespace rocksdb {
+
+namespace {
+
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 500  // v0.5.0+
+void FreeZSTDCompressionContext(void* ctx) {
+  ZSTD_freeCCtx(static_cast<ZSTD_CCtx*>(ctx));
+}
+
+void FreeZSTDUncompressionContext(void* ctx) {
+  ZSTD_freeDCtx(static_cast<ZSTD_DCtx*>(ctx));
+}
+#else
+void FreeZSTDCompressionContext(void* /*ctx*/) {}
+void FreeZSTDUncompressionContext(void* /*ctx*/) {}
+#endif
+
+}  // namespace
+
+CompressionContextCache* CompressionContextCache::Instance() {
+  // Never deleted: the threads of other static objects may still compress
+  // at exit
+  static CompressionContextCache* instance = new CompressionContextCache();
+  return instance;
+}
+
+CompressionContextCache::CompressionContextCache()
+    : zstd_cctx_(&FreeZSTDCompressionContext),
+      zstd_dctx_(&FreeZSTDUncompressionContext) {}
+
+void* CompressionContextCache::GetZSTDCompressionContext() {
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 500
+  void* ctx = zstd_cctx_.Swap(nullptr);
+  return ctx != nullptr ? ctx : ZSTD_createCCtx();
+#else
+  return nullptr;
+#endif
+}
+
+void CompressionContextCache::ReturnZSTDCompressionContext(void* ctx) {
+  void* expected = nullptr;
+  if (ctx != nullptr && !zstd_cctx_.CompareAndSwap(ctx, expected)) {
+    FreeZSTDCompressionContext(ctx);
+  }
+}
+
+void* CompressionContextCache::GetZSTDUncompressionContext() {
+#if defined(ZSTD) && ZSTD_VERSION_NUMBER >= 500
+  void* ctx = zstd_dctx_.Swap(nullptr);
+  return ctx != nullptr ? ctx : ZSTD_createDCtx();
+#else
+  return nullptr;
+#endif
+}
+
+void CompressionContextCache::ReturnZSTDUncompressionContext(void* ctx) {
+  void* expected = nullptr;
+  if (ctx != nullptr && !zstd_dctx_.CompareAndSwap(ctx, expected)) {
+    FreeZSTDUncompressionContext(ctx);
+  }
+}
+
+}  // namespace rocksdb
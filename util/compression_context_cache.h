@@ -0,0 +1,42 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include "util/thread_local.h"
+
+namespace rocksdb {
+
+// Keeps one ZSTD compression context and one decompression context per
+// thread, so that compressing or decompressing a block does not create and
+// free a context every time. The contexts are kept as void* so that this
+// header does not need zstd.h.
+class CompressionContextCache {
+ public:
+  static CompressionContextCache* Instance();
+
+  // Takes the calling thread's context, or creates one if the thread has
+  // none cached, e.g. because it is already using it. Returns nullptr if
+  // ZSTD is not supported.
+  void* GetZSTDCompressionContext();
+  // Caches ctx for the calling thread, or frees it if the thread already
+  // cached another one
+  void ReturnZSTDCompressionContext(void* ctx);
+
+  void* GetZSTDUncompressionContext();
+  void ReturnZSTDUncompressionContext(void* ctx);
+
+ private:
+  CompressionContextCache();
+
+  ThreadLocalPtr zstd_cctx_;
+  ThreadLocalPtr zstd_dctx_;
+
+  // No copying allowed
+  CompressionContextCache(const CompressionContextCache&) = delete;
+  void operator=(const CompressionContextCache&) = delete;
+};
+
+}  // namespace rocksdb
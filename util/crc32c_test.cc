@@ -8,6 +8,10 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include "util/crc32c.h"
+
+#include <algorithm>
+#include <string>
+#include "util/random.h"
 #include "util/testharness.h"
 
 namespace rocksdb {
@@ -61,6 +65,29 @@ TEST(CRC, Extend) {
             Extend(Value("hello ", 6), "world", 5));
 }
 
+TEST(CRC, LongBuffers) {
+  // Long buffers are checksummed in interleaved streams, the crc of short
+  // pieces of them is computed in a single stream
+  Random rnd(301);
+  std::string data;
+  for (int i = 0; i < 100000; i++) {
+    data.push_back(static_cast<char>(rnd.Uniform(256)));
+  }
+  for (size_t offset : {0, 1, 3, 8}) {
+    for (size_t size : {767, 768, 769, 4096, 12287, 12288, 12289, 13056,
+                        65536, 99990}) {
+      uint32_t expected = 0;
+      for (size_t i = 0; i < size; i += 7) {
+        expected = Extend(expected, data.data() + offset + i,
+                          std::min<size_t>(7, size - i));
+      }
+      ASSERT_EQ(expected, Value(data.data() + offset, size));
+      ASSERT_EQ(Extend(Value(data.data(), offset), data.data() + offset, size),
+                Value(data.data(), offset + size));
+    }
+  }
+}
+
 TEST(CRC, Mask) {
   uint32_t crc = Value("foo", 3);
   ASSERT_NE(crc, Mask(crc));
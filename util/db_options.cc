@@ -57,6 +57,12 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       allow_fallocate(options.allow_fallocate),
       is_fd_close_on_exec(options.is_fd_close_on_exec),
       stats_dump_period_sec(options.stats_dump_period_sec),
+      stats_persist_period_sec(options.stats_persist_period_sec),
+      stats_history_buffer_size(options.stats_history_buffer_size),
+      hot_blocks_persist_period_sec(options.hot_blocks_persist_period_sec),
+      max_persisted_hot_blocks(options.max_persisted_hot_blocks),
+      hot_blocks_warm_up_bytes_per_sec(
+          options.hot_blocks_warm_up_bytes_per_sec),
       advise_random_on_open(options.advise_random_on_open),
       db_write_buffer_size(options.db_write_buffer_size),
       write_buffer_manager(options.write_buffer_manager),
@@ -152,6 +158,19 @@ void ImmutableDBOptions::Dump(Logger* log) const {
          is_fd_close_on_exec);
   Header(log, "                  Options.stats_dump_period_sec: %u",
          stats_dump_period_sec);
+  Header(log, "               Options.stats_persist_period_sec: %u",
+         stats_persist_period_sec);
+  Header(log,
+         "              Options.stats_history_buffer_size: %" ROCKSDB_PRIszt,
+         stats_history_buffer_size);
+  Header(log, "          Options.hot_blocks_persist_period_sec: %u",
+         hot_blocks_persist_period_sec);
+  Header(log,
+         "               Options.max_persisted_hot_blocks: %" ROCKSDB_PRIszt,
+         max_persisted_hot_blocks);
+  Header(log,
+         "       Options.hot_blocks_warm_up_bytes_per_sec: %" PRIu64,
+         hot_blocks_warm_up_bytes_per_sec);
   Header(log, "                  Options.advise_random_on_open: %d",
          advise_random_on_open);
   Header(log,
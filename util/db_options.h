@@ -53,6 +53,11 @@ struct ImmutableDBOptions {
   bool allow_fallocate;
   bool is_fd_close_on_exec;
   unsigned int stats_dump_period_sec;
+  unsigned int stats_persist_period_sec;
+  size_t stats_history_buffer_size;
+  unsigned int hot_blocks_persist_period_sec;
+  size_t max_persisted_hot_blocks;
+  uint64_t hot_blocks_warm_up_bytes_per_sec;
   bool advise_random_on_open;
   size_t db_write_buffer_size;
   std::shared_ptr<WriteBufferManager> write_buffer_manager;
@@ -756,6 +756,48 @@ TEST_F(EnvPosixTest, RandomAccessUniqueID) {
   }
 }
 
+TEST_F(EnvPosixTest, MultiRead) {
+  EnvOptions soptions;
+  soptions.use_mmap_reads = false;
+  std::string fname = test::TmpDir(env_) + "/testfile_multiread";
+  const size_t kFileSize = 100 * 1024;
+  std::string data;
+  Random rnd(301);
+  test::RandomString(&rnd, kFileSize, &data);
+  unique_ptr<WritableFile> wfile;
+  ASSERT_OK(env_->NewWritableFile(fname, &wfile, soptions));
+  ASSERT_OK(wfile->Append(data));
+  ASSERT_OK(wfile->Close());
+
+  unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile(fname, &file, soptions));
+
+  // More requests than a single submission can hold, the last one
+  // crossing the end of the file.
+  const size_t kNumReqs = 150;
+  const size_t kReadSize = 1000;
+  std::vector<ReadRequest> reqs(kNumReqs);
+  std::vector<std::unique_ptr<char[]>> scratches(kNumReqs);
+  for (size_t i = 0; i < kNumReqs; ++i) {
+    scratches[i].reset(new char[kReadSize]);
+    reqs[i].offset = (i * 7919) % kFileSize;
+    reqs[i].len = kReadSize;
+    reqs[i].scratch = scratches[i].get();
+  }
+  reqs[kNumReqs - 1].offset = kFileSize - kReadSize / 2;
+  ASSERT_OK(file->MultiRead(reqs.data(), reqs.size()));
+  for (size_t i = 0; i < kNumReqs; ++i) {
+    ASSERT_OK(reqs[i].status);
+    size_t expected_size =
+        std::min(kReadSize, kFileSize - static_cast<size_t>(reqs[i].offset));
+    ASSERT_EQ(expected_size, reqs[i].result.size());
+    ASSERT_EQ(data.substr(reqs[i].offset, expected_size),
+              reqs[i].result.ToString());
+  }
+
+  env_->DeleteFile(fname);
+}
+
 // only works in linux platforms
 #ifdef ROCKSDB_FALLOCATE_PRESENT
 TEST_F(EnvPosixTest, AllocateTest) {
@@ -30,7 +30,7 @@ Status SequentialFileReader::Read(size_t n, Slice* result, char* scratch) {
     size_t offset_advance = offset - aligned_offset;
     size_t size = Roundup(offset + n, alignment) - aligned_offset;
     size_t r = 0;
-    AlignedBuffer buf;
+    AlignedBuffer buf(AlignedBufferPool::Default());
     buf.Alignment(alignment);
     buf.AllocateNewBuffer(size);
     Slice tmp;
@@ -55,7 +55,7 @@ Status SequentialFileReader::DirectRead(size_t n, Slice* result,
   size_t aligned_offset = TruncateToPageBoundary(alignment, offset);
   size_t offset_advance = offset - aligned_offset;
   size_t size = Roundup(offset + n, alignment) - aligned_offset;
-  AlignedBuffer buf;
+  AlignedBuffer buf(AlignedBufferPool::Default());
   buf.Alignment(alignment);
   buf.AllocateNewBuffer(size);
   Slice tmp;
@@ -83,6 +83,12 @@ Status SequentialFileReader::Skip(uint64_t n) {
 
 Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
                                     char* scratch) const {
+  return Read(offset, n, result, scratch, nullptr);
+}
+
+Status RandomAccessFileReader::Read(
+    uint64_t offset, size_t n, Slice* result, char* scratch,
+    std::unique_ptr<char[]>* aligned_buf) const {
   Status s;
   uint64_t elapsed = 0;
   {
@@ -94,18 +100,37 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
       size_t aligned_offset = TruncateToPageBoundary(alignment, offset);
       size_t offset_advance = offset - aligned_offset;
       size_t size = Roundup(offset + n, alignment) - aligned_offset;
-      size_t r = 0;
-      AlignedBuffer buf;
-      buf.Alignment(alignment);
-      buf.AllocateNewBuffer(size);
-      Slice tmp;
-      s = file_->Read(aligned_offset, size, &tmp, buf.BufferStart());
-      if (s.ok() && offset_advance < tmp.size()) {
-        buf.Size(tmp.size());
-        r = buf.Read(scratch, offset_advance,
-                            std::min(tmp.size() - offset_advance, n));
+      if (aligned_buf == nullptr && offset_advance == 0 && size == n &&
+          AlignedBuffer::isAligned(scratch, alignment)) {
+        // The request is aligned already, read straight into scratch
+        s = file_->Read(offset, n, result, scratch);
+      } else if (aligned_buf != nullptr) {
+        // Leave the data where it is read, the caller takes the buffer
+        AlignedBuffer buf;
+        buf.Alignment(alignment);
+        buf.AllocateNewBuffer(size);
+        Slice tmp;
+        s = file_->Read(aligned_offset, size, &tmp, buf.BufferStart());
+        size_t r = 0;
+        if (s.ok() && offset_advance < tmp.size()) {
+          r = std::min(tmp.size() - offset_advance, n);
+        }
+        *result = Slice(buf.BufferStart() + offset_advance, r);
+        *aligned_buf = buf.Release();
+      } else {
+        size_t r = 0;
+        AlignedBuffer buf(AlignedBufferPool::Default());
+        buf.Alignment(alignment);
+        buf.AllocateNewBuffer(size);
+        Slice tmp;
+        s = file_->Read(aligned_offset, size, &tmp, buf.BufferStart());
+        if (s.ok() && offset_advance < tmp.size()) {
+          buf.Size(tmp.size());
+          r = buf.Read(scratch, offset_advance,
+                              std::min(tmp.size() - offset_advance, n));
+        }
+        *result = Slice(scratch, r);
       }
-      *result = Slice(scratch, r);
     } else {
       s = file_->Read(offset, n, result, scratch);
     }
@@ -117,13 +142,42 @@ Status RandomAccessFileReader::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+Status RandomAccessFileReader::MultiRead(ReadRequest* reqs,
+                                         size_t num_reqs) const {
+  if (use_direct_io()) {
+    // Requests are usually not aligned, let Read() go through the aligned
+    // buffer for each of them.
+    for (size_t i = 0; i < num_reqs; ++i) {
+      ReadRequest& req = reqs[i];
+      req.status = Read(req.offset, req.len, &req.result, req.scratch);
+    }
+    return Status::OK();
+  }
+
+  Status s;
+  uint64_t elapsed = 0;
+  {
+    StopWatch sw(env_, stats_, hist_type_,
+                 (stats_ != nullptr) ? &elapsed : nullptr);
+    IOSTATS_TIMER_GUARD(read_nanos);
+    s = file_->MultiRead(reqs, num_reqs);
+    for (size_t i = 0; s.ok() && i < num_reqs; ++i) {
+      IOSTATS_ADD_IF_POSITIVE(bytes_read, reqs[i].result.size());
+    }
+  }
+  if (stats_ != nullptr && file_read_hist_ != nullptr) {
+    file_read_hist_->Add(elapsed);
+  }
+  return s;
+}
+
 Status RandomAccessFileReader::DirectRead(uint64_t offset, size_t n,
                                           Slice* result, char* scratch) const {
   size_t alignment = file_->GetRequiredBufferAlignment();
   size_t aligned_offset = TruncateToPageBoundary(alignment, offset);
   size_t offset_advance = offset - aligned_offset;
   size_t size = Roundup(offset + n, alignment) - aligned_offset;
-  AlignedBuffer buf;
+  AlignedBuffer buf(AlignedBufferPool::Default());
   buf.Alignment(alignment);
   buf.AllocateNewBuffer(size);
   Slice tmp;
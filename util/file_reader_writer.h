@@ -92,6 +92,20 @@ class RandomAccessFileReader {
 
   Status Read(uint64_t offset, size_t n, Slice* result, char* scratch) const;
 
+  // Like Read(), but with direct I/O the data is not copied out of the
+  // aligned buffer it is read into. Instead *result points into that buffer
+  // and *aligned_buf takes the ownership of it. scratch is unused in that
+  // case. Without direct I/O, this is the same as Read().
+  Status Read(uint64_t offset, size_t n, Slice* result, char* scratch,
+              std::unique_ptr<char[]>* aligned_buf) const;
+
+  // Issue a batch of reads at once. See RandomAccessFile::MultiRead().
+  Status MultiRead(ReadRequest* reqs, size_t num_reqs) const;
+
+  Status Prefetch(uint64_t offset, size_t n) {
+    return file_->Prefetch(offset, n);
+  }
+
   RandomAccessFile* file() { return file_.get(); }
 
   bool use_direct_io() const { return file_->use_direct_io(); }
@@ -124,7 +138,8 @@ class WritableFileWriter {
   WritableFileWriter(std::unique_ptr<WritableFile>&& file,
                      const EnvOptions& options)
       : writable_file_(std::move(file)),
-        buf_(),
+        buf_(writable_file_->use_direct_io() ? AlignedBufferPool::Default()
+                                             : nullptr),
         max_buffer_size_(options.writable_file_max_buffer_size),
         filesize_(0),
         next_write_offset_(0),
@@ -0,0 +1,132 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/frequency_sketch.h"
+
+#include <algorithm>
+
+namespace rocksdb {
+
+// MSVC complains that it is already defined since it is static in the header.
+#ifndef OS_WIN
+const uint32_t FrequencySketch::kMaxFrequency;
+const int FrequencySketch::kDepth;
+#endif
+
+namespace {
+const size_t kMinCapacity = 16;
+// Counters per key of capacity, and doorkeeper bits per counter
+const size_t kCountersPerEntry = 4;
+const size_t kDoorkeeperBitsPerCounter = 2;
+// Accesses between two resets, per key of capacity
+const size_t kSamplesPerEntry = 10;
+const uint64_t kMaxCounter = 15;
+
+// Spreads the bits of a hash; used to derive several indexes from one hash
+inline uint32_t Rehash(uint32_t hash) {
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6b;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35;
+  hash ^= hash >> 16;
+  return hash;
+}
+}  // namespace
+
+FrequencySketch::FrequencySketch()
+    : capacity_(0),
+      counter_mask_(0),
+      doorkeeper_mask_(0),
+      samples_(0),
+      sample_size_(0) {
+  EnsureCapacity(kMinCapacity);
+}
+
+void FrequencySketch::EnsureCapacity(size_t num_entries) {
+  if (num_entries <= capacity_) {
+    return;
+  }
+  size_t capacity = std::max(capacity_, kMinCapacity);
+  while (capacity < num_entries) {
+    capacity <<= 1;
+  }
+  capacity_ = capacity;
+  size_t num_counters = capacity * kCountersPerEntry;
+  counter_mask_ = num_counters - 1;
+  counters_.assign(num_counters / 16, 0);
+  size_t num_doorkeeper_bits = num_counters * kDoorkeeperBitsPerCounter;
+  doorkeeper_mask_ = num_doorkeeper_bits - 1;
+  doorkeeper_.assign(num_doorkeeper_bits / 64, 0);
+  samples_ = 0;
+  sample_size_ = capacity * kSamplesPerEntry;
+}
+
+size_t FrequencySketch::CounterIndex(uint32_t hash, int i) const {
+  // Double hashing: h1 + i * h2
+  uint32_t h2 = Rehash(hash) | 1;
+  return static_cast<size_t>(hash + i * h2) & counter_mask_;
+}
+
+size_t FrequencySketch::DoorkeeperIndex(uint32_t hash, int i) const {
+  uint32_t h = Rehash(hash ^ 0x9e3779b9);
+  return static_cast<size_t>(i == 0 ? h : Rehash(h)) & doorkeeper_mask_;
+}
+
+bool FrequencySketch::DoorkeeperContains(uint32_t hash) const {
+  for (int i = 0; i < 2; i++) {
+    size_t bit = DoorkeeperIndex(hash, i);
+    if ((doorkeeper_[bit / 64] & (uint64_t{1} << (bit % 64))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FrequencySketch::Increment(uint32_t hash) {
+  if (!DoorkeeperContains(hash)) {
+    for (int i = 0; i < 2; i++) {
+      size_t bit = DoorkeeperIndex(hash, i);
+      doorkeeper_[bit / 64] |= uint64_t{1} << (bit % 64);
+    }
+  } else {
+    for (int i = 0; i < kDepth; i++) {
+      size_t index = CounterIndex(hash, i);
+      uint64_t& word = counters_[index / 16];
+      int shift = static_cast<int>(index % 16) * 4;
+      if (((word >> shift) & kMaxCounter) < kMaxCounter) {
+        word += uint64_t{1} << shift;
+      }
+    }
+  }
+  if (++samples_ >= sample_size_) {
+    Reset();
+  }
+}
+
+uint32_t FrequencySketch::Estimate(uint32_t hash) const {
+  uint64_t frequency = kMaxCounter;
+  for (int i = 0; i < kDepth; i++) {
+    size_t index = CounterIndex(hash, i);
+    int shift = static_cast<int>(index % 16) * 4;
+    frequency =
+        std::min(frequency, (counters_[index / 16] >> shift) & kMaxCounter);
+  }
+  if (DoorkeeperContains(hash)) {
+    frequency++;
+  }
+  return static_cast<uint32_t>(frequency);
+}
+
+void FrequencySketch::Reset() {
+  // Halve every counter: shift the word and drop the bit that crossed into
+  // the neighbouring counter
+  for (auto& word : counters_) {
+    word = (word >> 1) & 0x7777777777777777ULL;
+  }
+  std::fill(doorkeeper_.begin(), doorkeeper_.end(), 0);
+  samples_ /= 2;
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,60 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace rocksdb {
+
+// FrequencySketch estimates how often a key was accessed recently, the way
+// TinyLFU does: a count-min sketch of 4-bit counters sitting behind a
+// "doorkeeper" bloom filter. The first access of a key only sets its
+// doorkeeper bits, so keys seen once never reach the counters. After a
+// number of accesses proportional to the capacity, all counters are halved
+// and the doorkeeper is cleared so that old accesses fade out.
+//
+// Keys are identified by a 32-bit hash. Not thread-safe.
+class FrequencySketch {
+ public:
+  // Maximum value returned by Estimate()
+  static const uint32_t kMaxFrequency = 16;
+
+  FrequencySketch();
+
+  // Make the sketch large enough for about `num_entries` distinct keys.
+  // Growing the sketch forgets all the frequencies recorded so far.
+  void EnsureCapacity(size_t num_entries);
+
+  // Record an access to the key
+  void Increment(uint32_t hash);
+
+  // Estimated number of recent accesses to the key
+  uint32_t Estimate(uint32_t hash) const;
+
+ private:
+  // Number of counters each key maps to
+  static const int kDepth = 4;
+
+  size_t CounterIndex(uint32_t hash, int i) const;
+  size_t DoorkeeperIndex(uint32_t hash, int i) const;
+  bool DoorkeeperContains(uint32_t hash) const;
+  void Reset();
+
+  size_t capacity_;
+  // Number of counters minus one; a power of two minus one
+  size_t counter_mask_;
+  // 16 counters per word
+  std::vector<uint64_t> counters_;
+  size_t doorkeeper_mask_;
+  std::vector<uint64_t> doorkeeper_;
+  // Accesses recorded since the last reset, and the number that triggers it
+  size_t samples_;
+  size_t sample_size_;
+};
+
+}  // namespace rocksdb
@@ -27,6 +27,12 @@
 #include <sys/statfs.h>
 #include <sys/syscall.h>
 #endif
+#ifdef ROCKSDB_IOURING_PRESENT
+#include <linux/io_uring.h>
+#include <sys/uio.h>
+#include <sched.h>
+#include <vector>
+#endif
 #include "port/port.h"
 #include "rocksdb/slice.h"
 #include "util/coding.h"
@@ -34,6 +40,9 @@
 #include "util/posix_logger.h"
 #include "util/string_util.h"
 #include "util/sync_point.h"
+#ifdef ROCKSDB_IOURING_PRESENT
+#include "util/thread_local.h"
+#endif
 
 namespace rocksdb {
 
@@ -269,6 +278,267 @@ Status PosixRandomAccessFile::Read(uint64_t offset, size_t n, Slice* result,
   return s;
 }
 
+#ifdef ROCKSDB_IOURING_PRESENT
+namespace {
+// A minimal io_uring instance driven through the raw system calls. It is only
+// used to issue batches of preadv() and wait for all of them, so there is no
+// need to pull in liburing.
+class IoUring {
+ public:
+  // Returns nullptr and sets *error to the errno of the failed call if the
+  // ring cannot be set up
+  static IoUring* Create(unsigned entries, int* error) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0) {
+      *error = errno;
+      return nullptr;
+    }
+    IoUring* ring = new IoUring(fd, params);
+    if (!ring->Map(params)) {
+      *error = errno;
+      delete ring;
+      return nullptr;
+    }
+    return ring;
+  }
+
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    close(fd_);
+  }
+
+  unsigned depth() const { return sq_entries_; }
+
+  // Queue a read of iov at offset. At most depth() reads may be queued
+  // before they are submitted.
+  void PrepareRead(int fd, const struct iovec* iov, uint64_t offset,
+                   uint64_t user_data) {
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    struct io_uring_sqe* sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = 1;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  }
+
+  // Discard the last n queued reads that have not been submitted yet
+  void UnprepareReads(unsigned n) {
+    __atomic_store_n(sq_tail_, *sq_tail_ - n, __ATOMIC_RELEASE);
+  }
+
+  // Returns the number of reads submitted, or -errno
+  int SubmitAndWait(unsigned to_submit, unsigned min_complete) {
+    int ret = static_cast<int>(syscall(__NR_io_uring_enter, fd_, to_submit,
+                                       min_complete, IORING_ENTER_GETEVENTS,
+                                       nullptr, 0));
+    return ret < 0 ? -errno : ret;
+  }
+
+  // Pop one completion if there is any
+  bool PopCompletion(uint64_t* user_data, int* res) {
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      return false;
+    }
+    const struct io_uring_cqe* cqe = &cqes_[head & *cq_mask_];
+    *user_data = cqe->user_data;
+    *res = cqe->res;
+    __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+    return true;
+  }
+
+ private:
+  IoUring(int fd, const struct io_uring_params& params)
+      : fd_(fd),
+        sq_entries_(params.sq_entries),
+        sq_ring_(MAP_FAILED),
+        cq_ring_(MAP_FAILED),
+        sqes_(static_cast<struct io_uring_sqe*>(MAP_FAILED)) {}
+
+  bool Map(const struct io_uring_params& params) {
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+    single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+#endif
+    if (single_mmap) {
+      sq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) {
+      return false;
+    }
+    if (single_mmap) {
+      cq_ring_ = sq_ring_;
+    } else {
+      cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+      if (cq_ring_ == MAP_FAILED) {
+        return false;
+      }
+    }
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_ = static_cast<struct io_uring_sqe*>(
+        mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+    if (sqes_ == MAP_FAILED) {
+      return false;
+    }
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  int fd_;
+  unsigned sq_entries_;
+  void* sq_ring_;
+  size_t sq_ring_size_;
+  void* cq_ring_;
+  size_t cq_ring_size_;
+  struct io_uring_sqe* sqes_;
+  size_t sqes_size_;
+
+  unsigned* sq_tail_;
+  unsigned* sq_mask_;
+  unsigned* sq_array_;
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  unsigned* cq_mask_;
+  struct io_uring_cqe* cqes_;
+};
+
+const unsigned kIoUringDepth = 64;
+
+// Set once io_uring_setup() has failed because the kernel does not support
+// io_uring or does not allow it, so that later calls do not retry it
+std::atomic<bool> io_uring_unsupported(false);
+
+void DeleteIoUring(void* ptr) { delete static_cast<IoUring*>(ptr); }
+
+// Returns the calling thread's ring, creating it on first use, or nullptr
+// if io_uring is not available. Other failures to create the ring, such as
+// running out of file descriptors or locked memory, only affect this call.
+IoUring* GetThreadLocalIoUring() {
+  if (io_uring_unsupported.load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  static ThreadLocalPtr* rings = new ThreadLocalPtr(&DeleteIoUring);
+  IoUring* ring = static_cast<IoUring*>(rings->Get());
+  if (ring == nullptr) {
+    int error = 0;
+    ring = IoUring::Create(kIoUringDepth, &error);
+    if (ring == nullptr) {
+      if (error == ENOSYS || error == EPERM || error == EINVAL) {
+        io_uring_unsupported.store(true, std::memory_order_relaxed);
+      }
+      return nullptr;
+    }
+    rings->Reset(ring);
+  }
+  return ring;
+}
+}  // namespace
+
+Status PosixRandomAccessFile::MultiRead(ReadRequest* reqs,
+                                        size_t num_reqs) const {
+  // Direct reads need aligned requests, which RandomAccessFileReader only
+  // issues one at a time through its aligned buffer
+  IoUring* ring = num_reqs > 1 && !use_direct_io() ? GetThreadLocalIoUring()
+                                                    : nullptr;
+  if (ring == nullptr) {
+    return RandomAccessFile::MultiRead(reqs, num_reqs);
+  }
+
+  std::vector<struct iovec> iovs(num_reqs);
+  size_t next = 0;
+  while (next < num_reqs) {
+    unsigned batch = static_cast<unsigned>(
+        std::min<size_t>(num_reqs - next, ring->depth()));
+    for (unsigned i = 0; i < batch; ++i) {
+      ReadRequest& req = reqs[next + i];
+      iovs[next + i].iov_base = req.scratch;
+      iovs[next + i].iov_len = req.len;
+      ring->PrepareRead(fd_, &iovs[next + i], req.offset, next + i);
+    }
+
+    unsigned submitted = 0;
+    unsigned completed = 0;
+    bool ring_failed = false;
+    while (completed < batch) {
+      if (!ring_failed) {
+        int ret = ring->SubmitAndWait(batch - submitted, batch - completed);
+        if (ret >= 0) {
+          submitted += static_cast<unsigned>(ret);
+        } else if (ret != -EINTR && ret != -EAGAIN && ret != -EBUSY) {
+          // Fail the reads that never reached the kernel and poll for the
+          // ones that did, their buffers must not be released before then.
+          ring->UnprepareReads(batch - submitted);
+          for (unsigned i = submitted; i < batch; ++i) {
+            reqs[next + i].result = Slice(reqs[next + i].scratch, 0);
+            reqs[next + i].status = IOError(filename_, -ret);
+          }
+          completed += batch - submitted;
+          ring_failed = true;
+        }
+      } else {
+        sched_yield();
+      }
+
+      uint64_t user_data;
+      int res;
+      while (ring->PopCompletion(&user_data, &res)) {
+        ReadRequest& req = reqs[user_data];
+        if (res == -EINTR || res == -EAGAIN) {
+          req.status = Read(req.offset, req.len, &req.result, req.scratch);
+        } else if (res < 0) {
+          req.result = Slice(req.scratch, 0);
+          req.status = IOError(filename_, -res);
+        } else if (static_cast<size_t>(res) < req.len && res > 0) {
+          // Short read, finish the rest of it synchronously
+          Slice rest;
+          req.status = Read(req.offset + res, req.len - res, &rest,
+                            req.scratch + res);
+          req.result = Slice(req.scratch, res + rest.size());
+        } else {
+          req.result = Slice(req.scratch, res);
+          req.status = Status::OK();
+        }
+        completed++;
+      }
+    }
+    next += batch;
+  }
+  return Status::OK();
+}
+#endif  // ROCKSDB_IOURING_PRESENT
+
 #if defined(OS_LINUX) || defined(OS_MACOSX)
 size_t PosixRandomAccessFile::GetUniqueId(char* id, size_t max_size) const {
   return PosixHelper::GetUniqueIdFromFile(fd_, id, max_size);
@@ -301,6 +571,21 @@ void PosixRandomAccessFile::Hint(AccessPattern pattern) {
   }
 }
 
+Status PosixRandomAccessFile::Prefetch(uint64_t offset, size_t n) {
+  if (use_direct_io()) {
+    // There is no page cache to load the data into
+    return Status::OK();
+  }
+#ifdef OS_LINUX
+  if (readahead(fd_, static_cast<off_t>(offset), n) != 0) {
+    return IOError(filename_, errno);
+  }
+  return Status::OK();
+#else
+  return RandomAccessFile::Prefetch(offset, n);
+#endif
+}
+
 Status PosixRandomAccessFile::InvalidateCache(size_t offset, size_t length) {
   if (use_direct_io()) {
     return Status::OK();
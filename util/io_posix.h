@@ -69,10 +69,15 @@ class PosixRandomAccessFile : public RandomAccessFile {
 
   virtual Status Read(uint64_t offset, size_t n, Slice* result,
                       char* scratch) const override;
+#ifdef ROCKSDB_IOURING_PRESENT
+  virtual Status MultiRead(ReadRequest* reqs,
+                           size_t num_reqs) const override;
+#endif
 #if defined(OS_LINUX) || defined(OS_MACOSX)
   virtual size_t GetUniqueId(char* id, size_t max_size) const override;
 #endif
   virtual void Hint(AccessPattern pattern) override;
+  virtual Status Prefetch(uint64_t offset, size_t n) override;
   virtual Status InvalidateCache(size_t offset, size_t length) override;
   virtual bool use_direct_io() const override { return use_direct_io_; }
 };
@@ -0,0 +1,607 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/io_tracer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "port/port.h"
+#include "util/coding.h"
+#include "util/mutexlock.h"
+#include "util/trace_replay.h"
+
+namespace rocksdb {
+
+#ifndef IOS_CROSS_COMPILE
+# ifdef _WIN32
+__declspec(thread) IOCaller thread_io_caller;
+# else
+__thread IOCaller thread_io_caller;
+# endif
+#endif  // IOS_CROSS_COMPILE
+
+namespace {
+const char kFlagFailed = 0x1;
+}  // namespace
+
+void EncodeIOTraceRecord(const IOTraceRecord& record, std::string* dst) {
+  PutFixed64(dst, record.access_timestamp);
+  PutVarint64(dst, record.latency_nanos);
+  PutLengthPrefixedSlice(dst, record.file_name);
+  dst->push_back(static_cast<char>(record.op));
+  dst->push_back(static_cast<char>(record.caller));
+  dst->push_back(record.ok ? 0 : kFlagFailed);
+  PutVarint64(dst, record.offset);
+  PutVarint64(dst, record.length);
+  PutVarint64(dst, record.io_size);
+}
+
+Status DecodeIOTraceRecord(const Slice& input, IOTraceRecord* record) {
+  Slice in = input;
+  Slice file_name;
+  if (in.size() < sizeof(uint64_t)) {
+    return Status::Corruption("Truncated I/O trace record");
+  }
+  record->access_timestamp = DecodeFixed64(in.data());
+  in.remove_prefix(sizeof(uint64_t));
+  if (!GetVarint64(&in, &record->latency_nanos) ||
+      !GetLengthPrefixedSlice(&in, &file_name) || in.size() < 3) {
+    return Status::Corruption("Truncated I/O trace record");
+  }
+  record->file_name.assign(file_name.data(), file_name.size());
+  const unsigned char op = static_cast<unsigned char>(in[0]);
+  const unsigned char caller = static_cast<unsigned char>(in[1]);
+  const char flags = in[2];
+  in.remove_prefix(3);
+  if (op >= static_cast<unsigned char>(IOTraceOp::kNumOps) ||
+      caller >= static_cast<unsigned char>(IOCaller::kNumCallers)) {
+    return Status::Corruption("Unknown operation or caller in I/O trace "
+                              "record");
+  }
+  record->op = static_cast<IOTraceOp>(op);
+  record->caller = static_cast<IOCaller>(caller);
+  record->ok = (flags & kFlagFailed) == 0;
+  if (!GetVarint64(&in, &record->offset) ||
+      !GetVarint64(&in, &record->length) ||
+      !GetVarint64(&in, &record->io_size)) {
+    return Status::Corruption("Truncated I/O trace record");
+  }
+  return Status::OK();
+}
+
+Status IOTraceReader::ReadHeader() {
+  Status s = trace_reader_->Read(&buffer_);
+  if (!s.ok()) {
+    return s.IsIncomplete() ? Status::Corruption("Empty I/O trace") : s;
+  }
+  if (buffer_.size() != 2 * sizeof(uint32_t) ||
+      DecodeFixed32(buffer_.data()) != kIOTraceMagicNumber) {
+    return Status::Corruption("Not an I/O trace");
+  }
+  if (DecodeFixed32(buffer_.data() + sizeof(uint32_t)) >
+      kIOTraceFormatVersion) {
+    return Status::NotSupported("I/O trace has a newer format");
+  }
+  return Status::OK();
+}
+
+Status IOTraceReader::ReadIOOp(IOTraceRecord* record) {
+  Status s = trace_reader_->Read(&buffer_);
+  if (!s.ok()) {
+    return s;
+  }
+  return DecodeIOTraceRecord(buffer_, record);
+}
+
+const char* IOTraceOpToString(IOTraceOp op) {
+  switch (op) {
+    case IOTraceOp::kRead:
+      return "read";
+    case IOTraceOp::kMultiRead:
+      return "multi_read";
+    case IOTraceOp::kPrefetch:
+      return "prefetch";
+    case IOTraceOp::kAppend:
+      return "append";
+    case IOTraceOp::kPositionedAppend:
+      return "positioned_append";
+    case IOTraceOp::kTruncate:
+      return "truncate";
+    case IOTraceOp::kFlush:
+      return "flush";
+    case IOTraceOp::kSync:
+      return "sync";
+    case IOTraceOp::kFsync:
+      return "fsync";
+    case IOTraceOp::kRangeSync:
+      return "range_sync";
+    case IOTraceOp::kClose:
+      return "close";
+    default:
+      return "unknown";
+  }
+}
+
+const char* IOCallerToString(IOCaller caller) {
+  switch (caller) {
+    case IOCaller::kOther:
+      return "other";
+    case IOCaller::kFlush:
+      return "flush";
+    case IOCaller::kCompaction:
+      return "compaction";
+    case IOCaller::kUserGet:
+      return "get";
+    case IOCaller::kUserIterator:
+      return "iterator";
+    case IOCaller::kUserWrite:
+      return "write";
+    default:
+      return "unknown";
+  }
+}
+
+namespace {
+
+class IOTracingEnvImpl;
+
+// Times one file operation and records it if the env is tracing
+class IOTraceTimer {
+ public:
+  IOTraceTimer(IOTracingEnvImpl* env, const std::string& file_name,
+               IOTraceOp op, uint64_t offset, uint64_t length);
+
+  // Records the operation with its status and the number of bytes read
+  void Finish(const Status& s, uint64_t io_size = 0);
+
+ private:
+  IOTracingEnvImpl* env_;
+  IOTraceRecord record_;
+  uint64_t start_nanos_;
+};
+
+class IOTracingEnvImpl : public IOTracingEnv {
+ public:
+  explicit IOTracingEnvImpl(Env* base_env)
+      : IOTracingEnv(base_env),
+        tracing_(false),
+        sampling_frequency_(1),
+        sample_count_(0),
+        trace_writer_(nullptr),
+        trace_writer_users_(0) {}
+
+  ~IOTracingEnvImpl() { EndTrace(); }
+
+  Status NewSequentialFile(const std::string& fname,
+                           unique_ptr<SequentialFile>* result,
+                           const EnvOptions& options) override;
+  Status NewRandomAccessFile(const std::string& fname,
+                             unique_ptr<RandomAccessFile>* result,
+                             const EnvOptions& options) override;
+  Status NewWritableFile(const std::string& fname,
+                         unique_ptr<WritableFile>* result,
+                         const EnvOptions& options) override;
+  Status ReuseWritableFile(const std::string& fname,
+                           const std::string& old_fname,
+                           unique_ptr<WritableFile>* result,
+                           const EnvOptions& options) override;
+
+  Status StartTrace(const IOTraceOptions& options,
+                    std::unique_ptr<TraceWriter>&& trace_writer) override;
+  Status EndTrace() override;
+
+  bool IsTracing() const override {
+    return tracing_.load(std::memory_order_relaxed);
+  }
+
+  // Returns whether an operation starting now is to be traced
+  bool ShouldTrace() {
+    if (!IsTracing()) {
+      return false;
+    }
+    const uint64_t sampling_frequency =
+        sampling_frequency_.load(std::memory_order_relaxed);
+    return sampling_frequency <= 1 ||
+           sample_count_.fetch_add(1, std::memory_order_relaxed) %
+                   sampling_frequency ==
+               0;
+  }
+
+  // Does not wait for the other threads writing records
+  void WriteIOOp(const IOTraceRecord& record);
+
+ private:
+  std::atomic<bool> tracing_;
+  std::atomic<uint64_t> sampling_frequency_;
+  std::atomic<uint64_t> sample_count_;
+  // Serializes StartTrace() and EndTrace()
+  port::Mutex mutex_;
+  // Set while tracing. WriteIOOp() uses it without taking mutex_, counting
+  // itself in trace_writer_users_ so that EndTrace() can wait for it before
+  // deleting the writer.
+  std::atomic<ConcurrentTraceWriter*> trace_writer_;
+  std::atomic<uint32_t> trace_writer_users_;
+};
+
+IOTraceTimer::IOTraceTimer(IOTracingEnvImpl* env, const std::string& file_name,
+                           IOTraceOp op, uint64_t offset, uint64_t length)
+    : env_(env->ShouldTrace() ? env : nullptr), start_nanos_(0) {
+  if (env_ == nullptr) {
+    return;
+  }
+  record_.access_timestamp = env_->NowMicros();
+  record_.file_name = file_name;
+  record_.op = op;
+  record_.caller = GetThreadIOCaller();
+  record_.offset = offset;
+  record_.length = length;
+  start_nanos_ = env_->NowNanos();
+}
+
+void IOTraceTimer::Finish(const Status& s, uint64_t io_size) {
+  if (env_ == nullptr) {
+    return;
+  }
+  record_.latency_nanos = env_->NowNanos() - start_nanos_;
+  record_.io_size = io_size;
+  record_.ok = s.ok();
+  env_->WriteIOOp(record_);
+}
+
+class IOTracingSequentialFile : public SequentialFile {
+ public:
+  IOTracingSequentialFile(unique_ptr<SequentialFile>&& target,
+                          IOTracingEnvImpl* env, const std::string& fname)
+      : target_(std::move(target)), env_(env), fname_(fname), offset_(0) {}
+
+  Status Read(size_t n, Slice* result, char* scratch) override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kRead, offset_, n);
+    Status s = target_->Read(n, result, scratch);
+    const size_t io_size = s.ok() ? result->size() : 0;
+    offset_ += io_size;
+    timer.Finish(s, io_size);
+    return s;
+  }
+
+  Status PositionedRead(uint64_t offset, size_t n, Slice* result,
+                        char* scratch) override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kRead, offset, n);
+    Status s = target_->PositionedRead(offset, n, result, scratch);
+    timer.Finish(s, s.ok() ? result->size() : 0);
+    return s;
+  }
+
+  Status Skip(uint64_t n) override {
+    offset_ += n;
+    return target_->Skip(n);
+  }
+
+  bool use_direct_io() const override { return target_->use_direct_io(); }
+
+  size_t GetRequiredBufferAlignment() const override {
+    return target_->GetRequiredBufferAlignment();
+  }
+
+  Status InvalidateCache(size_t offset, size_t length) override {
+    return target_->InvalidateCache(offset, length);
+  }
+
+ private:
+  unique_ptr<SequentialFile> target_;
+  IOTracingEnvImpl* env_;
+  const std::string fname_;
+  uint64_t offset_;
+};
+
+class IOTracingRandomAccessFile : public RandomAccessFile {
+ public:
+  IOTracingRandomAccessFile(unique_ptr<RandomAccessFile>&& target,
+                            IOTracingEnvImpl* env, const std::string& fname)
+      : target_(std::move(target)), env_(env), fname_(fname) {}
+
+  Status Read(uint64_t offset, size_t n, Slice* result,
+              char* scratch) const override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kRead, offset, n);
+    Status s = target_->Read(offset, n, result, scratch);
+    timer.Finish(s, s.ok() ? result->size() : 0);
+    return s;
+  }
+
+  Status MultiRead(ReadRequest* reqs, size_t num_reqs) const override {
+    if (!env_->IsTracing()) {
+      return target_->MultiRead(reqs, num_reqs);
+    }
+    const uint64_t start_micros = env_->NowMicros();
+    const uint64_t start_nanos = env_->NowNanos();
+    Status s = target_->MultiRead(reqs, num_reqs);
+    const uint64_t latency_nanos = env_->NowNanos() - start_nanos;
+    const IOCaller caller = GetThreadIOCaller();
+    for (size_t i = 0; i < num_reqs; ++i) {
+      if (!env_->ShouldTrace()) {
+        continue;
+      }
+      IOTraceRecord record;
+      record.access_timestamp = start_micros;
+      record.latency_nanos = latency_nanos;
+      record.file_name = fname_;
+      record.op = IOTraceOp::kMultiRead;
+      record.caller = caller;
+      record.offset = reqs[i].offset;
+      record.length = reqs[i].len;
+      record.ok = s.ok() && reqs[i].status.ok();
+      record.io_size = record.ok ? reqs[i].result.size() : 0;
+      env_->WriteIOOp(record);
+    }
+    return s;
+  }
+
+  bool ShouldForwardRawRequest() const override {
+    return target_->ShouldForwardRawRequest();
+  }
+
+  void EnableReadAhead() override { target_->EnableReadAhead(); }
+
+  Status Prefetch(uint64_t offset, size_t n) override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kPrefetch, offset, n);
+    Status s = target_->Prefetch(offset, n);
+    timer.Finish(s);
+    return s;
+  }
+
+  size_t GetUniqueId(char* id, size_t max_size) const override {
+    return target_->GetUniqueId(id, max_size);
+  }
+
+  void Hint(AccessPattern pattern) override { target_->Hint(pattern); }
+
+  bool use_direct_io() const override { return target_->use_direct_io(); }
+
+  size_t GetRequiredBufferAlignment() const override {
+    return target_->GetRequiredBufferAlignment();
+  }
+
+  Status InvalidateCache(size_t offset, size_t length) override {
+    return target_->InvalidateCache(offset, length);
+  }
+
+ private:
+  unique_ptr<RandomAccessFile> target_;
+  IOTracingEnvImpl* env_;
+  const std::string fname_;
+};
+
+class IOTracingWritableFile : public WritableFile {
+ public:
+  IOTracingWritableFile(unique_ptr<WritableFile>&& target,
+                        IOTracingEnvImpl* env, const std::string& fname)
+      : target_(std::move(target)), env_(env), fname_(fname), offset_(0) {}
+
+  Status Append(const Slice& data) override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kAppend, offset_,
+                       data.size());
+    Status s = target_->Append(data);
+    if (s.ok()) {
+      offset_ += data.size();
+    }
+    timer.Finish(s);
+    return s;
+  }
+
+  Status PositionedAppend(const Slice& data, uint64_t offset) override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kPositionedAppend, offset,
+                       data.size());
+    Status s = target_->PositionedAppend(data, offset);
+    if (s.ok()) {
+      offset_ = std::max<uint64_t>(offset_, offset + data.size());
+    }
+    timer.Finish(s);
+    return s;
+  }
+
+  Status Truncate(uint64_t size) override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kTruncate, size, 0);
+    Status s = target_->Truncate(size);
+    if (s.ok()) {
+      offset_ = size;
+    }
+    timer.Finish(s);
+    return s;
+  }
+
+  Status Close() override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kClose, 0, 0);
+    Status s = target_->Close();
+    timer.Finish(s);
+    return s;
+  }
+
+  Status Flush() override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kFlush, 0, 0);
+    Status s = target_->Flush();
+    timer.Finish(s);
+    return s;
+  }
+
+  Status Sync() override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kSync, 0, 0);
+    Status s = target_->Sync();
+    timer.Finish(s);
+    return s;
+  }
+
+  Status Fsync() override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kFsync, 0, 0);
+    Status s = target_->Fsync();
+    timer.Finish(s);
+    return s;
+  }
+
+  Status RangeSync(uint64_t offset, uint64_t nbytes) override {
+    IOTraceTimer timer(env_, fname_, IOTraceOp::kRangeSync, offset, nbytes);
+    Status s = target_->RangeSync(offset, nbytes);
+    timer.Finish(s);
+    return s;
+  }
+
+  bool IsSyncThreadSafe() const override {
+    return target_->IsSyncThreadSafe();
+  }
+
+  bool use_direct_io() const override { return target_->use_direct_io(); }
+
+  size_t GetRequiredBufferAlignment() const override {
+    return target_->GetRequiredBufferAlignment();
+  }
+
+  void SetIOPriority(Env::IOPriority pri) override {
+    target_->SetIOPriority(pri);
+  }
+
+  Env::IOPriority GetIOPriority() override {
+    return target_->GetIOPriority();
+  }
+
+  uint64_t GetFileSize() override { return target_->GetFileSize(); }
+
+  void SetPreallocationBlockSize(size_t size) override {
+    target_->SetPreallocationBlockSize(size);
+  }
+
+  void GetPreallocationStatus(size_t* block_size,
+                              size_t* last_allocated_block) override {
+    target_->GetPreallocationStatus(block_size, last_allocated_block);
+  }
+
+  size_t GetUniqueId(char* id, size_t max_size) const override {
+    return target_->GetUniqueId(id, max_size);
+  }
+
+  Status InvalidateCache(size_t offset, size_t length) override {
+    return target_->InvalidateCache(offset, length);
+  }
+
+  void PrepareWrite(size_t offset, size_t len) override {
+    target_->PrepareWrite(offset, len);
+  }
+
+ private:
+  unique_ptr<WritableFile> target_;
+  IOTracingEnvImpl* env_;
+  const std::string fname_;
+  // Where the next Append() writes
+  uint64_t offset_;
+};
+
+Status IOTracingEnvImpl::NewSequentialFile(const std::string& fname,
+                                           unique_ptr<SequentialFile>* result,
+                                           const EnvOptions& options) {
+  unique_ptr<SequentialFile> file;
+  Status s = target()->NewSequentialFile(fname, &file, options);
+  if (s.ok()) {
+    result->reset(new IOTracingSequentialFile(std::move(file), this, fname));
+  }
+  return s;
+}
+
+Status IOTracingEnvImpl::NewRandomAccessFile(
+    const std::string& fname, unique_ptr<RandomAccessFile>* result,
+    const EnvOptions& options) {
+  unique_ptr<RandomAccessFile> file;
+  Status s = target()->NewRandomAccessFile(fname, &file, options);
+  if (s.ok()) {
+    result->reset(
+        new IOTracingRandomAccessFile(std::move(file), this, fname));
+  }
+  return s;
+}
+
+Status IOTracingEnvImpl::NewWritableFile(const std::string& fname,
+                                         unique_ptr<WritableFile>* result,
+                                         const EnvOptions& options) {
+  unique_ptr<WritableFile> file;
+  Status s = target()->NewWritableFile(fname, &file, options);
+  if (s.ok()) {
+    result->reset(new IOTracingWritableFile(std::move(file), this, fname));
+  }
+  return s;
+}
+
+Status IOTracingEnvImpl::ReuseWritableFile(const std::string& fname,
+                                           const std::string& old_fname,
+                                           unique_ptr<WritableFile>* result,
+                                           const EnvOptions& options) {
+  unique_ptr<WritableFile> file;
+  Status s = target()->ReuseWritableFile(fname, old_fname, &file, options);
+  if (s.ok()) {
+    result->reset(new IOTracingWritableFile(std::move(file), this, fname));
+  }
+  return s;
+}
+
+Status IOTracingEnvImpl::StartTrace(
+    const IOTraceOptions& options,
+    std::unique_ptr<TraceWriter>&& trace_writer) {
+  MutexLock l(&mutex_);
+  if (trace_writer_.load() != nullptr) {
+    return Status::Busy("I/O trace already running");
+  }
+  std::string header;
+  PutFixed32(&header, kIOTraceMagicNumber);
+  PutFixed32(&header, kIOTraceFormatVersion);
+  Status s = trace_writer->Write(header);
+  if (!s.ok()) {
+    return s;
+  }
+  trace_writer_.store(new ConcurrentTraceWriter(std::move(trace_writer),
+                                                options.max_trace_file_size));
+  sampling_frequency_.store(
+      options.sampling_frequency == 0 ? 1 : options.sampling_frequency,
+      std::memory_order_relaxed);
+  sample_count_.store(0, std::memory_order_relaxed);
+  tracing_.store(true, std::memory_order_release);
+  return s;
+}
+
+Status IOTracingEnvImpl::EndTrace() {
+  MutexLock l(&mutex_);
+  tracing_.store(false, std::memory_order_release);
+  std::unique_ptr<ConcurrentTraceWriter> trace_writer(
+      trace_writer_.exchange(nullptr));
+  if (trace_writer == nullptr) {
+    return Status::OK();
+  }
+  // Operations that found the writer before it was cleared may still be
+  // writing to it
+  while (trace_writer_users_.load() != 0) {
+    std::this_thread::yield();
+  }
+  return trace_writer->Close(std::string() /* last_record */);
+}
+
+void IOTracingEnvImpl::WriteIOOp(const IOTraceRecord& record) {
+  std::string data;
+  EncodeIOTraceRecord(record, &data);
+
+  // Announce the use before looking at the writer, so that EndTrace()
+  // either waits for it or is seen to have cleared the writer
+  trace_writer_users_.fetch_add(1);
+  ConcurrentTraceWriter* trace_writer = trace_writer_.load();
+  // A trace that cannot be written any more is of no use; stop tracing
+  // rather than fail the I/O.
+  if (trace_writer != nullptr && !trace_writer->Write(std::move(data)).ok()) {
+    tracing_.store(false, std::memory_order_release);
+  }
+  trace_writer_users_.fetch_sub(1);
+}
+
+}  // namespace
+
+IOTracingEnv* NewIOTracingEnv(Env* base_env) {
+  return new IOTracingEnvImpl(base_env);
+}
+
+}  // namespace rocksdb
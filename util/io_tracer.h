@@ -0,0 +1,88 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include "rocksdb/io_tracer.h"
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+
+// An I/O trace is a sequence of TraceWriter records. The first one is a
+// header:
+//   magic number: fixed32
+//   format version: fixed32
+// Every other record is one file operation:
+//   access timestamp: fixed64
+//   latency in nanoseconds: varint64
+//   file name: varint32 length followed by the name
+//   operation: char
+//   caller: char
+//   flags, bit 0 for a failed operation: char
+//   offset: varint64
+//   length: varint64
+//   bytes read: varint64
+const uint32_t kIOTraceMagicNumber = 0x494f5452;  // "IOTR"
+const uint32_t kIOTraceFormatVersion = 1;
+
+extern void EncodeIOTraceRecord(const IOTraceRecord& record, std::string* dst);
+extern Status DecodeIOTraceRecord(const Slice& input, IOTraceRecord* record);
+
+// Reads back a trace written by an IOTracingEnv
+class IOTraceReader {
+ public:
+  explicit IOTraceReader(std::unique_ptr<TraceReader>&& trace_reader)
+      : trace_reader_(std::move(trace_reader)) {}
+
+  // Must be called first. Returns Corruption if the trace is not an I/O
+  // trace or NotSupported if it has a newer format.
+  Status ReadHeader();
+
+  // Returns Incomplete once all the operations have been read
+  Status ReadIOOp(IOTraceRecord* record);
+
+ private:
+  std::unique_ptr<TraceReader> trace_reader_;
+  std::string buffer_;
+};
+
+extern const char* IOTraceOpToString(IOTraceOp op);
+extern const char* IOCallerToString(IOCaller caller);
+
+#ifndef IOS_CROSS_COMPILE
+# ifdef _WIN32
+extern __declspec(thread) IOCaller thread_io_caller;
+# else
+extern __thread IOCaller thread_io_caller;
+# endif
+
+// The caller recorded for the I/O issued by the current thread
+inline IOCaller GetThreadIOCaller() { return thread_io_caller; }
+inline void SetThreadIOCaller(IOCaller caller) { thread_io_caller = caller; }
+#else  // IOS_CROSS_COMPILE
+inline IOCaller GetThreadIOCaller() { return IOCaller::kOther; }
+inline void SetThreadIOCaller(IOCaller /*caller*/) {}
+#endif  // IOS_CROSS_COMPILE
+
+// Sets the caller of the I/O issued by the current thread for its lifetime,
+// then restores the previous one
+class IOCallerGuard {
+ public:
+  explicit IOCallerGuard(IOCaller caller) : prev_(GetThreadIOCaller()) {
+    SetThreadIOCaller(caller);
+  }
+  ~IOCallerGuard() { SetThreadIOCaller(prev_); }
+
+ private:
+  const IOCaller prev_;
+
+  // No copying allowed
+  IOCallerGuard(const IOCallerGuard&) = delete;
+  IOCallerGuard& operator=(const IOCallerGuard&) = delete;
+};
+
+}  // namespace rocksdb
@@ -0,0 +1,310 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/io_tracer.h"
+
+#include <deque>
+#include <map>
+#include <set>
+#include "db/filename.h"
+#include "rocksdb/db.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Keeps the records in memory, shared with the reader below
+class StringTraceWriter : public TraceWriter {
+ public:
+  explicit StringTraceWriter(std::deque<std::string>* records)
+      : records_(records), size_(0), closed_(false) {}
+
+  Status Write(const Slice& data) override {
+    if (closed_) {
+      return Status::IOError("closed");
+    }
+    records_->push_back(data.ToString());
+    size_ += data.size();
+    return Status::OK();
+  }
+  Status Close() override {
+    closed_ = true;
+    return Status::OK();
+  }
+  uint64_t GetFileSize() override { return size_; }
+
+ private:
+  std::deque<std::string>* records_;
+  uint64_t size_;
+  bool closed_;
+};
+
+class StringTraceReader : public TraceReader {
+ public:
+  explicit StringTraceReader(std::deque<std::string>* records)
+      : records_(records) {}
+
+  Status Read(std::string* data) override {
+    if (records_->empty()) {
+      return Status::Incomplete();
+    }
+    *data = records_->front();
+    records_->pop_front();
+    return Status::OK();
+  }
+  Status Close() override { return Status::OK(); }
+
+ private:
+  std::deque<std::string>* records_;
+};
+
+FileType FileTypeOf(const std::string& file_name) {
+  uint64_t number;
+  FileType type = kTempFile;
+  ParseFileName(file_name.substr(file_name.find_last_of('/') + 1), &number,
+                &type);
+  return type;
+}
+
+}  // namespace
+
+class IOTracerTest : public testing::Test {
+ protected:
+  IOTracerTest()
+      : env_(NewIOTracingEnv(Env::Default())),
+        dbname_(test::TmpDir() + "/io_tracer_test") {
+    DestroyDB(dbname_, Options());
+  }
+
+  ~IOTracerTest() { DestroyDB(dbname_, Options()); }
+
+  std::unique_ptr<TraceWriter> NewWriter() {
+    return std::unique_ptr<TraceWriter>(new StringTraceWriter(&records_));
+  }
+
+  std::vector<IOTraceRecord> ReadTrace() {
+    IOTraceReader reader(
+        std::unique_ptr<TraceReader>(new StringTraceReader(&records_)));
+    EXPECT_OK(reader.ReadHeader());
+    std::vector<IOTraceRecord> ops;
+    IOTraceRecord record;
+    Status s;
+    while ((s = reader.ReadIOOp(&record)).ok()) {
+      ops.push_back(record);
+    }
+    EXPECT_TRUE(s.IsIncomplete());
+    return ops;
+  }
+
+  std::unique_ptr<IOTracingEnv> env_;
+  std::string dbname_;
+  std::deque<std::string> records_;
+};
+
+TEST_F(IOTracerTest, RoundTrip) {
+  std::string encoded;
+  IOTraceRecord record;
+  record.access_timestamp = 12345;
+  record.latency_nanos = 678;
+  record.file_name = "/db/000010.sst";
+  record.op = IOTraceOp::kMultiRead;
+  record.caller = IOCaller::kUserIterator;
+  record.offset = 1 << 20;
+  record.length = 4096;
+  record.io_size = 100;
+  record.ok = false;
+  EncodeIOTraceRecord(record, &encoded);
+
+  IOTraceRecord decoded;
+  ASSERT_OK(DecodeIOTraceRecord(encoded, &decoded));
+  ASSERT_EQ(record.access_timestamp, decoded.access_timestamp);
+  ASSERT_EQ(record.latency_nanos, decoded.latency_nanos);
+  ASSERT_EQ(record.file_name, decoded.file_name);
+  ASSERT_EQ(record.op, decoded.op);
+  ASSERT_EQ(record.caller, decoded.caller);
+  ASSERT_EQ(record.offset, decoded.offset);
+  ASSERT_EQ(record.length, decoded.length);
+  ASSERT_EQ(record.io_size, decoded.io_size);
+  ASSERT_EQ(record.ok, decoded.ok);
+
+  ASSERT_TRUE(DecodeIOTraceRecord(Slice(encoded.data(), encoded.size() - 1),
+                                  &decoded)
+                  .IsCorruption());
+}
+
+TEST_F(IOTracerTest, AttributesCallers) {
+  Options options;
+  options.create_if_missing = true;
+  options.env = env_.get();
+  DB* db;
+  ASSERT_OK(DB::Open(options, dbname_, &db));
+
+  // Nothing is recorded before the trace starts
+  ASSERT_OK(db->Put(WriteOptions(), "key0", "value"));
+  ASSERT_TRUE(records_.empty());
+
+  ASSERT_OK(env_->StartTrace(IOTraceOptions(), NewWriter()));
+  ASSERT_TRUE(env_->IsTracing());
+  ASSERT_TRUE(env_->StartTrace(IOTraceOptions(), NewWriter()).IsBusy());
+  for (int i = 1; i < 100; i++) {
+    ASSERT_OK(db->Put(WriteOptions(), "key" + ToString(i), "value"));
+  }
+  ASSERT_OK(db->Flush(FlushOptions()));
+  // Overlaps the first file so that the compaction is not a trivial move
+  ASSERT_OK(db->Put(WriteOptions(), "key0", "value"));
+  ASSERT_OK(db->Put(WriteOptions(), "key50", "value"));
+  ASSERT_OK(db->Flush(FlushOptions()));
+  ASSERT_OK(db->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ReadOptions read_options;
+  read_options.fill_cache = false;
+  std::string value;
+  ASSERT_OK(db->Get(read_options, "key50", &value));
+  std::unique_ptr<Iterator> iter(db->NewIterator(read_options));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    count++;
+  }
+  ASSERT_EQ(100, count);
+  iter.reset();
+  ASSERT_OK(env_->EndTrace());
+  ASSERT_FALSE(env_->IsTracing());
+  delete db;
+
+  // Which callers read and wrote which type of file
+  std::set<std::pair<IOCaller, FileType>> reads;
+  std::set<std::pair<IOCaller, FileType>> appends;
+  for (const auto& record : ReadTrace()) {
+    ASSERT_TRUE(record.ok);
+    if (record.op == IOTraceOp::kRead) {
+      ASSERT_GT(record.io_size, 0);
+      reads.insert({record.caller, FileTypeOf(record.file_name)});
+    } else if (record.op == IOTraceOp::kAppend) {
+      appends.insert({record.caller, FileTypeOf(record.file_name)});
+    }
+  }
+  ASSERT_TRUE(appends.count({IOCaller::kUserWrite, kLogFile}));
+  ASSERT_TRUE(appends.count({IOCaller::kFlush, kTableFile}));
+  ASSERT_TRUE(appends.count({IOCaller::kCompaction, kTableFile}));
+  ASSERT_TRUE(reads.count({IOCaller::kCompaction, kTableFile}));
+  ASSERT_TRUE(reads.count({IOCaller::kUserGet, kTableFile}));
+  ASSERT_TRUE(reads.count({IOCaller::kUserIterator, kTableFile}));
+  // Users do not write tables, and flushes and compactions do not write the
+  // WAL
+  ASSERT_FALSE(appends.count({IOCaller::kUserWrite, kTableFile}));
+  ASSERT_FALSE(appends.count({IOCaller::kFlush, kLogFile}));
+  ASSERT_FALSE(appends.count({IOCaller::kCompaction, kLogFile}));
+}
+
+TEST_F(IOTracerTest, SamplesOperations) {
+  const std::string fname = dbname_ + "_sampled";
+  IOTraceOptions options;
+  options.sampling_frequency = 4;
+  ASSERT_OK(env_->StartTrace(options, NewWriter()));
+  unique_ptr<WritableFile> file;
+  ASSERT_OK(env_->NewWritableFile(fname, &file, EnvOptions()));
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(file->Append("x"));
+  }
+  ASSERT_OK(file->Close());
+  ASSERT_OK(env_->EndTrace());
+  ASSERT_OK(env_->DeleteFile(fname));
+
+  uint64_t bytes = 0;
+  for (const auto& record : ReadTrace()) {
+    ASSERT_EQ(fname, record.file_name);
+    if (record.op == IOTraceOp::kAppend) {
+      bytes += record.length;
+    }
+  }
+  ASSERT_EQ(250, bytes);
+}
+
+TEST_F(IOTracerTest, RecordsAppendOffsets) {
+  const std::string fname = dbname_ + "_appended";
+  ASSERT_OK(env_->StartTrace(IOTraceOptions(), NewWriter()));
+  unique_ptr<WritableFile> file;
+  ASSERT_OK(env_->NewWritableFile(fname, &file, EnvOptions()));
+  ASSERT_OK(file->Append("ab"));
+  ASSERT_OK(file->Append("cde"));
+  ASSERT_OK(file->Append("f"));
+  ASSERT_OK(file->Close());
+  ASSERT_OK(env_->EndTrace());
+  ASSERT_OK(env_->DeleteFile(fname));
+
+  std::vector<uint64_t> offsets;
+  for (const auto& record : ReadTrace()) {
+    if (record.op == IOTraceOp::kAppend) {
+      offsets.push_back(record.offset);
+    }
+  }
+  ASSERT_EQ(std::vector<uint64_t>({0, 2, 5}), offsets);
+}
+
+TEST_F(IOTracerTest, TracesManyThreads) {
+  const int kNumThreads = 4;
+  const int kNumAppends = 1000;
+  ASSERT_OK(env_->StartTrace(IOTraceOptions(), NewWriter()));
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumThreads; t++) {
+    threads.emplace_back([&, t]() {
+      const std::string fname = dbname_ + "_thread" + ToString(t);
+      unique_ptr<WritableFile> file;
+      ASSERT_OK(env_->NewWritableFile(fname, &file, EnvOptions()));
+      for (int i = 0; i < kNumAppends; i++) {
+        ASSERT_OK(file->Append("x"));
+      }
+      ASSERT_OK(file->Close());
+      ASSERT_OK(env_->DeleteFile(fname));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_OK(env_->EndTrace());
+
+  // Every append is in the trace, in order for each file
+  std::map<std::string, uint64_t> next_offsets;
+  int num_appends = 0;
+  for (const auto& record : ReadTrace()) {
+    if (record.op == IOTraceOp::kAppend) {
+      ASSERT_EQ(next_offsets[record.file_name], record.offset);
+      next_offsets[record.file_name]++;
+      num_appends++;
+    }
+  }
+  ASSERT_EQ(kNumThreads * kNumAppends, num_appends);
+}
+
+TEST_F(IOTracerTest, StopsAtMaxTraceFileSize) {
+  const std::string fname = dbname_ + "_limited";
+  IOTraceOptions options;
+  options.max_trace_file_size = 1000;
+  ASSERT_OK(env_->StartTrace(options, NewWriter()));
+  unique_ptr<WritableFile> file;
+  ASSERT_OK(env_->NewWritableFile(fname, &file, EnvOptions()));
+  for (int i = 0; i < 1000 && env_->IsTracing(); i++) {
+    ASSERT_OK(file->Append("x"));
+  }
+  ASSERT_FALSE(env_->IsTracing());
+  ASSERT_OK(file->Close());
+  ASSERT_OK(env_->DeleteFile(fname));
+  ASSERT_LT(ReadTrace().size(), 1000);
+}
+
+TEST_F(IOTracerTest, RejectsOtherTraces) {
+  records_.push_back("not a trace header");
+  IOTraceReader reader(
+      std::unique_ptr<TraceReader>(new StringTraceReader(&records_)));
+  ASSERT_TRUE(reader.ReadHeader().IsCorruption());
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -18,10 +18,110 @@
 #include <stdlib.h>
 #include <string>
 
+#include "util/compression.h"
 #include "util/mutexlock.h"
 
 namespace rocksdb {
 
+namespace {
+// Format version of the compressed tier entries: the uncompressed size is
+// stored in front of the compressed bytes.
+const uint32_t kCompressedTierFormatVersion = 2;
+
+// An entry of the compressed tier
+struct CompressedTierEntry {
+  // Rebuilds the value on promotion
+  const CacheTierHelper* helper;
+  CompressionType compression_type;
+  // Serialized value, compressed with compression_type
+  std::string data;
+};
+
+void DeleteCompressedTierEntry(const Slice& key, void* value) {
+  delete reinterpret_cast<CompressedTierEntry*>(value);
+}
+
+bool CompressForTier(CompressionType type, const std::string& raw,
+                     std::string* output) {
+  CompressionOptions opts;
+  switch (type) {
+    case kSnappyCompression:
+      return Snappy_Compress(opts, raw.data(), raw.size(), output);
+    case kZlibCompression:
+      return Zlib_Compress(opts, kCompressedTierFormatVersion, raw.data(),
+                           raw.size(), output);
+    case kBZip2Compression:
+      return BZip2_Compress(opts, kCompressedTierFormatVersion, raw.data(),
+                            raw.size(), output);
+    case kLZ4Compression:
+      return LZ4_Compress(opts, kCompressedTierFormatVersion, raw.data(),
+                          raw.size(), output);
+    case kLZ4HCCompression:
+      return LZ4HC_Compress(opts, kCompressedTierFormatVersion, raw.data(),
+                            raw.size(), output);
+    case kXpressCompression:
+      return XPRESS_Compress(raw.data(), raw.size(), output);
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      return ZSTD_Compress(opts, raw.data(), raw.size(), output);
+    default:
+      return false;
+  }
+}
+
+// Returns the uncompressed bytes of entry, using *buf for storage if needed.
+bool UncompressFromTier(const CompressedTierEntry& entry,
+                        std::unique_ptr<char[]>* buf, Slice* result) {
+  const char* data = entry.data.data();
+  size_t size = entry.data.size();
+  int decompress_size = 0;
+  switch (entry.compression_type) {
+    case kNoCompression:
+      *result = Slice(data, size);
+      return true;
+    case kSnappyCompression: {
+      size_t ulength = 0;
+      if (!Snappy_GetUncompressedLength(data, size, &ulength)) {
+        return false;
+      }
+      buf->reset(new char[ulength]);
+      if (!Snappy_Uncompress(data, size, buf->get())) {
+        return false;
+      }
+      *result = Slice(buf->get(), ulength);
+      return true;
+    }
+    case kZlibCompression:
+      buf->reset(Zlib_Uncompress(data, size, &decompress_size,
+                                 kCompressedTierFormatVersion));
+      break;
+    case kBZip2Compression:
+      buf->reset(BZip2_Uncompress(data, size, &decompress_size,
+                                  kCompressedTierFormatVersion));
+      break;
+    case kLZ4Compression:
+    case kLZ4HCCompression:
+      buf->reset(LZ4_Uncompress(data, size, &decompress_size,
+                                kCompressedTierFormatVersion));
+      break;
+    case kXpressCompression:
+      buf->reset(XPRESS_Uncompress(data, size, &decompress_size));
+      break;
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      buf->reset(ZSTD_Uncompress(data, size, &decompress_size));
+      break;
+    default:
+      return false;
+  }
+  if (!*buf) {
+    return false;
+  }
+  *result = Slice(buf->get(), decompress_size);
+  return true;
+}
+}  // namespace
+
 LRUHandleTable::LRUHandleTable() : length_(0), elems_(0), list_(nullptr) {
   Resize();
 }
@@ -100,7 +200,11 @@ void LRUHandleTable::Resize() {
 }
 
 LRUCacheShard::LRUCacheShard()
-    : usage_(0), lru_usage_(0), high_pri_pool_usage_(0) {
+    : usage_(0),
+      lru_usage_(0),
+      high_pri_pool_usage_(0),
+      compressed_tier_(nullptr),
+      compressed_tier_compression_(kNoCompression) {
   // Make empty circular linked list
   lru_.next = &lru_;
   lru_.prev = &lru_;
@@ -152,6 +256,30 @@ void LRUCacheShard::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
   }
 }
 
+void LRUCacheShard::GetHotKeys(
+    size_t max_entries,
+    std::vector<std::pair<std::string, Cache::Priority>>* keys) {
+  MutexLock l(&mutex_);
+  size_t count = 0;
+  auto add = [&](LRUHandle* h) {
+    keys->emplace_back(h->key().ToString(), h->IsHighPri()
+                                                ? Cache::Priority::HIGH
+                                                : Cache::Priority::LOW);
+    count++;
+  };
+  // Entries in use by clients are not on the LRU list
+  table_.ApplyToAllCacheEntries([&](LRUHandle* h) {
+    if (count < max_entries && h->refs > 1) {
+      add(h);
+    }
+  });
+  // The head of the LRU list is the most recently used entry
+  for (LRUHandle* h = lru_.prev; h != &lru_ && count < max_entries;
+       h = h->prev) {
+    add(h);
+  }
+}
+
 void LRUCacheShard::TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri) {
   *lru = &lru_;
   *lru_low_pri = lru_low_pri_;
@@ -233,9 +361,7 @@ void LRUCacheShard::SetCapacity(size_t capacity) {
   }
   // we free the entries here outside of mutex for
   // performance reasons
-  for (auto entry : last_reference_list) {
-    entry->Free();
-  }
+  FreeEvicted(last_reference_list);
 }
 
 void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
@@ -244,16 +370,119 @@ void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
 }
 
 Cache::Handle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash) {
+  {
+    MutexLock l(&mutex_);
+    if (admission_filter_ != nullptr) {
+      admission_filter_->Increment(hash);
+    }
+    LRUHandle* e = table_.Lookup(key, hash);
+    if (e != nullptr) {
+      assert(e->InCache());
+      if (e->refs == 1) {
+        LRU_Remove(e);
+      }
+      e->refs++;
+      return reinterpret_cast<Cache::Handle*>(e);
+    }
+  }
+  if (compressed_tier_ != nullptr) {
+    return PromoteFromCompressedTier(key, hash);
+  }
+  return nullptr;
+}
+
+Cache::Handle* LRUCacheShard::PromoteFromCompressedTier(const Slice& key,
+                                                        uint32_t hash) {
+  Cache::Handle* tier_handle = compressed_tier_->Lookup(key);
+  if (tier_handle == nullptr) {
+    return nullptr;
+  }
+  auto* entry = reinterpret_cast<CompressedTierEntry*>(
+      compressed_tier_->Value(tier_handle));
+  const CacheTierHelper* helper = entry->helper;
+  void* value = nullptr;
+  size_t charge = 0;
+  std::unique_ptr<char[]> buf;
+  Slice data;
+  Status s;
+  if (UncompressFromTier(*entry, &buf, &data)) {
+    s = helper->create(data, &value, &charge);
+  } else {
+    s = Status::Corruption("Cannot uncompress compressed tier entry");
+  }
+  compressed_tier_->Release(tier_handle);
+  // The entry lives in one tier at a time
+  compressed_tier_->Erase(key);
+  if (!s.ok()) {
+    return nullptr;
+  }
+
+  Cache::Handle* handle = nullptr;
+  s = InsertImpl(key, hash, value, charge, helper->deleter, helper, &handle,
+                 Cache::Priority::LOW);
+  if (!s.ok()) {
+    (*helper->deleter)(key, value);
+    return nullptr;
+  }
+  return handle;
+}
+
+void LRUCacheShard::SetAdmissionFilter(bool use_admission_filter) {
   MutexLock l(&mutex_);
-  LRUHandle* e = table_.Lookup(key, hash);
-  if (e != nullptr) {
-    assert(e->InCache());
-    if (e->refs == 1) {
-      LRU_Remove(e);
+  if (use_admission_filter) {
+    admission_filter_.reset(new FrequencySketch());
+  } else {
+    admission_filter_.reset();
+  }
+}
+
+bool LRUCacheShard::Admit(LRUHandle* e) {
+  if (admission_filter_ == nullptr || e->IsHighPri() ||
+      usage_ + e->charge <= capacity_ || lru_.next == &lru_) {
+    return true;
+  }
+  // Replacing an entry that is already cached does not need room
+  if (table_.Lookup(e->key(), e->hash) != nullptr) {
+    return true;
+  }
+  admission_filter_->EnsureCapacity(table_.elems());
+  // Compare with the entry that would be evicted first
+  LRUHandle* victim = lru_.next;
+  return admission_filter_->Estimate(e->hash) >
+         admission_filter_->Estimate(victim->hash);
+}
+
+void LRUCacheShard::SetCompressedTier(Cache* compressed_tier,
+                                      CompressionType compression_type) {
+  compressed_tier_ = compressed_tier;
+  compressed_tier_compression_ = compression_type;
+}
+
+void LRUCacheShard::FreeEvicted(const autovector<LRUHandle*>& evicted) {
+  for (auto entry : evicted) {
+    if (compressed_tier_ != nullptr && entry->tier_helper != nullptr) {
+      std::string raw;
+      (*entry->tier_helper->save)(entry->value, &raw);
+      auto* tier_entry = new CompressedTierEntry();
+      tier_entry->helper = entry->tier_helper;
+      tier_entry->compression_type = compressed_tier_compression_;
+      if (compressed_tier_compression_ == kNoCompression ||
+          !CompressForTier(compressed_tier_compression_, raw,
+                           &tier_entry->data) ||
+          tier_entry->data.size() >= raw.size()) {
+        // Not worth compressing
+        tier_entry->compression_type = kNoCompression;
+        tier_entry->data.swap(raw);
+      }
+      // Compressors leave room for the worst case in the output buffer
+      tier_entry->data.shrink_to_fit();
+      compressed_tier_->Insert(entry->key(), tier_entry,
+                               sizeof(CompressedTierEntry) +
+                                   tier_entry->data.size(),
+                               &DeleteCompressedTierEntry);
     }
-    e->refs++;
+    entry->Free();
   }
-  return reinterpret_cast<Cache::Handle*>(e);
 }
 
 bool LRUCacheShard::Ref(Cache::Handle* h) {
@@ -279,10 +508,11 @@ void LRUCacheShard::Release(Cache::Handle* handle) {
   }
   LRUHandle* e = reinterpret_cast<LRUHandle*>(handle);
   bool last_reference = false;
+  bool evicted = false;
   {
     MutexLock l(&mutex_);
     last_reference = Unref(e);
-    if (last_reference) {
+    if (last_reference && e->IsCharged()) {
       usage_ -= e->charge;
     }
     if (e->refs == 1 && e->InCache()) {
@@ -297,6 +527,7 @@ void LRUCacheShard::Release(Cache::Handle* handle) {
         Unref(e);
         usage_ -= e->charge;
         last_reference = true;
+        evicted = true;
       } else {
         // put the item on the list to be potentially freed
         LRU_Insert(e);
@@ -305,7 +536,11 @@ void LRUCacheShard::Release(Cache::Handle* handle) {
   }
 
   // free outside of mutex
-  if (last_reference) {
+  if (evicted) {
+    autovector<LRUHandle*> evicted_list;
+    evicted_list.push_back(e);
+    FreeEvicted(evicted_list);
+  } else if (last_reference) {
     e->Free();
   }
 }
@@ -314,6 +549,25 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
                              size_t charge,
                              void (*deleter)(const Slice& key, void* value),
                              Cache::Handle** handle, Cache::Priority priority) {
+  return InsertImpl(key, hash, value, charge, deleter, nullptr, handle,
+                    priority);
+}
+
+Status LRUCacheShard::InsertWithHelper(const Slice& key, uint32_t hash,
+                                       void* value, size_t charge,
+                                       const CacheTierHelper* helper,
+                                       Cache::Handle** handle,
+                                       Cache::Priority priority) {
+  return InsertImpl(key, hash, value, charge, helper->deleter, helper, handle,
+                    priority);
+}
+
+Status LRUCacheShard::InsertImpl(const Slice& key, uint32_t hash, void* value,
+                                 size_t charge,
+                                 void (*deleter)(const Slice& key, void* value),
+                                 const CacheTierHelper* helper,
+                                 Cache::Handle** handle,
+                                 Cache::Priority priority) {
   // Allocate the memory here outside of the mutex
   // If the cache is full, we'll have to release it
   // It shouldn't happen very often though.
@@ -321,9 +575,12 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
       new char[sizeof(LRUHandle) - 1 + key.size()]);
   Status s;
   autovector<LRUHandle*> last_reference_list;
+  // Entries pushed out by this insert, as opposed to replaced or rejected
+  autovector<LRUHandle*> evicted_list;
 
   e->value = value;
   e->deleter = deleter;
+  e->tier_helper = helper;
   e->charge = charge;
   e->key_length = key.size();
   e->hash = hash;
@@ -333,6 +590,7 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
   e->next = e->prev = nullptr;
   e->SetInCache(true);
   e->SetPriority(priority);
+  e->SetCharged(true);
   memcpy(e->key_data, key.data(), key.size());
 
   {
@@ -340,14 +598,29 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
 
     // Free the space following strict LRU policy until enough space
     // is freed or the lru list is empty
-    EvictFromLRU(charge, &last_reference_list);
+    bool admitted = Admit(e);
+    if (admitted) {
+      EvictFromLRU(charge, &evicted_list);
+    }
 
-    if (usage_ - lru_usage_ + charge > capacity_ &&
-        (strict_capacity_limit_ || handle == nullptr)) {
+    if (!admitted) {
+      if (handle == nullptr) {
+        // As if the entry was inserted and evicted immediately
+        last_reference_list.push_back(e);
+      } else {
+        // Hand out an entry that is not in the cache. It is freed when the
+        // handle is released, and never counts towards the usage.
+        e->SetInCache(false);
+        e->SetCharged(false);
+        e->refs = 1;
+        *handle = reinterpret_cast<Cache::Handle*>(e);
+      }
+    } else if (usage_ - lru_usage_ + charge > capacity_ &&
+               (strict_capacity_limit_ || handle == nullptr)) {
       if (handle == nullptr) {
         // Don't insert the entry but still return ok, as if the entry inserted
         // into cache and get evicted immediately.
-        last_reference_list.push_back(e);
+        evicted_list.push_back(e);
       } else {
         delete[] reinterpret_cast<char*>(e);
         *handle = nullptr;
@@ -380,9 +653,14 @@ Status LRUCacheShard::Insert(const Slice& key, uint32_t hash, void* value,
 
   // we free the entries here outside of mutex for
   // performance reasons
+  FreeEvicted(evicted_list);
   for (auto entry : last_reference_list) {
     entry->Free();
   }
+  // The new value replaces any demoted copy of the key
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->Erase(key);
+  }
 
   return s;
 }
@@ -410,6 +688,9 @@ void LRUCacheShard::Erase(const Slice& key, uint32_t hash) {
   if (last_reference) {
     e->Free();
   }
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->Erase(key);
+  }
 }
 
 size_t LRUCacheShard::GetUsage() const {
@@ -428,21 +709,41 @@ std::string LRUCacheShard::GetPrintableOptions() const {
   char buffer[kBufferSize];
   {
     MutexLock l(&mutex_);
-    snprintf(buffer, kBufferSize, "    high_pri_pool_ratio: %.3lf\n",
-             high_pri_pool_ratio_);
+    snprintf(buffer, kBufferSize,
+             "    high_pri_pool_ratio: %.3lf\n"
+             "    use_admission_filter: %d\n",
+             high_pri_pool_ratio_, admission_filter_ != nullptr);
   }
   return std::string(buffer);
 }
 
 LRUCache::LRUCache(size_t capacity, int num_shard_bits,
-                   bool strict_capacity_limit, double high_pri_pool_ratio)
-    : ShardedCache(capacity, num_shard_bits, strict_capacity_limit) {
+                   bool strict_capacity_limit, double high_pri_pool_ratio,
+                   double compressed_tier_ratio,
+                   CompressionType compressed_tier_compression,
+                   bool use_admission_filter)
+    : ShardedCache(capacity, num_shard_bits, strict_capacity_limit),
+      compressed_tier_ratio_(compressed_tier_ratio),
+      compressed_tier_compression_(
+          CompressionTypeSupported(compressed_tier_compression)
+              ? compressed_tier_compression
+              : kNoCompression) {
   int num_shards = 1 << num_shard_bits;
   shards_ = new LRUCacheShard[num_shards];
+  if (compressed_tier_ratio_ > 0) {
+    compressed_tier_ = std::make_shared<LRUCache>(
+        static_cast<size_t>(capacity * compressed_tier_ratio_),
+        num_shard_bits, false /* strict_capacity_limit */, 0.0);
+    for (int i = 0; i < num_shards; i++) {
+      shards_[i].SetCompressedTier(compressed_tier_.get(),
+                                   compressed_tier_compression_);
+    }
+  }
   SetCapacity(capacity);
   SetStrictCapacityLimit(strict_capacity_limit);
   for (int i = 0; i < num_shards; i++) {
     shards_[i].SetHighPriorityPoolRatio(high_pri_pool_ratio);
+    shards_[i].SetAdmissionFilter(use_admission_filter);
   }
 }
 
@@ -468,11 +769,67 @@ uint32_t LRUCache::GetHash(Handle* handle) const {
   return reinterpret_cast<const LRUHandle*>(handle)->hash;
 }
 
-void LRUCache::DisownData() { shards_ = nullptr; }
+void LRUCache::DisownData() {
+  shards_ = nullptr;
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->DisownData();
+  }
+}
+
+void LRUCache::SetCapacity(size_t capacity) {
+  if (compressed_tier_ == nullptr) {
+    ShardedCache::SetCapacity(capacity);
+    return;
+  }
+  size_t tier_capacity = static_cast<size_t>(capacity * compressed_tier_ratio_);
+  ShardedCache::SetCapacity(capacity - tier_capacity);
+  compressed_tier_->SetCapacity(tier_capacity);
+}
+
+size_t LRUCache::GetCapacity() const {
+  size_t capacity = ShardedCache::GetCapacity();
+  if (compressed_tier_ != nullptr) {
+    capacity += compressed_tier_->GetCapacity();
+  }
+  return capacity;
+}
+
+size_t LRUCache::GetUsage() const {
+  return ShardedCache::GetUsage() + GetCompressedTierUsage();
+}
+
+size_t LRUCache::GetPinnedUsage() const {
+  size_t usage = ShardedCache::GetPinnedUsage();
+  if (compressed_tier_ != nullptr) {
+    usage += compressed_tier_->GetPinnedUsage();
+  }
+  return usage;
+}
+
+size_t LRUCache::GetCompressedTierUsage() const {
+  return compressed_tier_ != nullptr ? compressed_tier_->GetUsage() : 0;
+}
+
+std::string LRUCache::GetPrintableOptions() const {
+  std::string ret = ShardedCache::GetPrintableOptions();
+  if (compressed_tier_ != nullptr) {
+    const int kBufferSize = 200;
+    char buffer[kBufferSize];
+    snprintf(buffer, kBufferSize,
+             "    compressed_tier_capacity : %" ROCKSDB_PRIszt "\n",
+             compressed_tier_->GetCapacity());
+    ret.append(buffer);
+    snprintf(buffer, kBufferSize, "    compressed_tier_compression : %s\n",
+             CompressionTypeToString(compressed_tier_compression_).c_str());
+    ret.append(buffer);
+  }
+  return ret;
+}
 
 std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
                                    bool strict_capacity_limit,
-                                   double high_pri_pool_ratio) {
+                                   double high_pri_pool_ratio,
+                                   bool use_admission_filter) {
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
@@ -483,8 +840,36 @@ std::shared_ptr<Cache> NewLRUCache(size_t capacity, int num_shard_bits,
   if (num_shard_bits < 0) {
     num_shard_bits = GetDefaultCacheShardBits(capacity);
   }
+  return std::make_shared<LRUCache>(
+      capacity, num_shard_bits, strict_capacity_limit, high_pri_pool_ratio,
+      0.0 /* compressed_tier_ratio */, kNoCompression, use_admission_filter);
+}
+
+std::shared_ptr<Cache> NewTieredLRUCache(size_t capacity,
+                                         double compressed_tier_ratio,
+                                         CompressionType compression_type,
+                                         int num_shard_bits,
+                                         bool strict_capacity_limit,
+                                         double high_pri_pool_ratio,
+                                         bool use_admission_filter) {
+  if (num_shard_bits >= 20) {
+    return nullptr;  // the cache cannot be sharded into too many fine pieces
+  }
+  if (high_pri_pool_ratio < 0.0 || high_pri_pool_ratio > 1.0) {
+    // invalid high_pri_pool_ratio
+    return nullptr;
+  }
+  if (compressed_tier_ratio < 0.0 || compressed_tier_ratio >= 1.0) {
+    // invalid compressed_tier_ratio
+    return nullptr;
+  }
+  if (num_shard_bits < 0) {
+    num_shard_bits = GetDefaultCacheShardBits(capacity);
+  }
   return std::make_shared<LRUCache>(capacity, num_shard_bits,
-                                    strict_capacity_limit, high_pri_pool_ratio);
+                                    strict_capacity_limit, high_pri_pool_ratio,
+                                    compressed_tier_ratio, compression_type,
+                                    use_admission_filter);
 }
 
 }  // namespace rocksdb
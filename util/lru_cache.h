@@ -8,12 +8,15 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "util/sharded_cache.h"
 
 #include "port/port.h"
+#include "rocksdb/options.h"
 #include "util/autovector.h"
+#include "util/frequency_sketch.h"
 
 namespace rocksdb {
 
@@ -46,6 +49,8 @@ namespace rocksdb {
 struct LRUHandle {
   void* value;
   void (*deleter)(const Slice&, void* value);
+  // Set if the entry can be moved to the compressed tier on eviction
+  const CacheTierHelper* tier_helper;
   LRUHandle* next_hash;
   LRUHandle* next;
   LRUHandle* prev;
@@ -58,6 +63,7 @@ struct LRUHandle {
   //   in_cache:    whether this entry is referenced by the hash table.
   //   is_high_pri: whether this entry is high priority entry.
   //   in_high_pro_pool: whether this entry is in high-pri pool.
+  //   is_charged:  whether the charge of this entry counts towards usage.
   char flags;
 
   uint32_t hash;     // Hash of key(); used for fast sharding and comparisons
@@ -77,6 +83,7 @@ struct LRUHandle {
   bool InCache() { return flags & 1; }
   bool IsHighPri() { return flags & 2; }
   bool InHighPriPool() { return flags & 4; }
+  bool IsCharged() { return flags & 8; }
 
   void SetInCache(bool in_cache) {
     if (in_cache) {
@@ -102,6 +109,14 @@ struct LRUHandle {
     }
   }
 
+  void SetCharged(bool charged) {
+    if (charged) {
+      flags |= 8;
+    } else {
+      flags &= ~8;
+    }
+  }
+
   void Free() {
     assert((refs == 1 && InCache()) || (refs == 0 && !InCache()));
     if (deleter) {
@@ -125,6 +140,9 @@ class LRUHandleTable {
   LRUHandle* Insert(LRUHandle* h);
   LRUHandle* Remove(const Slice& key, uint32_t hash);
 
+  // Number of entries in the table
+  uint32_t elems() const { return elems_; }
+
   template <typename T>
   void ApplyToAllCacheEntries(T func) {
     for (uint32_t i = 0; i < length_; i++) {
@@ -176,6 +194,10 @@ class LRUCacheShard : public CacheShard {
                         void (*deleter)(const Slice& key, void* value),
                         Cache::Handle** handle,
                         Cache::Priority priority) override;
+  virtual Status InsertWithHelper(const Slice& key, uint32_t hash, void* value,
+                                  size_t charge, const CacheTierHelper* helper,
+                                  Cache::Handle** handle,
+                                  Cache::Priority priority) override;
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) override;
   virtual bool Ref(Cache::Handle* handle) override;
   virtual void Release(Cache::Handle* handle) override;
@@ -193,11 +215,42 @@ class LRUCacheShard : public CacheShard {
 
   virtual void EraseUnRefEntries() override;
 
+  virtual void GetHotKeys(
+      size_t max_entries,
+      std::vector<std::pair<std::string, Cache::Priority>>* keys) override;
+
   virtual std::string GetPrintableOptions() const override;
 
+  // If enabled, a low priority entry is only inserted into a full shard if
+  // it was accessed more often recently than the entry it would evict.
+  void SetAdmissionFilter(bool use_admission_filter);
+
+  // Entries evicted from this shard that have a CacheTierHelper are moved
+  // to compressed_tier, compressed with compression_type.
+  void SetCompressedTier(Cache* compressed_tier,
+                         CompressionType compression_type);
+
   void TEST_GetLRUList(LRUHandle** lru, LRUHandle** lru_low_pri);
 
  private:
+  Status InsertImpl(const Slice& key, uint32_t hash, void* value,
+                    size_t charge, void (*deleter)(const Slice& key, void* value),
+                    const CacheTierHelper* helper, Cache::Handle** handle,
+                    Cache::Priority priority);
+
+  // Whether e may be inserted, according to the admission filter. Always
+  // true without one.
+  // REQUIRES: mutex_ held
+  bool Admit(LRUHandle* e);
+
+  // Free evicted entries, first saving the ones that have a CacheTierHelper
+  // to the compressed tier. Must be called without holding mutex_.
+  void FreeEvicted(const autovector<LRUHandle*>& evicted);
+
+  // Move the entry for key from the compressed tier back into this shard.
+  // Returns nullptr if it is not there.
+  Cache::Handle* PromoteFromCompressedTier(const Slice& key, uint32_t hash);
+
   void LRU_Remove(LRUHandle* e);
   void LRU_Insert(LRUHandle* e);
 
@@ -251,12 +304,21 @@ class LRUCacheShard : public CacheShard {
   LRUHandle* lru_low_pri_;
 
   LRUHandleTable table_;
+
+  // Recent access frequencies of the keys for admission, or nullptr
+  std::unique_ptr<FrequencySketch> admission_filter_;
+
+  // Second tier holding compressed evicted entries, or nullptr. Not owned.
+  Cache* compressed_tier_;
+  CompressionType compressed_tier_compression_;
 };
 
 class LRUCache : public ShardedCache {
  public:
   LRUCache(size_t capacity, int num_shard_bits, bool strict_capacity_limit,
-           double high_pri_pool_ratio);
+           double high_pri_pool_ratio, double compressed_tier_ratio = 0.0,
+           CompressionType compressed_tier_compression = kNoCompression,
+           bool use_admission_filter = false);
   virtual ~LRUCache();
   virtual const char* Name() const override { return "LRUCache"; }
   virtual CacheShard* GetShard(int shard) override;
@@ -266,8 +328,22 @@ class LRUCache : public ShardedCache {
   virtual uint32_t GetHash(Handle* handle) const override;
   virtual void DisownData() override;
 
+  // With a compressed tier, capacity and usage cover both tiers
+  virtual void SetCapacity(size_t capacity) override;
+  virtual size_t GetCapacity() const override;
+  using ShardedCache::GetUsage;
+  virtual size_t GetUsage() const override;
+  virtual size_t GetPinnedUsage() const override;
+  virtual std::string GetPrintableOptions() const override;
+
+  // Usage of the compressed tier alone
+  size_t GetCompressedTierUsage() const;
+
  private:
   LRUCacheShard* shards_;
+  const double compressed_tier_ratio_;
+  const CompressionType compressed_tier_compression_;
+  std::shared_ptr<Cache> compressed_tier_;
 };
 
 }  // namespace rocksdb
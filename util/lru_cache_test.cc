@@ -7,6 +7,8 @@
 
 #include <string>
 #include <vector>
+#include "util/hash.h"
+#include "util/string_util.h"
 #include "util/testharness.h"
 
 namespace rocksdb {
@@ -16,16 +18,23 @@ class LRUCacheTest : public testing::Test {
   LRUCacheTest() {}
   ~LRUCacheTest() {}
 
-  void NewCache(size_t capacity, double high_pri_pool_ratio = 0.0) {
+  void NewCache(size_t capacity, double high_pri_pool_ratio = 0.0,
+                bool use_admission_filter = false) {
     cache_.reset(new LRUCacheShard());
     cache_->SetCapacity(capacity);
     cache_->SetStrictCapacityLimit(false);
     cache_->SetHighPriorityPoolRatio(high_pri_pool_ratio);
+    cache_->SetAdmissionFilter(use_admission_filter);
+  }
+
+  // The admission filter tells keys apart by their hash
+  static uint32_t HashKey(const std::string& key) {
+    return Hash(key.data(), key.size(), 0);
   }
 
   void Insert(const std::string& key,
               Cache::Priority priority = Cache::Priority::LOW) {
-    cache_->Insert(key, 0 /*hash*/, nullptr /*value*/, 1 /*charge*/,
+    cache_->Insert(key, HashKey(key), nullptr /*value*/, 1 /*charge*/,
                    nullptr /*deleter*/, nullptr /*handle*/, priority);
   }
 
@@ -33,8 +42,27 @@ class LRUCacheTest : public testing::Test {
     Insert(std::string(1, key), priority);
   }
 
+  Cache::Handle* InsertAndHold(const std::string& key) {
+    Cache::Handle* handle = nullptr;
+    EXPECT_OK(cache_->Insert(key, HashKey(key), nullptr /*value*/,
+                             1 /*charge*/, nullptr /*deleter*/, &handle,
+                             Cache::Priority::LOW));
+    return handle;
+  }
+
+  void Release(Cache::Handle* handle) { cache_->Release(handle); }
+
+  size_t GetUsage() { return cache_->GetUsage(); }
+
+  std::vector<std::pair<std::string, Cache::Priority>> GetHotKeys(
+      size_t max_entries) {
+    std::vector<std::pair<std::string, Cache::Priority>> keys;
+    cache_->GetHotKeys(max_entries, &keys);
+    return keys;
+  }
+
   bool Lookup(const std::string& key) {
-    auto handle = cache_->Lookup(key, 0 /*hash*/);
+    auto handle = cache_->Lookup(key, HashKey(key));
     if (handle) {
       cache_->Release(handle);
       return true;
@@ -44,7 +72,7 @@ class LRUCacheTest : public testing::Test {
 
   bool Lookup(char key) { return Lookup(std::string(1, key)); }
 
-  void Erase(const std::string& key) { cache_->Erase(key, 0 /*hash*/); }
+  void Erase(const std::string& key) { cache_->Erase(key, HashKey(key)); }
 
   void ValidateLRUList(std::vector<std::string> keys,
                        size_t num_high_pri_pool_keys = 0) {
@@ -155,6 +183,213 @@ TEST_F(LRUCacheTest, MidPointInsertion) {
   ValidateLRUList({"e", "f", "g", "d", "Z"}, 1);
 }
 
+TEST_F(LRUCacheTest, GetHotKeys) {
+  NewCache(5, 0.5);
+  Insert("a", Cache::Priority::HIGH);
+  Insert("b");
+  Insert("c");
+  Cache::Handle* held = InsertAndHold("d");
+  Lookup("b");
+
+  // Referenced entries first, then most recently used first
+  auto keys = GetHotKeys(10);
+  ASSERT_EQ(4U, keys.size());
+  ASSERT_EQ("d", keys[0].first);
+  ASSERT_EQ("a", keys[1].first);
+  ASSERT_EQ(Cache::Priority::HIGH, keys[1].second);
+  ASSERT_EQ("b", keys[2].first);
+  ASSERT_EQ(Cache::Priority::LOW, keys[2].second);
+  ASSERT_EQ("c", keys[3].first);
+
+  keys = GetHotKeys(2);
+  ASSERT_EQ(2U, keys.size());
+  ASSERT_EQ("a", keys[1].first);
+  Release(held);
+}
+
+TEST_F(LRUCacheTest, AdmissionFilter) {
+  NewCache(5, 0.0 /* high_pri_pool_ratio */, true /* use_admission_filter */);
+  // A hot set that fills the cache
+  for (char key = 'a'; key <= 'e'; key++) {
+    for (int i = 0; i < 3; i++) {
+      if (!Lookup(key)) {
+        Insert(key);
+      }
+    }
+  }
+  ValidateLRUList({"a", "b", "c", "d", "e"});
+
+  // A scan of keys read once does not push it out
+  for (int i = 0; i < 100; i++) {
+    std::string key = "scan" + ToString(i);
+    ASSERT_FALSE(Lookup(key));
+    Insert(key);
+  }
+  ValidateLRUList({"a", "b", "c", "d", "e"});
+
+  // A key that becomes hot gets in
+  for (int i = 0; i < 5; i++) {
+    ASSERT_FALSE(Lookup("f"));
+  }
+  Insert("f");
+  ASSERT_TRUE(Lookup("f"));
+  ValidateLRUList({"b", "c", "d", "e", "f"});
+
+  // High priority entries are always admitted
+  Insert("g", Cache::Priority::HIGH);
+  ASSERT_TRUE(Lookup("g"));
+}
+
+TEST_F(LRUCacheTest, AdmissionFilterWithHandle) {
+  NewCache(2, 0.0 /* high_pri_pool_ratio */, true /* use_admission_filter */);
+  for (int i = 0; i < 3; i++) {
+    Lookup("a");
+    Lookup("b");
+  }
+  Insert("a");
+  Insert("b");
+
+  // A rejected entry can still be used through its handle
+  Cache::Handle* handle = InsertAndHold("c");
+  ASSERT_TRUE(handle != nullptr);
+  // which does not count towards the usage of the cache
+  ASSERT_EQ(2U, GetUsage());
+  ASSERT_LE(GetUsage(), 2U /* capacity */);
+  Release(handle);
+  ASSERT_EQ(2U, GetUsage());
+  ASSERT_FALSE(Lookup("c"));
+  ValidateLRUList({"a", "b"});
+}
+
+TEST_F(LRUCacheTest, FrequencySketch) {
+  FrequencySketch sketch;
+  sketch.EnsureCapacity(1000);
+  ASSERT_EQ(0U, sketch.Estimate(1));
+  // The first access only goes to the doorkeeper
+  sketch.Increment(1);
+  ASSERT_EQ(1U, sketch.Estimate(1));
+  for (int i = 0; i < 100; i++) {
+    sketch.Increment(2);
+  }
+  ASSERT_EQ(FrequencySketch::kMaxFrequency, sketch.Estimate(2));
+  ASSERT_EQ(1U, sketch.Estimate(1));
+
+  // Old accesses fade out
+  for (uint32_t i = 0; i < 100000; i++) {
+    sketch.Increment(1000 + i);
+  }
+  ASSERT_LT(sketch.Estimate(2), FrequencySketch::kMaxFrequency / 2);
+}
+
+namespace {
+void SaveString(void* value, std::string* output) {
+  output->append(*reinterpret_cast<std::string*>(value));
+}
+
+Status CreateString(const Slice& data, void** value, size_t* charge) {
+  *value = new std::string(data.ToString());
+  *charge = data.size();
+  return Status::OK();
+}
+
+void DeleteString(const Slice& key, void* value) {
+  delete reinterpret_cast<std::string*>(value);
+}
+
+const CacheTierHelper kStringHelper = {&SaveString, &CreateString,
+                                       &DeleteString};
+}  // namespace
+
+TEST_F(LRUCacheTest, CompressedTier) {
+  const size_t kValueSize = 1000;
+  // 5 values fit in the uncompressed tier
+  std::shared_ptr<Cache> cache = NewTieredLRUCache(
+      10 * kValueSize, 0.5, kZlibCompression, 0 /* num_shard_bits */);
+  ASSERT_TRUE(cache != nullptr);
+  ASSERT_EQ(10 * kValueSize, cache->GetCapacity());
+
+  auto key = [](int i) { return "key" + ToString(i); };
+  auto value = [](int i) { return std::string(kValueSize, 'a' + i); };
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(cache->InsertWithHelper(key(i), new std::string(value(i)),
+                                      kValueSize, &kStringHelper));
+  }
+  // Everything is still there: the oldest values moved to the second tier
+  LRUCache* lru_cache = static_cast<LRUCache*>(cache.get());
+  ASSERT_GT(lru_cache->GetCompressedTierUsage(), 0U);
+  ASSERT_LE(cache->GetUsage(), cache->GetCapacity());
+  for (int i = 0; i < 10; i++) {
+    Cache::Handle* handle = cache->Lookup(key(i));
+    ASSERT_TRUE(handle != nullptr);
+    ASSERT_EQ(value(i), *reinterpret_cast<std::string*>(cache->Value(handle)));
+    cache->Release(handle);
+  }
+
+  // Entries inserted without a helper are dropped on eviction
+  ASSERT_OK(cache->Insert("plain", new std::string(value(0)), kValueSize,
+                          &DeleteString));
+  for (int i = 0; i < 10; i++) {
+    Cache::Handle* handle = cache->Lookup(key(i));
+    ASSERT_TRUE(handle != nullptr);
+    cache->Release(handle);
+  }
+  ASSERT_TRUE(cache->Lookup("plain") == nullptr);
+
+  // Erased entries are not moved to the second tier
+  cache->Erase(key(9));
+  ASSERT_TRUE(cache->Lookup(key(9)) == nullptr);
+
+  ASSERT_TRUE(NewTieredLRUCache(1000, 1.0, kZlibCompression) == nullptr);
+}
+
+TEST_F(LRUCacheTest, CompressedTierErase) {
+  const size_t kValueSize = 1000;
+  std::shared_ptr<Cache> cache = NewTieredLRUCache(
+      10 * kValueSize, 0.5, kZlibCompression, 0 /* num_shard_bits */);
+  LRUCache* lru_cache = static_cast<LRUCache*>(cache.get());
+  auto key = [](int i) { return "key" + ToString(i); };
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(cache->InsertWithHelper(
+        key(i), new std::string(kValueSize, 'a'), kValueSize, &kStringHelper));
+  }
+  // key0 was moved to the second tier
+  ASSERT_GT(lru_cache->GetCompressedTierUsage(), 0U);
+  cache->Erase(key(0));
+  ASSERT_TRUE(cache->Lookup(key(0)) == nullptr);
+}
+
+TEST_F(LRUCacheTest, CompressedTierReinsert) {
+  const size_t kValueSize = 1000;
+  std::shared_ptr<Cache> cache = NewTieredLRUCache(
+      10 * kValueSize, 0.5, kZlibCompression, 0 /* num_shard_bits */);
+  auto key = [](int i) { return "key" + ToString(i); };
+  auto fill = [&](int from) {
+    for (int i = from; i < from + 5; i++) {
+      ASSERT_OK(cache->InsertWithHelper(key(i),
+                                        new std::string(kValueSize, 'a'),
+                                        kValueSize, &kStringHelper));
+    }
+  };
+  // Move key0 and key1 to the second tier, then insert them again
+  fill(0);
+  fill(5);
+  ASSERT_OK(cache->InsertWithHelper(key(0), new std::string(kValueSize, 'b'),
+                                    kValueSize, &kStringHelper));
+  ASSERT_OK(cache->Insert(key(1), new std::string(kValueSize, 'b'),
+                          kValueSize, &DeleteString));
+
+  // The new values win once they are evicted too
+  fill(10);
+  Cache::Handle* handle = cache->Lookup(key(0));
+  ASSERT_TRUE(handle != nullptr);
+  ASSERT_EQ(std::string(kValueSize, 'b'),
+            *reinterpret_cast<std::string*>(cache->Value(handle)));
+  cache->Release(handle);
+  // Values inserted without a helper are dropped on eviction, along with the
+  // old value
+  ASSERT_TRUE(cache->Lookup(key(1)) == nullptr);
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -0,0 +1,758 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+// Microbenchmarks of the kernels on the hot paths of reads and writes: block
+// seeks and building, bloom filters, checksums and hashing, varint coding,
+// the memtable skip list, merging iterators, write batches and the arena.
+//
+// Each benchmark runs until it has taken --min_time seconds, and reports the
+// time per iteration and, where meaningful, the items or bytes processed per
+// second. --format=json or --format=csv give output that can be kept and
+// diffed between commits:
+//
+//   ./microbench --format=json > before.json
+//   ./microbench --benchmarks=BlockIter,Bloom --repetitions=5
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+#ifndef GFLAGS
+#include <cstdio>
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <gflags/gflags.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "db/inlineskiplist.h"
+#include "rocksdb/env.h"
+#include "rocksdb/filter_policy.h"
+#include "rocksdb/write_batch.h"
+#include "table/block.h"
+#include "table/block_builder.h"
+#include "table/format.h"
+#include "table/merging_iterator.h"
+#include "util/arena.h"
+#include "util/build_version.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/hash.h"
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/testutil.h"
+
+using GFLAGS::ParseCommandLineFlags;
+using GFLAGS::SetUsageMessage;
+
+DEFINE_string(benchmarks, "",
+              "Comma-separated list of name filters. Only the benchmarks "
+              "whose name contains one of them are run. Runs all "
+              "benchmarks if empty.");
+DEFINE_double(min_time, 0.5,
+              "Minimum number of seconds each measurement runs for.");
+DEFINE_int32(repetitions, 1, "Number of measurements of each benchmark.");
+DEFINE_string(format, "console", "Output format: console, csv or json.");
+DEFINE_bool(list, false, "Print the names of the benchmarks and exit.");
+
+namespace rocksdb {
+
+namespace {
+
+// Passed to every benchmark, which must run the code to measure for as long
+// as KeepRunning() returns true. Setup done before the first call and
+// cleanup done after the last one are not measured:
+//
+//   void Foo(BenchmarkState* state) {
+//     ... setup ...
+//     while (state->KeepRunning()) {
+//       ... one iteration ...
+//     }
+//     state->SetItemsProcessed(state->iterations());
+//   }
+class BenchmarkState {
+ public:
+  BenchmarkState(Env* env, uint64_t max_iterations)
+      : env_(env),
+        max_iterations_(max_iterations),
+        iterations_(0),
+        start_nanos_(0),
+        elapsed_nanos_(0),
+        running_(false),
+        items_processed_(0),
+        bytes_processed_(0) {}
+
+  bool KeepRunning() {
+    if (iterations_ < max_iterations_) {
+      if (iterations_ == 0) {
+        ResumeTiming();
+      }
+      iterations_++;
+      return true;
+    }
+    if (running_) {
+      PauseTiming();
+    }
+    return false;
+  }
+
+  // For setup needed between iterations that is not to be measured
+  void PauseTiming() {
+    elapsed_nanos_ += env_->NowNanos() - start_nanos_;
+    running_ = false;
+  }
+  void ResumeTiming() {
+    running_ = true;
+    start_nanos_ = env_->NowNanos();
+  }
+
+  void SetItemsProcessed(uint64_t items) { items_processed_ = items; }
+  void SetBytesProcessed(uint64_t bytes) { bytes_processed_ = bytes; }
+
+  uint64_t iterations() const { return iterations_; }
+  uint64_t elapsed_nanos() const { return elapsed_nanos_; }
+  uint64_t items_processed() const { return items_processed_; }
+  uint64_t bytes_processed() const { return bytes_processed_; }
+
+ private:
+  Env* env_;
+  const uint64_t max_iterations_;
+  uint64_t iterations_;
+  uint64_t start_nanos_;
+  uint64_t elapsed_nanos_;
+  bool running_;
+  uint64_t items_processed_;
+  uint64_t bytes_processed_;
+};
+
+// Benchmarks store what they compute here, so that the compiler cannot
+// drop the work as unused.
+volatile uint64_t benchmark_sink;
+
+struct Benchmark {
+  std::string name;
+  std::function<void(BenchmarkState*)> function;
+};
+
+struct BenchmarkResult {
+  std::string name;
+  uint64_t iterations;
+  double nanos_per_iteration;
+  double items_per_second;
+  double bytes_per_second;
+};
+
+// Keys of the form "key%012d", in order
+std::vector<std::string> MakeUserKeys(int num_keys) {
+  std::vector<std::string> keys;
+  char buf[32];
+  for (int i = 0; i < num_keys; i++) {
+    snprintf(buf, sizeof(buf), "key%012d", i);
+    keys.push_back(buf);
+  }
+  return keys;
+}
+
+std::vector<std::string> MakeInternalKeys(
+    const std::vector<std::string>& user_keys) {
+  std::vector<std::string> keys;
+  for (const auto& user_key : user_keys) {
+    keys.push_back(InternalKey(user_key, 1, kTypeValue).Encode().ToString());
+  }
+  return keys;
+}
+
+// A data block of 128 internal keys with 64 byte values
+std::string BuildDataBlock(int restart_interval,
+                           std::vector<std::string>* user_keys) {
+  *user_keys = MakeUserKeys(128);
+  const std::string value(64, 'v');
+  BlockBuilder builder(restart_interval);
+  for (const auto& key : MakeInternalKeys(*user_keys)) {
+    builder.Add(key, value);
+  }
+  return builder.Finish().ToString();
+}
+
+void BlockIterSeek(BenchmarkState* state, int restart_interval) {
+  std::vector<std::string> user_keys;
+  const std::string data = BuildDataBlock(restart_interval, &user_keys);
+  Block block(BlockContents(data, false /* cachable */, kNoCompression),
+              kDisableGlobalSequenceNumber);
+  InternalKeyComparator icmp(BytewiseComparator());
+  std::unique_ptr<InternalIterator> iter(block.NewIterator(&icmp));
+
+  std::vector<std::string> targets;
+  Random rnd(301);
+  for (int i = 0; i < 1024; i++) {
+    const std::string& user_key = user_keys[rnd.Uniform(
+        static_cast<int>(user_keys.size()))];
+    targets.push_back(
+        InternalKey(user_key, kMaxSequenceNumber, kValueTypeForSeek)
+            .Encode()
+            .ToString());
+  }
+
+  uint64_t found = 0;
+  size_t i = 0;
+  while (state->KeepRunning()) {
+    iter->Seek(targets[i++ & 1023]);
+    found += iter->Valid();
+  }
+  benchmark_sink = found;
+  state->SetItemsProcessed(state->iterations());
+}
+
+void BlockBuilderAdd(BenchmarkState* state) {
+  const std::vector<std::string> keys = MakeInternalKeys(MakeUserKeys(4096));
+  const std::string value(64, 'v');
+  BlockBuilder builder(16 /* block_restart_interval */);
+  uint64_t bytes = 0;
+  size_t i = 0;
+  while (state->KeepRunning()) {
+    // Blocks are cut at 4KB, as with the default block_size
+    if (i == keys.size() || builder.CurrentSizeEstimate() >= 4096) {
+      bytes += builder.Finish().size();
+      builder.Reset();
+      if (i == keys.size()) {
+        i = 0;
+      }
+    }
+    builder.Add(keys[i++], value);
+  }
+  benchmark_sink = bytes;
+  state->SetItemsProcessed(state->iterations());
+  state->SetBytesProcessed(state->iterations() * (keys[0].size() + 64));
+}
+
+void BloomBuild(BenchmarkState* state) {
+  const std::vector<std::string> keys = MakeUserKeys(100000);
+  std::unique_ptr<const FilterPolicy> policy(NewBloomFilterPolicy(10, false));
+  std::unique_ptr<FilterBitsBuilder> builder(policy->GetFilterBitsBuilder());
+  std::unique_ptr<const char[]> buf;
+  uint64_t bytes = 0;
+  size_t i = 0;
+  while (state->KeepRunning()) {
+    builder->AddKey(keys[i++]);
+    if (i == keys.size()) {
+      bytes += builder->Finish(&buf).size();
+      i = 0;
+    }
+  }
+  benchmark_sink = bytes;
+  state->SetItemsProcessed(state->iterations());
+}
+
+void BloomProbe(BenchmarkState* state) {
+  // Every other key is added, so that half of the probes are for keys that
+  // are not in the filter
+  const std::vector<std::string> keys = MakeUserKeys(200000);
+  std::unique_ptr<const FilterPolicy> policy(NewBloomFilterPolicy(10, false));
+  std::unique_ptr<FilterBitsBuilder> builder(policy->GetFilterBitsBuilder());
+  for (size_t i = 0; i < keys.size(); i += 2) {
+    builder->AddKey(keys[i]);
+  }
+  std::unique_ptr<const char[]> buf;
+  const Slice filter = builder->Finish(&buf);
+  std::unique_ptr<FilterBitsReader> reader(
+      policy->GetFilterBitsReader(filter));
+
+  uint64_t matches = 0;
+  size_t i = 0;
+  while (state->KeepRunning()) {
+    matches += reader->MayMatch(keys[i]);
+    if (++i == keys.size()) {
+      i = 0;
+    }
+  }
+  benchmark_sink = matches;
+  state->SetItemsProcessed(state->iterations());
+}
+
+std::string RandomData(size_t size) {
+  Random rnd(301);
+  std::string data;
+  test::RandomString(&rnd, static_cast<int>(size), &data);
+  return data;
+}
+
+void Crc32cExtend(BenchmarkState* state, size_t size) {
+  const std::string data = RandomData(size);
+  uint32_t crc = 0;
+  while (state->KeepRunning()) {
+    crc = crc32c::Extend(crc, data.data(), data.size());
+  }
+  benchmark_sink = crc;
+  state->SetBytesProcessed(state->iterations() * size);
+}
+
+void HashBench(BenchmarkState* state, size_t size) {
+  const std::string data = RandomData(size);
+  uint32_t hash = 0;
+  while (state->KeepRunning()) {
+    hash = Hash(data.data(), data.size(), hash);
+  }
+  benchmark_sink = hash;
+  state->SetBytesProcessed(state->iterations() * size);
+}
+
+// Values of 1 to 64 bits, so that every encoded length is exercised
+std::vector<uint64_t> MakeVarintValues() {
+  Random64 rnd(301);
+  std::vector<uint64_t> values;
+  for (int i = 0; i < 4096; i++) {
+    const int bits = 1 + static_cast<int>(rnd.Uniform(64));
+    values.push_back(bits == 64 ? rnd.Next()
+                                : rnd.Next() & ((uint64_t{1} << bits) - 1));
+  }
+  return values;
+}
+
+void VarintEncode(BenchmarkState* state) {
+  const std::vector<uint64_t> values = MakeVarintValues();
+  std::string buf(values.size() * kMaxVarint64Length, '\0');
+  char* p = &buf[0];
+  size_t i = 0;
+  while (state->KeepRunning()) {
+    p = EncodeVarint64(p, values[i++]);
+    if (i == values.size()) {
+      benchmark_sink = p - buf.data();
+      p = &buf[0];
+      i = 0;
+    }
+  }
+  state->SetItemsProcessed(state->iterations());
+}
+
+void VarintDecode(BenchmarkState* state) {
+  std::string buf;
+  for (uint64_t v : MakeVarintValues()) {
+    PutVarint64(&buf, v);
+  }
+  const char* const limit = buf.data() + buf.size();
+  const char* p = buf.data();
+  uint64_t sum = 0;
+  while (state->KeepRunning()) {
+    uint64_t v;
+    p = GetVarint64Ptr(p, limit, &v);
+    sum += v;
+    if (p == limit) {
+      p = buf.data();
+    }
+  }
+  benchmark_sink = sum;
+  state->SetItemsProcessed(state->iterations());
+}
+
+// Skip list of 8 byte keys in native byte order, as in inlineskiplist_test
+struct SkipListKeyComparator {
+  typedef uint64_t DecodedType;
+
+  static DecodedType decode_key(const char* b) {
+    uint64_t key;
+    memcpy(&key, b, sizeof(key));
+    return key;
+  }
+
+  int operator()(const char* a, const char* b) const {
+    return (*this)(a, decode_key(b));
+  }
+
+  int operator()(const char* a, const DecodedType b) const {
+    const uint64_t key_a = decode_key(a);
+    return key_a < b ? -1 : (key_a > b ? 1 : 0);
+  }
+};
+
+typedef InlineSkipList<SkipListKeyComparator> BenchSkipList;
+
+// Distinct keys in a scattered order
+inline uint64_t SkipListKey(uint64_t i) {
+  return i * 0x9E3779B97F4A7C15ull;
+}
+
+void InsertIntoSkipList(BenchSkipList* list, uint64_t key) {
+  char* buf = list->AllocateKey(sizeof(key));
+  memcpy(buf, &key, sizeof(key));
+  list->Insert(buf);
+}
+
+void InlineSkipListInsert(BenchmarkState* state) {
+  // The list is rebuilt every kMaxKeys inserts, to bound its memory
+  const uint64_t kMaxKeys = 1 << 20;
+  SkipListKeyComparator cmp;
+  std::unique_ptr<Arena> arena(new Arena());
+  std::unique_ptr<BenchSkipList> list(new BenchSkipList(cmp, arena.get()));
+  uint64_t i = 0;
+  while (state->KeepRunning()) {
+    if (i == kMaxKeys) {
+      state->PauseTiming();
+      list.reset();
+      arena.reset(new Arena());
+      list.reset(new BenchSkipList(cmp, arena.get()));
+      i = 0;
+      state->ResumeTiming();
+    }
+    InsertIntoSkipList(list.get(), SkipListKey(i++));
+  }
+  state->SetItemsProcessed(state->iterations());
+}
+
+void InlineSkipListSeek(BenchmarkState* state) {
+  const uint64_t kNumKeys = 1 << 20;
+  SkipListKeyComparator cmp;
+  Arena arena;
+  BenchSkipList list(cmp, &arena);
+  for (uint64_t i = 0; i < kNumKeys; i++) {
+    InsertIntoSkipList(&list, SkipListKey(i));
+  }
+  BenchSkipList::Iterator iter(&list);
+  Random64 rnd(301);
+  uint64_t found = 0;
+  char target[sizeof(uint64_t)];
+  while (state->KeepRunning()) {
+    const uint64_t key = SkipListKey(rnd.Uniform(kNumKeys));
+    memcpy(target, &key, sizeof(key));
+    iter.Seek(target);
+    found += iter.Valid();
+  }
+  benchmark_sink = found;
+  state->SetItemsProcessed(state->iterations());
+}
+
+void MergingIteratorNext(BenchmarkState* state, int num_children) {
+  // The children hold interleaved keys, as overlapping sorted runs do
+  const int kKeysPerChild = 10000;
+  const std::vector<std::string> user_keys =
+      MakeUserKeys(kKeysPerChild * num_children);
+  std::vector<std::vector<std::string>> child_keys(num_children);
+  for (size_t i = 0; i < user_keys.size(); i++) {
+    child_keys[i % num_children].push_back(
+        InternalKey(user_keys[i], 1, kTypeValue).Encode().ToString());
+  }
+  std::vector<InternalIterator*> children;
+  for (const auto& keys : child_keys) {
+    children.push_back(new test::VectorIterator(keys));
+  }
+  InternalKeyComparator icmp(BytewiseComparator());
+  std::unique_ptr<InternalIterator> iter(NewMergingIterator(
+      &icmp, children.data(), static_cast<int>(children.size())));
+
+  uint64_t key_bytes = 0;
+  iter->SeekToFirst();
+  while (state->KeepRunning()) {
+    iter->Next();
+    if (!iter->Valid()) {
+      iter->SeekToFirst();
+    }
+    key_bytes += iter->key().size();
+  }
+  benchmark_sink = key_bytes;
+  state->SetItemsProcessed(state->iterations());
+}
+
+void WriteBatchEncode(BenchmarkState* state) {
+  const std::vector<std::string> keys = MakeUserKeys(100);
+  const std::string value(100, 'v');
+  WriteBatch batch;
+  uint64_t bytes = 0;
+  size_t i = 0;
+  while (state->KeepRunning()) {
+    batch.Put(keys[i++], value);
+    if (i == keys.size()) {
+      bytes += batch.GetDataSize();
+      batch.Clear();
+      i = 0;
+    }
+  }
+  benchmark_sink = bytes;
+  state->SetItemsProcessed(state->iterations());
+}
+
+class CountingHandler : public WriteBatch::Handler {
+ public:
+  CountingHandler() : bytes_(0) {}
+
+  virtual void Put(const Slice& key, const Slice& value) override {
+    bytes_ += key.size() + value.size();
+  }
+  virtual void Delete(const Slice& key) override { bytes_ += key.size(); }
+
+  uint64_t bytes_;
+};
+
+void WriteBatchIterate(BenchmarkState* state) {
+  const int kBatchSize = 100;
+  const std::vector<std::string> keys = MakeUserKeys(kBatchSize);
+  WriteBatch batch;
+  for (const auto& key : keys) {
+    batch.Put(key, std::string(100, 'v'));
+  }
+  CountingHandler handler;
+  while (state->KeepRunning()) {
+    batch.Iterate(&handler);
+  }
+  benchmark_sink = handler.bytes_;
+  state->SetItemsProcessed(state->iterations() * kBatchSize);
+}
+
+void ArenaAllocate(BenchmarkState* state, bool aligned) {
+  // A mix of sizes, as memtable entries are. The arena is replaced every
+  // 1MB, so that the memory is reused rather than faulted in.
+  const size_t kSizes[] = {16, 24, 48, 100, 130, 256, 700, 1024};
+  const size_t kNumSizes = sizeof(kSizes) / sizeof(kSizes[0]);
+  const size_t kMaxArenaBytes = 1 << 20;
+  std::unique_ptr<Arena> arena(new Arena());
+  uint64_t addresses = 0;
+  size_t arena_bytes = 0;
+  size_t i = 0;
+  while (state->KeepRunning()) {
+    const size_t size = kSizes[i++ % kNumSizes];
+    if (arena_bytes + size > kMaxArenaBytes) {
+      state->PauseTiming();
+      arena.reset(new Arena());
+      arena_bytes = 0;
+      state->ResumeTiming();
+    }
+    char* p = aligned ? arena->AllocateAligned(size) : arena->Allocate(size);
+    addresses += reinterpret_cast<uintptr_t>(p);
+    arena_bytes += size;
+  }
+  benchmark_sink = addresses;
+  state->SetItemsProcessed(state->iterations());
+}
+
+std::vector<Benchmark> GetBenchmarks() {
+  std::vector<Benchmark> benchmarks = {
+      {"BlockIter::Seek/restart_interval:1",
+       [](BenchmarkState* s) { BlockIterSeek(s, 1); }},
+      {"BlockIter::Seek/restart_interval:16",
+       [](BenchmarkState* s) { BlockIterSeek(s, 16); }},
+      {"BlockBuilder::Add", BlockBuilderAdd},
+      {"Bloom/build", BloomBuild},
+      {"Bloom/probe", BloomProbe},
+      {"crc32c::Extend/16", [](BenchmarkState* s) { Crc32cExtend(s, 16); }},
+      {"crc32c::Extend/4096",
+       [](BenchmarkState* s) { Crc32cExtend(s, 4096); }},
+      {"Hash/16", [](BenchmarkState* s) { HashBench(s, 16); }},
+      {"Hash/4096", [](BenchmarkState* s) { HashBench(s, 4096); }},
+      {"Varint64/encode", VarintEncode},
+      {"Varint64/decode", VarintDecode},
+      {"InlineSkipList/insert", InlineSkipListInsert},
+      {"InlineSkipList/seek", InlineSkipListSeek},
+      {"MergingIterator::Next/children:2",
+       [](BenchmarkState* s) { MergingIteratorNext(s, 2); }},
+      {"MergingIterator::Next/children:8",
+       [](BenchmarkState* s) { MergingIteratorNext(s, 8); }},
+      {"WriteBatch/encode", WriteBatchEncode},
+      {"WriteBatch/iterate", WriteBatchIterate},
+      {"Arena::Allocate",
+       [](BenchmarkState* s) { ArenaAllocate(s, false); }},
+      {"Arena::AllocateAligned",
+       [](BenchmarkState* s) { ArenaAllocate(s, true); }},
+  };
+  return benchmarks;
+}
+
+bool MatchesFilter(const std::string& name) {
+  if (FLAGS_benchmarks.empty()) {
+    return true;
+  }
+  for (const auto& filter : StringSplit(FLAGS_benchmarks, ',')) {
+    if (!filter.empty() && name.find(filter) != std::string::npos) {
+      return true;
+    }
+  }
+  return false;
+}
+
+BenchmarkResult MakeResult(const Benchmark& benchmark,
+                           const BenchmarkState& state) {
+  BenchmarkResult result;
+  result.name = benchmark.name;
+  result.iterations = state.iterations();
+  const double seconds = state.elapsed_nanos() / 1e9;
+  result.nanos_per_iteration =
+      static_cast<double>(state.elapsed_nanos()) / state.iterations();
+  result.items_per_second =
+      seconds > 0 ? state.items_processed() / seconds : 0.0;
+  result.bytes_per_second =
+      seconds > 0 ? state.bytes_processed() / seconds : 0.0;
+  return result;
+}
+
+// Runs the benchmark with more and more iterations until a run takes
+// --min_time, and measures it --repetitions times with that many iterations
+void RunBenchmark(Env* env, const Benchmark& benchmark,
+                  std::vector<BenchmarkResult>* results) {
+  const double min_nanos = FLAGS_min_time * 1e9;
+  const uint64_t kMaxIterations = 1000000000;
+  uint64_t iterations = 1;
+  int repetitions = 0;
+  while (true) {
+    BenchmarkState state(env, iterations);
+    benchmark.function(&state);
+    const double elapsed = static_cast<double>(state.elapsed_nanos());
+    if (elapsed >= min_nanos || iterations >= kMaxIterations) {
+      results->push_back(MakeResult(benchmark, state));
+      repetitions++;
+      break;
+    }
+    // Aim 40% past the minimum time, growing at most tenfold at a time
+    double multiplier = elapsed > 0 ? 1.4 * min_nanos / elapsed : 10.0;
+    multiplier = std::max(std::min(multiplier, 10.0), 2.0);
+    iterations = std::min(
+        kMaxIterations, static_cast<uint64_t>(iterations * multiplier));
+  }
+  for (; repetitions < FLAGS_repetitions; repetitions++) {
+    BenchmarkState state(env, iterations);
+    benchmark.function(&state);
+    results->push_back(MakeResult(benchmark, state));
+  }
+}
+
+std::string JsonEscape(const std::string& s) {
+  std::string escaped;
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+    }
+    escaped.push_back(c);
+  }
+  return escaped;
+}
+
+void PrintResult(const BenchmarkResult& result, bool last) {
+  if (FLAGS_format == "csv") {
+    fprintf(stdout, "\"%s\",%" PRIu64 ",%.3f,%.1f,%.1f\n",
+            result.name.c_str(), result.iterations,
+            result.nanos_per_iteration, result.items_per_second,
+            result.bytes_per_second);
+  } else if (FLAGS_format == "json") {
+    fprintf(stdout,
+            "    {\n"
+            "      \"name\": \"%s\",\n"
+            "      \"iterations\": %" PRIu64 ",\n"
+            "      \"real_time\": %.3f,\n"
+            "      \"time_unit\": \"ns\",\n"
+            "      \"items_per_second\": %.1f,\n"
+            "      \"bytes_per_second\": %.1f\n"
+            "    }%s\n",
+            JsonEscape(result.name).c_str(), result.iterations,
+            result.nanos_per_iteration, result.items_per_second,
+            result.bytes_per_second, last ? "" : ",");
+  } else {
+    std::string rate;
+    if (result.bytes_per_second > 0) {
+      char buf[64];
+      snprintf(buf, sizeof(buf), "%10.1f MB/s",
+               result.bytes_per_second / 1048576.0);
+      rate.append(buf);
+    }
+    if (result.items_per_second > 0) {
+      char buf[64];
+      snprintf(buf, sizeof(buf), "%12.3f M items/s",
+               result.items_per_second / 1e6);
+      rate.append(buf);
+    }
+    fprintf(stdout, "%-40s %12.2f ns %12" PRIu64 "%s\n", result.name.c_str(),
+            result.nanos_per_iteration, result.iterations, rate.c_str());
+  }
+  fflush(stdout);
+}
+
+void PrintHeader() {
+  if (FLAGS_format == "csv") {
+    fprintf(stdout,
+            "name,iterations,real_time_ns,items_per_second,"
+            "bytes_per_second\n");
+  } else if (FLAGS_format == "json") {
+    fprintf(stdout,
+            "{\n"
+            "  \"context\": {\n"
+            "    \"git_sha\": \"%s\",\n"
+            "    \"compile_date\": \"%s\",\n"
+#ifdef NDEBUG
+            "    \"library_build_type\": \"release\",\n"
+#else
+            "    \"library_build_type\": \"debug\",\n"
+#endif
+            "    \"min_time\": %.3f,\n"
+            "    \"repetitions\": %d\n"
+            "  },\n"
+            "  \"benchmarks\": [\n",
+            JsonEscape(rocksdb_build_git_sha).c_str(),
+            JsonEscape(rocksdb_build_compile_date).c_str(), FLAGS_min_time,
+            FLAGS_repetitions);
+  } else {
+#ifndef NDEBUG
+    fprintf(stdout,
+            "WARNING: Assertions are enabled; benchmarks unnecessarily "
+            "slow\n");
+#endif
+    fprintf(stdout, "%-40s %15s %12s\n", "Benchmark", "Time", "Iterations");
+  }
+}
+
+void PrintFooter() {
+  if (FLAGS_format == "json") {
+    fprintf(stdout, "  ]\n}\n");
+  }
+}
+
+}  // namespace
+
+int RunMicrobenchmarks() {
+  if (FLAGS_format != "console" && FLAGS_format != "csv" &&
+      FLAGS_format != "json") {
+    fprintf(stderr, "Unknown --format %s\n", FLAGS_format.c_str());
+    return 1;
+  }
+  std::vector<Benchmark> benchmarks;
+  for (auto& benchmark : GetBenchmarks()) {
+    if (MatchesFilter(benchmark.name)) {
+      benchmarks.push_back(std::move(benchmark));
+    }
+  }
+  if (FLAGS_list) {
+    for (const auto& benchmark : benchmarks) {
+      fprintf(stdout, "%s\n", benchmark.name.c_str());
+    }
+    return 0;
+  }
+
+  Env* env = Env::Default();
+  PrintHeader();
+  for (size_t i = 0; i < benchmarks.size(); i++) {
+    std::vector<BenchmarkResult> results;
+    RunBenchmark(env, benchmarks[i], &results);
+    for (size_t j = 0; j < results.size(); j++) {
+      PrintResult(results[j],
+                  i + 1 == benchmarks.size() && j + 1 == results.size());
+    }
+  }
+  PrintFooter();
+  return 0;
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " [OPTIONS]...");
+  ParseCommandLineFlags(&argc, &argv, true);
+  return rocksdb::RunMicrobenchmarks();
+}
+
+#endif  // GFLAGS
@@ -161,6 +161,12 @@ DBOptions::DBOptions(const Options& options)
       is_fd_close_on_exec(options.is_fd_close_on_exec),
       skip_log_error_on_recovery(options.skip_log_error_on_recovery),
       stats_dump_period_sec(options.stats_dump_period_sec),
+      stats_persist_period_sec(options.stats_persist_period_sec),
+      stats_history_buffer_size(options.stats_history_buffer_size),
+      hot_blocks_persist_period_sec(options.hot_blocks_persist_period_sec),
+      max_persisted_hot_blocks(options.max_persisted_hot_blocks),
+      hot_blocks_warm_up_bytes_per_sec(
+          options.hot_blocks_warm_up_bytes_per_sec),
       advise_random_on_open(options.advise_random_on_open),
       db_write_buffer_size(options.db_write_buffer_size),
       write_buffer_manager(options.write_buffer_manager),
@@ -246,6 +252,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     Header(log,
         "        Options.compression_opts.max_dict_bytes: %" ROCKSDB_PRIszt,
         compression_opts.max_dict_bytes);
+    Header(log,
+        "  Options.compression_opts.zstd_max_train_bytes: %" ROCKSDB_PRIszt,
+        compression_opts.zstd_max_train_bytes);
     Header(log, "     Options.level0_file_num_compaction_trigger: %d",
         level0_file_num_compaction_trigger);
     Header(log, "         Options.level0_slowdown_writes_trigger: %d",
@@ -568,7 +577,9 @@ ReadOptions::ReadOptions()
       pin_data(false),
       background_purge_on_iterator_cleanup(false),
       readahead_size(0),
-      ignore_range_deletions(false) {
+      ignore_range_deletions(false),
+      projected_value_columns(nullptr),
+      keys_only(false) {
   XFUNC_TEST("", "managed_options", managed_options, xf_manage_options,
              reinterpret_cast<ReadOptions*>(this));
 }
@@ -586,7 +597,9 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       pin_data(false),
       background_purge_on_iterator_cleanup(false),
       readahead_size(0),
-      ignore_range_deletions(false) {
+      ignore_range_deletions(false),
+      projected_value_columns(nullptr),
+      keys_only(false) {
   XFUNC_TEST("", "managed_options", managed_options, xf_manage_options,
              reinterpret_cast<ReadOptions*>(this));
 }
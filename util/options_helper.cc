@@ -78,6 +78,16 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.allow_fallocate = immutable_db_options.allow_fallocate;
   options.is_fd_close_on_exec = immutable_db_options.is_fd_close_on_exec;
   options.stats_dump_period_sec = immutable_db_options.stats_dump_period_sec;
+  options.stats_persist_period_sec =
+      immutable_db_options.stats_persist_period_sec;
+  options.stats_history_buffer_size =
+      immutable_db_options.stats_history_buffer_size;
+  options.hot_blocks_persist_period_sec =
+      immutable_db_options.hot_blocks_persist_period_sec;
+  options.max_persisted_hot_blocks =
+      immutable_db_options.max_persisted_hot_blocks;
+  options.hot_blocks_warm_up_bytes_per_sec =
+      immutable_db_options.hot_blocks_warm_up_bytes_per_sec;
   options.advise_random_on_open = immutable_db_options.advise_random_on_open;
   options.db_write_buffer_size = immutable_db_options.db_write_buffer_size;
   options.write_buffer_manager = immutable_db_options.write_buffer_manager;
@@ -943,9 +953,20 @@ Status ParseColumnFamilyOption(const std::string& name,
           return Status::InvalidArgument(
               "unable to parse the specified CF option " + name);
         }
+        end = value.find(':', start);
         new_options->compression_opts.max_dict_bytes =
             ParseInt(value.substr(start, value.size() - start));
       }
+      // zstd_max_train_bytes is optional for backwards compatibility
+      if (end != std::string::npos) {
+        start = end + 1;
+        if (start >= value.size()) {
+          return Status::InvalidArgument(
+              "unable to parse the specified CF option " + name);
+        }
+        new_options->compression_opts.zstd_max_train_bytes =
+            ParseInt(value.substr(start, value.size() - start));
+      }
     } else if (name == "compaction_options_fifo") {
       new_options->compaction_options_fifo.max_table_files_size =
           ParseUint64(value);
@@ -332,6 +332,21 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"stats_dump_period_sec",
      {offsetof(struct DBOptions, stats_dump_period_sec), OptionType::kUInt,
       OptionVerificationType::kNormal, false, 0}},
+    {"stats_persist_period_sec",
+     {offsetof(struct DBOptions, stats_persist_period_sec), OptionType::kUInt,
+      OptionVerificationType::kNormal, false, 0}},
+    {"stats_history_buffer_size",
+     {offsetof(struct DBOptions, stats_history_buffer_size),
+      OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}},
+    {"hot_blocks_persist_period_sec",
+     {offsetof(struct DBOptions, hot_blocks_persist_period_sec),
+      OptionType::kUInt, OptionVerificationType::kNormal, false, 0}},
+    {"max_persisted_hot_blocks",
+     {offsetof(struct DBOptions, max_persisted_hot_blocks), OptionType::kSizeT,
+      OptionVerificationType::kNormal, false, 0}},
+    {"hot_blocks_warm_up_bytes_per_sec",
+     {offsetof(struct DBOptions, hot_blocks_warm_up_bytes_per_sec),
+      OptionType::kUInt64T, OptionVerificationType::kNormal, false, 0}},
     {"fail_if_options_file_error",
      {offsetof(struct DBOptions, fail_if_options_file_error),
       OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
@@ -624,6 +639,9 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"index_block_restart_interval",
          {offsetof(struct BlockBasedTableOptions, index_block_restart_interval),
           OptionType::kInt, OptionVerificationType::kNormal, false, 0}},
+        {"separate_data_block_values",
+         {offsetof(struct BlockBasedTableOptions, separate_data_block_values),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"index_per_partition",
          {offsetof(struct BlockBasedTableOptions, index_per_partition),
           OptionType::kUInt64T, OptionVerificationType::kNormal, false, 0}},
@@ -643,9 +661,29 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"verify_compression",
          {offsetof(struct BlockBasedTableOptions, verify_compression),
           OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+        {"verify_persistent_cache_checksums",
+         {offsetof(struct BlockBasedTableOptions,
+                   verify_persistent_cache_checksums),
+          OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
         {"read_amp_bytes_per_bit",
          {offsetof(struct BlockBasedTableOptions, read_amp_bytes_per_bit),
-          OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}}};
+          OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}},
+        {"max_auto_readahead_size",
+         {offsetof(struct BlockBasedTableOptions, max_auto_readahead_size),
+          OptionType::kSizeT, OptionVerificationType::kNormal, false, 0}},
+        {"adaptive_compression_candidates",
+         {offsetof(struct BlockBasedTableOptions,
+                   adaptive_compression_candidates),
+          OptionType::kVectorCompressionType, OptionVerificationType::kNormal,
+          false, 0}},
+        {"adaptive_compression_sampling_interval",
+         {offsetof(struct BlockBasedTableOptions,
+                   adaptive_compression_sampling_interval),
+          OptionType::kUInt32T, OptionVerificationType::kNormal, false, 0}},
+        {"adaptive_compression_max_nanos_per_kb",
+         {offsetof(struct BlockBasedTableOptions,
+                   adaptive_compression_max_nanos_per_kb),
+          OptionType::kUInt64T, OptionVerificationType::kNormal, false, 0}}};
 
 static std::unordered_map<std::string, OptionTypeInfo> plain_table_type_info = {
     {"user_key_len",
@@ -671,7 +709,10 @@ static std::unordered_map<std::string, OptionTypeInfo> plain_table_type_info = {
       OptionVerificationType::kNormal, false, 0}},
     {"store_index_in_file",
      {offsetof(struct PlainTableOptions, store_index_in_file),
-      OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}}};
+      OptionType::kBoolean, OptionVerificationType::kNormal, false, 0}},
+    {"chunk_size",
+     {offsetof(struct PlainTableOptions, chunk_size), OptionType::kSizeT,
+      OptionVerificationType::kNormal, false, 0}}};
 
 static std::unordered_map<std::string, CompressionType>
     compression_type_string_map = {
@@ -697,7 +738,10 @@ static std::unordered_map<std::string, EncodingType> encoding_type_string_map =
     {{"kPlain", kPlain}, {"kPrefix", kPrefix}};
 
 static std::unordered_map<std::string, ChecksumType> checksum_type_string_map =
-    {{"kNoChecksum", kNoChecksum}, {"kCRC32c", kCRC32c}, {"kxxHash", kxxHash}};
+    {{"kNoChecksum", kNoChecksum},
+     {"kCRC32c", kCRC32c},
+     {"kxxHash", kxxHash},
+     {"kxxHash64", kxxHash64}};
 
 static std::unordered_map<std::string, CompactionStyle>
     compaction_style_string_map = {
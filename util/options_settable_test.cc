@@ -106,6 +106,8 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
        sizeof(std::shared_ptr<PersistentCache>)},
       {offsetof(struct BlockBasedTableOptions, block_cache_compressed),
        sizeof(std::shared_ptr<Cache>)},
+      {offsetof(struct BlockBasedTableOptions, block_cache_tracer),
+       sizeof(std::shared_ptr<BlockCacheTracer>)},
       {offsetof(struct BlockBasedTableOptions, filter_policy),
        sizeof(std::shared_ptr<const FilterPolicy>)},
   };
@@ -123,6 +125,9 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
   // bytes left.
   BlockBasedTableOptions* bbto = new (bbto_ptr) BlockBasedTableOptions();
   FillWithSpecialChar(bbto_ptr, sizeof(BlockBasedTableOptions), kBbtoBlacklist);
+  // The special chars are not a valid vector. An empty one is all zeros, so
+  // a vector that is not set still adds no unset bytes; it is checked below.
+  new (&bbto->adaptive_compression_candidates) std::vector<CompressionType>();
   // It based on the behavior of compiler that padding bytes are not changed
   // when copying the struct. It's prone to failure when compiler behavior
   // changes. We verify there is unset bytes to detect the case.
@@ -136,6 +141,7 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
   // GetBlockBasedTableOptionsFromString().
   bbto = new (bbto_ptr) BlockBasedTableOptions();
   FillWithSpecialChar(bbto_ptr, sizeof(BlockBasedTableOptions), kBbtoBlacklist);
+  new (&bbto->adaptive_compression_candidates) std::vector<CompressionType>();
   // This option is not setable:
   bbto->use_delta_encoding = true;
 
@@ -144,6 +150,8 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       new (new_bbto_ptr) BlockBasedTableOptions();
   FillWithSpecialChar(new_bbto_ptr, sizeof(BlockBasedTableOptions),
                       kBbtoBlacklist);
+  new (&new_bbto->adaptive_compression_candidates)
+      std::vector<CompressionType>();
 
   // Need to update the option string if a new option is added.
   ASSERT_OK(GetBlockBasedTableOptionsFromString(
@@ -156,13 +164,37 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "block_cache=1M;block_cache_compressed=1k;block_size=1024;"
       "block_size_deviation=8;block_restart_interval=4; "
       "index_per_partition=4;"
+      "separate_data_block_values=true;"
       "index_block_restart_interval=4;"
       "filter_policy=bloomfilter:4:true;whole_key_filtering=1;"
       "skip_table_builder_flush=1;format_version=1;"
       "hash_index_allow_collision=false;"
-      "verify_compression=true;read_amp_bytes_per_bit=0",
+      "verify_compression=true;verify_persistent_cache_checksums=true;"
+      "read_amp_bytes_per_bit=0;"
+      "max_auto_readahead_size=65536;"
+      "adaptive_compression_candidates=kSnappyCompression:kZSTD;"
+      "adaptive_compression_sampling_interval=8;"
+      "adaptive_compression_max_nanos_per_kb=1000",
       new_bbto));
 
+  // The vector round-trips through the option string. Its heap pointers may
+  // contain the special char, so it is emptied before counting.
+  const std::vector<CompressionType> candidates = {kSnappyCompression, kZSTD};
+  ASSERT_EQ(candidates, new_bbto->adaptive_compression_candidates);
+  std::unique_ptr<TableFactory> factory(NewBlockBasedTableFactory(*new_bbto));
+  std::string bbto_string;
+  ASSERT_OK(GetStringFromTableFactory(&bbto_string, factory.get(), ";"));
+  // Not every option in the string parses back, e.g. filter_policy
+  const size_t begin = bbto_string.find("adaptive_compression_candidates=");
+  ASSERT_NE(std::string::npos, begin);
+  BlockBasedTableOptions round_tripped;
+  ASSERT_OK(GetBlockBasedTableOptionsFromString(
+      BlockBasedTableOptions(),
+      bbto_string.substr(begin, bbto_string.find(';', begin) - begin),
+      &round_tripped));
+  ASSERT_EQ(candidates, round_tripped.adaptive_compression_candidates);
+  std::vector<CompressionType>().swap(new_bbto->adaptive_compression_candidates);
+
   ASSERT_EQ(unset_bytes_base,
             NumUnsetBytes(new_bbto_ptr, sizeof(BlockBasedTableOptions),
                           kBbtoBlacklist));
@@ -272,6 +304,11 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "manifest_preallocation_size=1222;"
                              "allow_mmap_writes=false;"
                              "stats_dump_period_sec=70127;"
+                             "stats_persist_period_sec=57;"
+                             "stats_history_buffer_size=14159;"
+                             "hot_blocks_persist_period_sec=1800;"
+                             "max_persisted_hot_blocks=8421;"
+                             "hot_blocks_warm_up_bytes_per_sec=1048576;"
                              "allow_fallocate=true;"
                              "allow_mmap_reads=false;"
                              "use_direct_reads=false;"
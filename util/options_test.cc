@@ -300,6 +300,18 @@ TEST_F(OptionsTest, GetColumnFamilyOptionsFromStringTest) {
              "write_buffer_size=13; =100;", &new_cf_opt));
   ASSERT_OK(RocksDBOptionsParser::VerifyCFOptions(base_cf_opt, new_cf_opt));
 
+  // compression_opts with and without the optional zstd_max_train_bytes
+  ASSERT_OK(GetColumnFamilyOptionsFromString(
+      base_cf_opt, "compression_opts=4:5:6:7:8", &new_cf_opt));
+  ASSERT_EQ(new_cf_opt.compression_opts.max_dict_bytes, 7);
+  ASSERT_EQ(new_cf_opt.compression_opts.zstd_max_train_bytes, 8);
+  ASSERT_OK(GetColumnFamilyOptionsFromString(
+      base_cf_opt, "compression_opts=4:5:6:7", &new_cf_opt));
+  ASSERT_EQ(new_cf_opt.compression_opts.max_dict_bytes, 7);
+  ASSERT_EQ(new_cf_opt.compression_opts.zstd_max_train_bytes, 0);
+  ASSERT_NOK(GetColumnFamilyOptionsFromString(
+      base_cf_opt, "compression_opts=4:5:6:7:", &new_cf_opt));
+
   const int64_t kilo = 1024UL;
   const int64_t mega = 1024 * kilo;
   const int64_t giga = 1024 * mega;
@@ -511,7 +523,7 @@ TEST_F(OptionsTest, GetPlainTableOptionsFromString) {
   ASSERT_OK(GetPlainTableOptionsFromString(table_opt,
             "user_key_len=66;bloom_bits_per_key=20;hash_table_ratio=0.5;"
             "index_sparseness=8;huge_page_tlb_size=4;encoding_type=kPrefix;"
-            "full_scan_mode=true;store_index_in_file=true",
+            "full_scan_mode=true;store_index_in_file=true;chunk_size=4096",
             &new_opt));
   ASSERT_EQ(new_opt.user_key_len, 66);
   ASSERT_EQ(new_opt.bloom_bits_per_key, 20);
@@ -521,6 +533,7 @@ TEST_F(OptionsTest, GetPlainTableOptionsFromString) {
   ASSERT_EQ(new_opt.encoding_type, EncodingType::kPrefix);
   ASSERT_TRUE(new_opt.full_scan_mode);
   ASSERT_TRUE(new_opt.store_index_in_file);
+  ASSERT_EQ(new_opt.chunk_size, 4096);
 
   // unknown option
   ASSERT_NOK(GetPlainTableOptionsFromString(table_opt,
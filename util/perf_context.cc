@@ -62,14 +62,53 @@ void PerfContext::Reset() {
   bloom_memtable_miss_count = 0;
   bloom_sst_hit_count = 0;
   bloom_sst_miss_count = 0;
+  index_block_read_count = 0;
+  data_block_read_count = 0;
+  if (per_level_perf_context_enabled) {
+    ClearPerLevelPerfContext();
+  }
+#endif
+}
+
+void PerfContextByLevel::Reset() {
+#if !defined(NPERF_CONTEXT) && !defined(IOS_CROSS_COMPILE)
+  bloom_filter_useful = 0;
+  bloom_filter_full_positive = 0;
+  bloom_filter_full_true_positive = 0;
+  block_cache_hit_count = 0;
+  index_block_read_count = 0;
+  data_block_read_count = 0;
+  block_read_byte = 0;
+  get_from_table_nanos = 0;
 #endif
 }
 
+void PerfContext::ClearPerLevelPerfContext() {
+  for (int level = 0; level < kPerfContextMaxLevels; level++) {
+    level_perf_context[level].Reset();
+  }
+}
+
 #define PERF_CONTEXT_OUTPUT(counter)             \
   if (!exclude_zero_counters || (counter > 0)) { \
     ss << #counter << " = " << counter << ", ";  \
   }
 
+// Prints the non-zero values of a PerfContextByLevel counter, as
+// "counter = value@level0, value@level3, "
+#define PERF_CONTEXT_BY_LEVEL_OUTPUT(counter)                     \
+  {                                                               \
+    bool printed = false;                                         \
+    for (int level = 0; level < kPerfContextMaxLevels; level++) { \
+      uint64_t value = level_perf_context[level].counter;         \
+      if (value > 0) {                                            \
+        ss << (printed ? "" : #counter " = ") << value << "@level" \
+           << level << ", ";                                      \
+        printed = true;                                           \
+      }                                                           \
+    }                                                             \
+  }
+
 std::string PerfContext::ToString(bool exclude_zero_counters) const {
 #if defined(NPERF_CONTEXT) || defined(IOS_CROSS_COMPILE)
   return "";
@@ -117,6 +156,18 @@ std::string PerfContext::ToString(bool exclude_zero_counters) const {
   PERF_CONTEXT_OUTPUT(bloom_memtable_miss_count);
   PERF_CONTEXT_OUTPUT(bloom_sst_hit_count);
   PERF_CONTEXT_OUTPUT(bloom_sst_miss_count);
+  PERF_CONTEXT_OUTPUT(index_block_read_count);
+  PERF_CONTEXT_OUTPUT(data_block_read_count);
+  if (per_level_perf_context_enabled) {
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(bloom_filter_useful);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(bloom_filter_full_positive);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(bloom_filter_full_true_positive);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(block_cache_hit_count);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(index_block_read_count);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(data_block_read_count);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(block_read_byte);
+    PERF_CONTEXT_BY_LEVEL_OUTPUT(get_from_table_nanos);
+  }
   return ss.str();
 #endif
 }
@@ -4,6 +4,8 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 //
 #pragma once
+#include <algorithm>
+#include "port/likely.h"
 #include "rocksdb/perf_context.h"
 #include "util/perf_step_timer.h"
 #include "util/stop_watch.h"
@@ -19,6 +21,12 @@ namespace rocksdb {
 #define PERF_TIMER_START(metric)
 #define PERF_COUNTER_ADD(metric, value)
 
+class PerfContextByLevelRecorder {
+ public:
+  explicit PerfContextByLevelRecorder(int /*level*/) {}
+  void Finish(bool /*key_found*/) {}
+};
+
 #else
 
 // Stop the timer and update the metric
@@ -48,6 +56,69 @@ namespace rocksdb {
 #define PERF_COUNTER_ADD(metric, value)     \
   perf_context.metric += value;
 
+// Adds what the lookup of one file of a level by Get() adds to perf_context
+// to the PerfContextByLevel of that level. It does nothing unless the
+// per-level breakdown is enabled.
+class PerfContextByLevelRecorder {
+ public:
+  explicit PerfContextByLevelRecorder(int level)
+      : by_level_(nullptr), start_nanos_(0) {
+    if (LIKELY(!perf_context.per_level_perf_context_enabled) || level < 0) {
+      return;
+    }
+    by_level_ = &perf_context.level_perf_context[std::min(
+        level, kPerfContextMaxLevels - 1)];
+    bloom_sst_hit_count_ = perf_context.bloom_sst_hit_count;
+    bloom_sst_miss_count_ = perf_context.bloom_sst_miss_count;
+    block_cache_hit_count_ = perf_context.block_cache_hit_count;
+    index_block_read_count_ = perf_context.index_block_read_count;
+    data_block_read_count_ = perf_context.data_block_read_count;
+    block_read_byte_ = perf_context.block_read_byte;
+    if (perf_level >= PerfLevel::kEnableTimeExceptForMutex) {
+      start_nanos_ = Env::Default()->NowNanos();
+    }
+  }
+
+  // key_found tells whether the file held the key
+  void Finish(bool key_found) {
+    if (LIKELY(by_level_ == nullptr)) {
+      return;
+    }
+    const uint64_t filter_positive =
+        perf_context.bloom_sst_hit_count - bloom_sst_hit_count_;
+    by_level_->bloom_filter_useful +=
+        perf_context.bloom_sst_miss_count - bloom_sst_miss_count_;
+    by_level_->bloom_filter_full_positive += filter_positive;
+    if (key_found) {
+      by_level_->bloom_filter_full_true_positive += filter_positive;
+    }
+    by_level_->block_cache_hit_count +=
+        perf_context.block_cache_hit_count - block_cache_hit_count_;
+    by_level_->index_block_read_count +=
+        perf_context.index_block_read_count - index_block_read_count_;
+    by_level_->data_block_read_count +=
+        perf_context.data_block_read_count - data_block_read_count_;
+    by_level_->block_read_byte +=
+        perf_context.block_read_byte - block_read_byte_;
+    if (start_nanos_ != 0) {
+      by_level_->get_from_table_nanos +=
+          Env::Default()->NowNanos() - start_nanos_;
+    }
+    by_level_ = nullptr;
+  }
+
+ private:
+  PerfContextByLevel* by_level_;
+  uint64_t start_nanos_;
+  // Values of the perf_context counters when the lookup started
+  uint64_t bloom_sst_hit_count_;
+  uint64_t bloom_sst_miss_count_;
+  uint64_t block_cache_hit_count_;
+  uint64_t index_block_read_count_;
+  uint64_t data_block_read_count_;
+  uint64_t block_read_byte_;
+};
+
 #endif
 
 }
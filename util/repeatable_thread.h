@@ -0,0 +1,93 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "util/instrumented_mutex.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+// A thread that calls a function every delay_us microseconds until it is
+// cancelled. The first call is made delay_us after the thread is started.
+// Cancelling waits for a call in progress to return.
+class RepeatableThread {
+ public:
+  RepeatableThread(std::function<void()> function, Env* env,
+                   uint64_t delay_us)
+      : function_(function),
+        env_(env),
+        delay_us_(delay_us),
+        cond_var_(&mutex_),
+        running_(true) {
+    thread_.reset(new port::Thread([this] { thread(); }));
+  }
+
+  ~RepeatableThread() { cancel(); }
+
+  void cancel() {
+    {
+      InstrumentedMutexLock l(&mutex_);
+      if (!running_) {
+        return;
+      }
+      running_ = false;
+      cond_var_.SignalAll();
+    }
+    thread_->join();
+  }
+
+ private:
+  // Returns false if the thread was cancelled while waiting
+  bool wait(uint64_t delay) {
+    InstrumentedMutexLock l(&mutex_);
+    const uint64_t wait_until = env_->NowMicros() + delay;
+    while (running_) {
+      const uint64_t now = env_->NowMicros();
+      if (now >= wait_until) {
+        break;
+      }
+      // The deadline of TimedWait() is on the wall clock, which env_ need
+      // not follow. Waiting for what is left of the delay on that clock
+      // keeps an env running behind it from turning this into a busy loop.
+      cond_var_.TimedWait(WallClockMicros() + (wait_until - now));
+    }
+    return running_;
+  }
+
+  static uint64_t WallClockMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+  }
+
+  void thread() {
+    while (wait(delay_us_)) {
+      function_();
+    }
+  }
+
+  const std::function<void()> function_;
+  Env* const env_;
+  const uint64_t delay_us_;
+
+  // Mutex lock should be held when accessing running_
+  InstrumentedMutex mutex_;
+  InstrumentedCondVar cond_var_;
+  bool running_;
+  std::unique_ptr<port::Thread> thread_;
+
+  // No copying allowed
+  RepeatableThread(const RepeatableThread&) = delete;
+  RepeatableThread& operator=(const RepeatableThread&) = delete;
+};
+
+}  // namespace rocksdb
@@ -0,0 +1,69 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include <atomic>
+
+#include "rocksdb/env.h"
+#include "util/repeatable_thread.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class RepeatableThreadTest : public testing::Test {
+ public:
+  RepeatableThreadTest() : env_(Env::Default()) {}
+
+  Env* env_;
+};
+
+namespace {
+// An env whose clock runs an hour behind the wall clock
+class LaggingEnv : public EnvWrapper {
+ public:
+  explicit LaggingEnv(Env* base) : EnvWrapper(base), now_micros_calls(0) {}
+
+  uint64_t NowMicros() override {
+    now_micros_calls++;
+    return target()->NowMicros() - 3600 * 1000000ULL;
+  }
+
+  std::atomic<uint64_t> now_micros_calls;
+};
+}  // namespace
+
+TEST_F(RepeatableThreadTest, CallsUntilCancelled) {
+  std::atomic<int> num_calls(0);
+  RepeatableThread thread([&num_calls]() { num_calls++; }, env_,
+                          10000 /* delay_us */);
+  env_->SleepForMicroseconds(200000);
+  thread.cancel();
+  const int calls = num_calls.load();
+  ASSERT_GE(calls, 1);
+  ASSERT_LE(calls, 20);
+  // Cancelling twice is fine, and no call is made after the first one
+  thread.cancel();
+  env_->SleepForMicroseconds(50000);
+  ASSERT_EQ(calls, num_calls.load());
+}
+
+TEST_F(RepeatableThreadTest, LaggingEnv) {
+  LaggingEnv lagging_env(env_);
+  std::atomic<int> num_calls(0);
+  RepeatableThread thread([&num_calls]() { num_calls++; }, &lagging_env,
+                          100000 /* delay_us */);
+  env_->SleepForMicroseconds(350000);
+  thread.cancel();
+  ASSERT_GE(num_calls.load(), 1);
+  ASSERT_LE(num_calls.load(), 4);
+  // Each wait looks at the clock a few times, instead of spinning on it
+  ASSERT_LT(lagging_env.now_micros_calls.load(), 100U);
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
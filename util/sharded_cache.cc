@@ -13,6 +13,7 @@
 
 #include "util/sharded_cache.h"
 
+#include <algorithm>
 #include <string>
 
 #include "util/mutexlock.h"
@@ -53,6 +54,15 @@ Status ShardedCache::Insert(const Slice& key, void* value, size_t charge,
       ->Insert(key, hash, value, charge, deleter, handle, priority);
 }
 
+Status ShardedCache::InsertWithHelper(const Slice& key, void* value,
+                                      size_t charge,
+                                      const CacheTierHelper* helper,
+                                      Handle** handle, Priority priority) {
+  uint32_t hash = HashSlice(key);
+  return GetShard(Shard(hash))
+      ->InsertWithHelper(key, hash, value, charge, helper, handle, priority);
+}
+
 Cache::Handle* ShardedCache::Lookup(const Slice& key, Statistics* stats) {
   uint32_t hash = HashSlice(key);
   return GetShard(Shard(hash))->Lookup(key, hash);
@@ -111,6 +121,18 @@ size_t ShardedCache::GetPinnedUsage() const {
   return usage;
 }
 
+void ShardedCache::GetHotKeys(
+    size_t max_entries,
+    std::vector<std::pair<std::string, Priority>>* keys) {
+  // Keys are spread evenly over the shards, so each one reports its share
+  int num_shards = 1 << num_shard_bits_;
+  size_t per_shard = (max_entries + num_shards - 1) / num_shards;
+  for (int s = 0; s < num_shards && keys->size() < max_entries; s++) {
+    GetShard(s)->GetHotKeys(
+        std::min(per_shard, max_entries - keys->size()), keys);
+  }
+}
+
 void ShardedCache::ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                           bool thread_safe) {
   int num_shards = 1 << num_shard_bits_;
@@ -28,6 +28,12 @@ class CacheShard {
                         size_t charge,
                         void (*deleter)(const Slice& key, void* value),
                         Cache::Handle** handle, Cache::Priority priority) = 0;
+  virtual Status InsertWithHelper(const Slice& key, uint32_t hash, void* value,
+                                  size_t charge, const CacheTierHelper* helper,
+                                  Cache::Handle** handle,
+                                  Cache::Priority priority) {
+    return Insert(key, hash, value, charge, helper->deleter, handle, priority);
+  }
   virtual Cache::Handle* Lookup(const Slice& key, uint32_t hash) = 0;
   virtual bool Ref(Cache::Handle* handle) = 0;
   virtual void Release(Cache::Handle* handle) = 0;
@@ -39,6 +45,9 @@ class CacheShard {
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) = 0;
   virtual void EraseUnRefEntries() = 0;
+  virtual void GetHotKeys(
+      size_t max_entries,
+      std::vector<std::pair<std::string, Cache::Priority>>* keys) {}
   virtual std::string GetPrintableOptions() const { return ""; }
 };
 
@@ -63,6 +72,9 @@ class ShardedCache : public Cache {
   virtual Status Insert(const Slice& key, void* value, size_t charge,
                         void (*deleter)(const Slice& key, void* value),
                         Handle** handle, Priority priority) override;
+  virtual Status InsertWithHelper(const Slice& key, void* value, size_t charge,
+                                  const CacheTierHelper* helper,
+                                  Handle** handle, Priority priority) override;
   virtual Handle* Lookup(const Slice& key, Statistics* stats) override;
   virtual bool Ref(Handle* handle) override;
   virtual void Release(Handle* handle) override;
@@ -76,6 +88,9 @@ class ShardedCache : public Cache {
   virtual void ApplyToAllCacheEntries(void (*callback)(void*, size_t),
                                       bool thread_safe) override;
   virtual void EraseUnRefEntries() override;
+  virtual void GetHotKeys(
+      size_t max_entries,
+      std::vector<std::pair<std::string, Priority>>* keys) override;
   virtual std::string GetPrintableOptions() const override;
 
   int GetNumShardBits() const { return num_shard_bits_; }
@@ -4,7 +4,11 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 //
 
+#include <thread>
+#include <vector>
+
 #include "port/stack_trace.h"
+#include "util/core_local.h"
 #include "util/testharness.h"
 #include "util/testutil.h"
 
@@ -26,6 +30,62 @@ TEST_F(StatisticsTest, Sanity) {
   }
 }
 
+TEST_F(StatisticsTest, CoreLocalArray) {
+  CoreLocalArray<std::atomic<int>> array;
+  ASSERT_GE(array.Size(), 8U);
+  ASSERT_EQ(0U, array.Size() & (array.Size() - 1));
+  ASSERT_GE(array.Size(), std::thread::hardware_concurrency());
+  for (size_t i = 0; i < array.Size(); i++) {
+    array.AccessAtCore(i)->store(0);
+  }
+  auto element_and_index = array.AccessElementAndIndex();
+  ASSERT_LT(element_and_index.second, array.Size());
+  ASSERT_EQ(array.AccessAtCore(element_and_index.second),
+            element_and_index.first);
+}
+
+TEST_F(StatisticsTest, ConcurrentRecording) {
+  auto stats = CreateDBStatistics();
+  const int kThreads = 8;
+  const int kTicksPerThread = 10000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&stats, t]() {
+      for (int i = 0; i < kTicksPerThread; i++) {
+        stats->recordTick(NUMBER_KEYS_WRITTEN, 2);
+        stats->measureTime(DB_GET, t + 1);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(2U * kThreads * kTicksPerThread,
+            stats->getTickerCount(NUMBER_KEYS_WRITTEN));
+  HistogramData data;
+  stats->histogramData(DB_GET, &data);
+  ASSERT_DOUBLE_EQ((kThreads + 1) / 2.0, data.average);
+}
+
+TEST_F(StatisticsTest, SetAndResetTickers) {
+  auto stats = CreateDBStatistics();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back(
+        [&stats]() { stats->recordTick(NUMBER_KEYS_READ, 5); });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(20U, stats->getTickerCount(NUMBER_KEYS_READ));
+
+  stats->setTickerCount(NUMBER_KEYS_READ, 7);
+  ASSERT_EQ(7U, stats->getTickerCount(NUMBER_KEYS_READ));
+  stats->recordTick(NUMBER_KEYS_READ, 3);
+  ASSERT_EQ(10U, stats->getAndResetTickerCount(NUMBER_KEYS_READ));
+  ASSERT_EQ(0U, stats->getTickerCount(NUMBER_KEYS_READ));
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
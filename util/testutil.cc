@@ -197,7 +197,7 @@ BlockBasedTableOptions RandomBlockBasedTableOptions(Random* rnd) {
   opt.index_type = rnd->Uniform(2) ? BlockBasedTableOptions::kBinarySearch
                                    : BlockBasedTableOptions::kHashSearch;
   opt.hash_index_allow_collision = rnd->Uniform(2);
-  opt.checksum = static_cast<ChecksumType>(rnd->Uniform(3));
+  opt.checksum = static_cast<ChecksumType>(rnd->Uniform(4));
   opt.block_size = rnd->Uniform(10000000);
   opt.block_size_deviation = rnd->Uniform(100);
   opt.block_restart_interval = rnd->Uniform(100);
@@ -270,6 +270,8 @@ void RandomInitDBOptions(DBOptions* db_opt, Random* rnd) {
   db_opt->log_file_time_to_roll = rnd->Uniform(10000);
   db_opt->manifest_preallocation_size = rnd->Uniform(10000);
   db_opt->max_log_file_size = rnd->Uniform(10000);
+  db_opt->max_persisted_hot_blocks = rnd->Uniform(10000);
+  db_opt->stats_history_buffer_size = rnd->Uniform(10000);
 
   // std::string options
   db_opt->db_log_dir = "path/to/db_log_dir";
@@ -285,12 +287,15 @@ void RandomInitDBOptions(DBOptions* db_opt, Random* rnd) {
   db_opt->bytes_per_sync = uint_max + rnd->Uniform(100000);
   db_opt->delayed_write_rate = uint_max + rnd->Uniform(100000);
   db_opt->delete_obsolete_files_period_micros = uint_max + rnd->Uniform(100000);
+  db_opt->hot_blocks_warm_up_bytes_per_sec = uint_max + rnd->Uniform(100000);
   db_opt->max_manifest_file_size = uint_max + rnd->Uniform(100000);
   db_opt->max_total_wal_size = uint_max + rnd->Uniform(100000);
   db_opt->wal_bytes_per_sync = uint_max + rnd->Uniform(100000);
 
   // unsigned int options
   db_opt->stats_dump_period_sec = rnd->Uniform(100000);
+  db_opt->hot_blocks_persist_period_sec = rnd->Uniform(100000);
+  db_opt->stats_persist_period_sec = rnd->Uniform(100000);
 }
 
 void RandomInitCFOptions(ColumnFamilyOptions* cf_opt, Random* rnd) {
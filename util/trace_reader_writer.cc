@@ -0,0 +1,130 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "rocksdb/trace_reader_writer.h"
+
+#include "util/coding.h"
+#include "util/file_reader_writer.h"
+
+namespace rocksdb {
+
+namespace {
+
+// Each record is stored as its length (fixed32) followed by its data
+const size_t kRecordHeaderSize = sizeof(uint32_t);
+
+class FileTraceWriter : public TraceWriter {
+ public:
+  explicit FileTraceWriter(std::unique_ptr<WritableFileWriter>&& file_writer)
+      : file_writer_(std::move(file_writer)) {}
+
+  ~FileTraceWriter() { Close(); }
+
+  Status Write(const Slice& data) override {
+    if (file_writer_ == nullptr) {
+      return Status::InvalidArgument("Trace file is closed");
+    }
+    char header[kRecordHeaderSize];
+    EncodeFixed32(header, static_cast<uint32_t>(data.size()));
+    Status s = file_writer_->Append(Slice(header, sizeof(header)));
+    if (s.ok()) {
+      s = file_writer_->Append(data);
+    }
+    return s;
+  }
+
+  Status Close() override {
+    if (file_writer_ == nullptr) {
+      return Status::OK();
+    }
+    Status s = file_writer_->Close();
+    file_writer_.reset();
+    return s;
+  }
+
+  uint64_t GetFileSize() override {
+    return file_writer_ == nullptr ? 0 : file_writer_->GetFileSize();
+  }
+
+ private:
+  std::unique_ptr<WritableFileWriter> file_writer_;
+};
+
+class FileTraceReader : public TraceReader {
+ public:
+  explicit FileTraceReader(std::unique_ptr<SequentialFileReader>&& reader)
+      : file_reader_(std::move(reader)) {}
+
+  Status Read(std::string* data) override {
+    if (file_reader_ == nullptr) {
+      return Status::InvalidArgument("Trace file is closed");
+    }
+    char header[kRecordHeaderSize];
+    Slice result;
+    Status s = file_reader_->Read(kRecordHeaderSize, &result, header);
+    if (!s.ok()) {
+      return s;
+    }
+    if (result.size() == 0) {
+      return Status::Incomplete("End of trace");
+    }
+    if (result.size() < kRecordHeaderSize) {
+      return Status::Corruption("Truncated trace record header");
+    }
+    const uint32_t length = DecodeFixed32(result.data());
+    data->resize(length);
+    s = file_reader_->Read(length, &result, &(*data)[0]);
+    if (!s.ok()) {
+      return s;
+    }
+    if (result.size() < length) {
+      return Status::Corruption("Truncated trace record");
+    }
+    if (result.data() != data->data()) {
+      data->assign(result.data(), result.size());
+    }
+    return Status::OK();
+  }
+
+  Status Close() override {
+    file_reader_.reset();
+    return Status::OK();
+  }
+
+ private:
+  std::unique_ptr<SequentialFileReader> file_reader_;
+};
+
+}  // namespace
+
+Status NewFileTraceWriter(Env* env, const EnvOptions& env_options,
+                          const std::string& trace_filename,
+                          std::unique_ptr<TraceWriter>* trace_writer) {
+  unique_ptr<WritableFile> trace_file;
+  Status s = env->NewWritableFile(trace_filename, &trace_file, env_options);
+  if (!s.ok()) {
+    return s;
+  }
+  std::unique_ptr<WritableFileWriter> file_writer(
+      new WritableFileWriter(std::move(trace_file), env_options));
+  trace_writer->reset(new FileTraceWriter(std::move(file_writer)));
+  return s;
+}
+
+Status NewFileTraceReader(Env* env, const EnvOptions& env_options,
+                          const std::string& trace_filename,
+                          std::unique_ptr<TraceReader>* trace_reader) {
+  unique_ptr<SequentialFile> trace_file;
+  Status s = env->NewSequentialFile(trace_filename, &trace_file, env_options);
+  if (!s.ok()) {
+    return s;
+  }
+  std::unique_ptr<SequentialFileReader> file_reader(
+      new SequentialFileReader(std::move(trace_file)));
+  trace_reader->reset(new FileTraceReader(std::move(file_reader)));
+  return s;
+}
+
+}  // namespace rocksdb
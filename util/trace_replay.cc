@@ -0,0 +1,342 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/trace_replay.h"
+
+#include <algorithm>
+#include "rocksdb/db.h"
+#include "rocksdb/write_batch.h"
+#include "util/coding.h"
+#include "util/threadpool_imp.h"
+
+namespace rocksdb {
+
+void EncodeTrace(const Trace& trace, std::string* dst) {
+  PutFixed64(dst, trace.ts);
+  dst->push_back(trace.type);
+  dst->append(trace.payload);
+}
+
+Status DecodeTrace(const Slice& input, Trace* trace) {
+  if (input.size() < sizeof(uint64_t) + 1) {
+    return Status::Corruption("Truncated query trace record");
+  }
+  trace->ts = DecodeFixed64(input.data());
+  const unsigned char type =
+      static_cast<unsigned char>(input[sizeof(uint64_t)]);
+  if (type < kTraceBegin || type >= kTraceMax) {
+    return Status::Corruption("Unknown query trace record type");
+  }
+  trace->type = static_cast<TraceType>(type);
+  trace->payload.assign(input.data() + sizeof(uint64_t) + 1,
+                        input.size() - sizeof(uint64_t) - 1);
+  return Status::OK();
+}
+
+ConcurrentTraceWriter::ConcurrentTraceWriter(
+    std::unique_ptr<TraceWriter>&& trace_writer, uint64_t max_trace_file_size)
+    : trace_writer_(std::move(trace_writer)),
+      max_trace_file_size_(max_trace_file_size),
+      pending_(nullptr),
+      ended_(false) {}
+
+ConcurrentTraceWriter::~ConcurrentTraceWriter() {
+  PendingRecord* pending = pending_.load(std::memory_order_acquire);
+  while (pending != nullptr) {
+    PendingRecord* next = pending->next;
+    delete pending;
+    pending = next;
+  }
+}
+
+Status ConcurrentTraceWriter::Write(std::string&& record) {
+  if (ended_.load(std::memory_order_relaxed)) {
+    return Status::OK();
+  }
+  PendingRecord* pending = new PendingRecord();
+  pending->data = std::move(record);
+  pending->next = pending_.load(std::memory_order_relaxed);
+  while (!pending_.compare_exchange_weak(pending->next, pending,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed)) {
+  }
+  // Otherwise the thread already writing picks the record up, or the next
+  // one to write or Close() does
+  std::unique_lock<SpinMutex> lock(write_mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return Status::OK();
+  }
+  return WritePendingLocked();
+}
+
+Status ConcurrentTraceWriter::Close(const std::string& last_record) {
+  std::lock_guard<SpinMutex> lock(write_mutex_);
+  Status s = WritePendingLocked();
+  if (!ended_.load(std::memory_order_relaxed)) {
+    if (!last_record.empty()) {
+      s = trace_writer_->Write(last_record);
+    }
+    ended_.store(true, std::memory_order_relaxed);
+  }
+  Status close_status = trace_writer_->Close();
+  return s.ok() ? close_status : s;
+}
+
+Status ConcurrentTraceWriter::WritePendingLocked() {
+  // Take the records queued so far, in the order they were queued
+  PendingRecord* pending = pending_.exchange(nullptr, std::memory_order_acquire);
+  PendingRecord* oldest = nullptr;
+  while (pending != nullptr) {
+    PendingRecord* next = pending->next;
+    pending->next = oldest;
+    oldest = pending;
+    pending = next;
+  }
+
+  Status s;
+  while (oldest != nullptr) {
+    if (s.ok() && !ended_.load(std::memory_order_relaxed)) {
+      s = trace_writer_->Write(oldest->data);
+    }
+    PendingRecord* next = oldest->next;
+    delete oldest;
+    oldest = next;
+  }
+  if (ended_.load(std::memory_order_relaxed)) {
+    return Status::OK();
+  }
+  if (s.ok() && trace_writer_->GetFileSize() >= max_trace_file_size_) {
+    s = Status::Incomplete("Trace reached its maximum file size");
+  }
+  if (!s.ok()) {
+    ended_.store(true, std::memory_order_relaxed);
+  }
+  return s;
+}
+
+Tracer::Tracer(Env* env, const TraceOptions& options,
+               std::unique_ptr<TraceWriter>&& trace_writer)
+    : env_(env),
+      options_(options),
+      trace_writer_(std::move(trace_writer), options.max_trace_file_size),
+      trace_request_count_(0) {}
+
+Tracer::~Tracer() {}
+
+Status Tracer::WriteHeader() {
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = kTraceBegin;
+  PutFixed32(&trace.payload, kQueryTraceMagicNumber);
+  PutFixed32(&trace.payload, kQueryTraceFormatVersion);
+  return WriteTrace(trace);
+}
+
+Status Tracer::Write(WriteBatch* write_batch) {
+  if (ShouldSkipTrace()) {
+    return Status::OK();
+  }
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = kTraceWrite;
+  trace.payload = write_batch->Data();
+  return WriteTrace(trace);
+}
+
+Status Tracer::Get(uint32_t cf_id, const Slice& key) {
+  return TraceKey(kTraceGet, cf_id, key);
+}
+
+Status Tracer::IteratorSeek(uint32_t cf_id, const Slice& key) {
+  return TraceKey(kTraceIteratorSeek, cf_id, key);
+}
+
+Status Tracer::IteratorSeekForPrev(uint32_t cf_id, const Slice& key) {
+  return TraceKey(kTraceIteratorSeekForPrev, cf_id, key);
+}
+
+Status Tracer::TraceKey(TraceType type, uint32_t cf_id, const Slice& key) {
+  if (ShouldSkipTrace()) {
+    return Status::OK();
+  }
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = type;
+  PutVarint32(&trace.payload, cf_id);
+  PutLengthPrefixedSlice(&trace.payload, key);
+  return WriteTrace(trace);
+}
+
+bool Tracer::ShouldSkipTrace() {
+  if (options_.sampling_frequency <= 1) {
+    return false;
+  }
+  return trace_request_count_.fetch_add(1, std::memory_order_relaxed) %
+             options_.sampling_frequency !=
+         0;
+}
+
+Status Tracer::Close() {
+  Trace trace;
+  trace.ts = env_->NowMicros();
+  trace.type = kTraceEnd;
+  std::string encoded_trace;
+  EncodeTrace(trace, &encoded_trace);
+  return trace_writer_.Close(encoded_trace);
+}
+
+Status Tracer::WriteTrace(const Trace& trace) {
+  std::string encoded_trace;
+  EncodeTrace(trace, &encoded_trace);
+  return trace_writer_.Write(std::move(encoded_trace));
+}
+
+Replayer::Replayer(DB* db, const std::vector<ColumnFamilyHandle*>& handles,
+                   std::unique_ptr<TraceReader>&& trace_reader)
+    : db_(db),
+      env_(db->GetEnv()),
+      trace_reader_(std::move(trace_reader)),
+      fast_forward_(1.0),
+      num_queries_(0) {
+  for (ColumnFamilyHandle* cfh : handles) {
+    cf_map_[cfh->GetID()] = cfh;
+  }
+}
+
+Replayer::~Replayer() { trace_reader_.reset(); }
+
+Status Replayer::SetFastForward(double fast_forward) {
+  if (!(fast_forward > 0.0)) {
+    return Status::InvalidArgument("Fast forward must be positive");
+  }
+  fast_forward_ = fast_forward;
+  return Status::OK();
+}
+
+Status Replayer::Replay() {
+  Status s = Run([this](Trace&& trace) { Execute(trace); });
+  return s.ok() ? first_error_ : s;
+}
+
+Status Replayer::MultiThreadReplay(uint32_t threads_num) {
+  ThreadPoolImpl thread_pool;
+  thread_pool.SetHostEnv(env_);
+  thread_pool.SetBackgroundThreads(static_cast<int>(threads_num));
+  Status s = Run([this, &thread_pool](Trace&& trace) {
+    // std::function must be copyable, so the trace is shared rather than
+    // moved into the job
+    std::shared_ptr<Trace> job_trace = std::make_shared<Trace>();
+    *job_trace = std::move(trace);
+    thread_pool.SubmitJob([this, job_trace]() { Execute(*job_trace); });
+  });
+  thread_pool.WaitForJobsAndJoinAllThreads();
+  return s.ok() ? first_error_ : s;
+}
+
+Status Replayer::Run(const std::function<void(Trace&&)>& dispatch) {
+  num_queries_ = 0;
+  first_error_ = Status::OK();
+  Trace header;
+  Status s = ReadHeader(&header);
+  if (!s.ok()) {
+    return s;
+  }
+
+  const uint64_t replay_start = env_->NowMicros();
+  Trace trace;
+  while ((s = ReadTrace(&trace)).ok()) {
+    if (trace.type == kTraceEnd) {
+      break;
+    }
+    if (trace.type == kTraceBegin) {
+      return Status::Corruption("Query trace with more than one header");
+    }
+    const uint64_t due =
+        replay_start +
+        static_cast<uint64_t>(
+            (trace.ts > header.ts ? trace.ts - header.ts : 0) / fast_forward_);
+    uint64_t now = env_->NowMicros();
+    while (due > now) {
+      // SleepForMicroseconds() takes an int, shorter than the gaps a trace
+      // can have
+      env_->SleepForMicroseconds(
+          static_cast<int>(std::min<uint64_t>(due - now, 1000000)));
+      now = env_->NowMicros();
+    }
+    num_queries_++;
+    dispatch(std::move(trace));
+    trace = Trace();
+  }
+  // A trace whose tracer was never closed ends without a kTraceEnd record
+  return s.IsIncomplete() ? Status::OK() : s;
+}
+
+void Replayer::Execute(const Trace& trace) {
+  Status s = ExecuteQuery(trace);
+  if (!s.ok()) {
+    MutexLock l(&error_mutex_);
+    if (first_error_.ok()) {
+      first_error_ = s;
+    }
+  }
+}
+
+Status Replayer::ExecuteQuery(const Trace& trace) {
+  if (trace.type == kTraceWrite) {
+    WriteBatch batch(trace.payload);
+    return db_->Write(WriteOptions(), &batch);
+  }
+
+  Slice payload(trace.payload);
+  uint32_t cf_id;
+  Slice key;
+  if (!GetVarint32(&payload, &cf_id) ||
+      !GetLengthPrefixedSlice(&payload, &key)) {
+    return Status::Corruption("Bad query trace record");
+  }
+  auto cfh = cf_map_.find(cf_id);
+  if (cfh == cf_map_.end()) {
+    return Status::OK();
+  }
+  if (trace.type == kTraceGet) {
+    std::string value;
+    Status s = db_->Get(ReadOptions(), cfh->second, key, &value);
+    return s.IsNotFound() ? Status::OK() : s;
+  }
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions(),
+                                                  cfh->second));
+  if (trace.type == kTraceIteratorSeek) {
+    iter->Seek(key);
+  } else {
+    iter->SeekForPrev(key);
+  }
+  return iter->status();
+}
+
+Status Replayer::ReadHeader(Trace* header) {
+  Status s = ReadTrace(header);
+  if (!s.ok()) {
+    return s.IsIncomplete() ? Status::Corruption("Empty query trace") : s;
+  }
+  if (header->type != kTraceBegin || header->payload.size() != 8 ||
+      DecodeFixed32(header->payload.data()) != kQueryTraceMagicNumber) {
+    return Status::Corruption("Not a query trace");
+  }
+  if (DecodeFixed32(header->payload.data() + 4) > kQueryTraceFormatVersion) {
+    return Status::NotSupported("Query trace has a newer format");
+  }
+  return Status::OK();
+}
+
+Status Replayer::ReadTrace(Trace* trace) {
+  std::string encoded_trace;
+  Status s = trace_reader_->Read(&encoded_trace);
+  if (!s.ok()) {
+    return s;
+  }
+  return DecodeTrace(encoded_trace, trace);
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,186 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "rocksdb/env.h"
+#include "rocksdb/options.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/trace_reader_writer.h"
+#include "util/mutexlock.h"
+
+namespace rocksdb {
+
+class ColumnFamilyHandle;
+class DB;
+class WriteBatch;
+
+// A query trace is a sequence of TraceWriter records, each one:
+//   timestamp in microseconds: fixed64
+//   type: char
+//   payload, depending on the type:
+//     kTraceBegin       magic number: fixed32, format version: fixed32
+//     kTraceEnd         empty
+//     kTraceWrite       contents of the WriteBatch
+//     kTraceGet, kTraceIteratorSeek, kTraceIteratorSeekForPrev
+//                       column family id: varint32, followed by the
+//                       length-prefixed key
+// Puts, merges and deletes all reach the DB as a WriteBatch and are traced
+// as kTraceWrite. Iterators are only traced when they seek: their Next() and
+// Prev() calls are not recorded, so a replayed iterator stops at the seek.
+const uint32_t kQueryTraceMagicNumber = 0x51545243;  // "QTRC"
+const uint32_t kQueryTraceFormatVersion = 1;
+
+enum TraceType : char {
+  kTraceBegin = 1,
+  kTraceEnd = 2,
+  kTraceWrite = 3,
+  kTraceGet = 4,
+  kTraceIteratorSeek = 5,
+  kTraceIteratorSeekForPrev = 6,
+  kTraceMax,
+};
+
+struct Trace {
+  uint64_t ts = 0;
+  TraceType type = kTraceMax;
+  std::string payload;
+};
+
+extern void EncodeTrace(const Trace& trace, std::string* dst);
+extern Status DecodeTrace(const Slice& input, Trace* trace);
+
+// Writes the records of a trace produced by many threads to a TraceWriter,
+// without the threads waiting for each other: each record is queued without
+// a lock, and written by whichever thread finds no other one writing. The
+// trace ends, and later records are dropped, once a record cannot be written
+// or the trace has reached max_trace_file_size.
+class ConcurrentTraceWriter {
+ public:
+  ConcurrentTraceWriter(std::unique_ptr<TraceWriter>&& trace_writer,
+                        uint64_t max_trace_file_size);
+  ~ConcurrentTraceWriter();
+
+  // The call that ends the trace returns why; all others return OK
+  Status Write(std::string&& record);
+
+  // Writes the queued records, then last_record unless it is empty, and
+  // closes the TraceWriter. REQUIRES: no other call in progress
+  Status Close(const std::string& last_record);
+
+ private:
+  // A record waiting to be written, in a list from the newest to the oldest
+  struct PendingRecord {
+    std::string data;
+    PendingRecord* next;
+  };
+
+  // Writes the records queued so far. REQUIRES: write_mutex_ held
+  Status WritePendingLocked();
+
+  std::unique_ptr<TraceWriter> trace_writer_;
+  const uint64_t max_trace_file_size_;
+  std::atomic<PendingRecord*> pending_;
+  // Held by the thread writing to trace_writer_
+  SpinMutex write_mutex_;
+  // Set once the trace has ended
+  std::atomic<bool> ended_;
+
+  // No copying allowed
+  ConcurrentTraceWriter(const ConcurrentTraceWriter&) = delete;
+  ConcurrentTraceWriter& operator=(const ConcurrentTraceWriter&) = delete;
+};
+
+// Tracer turns the queries made to a DB into trace records. It is
+// thread-safe, and queries traced concurrently do not wait for each other,
+// see ConcurrentTraceWriter.
+class Tracer {
+ public:
+  Tracer(Env* env, const TraceOptions& options,
+         std::unique_ptr<TraceWriter>&& trace_writer);
+  ~Tracer();
+
+  // Must be called once, before any query is traced
+  Status WriteHeader();
+
+  // The trace ends, and later queries are dropped, once a record cannot be
+  // written or the trace has reached options.max_trace_file_size. The call
+  // that ends the trace returns why; all others return OK.
+  Status Write(WriteBatch* write_batch);
+  Status Get(uint32_t cf_id, const Slice& key);
+  Status IteratorSeek(uint32_t cf_id, const Slice& key);
+  Status IteratorSeekForPrev(uint32_t cf_id, const Slice& key);
+
+  // Writes the queued records and the kTraceEnd record, and closes the
+  // TraceWriter. REQUIRES: no other call in progress
+  Status Close();
+
+ private:
+  // True for the queries left out by sampling
+  bool ShouldSkipTrace();
+  Status TraceKey(TraceType type, uint32_t cf_id, const Slice& key);
+  Status WriteTrace(const Trace& trace);
+
+  Env* env_;
+  const TraceOptions options_;
+  ConcurrentTraceWriter trace_writer_;
+  std::atomic<uint64_t> trace_request_count_;
+};
+
+// Replayer re-issues the queries of a trace against a DB, waiting between
+// them as long as the traced application did, divided by the fast forward
+// factor. Queries on column families missing from the handles given are
+// skipped. Gets of keys the DB replayed against does not hold are not
+// errors.
+class Replayer {
+ public:
+  Replayer(DB* db, const std::vector<ColumnFamilyHandle*>& handles,
+           std::unique_ptr<TraceReader>&& trace_reader);
+  ~Replayer();
+
+  // 1.0 replays at the traced speed, 2.0 twice as fast. Returns
+  // InvalidArgument unless fast_forward is positive.
+  Status SetFastForward(double fast_forward);
+
+  // Replays the whole trace from the calling thread. Returns the error of the
+  // first query that failed, if any, once the whole trace was replayed.
+  Status Replay();
+
+  // Replays the whole trace with threads_num threads issuing the queries. A
+  // query can then overlap with the ones traced after it. Returns like
+  // Replay().
+  Status MultiThreadReplay(uint32_t threads_num);
+
+  // Number of queries issued by the last replay
+  uint64_t num_queries() const { return num_queries_; }
+
+ private:
+  Status ReadHeader(Trace* header);
+  Status ReadTrace(Trace* trace);
+  // Issues the query of a kTraceWrite, kTraceGet or kTraceIteratorSeek*
+  // record, and records its error if it is the first one
+  void Execute(const Trace& trace);
+  Status ExecuteQuery(const Trace& trace);
+  // Reads the queries and hands each to dispatch once it is due
+  Status Run(const std::function<void(Trace&&)>& dispatch);
+
+  DB* db_;
+  Env* env_;
+  std::unordered_map<uint32_t, ColumnFamilyHandle*> cf_map_;
+  std::unique_ptr<TraceReader> trace_reader_;
+  double fast_forward_;
+  uint64_t num_queries_;
+  // First error returned by a replayed query
+  port::Mutex error_mutex_;
+  Status first_error_;
+};
+
+}  // namespace rocksdb
@@ -59,6 +59,8 @@ It depends on successfully passing SMHasher test set.
 
 #pragma once
 
+#include <stddef.h>
+
 #if defined (__cplusplus)
 namespace rocksdb {
 #endif
@@ -148,6 +150,43 @@ To free memory context, use XXH32_digest(), or free().
 
 
 
+//****************************
+// 64-bits Hash Functions
+//****************************
+
+unsigned long long XXH64 (const void* input, size_t len, unsigned long long seed);
+
+/*
+XXH64() :
+    Calculate the 64-bits hash of sequence of length "len" stored at memory address "input".
+    It reads 8 bytes at a time and is about twice as fast as XXH32() on 64-bits platforms.
+    Its result is the same as the XXH64() of the reference xxHash library.
+*/
+
+typedef struct
+{
+    unsigned long long total_len;
+    unsigned long long v1;
+    unsigned long long v2;
+    unsigned long long v3;
+    unsigned long long v4;
+    unsigned long long mem64[4];
+    unsigned memsize;
+} XXH64_state_t;
+
+XXH_errorcode      XXH64_reset  (XXH64_state_t* state, unsigned long long seed);
+XXH_errorcode      XXH64_update (XXH64_state_t* state, const void* input, size_t len);
+unsigned long long XXH64_digest (const XXH64_state_t* state);
+
+/*
+These functions calculate the XXH64() of an input provided in several packets.
+Unlike XXH32_init(), they do not allocate: the state can live on the stack, is
+started with XXH64_reset(), and XXH64_digest() can be called at any time
+without ending the calculation.
+*/
+
+
+
 //****************************
 // Deprecated function names
 //****************************
@@ -119,7 +119,8 @@ Status BlobDB::Put(const WriteOptions& options, const Slice& key,
 
   block_contents = CompressBlock(block_builder.Finish(), compression_opts,
                                  &compression, kBlockBasedTableVersionFormat,
-                                 Slice() /* dictionary */, &compression_output);
+                                 CompressionDict::GetEmptyDict(),
+                                 &compression_output);
 
   char header[kBlockHeaderSize];
   char trailer[kBlockTrailerSize];
@@ -51,6 +51,34 @@ void ReadVarint64(const char** src_ptr, uint64_t* val_ptr) {
   assert(q != nullptr);
   *src_ptr = q;
 }
+
+// Whether the dictionary at src, a varint count followed by as many varint
+// entries, ends by limit
+bool CheckDictionary(const char* src, const char* limit) {
+  uint64_t dict_size;
+  src = GetVarint64Ptr(src, limit, &dict_size);
+  for (uint64_t i = 0; src != nullptr && i < dict_size; ++i) {
+    uint64_t dict_key;
+    src = GetVarint64Ptr(src, limit, &dict_key);
+  }
+  return src != nullptr;
+}
+
+// Whether the optional null mark at *src ends by limit, and the value after
+// it is null. Moves *src past the mark.
+bool CheckNullMark(bool nullable, const char** src, const char* limit,
+                   bool* is_null) {
+  *is_null = false;
+  if (!nullable) {
+    return true;
+  }
+  if (*src >= limit) {
+    return false;
+  }
+  *is_null = **src == 0;
+  *src += 1;
+  return true;
+}
 }  // namespace
 
 size_t FixedLengthColBufDecoder::Init(const char* src) {
@@ -80,6 +108,57 @@ size_t FixedLengthColBufDecoder::Init(const char* src) {
   return src - orig_src;
 }
 
+bool FixedLengthColBufDecoder::CheckInit(const char* src,
+                                         const char* limit) const {
+  if (col_compression_type_ == kColDict ||
+      col_compression_type_ == kColRleDict) {
+    return CheckDictionary(src, limit);
+  }
+  return true;
+}
+
+bool FixedLengthColBufDecoder::CheckNext(const char* src,
+                                         const char* limit) const {
+  bool is_null;
+  if (!CheckNullMark(nullable_, &src, limit, &is_null)) {
+    return false;
+  }
+  if (is_null) {
+    return true;
+  }
+  uint64_t read_val = 0;
+  if (IsRunLength(col_compression_type_)) {
+    if (remain_runs_ > 0) {
+      // The value of the current run was checked when the run started
+      return true;
+    }
+    if (col_compression_type_ == kColRle) {
+      if (static_cast<size_t>(limit - src) < size_) {
+        return false;
+      }
+      src += size_;
+    } else {
+      src = GetVarint64Ptr(src, limit, &read_val);
+    }
+    uint64_t runs = 0;
+    if (src == nullptr || GetVarint64Ptr(src, limit, &runs) == nullptr ||
+        runs == 0) {
+      return false;
+    }
+  } else if (col_compression_type_ == kColNoCompression) {
+    if (static_cast<size_t>(limit - src) < size_) {
+      return false;
+    }
+  } else if (GetVarint64Ptr(src, limit, &read_val) == nullptr) {
+    return false;
+  }
+  if (col_compression_type_ == kColRleDict ||
+      col_compression_type_ == kColDict) {
+    return read_val < dict_vec_.size();
+  }
+  return true;
+}
+
 size_t FixedLengthColBufDecoder::Decode(const char* src, char** dest) {
   uint64_t read_val = 0;
   const char* orig_src = src;
@@ -170,13 +249,29 @@ size_t LongFixedLengthColBufDecoder::Decode(const char* src, char** dest) {
   }
   memcpy(*dest, src, size_);
   *dest += size_;
-  return size_ + 1;
+  return nullable_ ? size_ + 1 : size_;
+}
+
+bool LongFixedLengthColBufDecoder::CheckNext(const char* src,
+                                             const char* limit) const {
+  bool is_null;
+  if (!CheckNullMark(nullable_, &src, limit, &is_null)) {
+    return false;
+  }
+  return is_null || static_cast<size_t>(limit - src) >= size_;
+}
+
+bool VariableLengthColBufDecoder::CheckNext(const char* src,
+                                            const char* limit) const {
+  return src < limit &&
+         static_cast<size_t>(limit - src) >=
+             1 + static_cast<size_t>(static_cast<uint8_t>(*src));
 }
 
 size_t VariableLengthColBufDecoder::Decode(const char* src, char** dest) {
   uint8_t len;
   len = *src;
-  memcpy(dest, reinterpret_cast<char*>(&len), 1);
+  memcpy(*dest, reinterpret_cast<char*>(&len), 1);
   *dest += 1;
   src += 1;
   memcpy(*dest, src, len);
@@ -206,6 +301,40 @@ size_t VariableChunkColBufDecoder::Init(const char* src) {
   return src - orig_src;
 }
 
+bool VariableChunkColBufDecoder::CheckInit(const char* src,
+                                           const char* limit) const {
+  if (col_compression_type_ == kColDict) {
+    return CheckDictionary(src, limit);
+  }
+  return true;
+}
+
+bool VariableChunkColBufDecoder::CheckNext(const char* src,
+                                           const char* limit) const {
+  uint64_t size;
+  src = GetVarint64Ptr(src, limit, &size);
+  if (src == nullptr) {
+    return false;
+  }
+  const uint64_t full_chunks = size / 8;
+  for (uint64_t i = 0; i < full_chunks + 1; ++i) {
+    if (col_compression_type_ == kColDict) {
+      uint64_t dict_val;
+      src = GetVarint64Ptr(src, limit, &dict_val);
+      if (src == nullptr || dict_val >= dict_vec_.size()) {
+        return false;
+      }
+    } else {
+      const size_t chunk_size = i == full_chunks ? size % 8 : 8;
+      if (static_cast<size_t>(limit - src) < chunk_size) {
+        return false;
+      }
+      src += chunk_size;
+    }
+  }
+  return true;
+}
+
 size_t VariableChunkColBufDecoder::Decode(const char* src, char** dest) {
   const char* orig_src = src;
   uint64_t size = 0;
@@ -20,11 +20,19 @@ struct ColDeclaration;
 // ColBufDecoder is a class to decode column buffers. It can be populated from a
 // ColDeclaration. Before starting decoding, a Init() method should be called.
 // Each time it takes a column value into Decode() method.
+// Init() and Decode() trust their input. Buffers that may be corrupt are
+// checked with CheckInit() and CheckNext() first.
 class ColBufDecoder {
  public:
   virtual ~ColBufDecoder() = 0;
   virtual size_t Init(const char* src) { return 0; }
   virtual size_t Decode(const char* src, char** dest) = 0;
+  // Whether Init(src) reads a valid header that ends by limit
+  virtual bool CheckInit(const char* src, const char* limit) const {
+    return true;
+  }
+  // Whether the next Decode(src) reads a valid value that ends by limit
+  virtual bool CheckNext(const char* src, const char* limit) const = 0;
   static ColBufDecoder* NewColBufDecoder(const ColDeclaration& col_declaration);
 
  protected:
@@ -47,6 +55,8 @@ class FixedLengthColBufDecoder : public ColBufDecoder {
 
   size_t Init(const char* src) override;
   size_t Decode(const char* src, char** dest) override;
+  bool CheckInit(const char* src, const char* limit) const override;
+  bool CheckNext(const char* src, const char* limit) const override;
   ~FixedLengthColBufDecoder() {}
 
  private:
@@ -68,6 +78,7 @@ class LongFixedLengthColBufDecoder : public ColBufDecoder {
       : size_(size), nullable_(nullable) {}
 
   size_t Decode(const char* src, char** dest) override;
+  bool CheckNext(const char* src, const char* limit) const override;
   ~LongFixedLengthColBufDecoder() {}
 
  private:
@@ -78,6 +89,7 @@ class LongFixedLengthColBufDecoder : public ColBufDecoder {
 class VariableLengthColBufDecoder : public ColBufDecoder {
  public:
   size_t Decode(const char* src, char** dest) override;
+  bool CheckNext(const char* src, const char* limit) const override;
   ~VariableLengthColBufDecoder() {}
 };
 
@@ -85,6 +97,8 @@ class VariableChunkColBufDecoder : public VariableLengthColBufDecoder {
  public:
   size_t Init(const char* src) override;
   size_t Decode(const char* src, char** dest) override;
+  bool CheckInit(const char* src, const char* limit) const override;
+  bool CheckNext(const char* src, const char* limit) const override;
   explicit VariableChunkColBufDecoder(ColCompressionType col_compression_type)
       : col_compression_type_(col_compression_type) {}
   VariableChunkColBufDecoder() : col_compression_type_(kColNoCompression) {}
@@ -109,8 +123,10 @@ struct KVPairColBufDecoders {
       value_col_bufs.emplace_back(
           std::move(ColBufDecoder::NewColBufDecoder(vcd)));
     }
-    value_checksum_buf.reset(
-        ColBufDecoder::NewColBufDecoder(*kvp_cd.value_checksum_declaration));
+    if (kvp_cd.value_checksum_declaration != nullptr) {
+      value_checksum_buf.reset(
+          ColBufDecoder::NewColBufDecoder(*kvp_cd.value_checksum_declaration));
+    }
   }
 };
 }  // namespace rocksdb
@@ -130,7 +130,7 @@ void FixedLengthColBufEncoder::Finish() {
     }
     buffer_ = header + buffer_;
   }
-  if (IsRunLength(col_compression_type_)) {
+  if (IsRunLength(col_compression_type_) && run_length_ > 0) {
     // Finish last run value
     if (col_compression_type_ == kColRle) {
       buffer_.append(reinterpret_cast<char *>(&run_val_), size_);
@@ -94,7 +94,7 @@ class FixedLengthColBufEncoder : public ColBufEncoder {
 
   // for encoding
   uint64_t last_val_;
-  int16_t run_length_;
+  int64_t run_length_;
   uint64_t run_val_;
   // Map to store dictionary for dictionary encoding
   std::unordered_map<uint64_t, uint64_t> dictionary_;
@@ -186,7 +186,8 @@ struct KVPairColDeclarations {
 };
 
 // Similar to KVPairDeclarations, KVPairColBufEncoders is used to hold column
-// buffer encoders of all columns in key and value.
+// buffer encoders of all columns in key and value. value_checksum_buf is null
+// if there is no value checksum declaration.
 struct KVPairColBufEncoders {
   std::vector<std::unique_ptr<ColBufEncoder>> key_col_bufs;
   std::vector<std::unique_ptr<ColBufEncoder>> value_col_bufs;
@@ -201,8 +202,10 @@ struct KVPairColBufEncoders {
       value_col_bufs.emplace_back(
           std::move(ColBufEncoder::NewColBufEncoder(vcd)));
     }
-    value_checksum_buf.reset(
-        ColBufEncoder::NewColBufEncoder(*kvp_cd.value_checksum_declaration));
+    if (kvp_cd.value_checksum_declaration != nullptr) {
+      value_checksum_buf.reset(
+          ColBufEncoder::NewColBufEncoder(*kvp_cd.value_checksum_declaration));
+    }
   }
 
   // Helper function to call Finish()
@@ -213,7 +216,9 @@ struct KVPairColBufEncoders {
     for (auto &col_buf : value_col_bufs) {
       col_buf->Finish();
     }
-    value_checksum_buf->Finish();
+    if (value_checksum_buf) {
+      value_checksum_buf->Finish();
+    }
   }
 };
 }  // namespace rocksdb
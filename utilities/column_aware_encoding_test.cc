@@ -235,6 +235,70 @@ TEST_F(ColumnAwareEncodingTest, ChunkBufEncodeDecode) {
   delete[] decoded_data_base;
 }
 
+TEST_F(ColumnAwareEncodingTest, CheckTruncatedColumns) {
+  char* decoded_data = new char[100];
+  char* decoded_data_base = decoded_data;
+
+  // A length and as many bytes
+  VariableLengthColBufDecoder var_decoder;
+  std::string var_data("\3abc", 4);
+  const char* var_ptr = var_data.data();
+  ASSERT_TRUE(var_decoder.CheckNext(var_ptr, var_ptr + 4));
+  ASSERT_FALSE(var_decoder.CheckNext(var_ptr, var_ptr + 3));
+  ASSERT_FALSE(var_decoder.CheckNext(var_ptr, var_ptr));
+
+  // A run of three values is read with the first one
+  FixedLengthColBufEncoder rle_encoder(4, kColRleVarint);
+  uint32_t val = 300;
+  for (int i = 0; i < 3; ++i) {
+    rle_encoder.Append(reinterpret_cast<const char*>(&val));
+  }
+  rle_encoder.Finish();
+  const std::string& rle_data = rle_encoder.GetData();
+  const char* rle_ptr = rle_data.data();
+  const char* rle_limit = rle_ptr + rle_data.size();
+  FixedLengthColBufDecoder rle_decoder(4, kColRleVarint);
+  ASSERT_TRUE(rle_decoder.CheckInit(rle_ptr, rle_limit));
+  rle_ptr += rle_decoder.Init(rle_ptr);
+  ASSERT_FALSE(rle_decoder.CheckNext(rle_ptr, rle_limit - 1));
+  ASSERT_TRUE(rle_decoder.CheckNext(rle_ptr, rle_limit));
+  rle_ptr += rle_decoder.Decode(rle_ptr, &decoded_data);
+  ASSERT_EQ(rle_limit, rle_ptr);
+  ASSERT_TRUE(rle_decoder.CheckNext(rle_ptr, rle_limit));
+
+  // Dictionary entries past the dictionary, and a truncated dictionary
+  FixedLengthColBufEncoder dict_encoder(4, kColDict);
+  for (uint32_t i = 0; i < 3; ++i) {
+    dict_encoder.Append(reinterpret_cast<const char*>(&i));
+  }
+  dict_encoder.Finish();
+  std::string dict_data = dict_encoder.GetData();
+  const char* dict_ptr = dict_data.data();
+  const char* dict_limit = dict_ptr + dict_data.size();
+  FixedLengthColBufDecoder dict_decoder(4, kColDict);
+  ASSERT_FALSE(dict_decoder.CheckInit(dict_ptr, dict_ptr + 2));
+  ASSERT_TRUE(dict_decoder.CheckInit(dict_ptr, dict_limit));
+  dict_ptr += dict_decoder.Init(dict_ptr);
+  ASSERT_TRUE(dict_decoder.CheckNext(dict_ptr, dict_limit));
+  dict_data[dict_ptr - dict_data.data()] = 3;
+  ASSERT_FALSE(dict_decoder.CheckNext(dict_ptr, dict_limit));
+
+  // Every chunk of the value
+  VariableChunkColBufEncoder chunk_encoder(kColNoCompression);
+  std::string chunk_buf("12345678\377\1\0\0\0\0\0\0\0\376", 18);
+  chunk_encoder.Append(chunk_buf.c_str());
+  chunk_encoder.Finish();
+  const std::string& chunk_data = chunk_encoder.GetData();
+  const char* chunk_ptr = chunk_data.data();
+  VariableChunkColBufDecoder chunk_decoder(kColNoCompression);
+  ASSERT_TRUE(
+      chunk_decoder.CheckNext(chunk_ptr, chunk_ptr + chunk_data.size()));
+  ASSERT_FALSE(
+      chunk_decoder.CheckNext(chunk_ptr, chunk_ptr + chunk_data.size() - 1));
+
+  delete[] decoded_data_base;
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
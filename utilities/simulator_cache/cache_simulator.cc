@@ -0,0 +1,166 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "utilities/simulator_cache/cache_simulator.h"
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include "util/string_util.h"
+
+namespace rocksdb {
+
+const char* TraceBlockTypeName(TraceBlockType type) {
+  switch (type) {
+    case TraceBlockType::kDataBlock:
+      return "data";
+    case TraceBlockType::kFilterBlock:
+      return "filter";
+    case TraceBlockType::kIndexBlock:
+      return "index";
+    case TraceBlockType::kRangeDeletionBlock:
+      return "range_deletion";
+    default:
+      return "unknown";
+  }
+}
+
+const char* TableReaderCallerName(TableReaderCaller caller) {
+  switch (caller) {
+    case TableReaderCaller::kUserGet:
+      return "get";
+    case TableReaderCaller::kUserIterator:
+      return "iterator";
+    case TableReaderCaller::kCompaction:
+      return "compaction";
+    case TableReaderCaller::kPrefetch:
+      return "prefetch";
+    case TableReaderCaller::kOther:
+      return "other";
+    default:
+      return "unknown";
+  }
+}
+
+CacheSimulator::CacheSimulator(std::shared_ptr<Cache> sim_cache,
+                               bool high_pri_index_and_filter)
+    : sim_cache_(sim_cache),
+      high_pri_index_and_filter_(high_pri_index_and_filter) {}
+
+void CacheSimulator::Access(const BlockCacheTraceRecord& access) {
+  bool is_miss = false;
+  Cache::Handle* handle = sim_cache_->Lookup(access.block_key);
+  if (handle != nullptr) {
+    sim_cache_->Release(handle);
+  } else {
+    is_miss = true;
+    if (!access.no_insert) {
+      const bool high_pri =
+          high_pri_index_and_filter_ &&
+          (access.block_type == TraceBlockType::kIndexBlock ||
+           access.block_type == TraceBlockType::kFilterBlock);
+      sim_cache_->Insert(access.block_key, nullptr /* value */,
+                         access.block_size, [](const Slice& k, void* v) {},
+                         nullptr /* handle */,
+                         high_pri ? Cache::Priority::HIGH
+                                  : Cache::Priority::LOW);
+    }
+  }
+
+  CacheAccessCounts* counts[] = {
+      &total_, &block_types_[static_cast<int>(access.block_type)],
+      &callers_[static_cast<int>(access.caller)], &levels_[access.level]};
+  for (CacheAccessCounts* c : counts) {
+    c->accesses++;
+    if (is_miss) {
+      c->misses++;
+    }
+  }
+}
+
+Status BlockCacheTraceSimulator::Create(
+    const std::vector<CacheConfiguration>& configs,
+    std::unique_ptr<BlockCacheTraceSimulator>* simulator) {
+  std::unique_ptr<BlockCacheTraceSimulator> result(
+      new BlockCacheTraceSimulator());
+  for (const auto& config : configs) {
+    // The caches have a single shard, so that the whole capacity is managed
+    // by one policy, as in a cache too large for sharding to matter
+    const size_t capacity = static_cast<size_t>(config.capacity);
+    std::shared_ptr<Cache> cache;
+    bool high_pri_index_and_filter = false;
+    if (config.policy == "lru") {
+      cache = NewLRUCache(capacity, 0 /* num_shard_bits */);
+    } else if (config.policy == "lru_priority") {
+      cache = NewLRUCache(capacity, 0 /* num_shard_bits */,
+                          false /* strict_capacity_limit */,
+                          0.5 /* high_pri_pool_ratio */);
+      high_pri_index_and_filter = true;
+    } else if (config.policy == "lru_tinylfu") {
+      cache = NewLRUCache(capacity, 0 /* num_shard_bits */,
+                          false /* strict_capacity_limit */,
+                          0.0 /* high_pri_pool_ratio */,
+                          true /* use_admission_filter */);
+    } else if (config.policy == "clock") {
+      cache = NewClockCache(capacity, 0 /* num_shard_bits */);
+      if (cache == nullptr) {
+        return Status::NotSupported("Clock cache is not supported");
+      }
+    } else {
+      return Status::InvalidArgument("Unknown cache policy", config.policy);
+    }
+    result->configs_.push_back(config);
+    result->simulators_.emplace_back(
+        new CacheSimulator(cache, high_pri_index_and_filter));
+  }
+  *simulator = std::move(result);
+  return Status::OK();
+}
+
+void BlockCacheTraceSimulator::Access(const BlockCacheTraceRecord& access) {
+  for (auto& sim : simulators_) {
+    sim->Access(access);
+  }
+}
+
+std::string BlockCacheTraceSimulator::ToCSV() const {
+  std::string csv = "policy,capacity,group,accesses,misses,miss_ratio\n";
+  char buffer[200];
+  for (size_t i = 0; i < simulators_.size(); i++) {
+    const CacheSimulator& sim = *simulators_[i];
+    auto append = [&](const std::string& group, const CacheAccessCounts& c) {
+      if (c.accesses == 0) {
+        return;
+      }
+      snprintf(buffer, sizeof(buffer), "%s,%" PRIu64 ",%s,%" PRIu64
+                                       ",%" PRIu64 ",%.4f\n",
+               configs_[i].policy.c_str(), configs_[i].capacity,
+               group.c_str(), c.accesses, c.misses, c.miss_ratio());
+      csv.append(buffer);
+    };
+    append("all", sim.total());
+    for (int t = 0; t < static_cast<int>(TraceBlockType::kNumBlockTypes);
+         t++) {
+      const TraceBlockType type = static_cast<TraceBlockType>(t);
+      append(std::string("block_type_") + TraceBlockTypeName(type),
+             sim.block_type(type));
+    }
+    for (int c = 0; c < static_cast<int>(TableReaderCaller::kNumCallers);
+         c++) {
+      const TableReaderCaller caller = static_cast<TableReaderCaller>(c);
+      append(std::string("caller_") + TableReaderCallerName(caller),
+             sim.caller(caller));
+    }
+    for (const auto& level : sim.levels()) {
+      append("level_" + ToString(level.first), level.second);
+    }
+  }
+  return csv;
+}
+
+}  // namespace rocksdb
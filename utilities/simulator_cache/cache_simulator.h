@@ -0,0 +1,104 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "rocksdb/block_cache_tracer.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/status.h"
+
+namespace rocksdb {
+
+// Lookups and misses of a group of blocks
+struct CacheAccessCounts {
+  uint64_t accesses = 0;
+  uint64_t misses = 0;
+
+  double miss_ratio() const {
+    return accesses == 0 ? 0.0 : 100.0 * misses / accesses;
+  }
+};
+
+// CacheSimulator replays the lookups of a block cache trace against a cache
+// that only holds keys, and counts the misses for each block type, level
+// and caller.
+class CacheSimulator {
+ public:
+  // Index and filter blocks are inserted with high priority if
+  // high_pri_index_and_filter is set.
+  CacheSimulator(std::shared_ptr<Cache> sim_cache,
+                 bool high_pri_index_and_filter);
+
+  void Access(const BlockCacheTraceRecord& access);
+
+  const CacheAccessCounts& total() const { return total_; }
+  const CacheAccessCounts& block_type(TraceBlockType type) const {
+    return block_types_[static_cast<int>(type)];
+  }
+  const CacheAccessCounts& caller(TableReaderCaller caller) const {
+    return callers_[static_cast<int>(caller)];
+  }
+  // Keyed by level, -1 for tables of unknown level
+  const std::map<int, CacheAccessCounts>& levels() const { return levels_; }
+
+ private:
+  std::shared_ptr<Cache> sim_cache_;
+  const bool high_pri_index_and_filter_;
+  CacheAccessCounts total_;
+  CacheAccessCounts
+      block_types_[static_cast<int>(TraceBlockType::kNumBlockTypes)];
+  CacheAccessCounts callers_[static_cast<int>(TableReaderCaller::kNumCallers)];
+  std::map<int, CacheAccessCounts> levels_;
+};
+
+// A cache policy and capacity to simulate. The policies are:
+//   lru            LRUCache
+//   lru_priority   LRUCache with half of it reserved for index and filter
+//                  blocks
+//   lru_tinylfu    LRUCache with its admission filter
+//   clock          ClockCache, if supported on this platform
+struct CacheConfiguration {
+  std::string policy;
+  uint64_t capacity;
+};
+
+// Replays a block cache trace against several simulated caches at once and
+// reports their miss ratios, giving a miss ratio curve for each policy.
+class BlockCacheTraceSimulator {
+ public:
+  // Returns InvalidArgument for an unknown policy and NotSupported for one
+  // not available on this platform.
+  static Status Create(const std::vector<CacheConfiguration>& configs,
+                       std::unique_ptr<BlockCacheTraceSimulator>* simulator);
+
+  void Access(const BlockCacheTraceRecord& access);
+
+  // Simulators in the order of the configurations they were created with
+  const std::vector<CacheConfiguration>& configs() const { return configs_; }
+  const std::vector<std::unique_ptr<CacheSimulator>>& simulators() const {
+    return simulators_;
+  }
+
+  // Miss ratios of every configuration as CSV, one line per configuration
+  // and group of blocks (all blocks, each block type, each caller and each
+  // level).
+  std::string ToCSV() const;
+
+ private:
+  BlockCacheTraceSimulator() {}
+
+  std::vector<CacheConfiguration> configs_;
+  std::vector<std::unique_ptr<CacheSimulator>> simulators_;
+};
+
+extern const char* TraceBlockTypeName(TraceBlockType type);
+extern const char* TableReaderCallerName(TableReaderCaller caller);
+
+}  // namespace rocksdb
@@ -0,0 +1,95 @@
+// Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "utilities/simulator_cache/cache_simulator.h"
+
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class CacheSimulatorTest : public testing::Test {
+ protected:
+  static BlockCacheTraceRecord Access(int block, TraceBlockType type,
+                                      int level) {
+    BlockCacheTraceRecord access;
+    access.block_key = "block" + ToString(block);
+    access.block_type = type;
+    access.block_size = 1000;
+    access.level = level;
+    access.caller = TableReaderCaller::kUserGet;
+    return access;
+  }
+};
+
+TEST_F(CacheSimulatorTest, CountsMisses) {
+  CacheSimulator sim(NewLRUCache(10000, 0), false);
+  // Each block misses once and then hits while the cache holds all of them
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 5; i++) {
+      sim.Access(Access(i, TraceBlockType::kDataBlock, 1));
+    }
+    sim.Access(Access(100, TraceBlockType::kIndexBlock, 2));
+  }
+  ASSERT_EQ(18U, sim.total().accesses);
+  ASSERT_EQ(6U, sim.total().misses);
+  ASSERT_EQ(15U, sim.block_type(TraceBlockType::kDataBlock).accesses);
+  ASSERT_EQ(5U, sim.block_type(TraceBlockType::kDataBlock).misses);
+  ASSERT_EQ(1U, sim.block_type(TraceBlockType::kIndexBlock).misses);
+  ASSERT_EQ(18U, sim.caller(TableReaderCaller::kUserGet).accesses);
+  ASSERT_EQ(2U, sim.levels().size());
+  ASSERT_EQ(5U, sim.levels().at(1).misses);
+  ASSERT_EQ(3U, sim.levels().at(2).accesses);
+
+  // Blocks not inserted by the traced lookup stay out of the cache
+  BlockCacheTraceRecord no_insert = Access(200, TraceBlockType::kDataBlock, 1);
+  no_insert.no_insert = true;
+  sim.Access(no_insert);
+  sim.Access(no_insert);
+  ASSERT_EQ(8U, sim.total().misses);
+}
+
+TEST_F(CacheSimulatorTest, MissRatioCurve) {
+  std::vector<CacheConfiguration> configs = {
+      {"lru", 5000}, {"lru", 20000}, {"lru_priority", 5000}};
+  std::unique_ptr<BlockCacheTraceSimulator> simulator;
+  ASSERT_OK(BlockCacheTraceSimulator::Create(configs, &simulator));
+  ASSERT_EQ(3U, simulator->simulators().size());
+
+  // Cycle through 10 data blocks and one index block. The small caches
+  // always miss on the data blocks; the large one holds all of them.
+  for (int round = 0; round < 10; round++) {
+    for (int i = 0; i < 10; i++) {
+      simulator->Access(Access(i, TraceBlockType::kDataBlock, 0));
+      simulator->Access(Access(100, TraceBlockType::kIndexBlock, 0));
+    }
+  }
+  const auto& small = *simulator->simulators()[0];
+  const auto& large = *simulator->simulators()[1];
+  const auto& priority = *simulator->simulators()[2];
+  ASSERT_EQ(100U, small.block_type(TraceBlockType::kDataBlock).misses);
+  ASSERT_EQ(10U, large.block_type(TraceBlockType::kDataBlock).misses);
+  ASSERT_GT(small.total().miss_ratio(), large.total().miss_ratio());
+  // The high priority pool keeps the index block cached
+  ASSERT_EQ(1U, priority.block_type(TraceBlockType::kIndexBlock).misses);
+
+  std::string csv = simulator->ToCSV();
+  ASSERT_NE(std::string::npos, csv.find("lru,20000,all,200,11,5.5000\n"));
+  ASSERT_NE(std::string::npos, csv.find("lru,5000,block_type_data,100,100,"));
+  ASSERT_NE(std::string::npos, csv.find("lru_priority,5000,level_0,200,"));
+}
+
+TEST_F(CacheSimulatorTest, UnknownPolicy) {
+  std::unique_ptr<BlockCacheTraceSimulator> simulator;
+  ASSERT_TRUE(BlockCacheTraceSimulator::Create({{"fifo", 1000}}, &simulator)
+                  .IsInvalidArgument());
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -16,10 +16,10 @@ class SimCacheImpl : public SimCache {
  public:
   // capacity for real cache (ShardedLRUCache)
   // test_capacity for key only cache
-  SimCacheImpl(std::shared_ptr<Cache> cache, size_t sim_capacity,
-               int num_shard_bits)
+  SimCacheImpl(std::shared_ptr<Cache> cache,
+               std::shared_ptr<Cache> key_only_cache)
       : cache_(cache),
-        key_only_cache_(NewLRUCache(sim_capacity, num_shard_bits)),
+        key_only_cache_(key_only_cache),
         miss_times_(0),
         hit_times_(0) {}
 
@@ -40,17 +40,24 @@ class SimCacheImpl : public SimCache {
     // will be called by user to perform some external operation which should
     // be applied only once. Thus key_only_cache accepts an empty function.
     // *Lambda function without capture can be assgined to a function pointer
-    Handle* h = key_only_cache_->Lookup(key);
-    if (h == nullptr) {
-      key_only_cache_->Insert(key, nullptr, charge,
-                              [](const Slice& k, void* v) {}, nullptr,
-                              priority);
-    } else {
-      key_only_cache_->Release(h);
-    }
+    // Inserting a key that is already there only refreshes it, so there is
+    // no need to look it up first, which would count as an extra access
+    // for an admission filter.
+    key_only_cache_->Insert(key, nullptr, charge,
+                            [](const Slice& k, void* v) {}, nullptr, priority);
     return cache_->Insert(key, value, charge, deleter, handle, priority);
   }
 
+  virtual Status InsertWithHelper(const Slice& key, void* value, size_t charge,
+                                  const CacheTierHelper* helper,
+                                  Handle** handle,
+                                  Priority priority) override {
+    key_only_cache_->Insert(key, nullptr, charge,
+                            [](const Slice& k, void* v) {}, nullptr, priority);
+    return cache_->InsertWithHelper(key, value, charge, helper, handle,
+                                    priority);
+  }
+
   virtual Handle* Lookup(const Slice& key, Statistics* stats) override {
     Handle* h = key_only_cache_->Lookup(key);
     if (h != nullptr) {
@@ -109,6 +116,12 @@ class SimCacheImpl : public SimCache {
     key_only_cache_->EraseUnRefEntries();
   }
 
+  virtual void GetHotKeys(
+      size_t max_entries,
+      std::vector<std::pair<std::string, Priority>>* keys) override {
+    cache_->GetHotKeys(max_entries, keys);
+  }
+
   virtual size_t GetSimCapacity() const override {
     return key_only_cache_->GetCapacity();
   }
@@ -176,7 +189,16 @@ std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> cache,
   if (num_shard_bits >= 20) {
     return nullptr;  // the cache cannot be sharded into too many fine pieces
   }
-  return std::make_shared<SimCacheImpl>(cache, sim_capacity, num_shard_bits);
+  return std::make_shared<SimCacheImpl>(
+      cache, NewLRUCache(sim_capacity, num_shard_bits));
+}
+
+std::shared_ptr<SimCache> NewSimCache(std::shared_ptr<Cache> cache,
+                                      std::shared_ptr<Cache> sim_cache) {
+  if (sim_cache == nullptr) {
+    return nullptr;
+  }
+  return std::make_shared<SimCacheImpl>(cache, sim_cache);
 }
 
 }  // end namespace rocksdb
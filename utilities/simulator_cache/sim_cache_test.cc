@@ -138,6 +138,40 @@ TEST_F(SimCacheTest, SimCache) {
   ASSERT_EQ(6, simCache->get_hit_counter());
 }
 
+TEST_F(SimCacheTest, CompareAdmissionPolicies) {
+  std::shared_ptr<Cache> cache = NewLRUCache(1 << 20, 0);
+  // Stack two simulations to see both on the same traffic
+  std::shared_ptr<SimCache> lru = NewSimCache(cache, NewLRUCache(5, 0));
+  std::shared_ptr<SimCache> tiny_lfu = NewSimCache(
+      lru, NewLRUCache(5, 0, false /* strict_capacity_limit */,
+                       0.0 /* high_pri_pool_ratio */,
+                       true /* use_admission_filter */));
+  ASSERT_TRUE(tiny_lfu != nullptr);
+
+  auto access = [&](const std::string& key) {
+    Cache::Handle* handle = tiny_lfu->Lookup(key);
+    if (handle != nullptr) {
+      tiny_lfu->Release(handle);
+    } else {
+      ASSERT_OK(tiny_lfu->Insert(key, nullptr, 1,
+                                 [](const Slice& k, void* v) {}));
+    }
+  };
+  // A few hot keys mixed with a scan that reads every other key once
+  int scan_key = 0;
+  for (int round = 0; round < 100; round++) {
+    for (int i = 0; i < 4; i++) {
+      access("hot" + ToString(i));
+    }
+    for (int i = 0; i < 4; i++) {
+      access("scan" + ToString(scan_key++));
+    }
+  }
+  ASSERT_EQ(800U, lru->get_hit_counter() + lru->get_miss_counter());
+  ASSERT_EQ(800U, tiny_lfu->get_hit_counter() + tiny_lfu->get_miss_counter());
+  ASSERT_GT(tiny_lfu->get_hit_counter(), 3 * lru->get_hit_counter());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {